@@ -49,8 +49,10 @@ class FootprintMerge;
  *  existing FootprintMerge, the Footprint will be added to it.  If not, then a new FootprintMerge will be
  *  created and added to the vector.
  *
- *  The search algorithm uses a brute force approach over the current list.  This should be fine if we
- *  are operating on smallish number of objects, such as at the tract level.
+ *  While a catalog is added, the existing FootprintMerges are indexed by the cells of a uniform grid
+ *  that their bounding boxes cover, so each Footprint is only compared to the FootprintMerges near it.
+ *  These are visited in the order of the list, so the result is the same as that of comparing each
+ *  Footprint to every FootprintMerge.
  *
  */
 class FootprintMergeList final {
@@ -67,11 +67,15 @@ public:
      * @param npixMin minimum number of pixels in an object
      * @param setPeaks should I set the Peaks list?
      * @param peakSchema Schema for peak records, even if we don't measure them here.
+     * @param numThreads number of threads to search with; 0 means one per hardware thread.
+     *                   The Footprints, their order and their peaks do not depend on this.
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if numThreads is negative
      */
     template <typename ImagePixelT>
     FootprintSet(image::Image<ImagePixelT> const& img, Threshold const& threshold, int const npixMin = 1,
                  bool const setPeaks = true,
-                 table::Schema const& peakSchema = PeakTable::makeMinimalSchema());
+                 table::Schema const& peakSchema = PeakTable::makeMinimalSchema(), int const numThreads = 1);
 
     /**
      * Find a FootprintSet given a Mask and a threshold
@@ -79,9 +83,13 @@ public:
      * @param img Image to search for objects
      * @param threshold threshold to find objects
      * @param npixMin minimum number of pixels in an object
+     * @param numThreads number of threads to search with; 0 means one per hardware thread
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if numThreads is negative
      */
     template <typename MaskPixelT>
-    FootprintSet(image::Mask<MaskPixelT> const& img, Threshold const& threshold, int const npixMin = 1);
+    FootprintSet(image::Mask<MaskPixelT> const& img, Threshold const& threshold, int const npixMin = 1,
+                 int const numThreads = 1);
 
     /**
      * Find a FootprintSet given a MaskedImage and a threshold
@@ -100,10 +108,15 @@ public:
      * @param planeName mask plane to set (if != "")
      * @param npixMin minimum number of pixels in an object
      * @param setPeaks should I set the Peaks list?
+     * @param numThreads number of threads to search with; 0 means one per hardware thread.
+     *                   The Footprints, their order and their peaks do not depend on this.
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if numThreads is negative
      */
     template <typename ImagePixelT, typename MaskPixelT>
     FootprintSet(image::MaskedImage<ImagePixelT, MaskPixelT> const& img, Threshold const& threshold,
-                 std::string const& planeName = "", int const npixMin = 1, bool const setPeaks = true);
+                 std::string const& planeName = "", int const npixMin = 1, bool const setPeaks = true,
+                 int const numThreads = 1);
 
     /**
      * Construct an empty FootprintSet given a region that its footprints would have lived in
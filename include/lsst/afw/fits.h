@@ -581,7 +581,13 @@ public:
     /// Return the number of row in a table.
     std::size_t countRows();
 
-    /// Write an array value to a binary table.
+    /**
+     *  Write an array value to a binary table.
+     *
+     *  If nElements is larger than the size of a fixed-length column's cells, the values continue
+     *  into the same column of the following rows, so a block of rows can be written at once.
+     *  For a bit column, std::uint8_t values are written as packed bytes (most significant bit first).
+     */
     template <typename T>
     void writeTableArray(std::size_t row, int col, int nElements, T const* value);
 
@@ -593,7 +599,13 @@ public:
     /// Write a string to a binary table.
     void writeTableScalar(std::size_t row, int col, std::string const& value);
 
-    /// Read an array value from a binary table.
+    /**
+     *  Read an array value from a binary table.
+     *
+     *  As with writeTableArray, nElements may be larger than the size of a fixed-length column's
+     *  cells to read the same column of a block of rows at once, and std::uint8_t values are read
+     *  from a bit column as packed bytes.
+     */
     template <typename T>
     void readTableArray(std::size_t row, int col, int nElements, T* value);
 
@@ -27,7 +27,9 @@
 
 #include <vector>
 #include <algorithm>
+#include <cstddef>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <utility>
 #include "lsst/pex/exceptions.h"
@@ -55,6 +57,79 @@ public:
     bool operator()(T pixelValue) { return pixelValue != 0; }
 };
 
+/* Random access iterator over the Spans of a SpanSet
+ *
+ * SpanSets made from one another by shifting share their Spans, and differ only in an offset, so the
+ * iterator adds the offset to each stored Span and dereferences to a Span by value.
+ */
+class SpanSetIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Span;
+    using difference_type = std::ptrdiff_t;
+    using reference = Span;
+
+    // Keeps the Span returned by operator-> alive for the rest of the expression using it
+    class pointer {
+    public:
+        explicit pointer(Span const &span) : _span(span) {}
+        Span const *operator->() const { return &_span; }
+
+    private:
+        Span _span;
+    };
+
+    SpanSetIterator() noexcept : _ptr(nullptr), _dx(0), _dy(0) {}
+    SpanSetIterator(Span const *ptr, int dx, int dy) noexcept : _ptr(ptr), _dx(dx), _dy(dy) {}
+
+    reference operator*() const { return Span(_ptr->getY() + _dy, _ptr->getX0() + _dx, _ptr->getX1() + _dx); }
+    pointer operator->() const { return pointer(**this); }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    SpanSetIterator &operator++() {
+        ++_ptr;
+        return *this;
+    }
+    SpanSetIterator operator++(int) {
+        SpanSetIterator old(*this);
+        ++_ptr;
+        return old;
+    }
+    SpanSetIterator &operator--() {
+        --_ptr;
+        return *this;
+    }
+    SpanSetIterator operator--(int) {
+        SpanSetIterator old(*this);
+        --_ptr;
+        return old;
+    }
+    SpanSetIterator &operator+=(difference_type n) {
+        _ptr += n;
+        return *this;
+    }
+    SpanSetIterator &operator-=(difference_type n) {
+        _ptr -= n;
+        return *this;
+    }
+    SpanSetIterator operator+(difference_type n) const { return SpanSetIterator(_ptr + n, _dx, _dy); }
+    SpanSetIterator operator-(difference_type n) const { return SpanSetIterator(_ptr - n, _dx, _dy); }
+    friend SpanSetIterator operator+(difference_type n, SpanSetIterator const &it) { return it + n; }
+    difference_type operator-(SpanSetIterator const &other) const { return _ptr - other._ptr; }
+
+    bool operator==(SpanSetIterator const &other) const { return _ptr == other._ptr; }
+    bool operator!=(SpanSetIterator const &other) const { return _ptr != other._ptr; }
+    bool operator<(SpanSetIterator const &other) const { return _ptr < other._ptr; }
+    bool operator>(SpanSetIterator const &other) const { return _ptr > other._ptr; }
+    bool operator<=(SpanSetIterator const &other) const { return _ptr <= other._ptr; }
+    bool operator>=(SpanSetIterator const &other) const { return _ptr >= other._ptr; }
+
+private:
+    Span const *_ptr;
+    int _dx;
+    int _dy;
+};
+
 }  // namespace details
 
 /** An enumeration class which describes the shapes
@@ -73,26 +148,37 @@ enum class Stencil { CIRCLE, BOX, MANHATTAN };
  * The SpanSet class also contains mathematical set style operators, for working with
  * the collection of pixels, and helper functions which make use of the area defined
  * to perform localized actions
+ *
+ * SpanSets are immutable, so their Spans are stored once and shared: a SpanSet made by shifting,
+ * copying, or otherwise reproducing another refers to the same Spans, and a shift only records an
+ * offset.  Iterators therefore yield Spans by value.
+ *
+ * This sharing has costs of its own:
+ *  - A SpanSet that is never shifted or copied uses more memory than a plain vector of Spans would:
+ *    a shared_ptr control block (allocated together with the vector) and an Extent2I offset.
+ *  - const_iterator is a random access iterator of its own, not std::vector<Span>::const_iterator,
+ *    and front() and back() return Spans by value rather than by reference.  Code that relied on
+ *    either (e.g. by taking the address of a Span) must copy the Spans it needs.
  */
 class SpanSet : public afw::table::io::PersistableFacade<lsst::afw::geom::SpanSet>,
                 public afw::table::io::Persistable {
 public:
-    using const_iterator = std::vector<Span>::const_iterator;
+    using const_iterator = details::SpanSetIterator;
     using size_type = std::vector<Span>::size_type;
     using value_type = Span;
-    using const_reference = const value_type &;
+    using const_reference = value_type;
 
     // Expose properties of the underlying vector containing spans such that the
     // SpanSet can be considered a container.
     // Return the constant versions as SpanSets should be immutable
-    const_iterator begin() const { return _spanVector.cbegin(); }
-    const_iterator end() const { return _spanVector.cend(); }
-    const_iterator cbegin() const { return _spanVector.cbegin(); }
-    const_iterator cend() const { return _spanVector.cend(); }
-    const_reference front() const { return const_cast<geom::Span &>(_spanVector.front()); }
-    const_reference back() const { return const_cast<geom::Span &>(_spanVector.back()); }
-    size_type size() const { return _spanVector.size(); }
-    bool empty() const { return _spanVector.empty(); }
+    const_iterator begin() const { return const_iterator(_spans->data(), _offset.getX(), _offset.getY()); }
+    const_iterator end() const { return begin() + _spans->size(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+    const_reference front() const { return *begin(); }
+    const_reference back() const { return *(end() - 1); }
+    size_type size() const { return _spans->size(); }
+    bool empty() const { return _spans->empty(); }
 
     /** Default constructor
      *
@@ -120,18 +206,8 @@ public:
                         be normalized.
      */
     template <typename iter>
-    SpanSet(iter begin, iter end, bool normalize = true) : _spanVector(begin, end) {
-        // Return a null SpanSet if spanVector is 0
-        if (_spanVector.size() == 0) {
-            _bbox = lsst::geom::Box2I();
-            _area = 0;
-        } else {
-            if (normalize) {
-                _runNormalize();
-            }
-            _initialize();
-        }
-    }
+    SpanSet(iter begin, iter end, bool normalize = true)
+            : SpanSet(std::vector<Span>(begin, end), normalize) {}
 
     /** Construct a SpanSet from a std vector by copying
      *
@@ -256,6 +332,11 @@ public:
      * @param r radius of the stencil, the length is inclusive i.e. 3 ranges from -3 to 3
      * @param s must be an enumeration of type geom::Stencil. Specifies the shape of the
                 dilation kernel. May be CIRCLE, MANHATTAN, or BOX
+     *
+     * The result is the same as that of the overload taking fromShape(r, s), but is computed one
+     * row at a time from runs of pixels, so large SpanSets and radii are much cheaper.
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if r < 0
      */
     std::shared_ptr<SpanSet> dilated(int r, Stencil s = Stencil::CIRCLE) const;
 
@@ -274,6 +355,11 @@ public:
      * @param r radius of the stencil, the length is inclusive i.e. 3 ranges from -3 to 3
      * @param s must be an enumeration of type geom::Stencil. Specifies the shape of the
                 erosion kernel. May be CIRCLE, MANHATTAN, or BOX
+     *
+     * The result is the same as that of the overload taking fromShape(r, s), but is computed one
+     * row at a time from runs of pixels, so large SpanSets and radii are much cheaper.
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if r < 0
      */
     std::shared_ptr<SpanSet> eroded(int r, Stencil s = Stencil::CIRCLE) const;
 
@@ -545,6 +631,10 @@ public:
     /** Determine the common points between two SpanSets, and create a new SpanSet
      *
      * @param other The other SpanSet with which to intersect with
+     *
+     * This and the other set operations between SpanSets walk the normalized Spans of both SpanSets
+     * together in a single pass.  A SpanSet constructed with normalize=false from Spans which were not
+     * normalized is first replaced by a normalized copy.
      */
     std::shared_ptr<SpanSet> intersect(SpanSet const &other) const;
 
@@ -582,6 +672,25 @@ public:
      */
     std::shared_ptr<SpanSet> union_(SpanSet const &other) const;
 
+    /** Create a new SpanSet that contains all points from any of several SpanSets
+     *
+     * The SpanSets are merged together in a single pass, which is much faster than computing their
+     * union one SpanSet at a time.
+     *
+     * @param spanSets The SpanSets from which the union will be calculated; none may be null
+     */
+    static std::shared_ptr<SpanSet> unionAll(std::vector<std::shared_ptr<SpanSet>> const &spanSets);
+
+    /** Create a new SpanSet that contains the points common to all of several SpanSets
+     *
+     * The SpanSets are intersected one row at a time, skipping rows missing from any of them, which is
+     * much faster than computing their intersection one SpanSet at a time.
+     *
+     * @param spanSets The SpanSets from which the intersection will be calculated; none may be null.
+     *                 The intersection of no SpanSets is a null SpanSet.
+     */
+    static std::shared_ptr<SpanSet> intersectAll(std::vector<std::shared_ptr<SpanSet>> const &spanSets);
+
     /** Determine the union between a SpanSet and a Mask for a given bit pattern
      *
      * @tparam T Pixel type of the Mask
@@ -731,23 +840,34 @@ private:
      */
     friend class SpansSetFactory;
 
-    /* A function to combine overlapping Spans in a SpanSet into a single Span
+    /* Construct a SpanSet which shares the given Spans, shifted by offset
+     */
+    SpanSet(std::shared_ptr<std::vector<Span> const> spans, lsst::geom::Extent2I const &offset,
+            lsst::geom::Box2I const &bbox, std::size_t area, bool normalized);
+
+    /* A function to combine overlapping Spans in a vector into a single Span
      */
-    void _runNormalize();
+    static void _runNormalize(std::vector<Span> &spans);
 
-    /* Initializes the SpanSet class. Contains code that is common to multiple constructors
+    /* Initializes the SpanSet class from a vector of Spans. Contains code that is common to multiple
+     * constructors
      */
-    void _initialize();
+    void _initialize(std::vector<Span> &&spans, bool normalize);
 
     /* Label Spans according to contiguous group. If the SpanSet is contiguous, all Spans will be labeled 1.
      * If there is more than one group each group will receive a label one higher than the previous.
      */
     void _label(geom::Span const &spn, std::vector<std::size_t> &labelVector, std::size_t currentLabel,
-                std::unordered_map<int, std::vector<std::pair<std::size_t, const Span *>>> &sortVector) const;
+                std::unordered_map<int, std::vector<std::pair<std::size_t, Span>>> &sortVector) const;
     std::pair<std::vector<std::size_t>, std::size_t> _makeLabels() const;
 
     std::shared_ptr<SpanSet> makeShift(int x, int y) const;
 
+    /* Return a SpanSet sharing the Spans of this one if they are normalized, as the set operations
+     * require, or a normalized copy if they are not
+     */
+    std::shared_ptr<SpanSet> _makeNormalized() const;
+
     template <typename F, typename... T>
     void applyFunctorImpl(F &&f, T... args) const {
         /* Implementation for applying functors, loop over each of the spans, and then
@@ -756,7 +876,7 @@ private:
          */
         // make sure that the SpanSet is within the bounds of functor arguments
         details::variadicBoundChecker(_bbox, _area, args...);
-        for (auto const &spn : _spanVector) {
+        for (auto const &spn : *this) {
             // Set the current span in the getter, useful for optimizing value lookups
             details::variadicSpanSetter(spn, args...);
             for (int x = spn.getX0(); x <= spn.getX1(); ++x) {
@@ -767,14 +887,22 @@ private:
         }
     }
 
-    // Vector to hold the Spans contained in the SpanSet
-    std::vector<Span> _spanVector;
+    // Vector to hold the Spans contained in the SpanSet, before they are shifted by _offset. It is never
+    // modified, so SpanSets made from one another without changing their Spans share it.
+    std::shared_ptr<std::vector<Span> const> _spans;
+
+    // Offset added to each of the stored Spans
+    lsst::geom::Extent2I _offset;
 
     // Box that is large enough to bound all pixels in the SpanSet
     lsst::geom::Box2I _bbox;
 
     // Number of pixels in the SpanSet
     std::size_t _area;
+
+    // Whether the Spans are sorted, and the Spans in each row neither overlap nor touch; a SpanSet
+    // constructed with normalize=false may not be
+    bool _normalized;
 };
 }  // namespace geom
 }  // namespace afw
@@ -61,7 +61,9 @@ class SkyWcs;
  *
  * @note "In place" versions of `applyForward` and `applyInverse` are not available
  * because data must be copied when converting from LSST data types to the type used by astshim,
- * so it didn't seem worth the bother.
+ * so it didn't seem worth the bother. Code that transforms many points, such as image warping,
+ * can instead use `applyForwardData` and `applyInverseData`, which work on astshim's raw data
+ * in arrays that the caller may reuse.
  */
 template <class FromEndpoint, class ToEndpoint>
 class Transform final : public table::io::PersistableFacade<Transform<FromEndpoint, ToEndpoint>>,
@@ -167,6 +169,35 @@ public:
      */
     FromArray applyInverse(ToArray const &array) const;
 
+    /**
+     * Transform raw point data in the forward direction, into a preallocated array
+     *
+     * Unlike `applyForward` this neither converts nor allocates anything, so it is suited to
+     * transforming many points in arrays that are reused.
+     *
+     * @param[in] from  the points to transform, with shape (`getFromEndpoint().getNAxes()`, nPoints),
+     *                  in the units used by AST (e.g. radians for a SpherePointEndpoint) and in the order
+     *                  x0, x1, x2, ..., y0, y1, y2...
+     * @param[out] to  the transformed points, with shape (`getToEndpoint().getNAxes()`, nPoints)
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if the arrays have the wrong shape
+     */
+    void applyForwardData(ndarray::Array<double const, 2, 2> const &from,
+                          ndarray::Array<double, 2, 2> const &to) const;
+
+    /**
+     * Transform raw point data in the inverse direction, into a preallocated array
+     *
+     * @param[in] from  the points to transform, with shape (`getToEndpoint().getNAxes()`, nPoints)
+     * @param[out] to  the transformed points, with shape (`getFromEndpoint().getNAxes()`, nPoints)
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if the arrays have the wrong shape
+     *
+     * @see applyForwardData
+     */
+    void applyInverseData(ndarray::Array<double const, 2, 2> const &from,
+                          ndarray::Array<double, 2, 2> const &to) const;
+
     /**
      * The inverse of this Transform.
      *
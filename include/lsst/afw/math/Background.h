@@ -71,7 +71,8 @@ public:
               _undersampleStyle(THROW_EXCEPTION),
               _sctrl(new StatisticsControl(sctrl)),
               _prop(prop),
-              _actrl(new ApproximateControl(actrl)) {
+              _actrl(new ApproximateControl(actrl)),
+              _numThreads(1) {
         if (nxSample <= 0 || nySample <= 0) {
             throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
                               str(boost::format("You must specify at least one point, not %dx%d") % nxSample %
@@ -97,7 +98,8 @@ public:
               _undersampleStyle(THROW_EXCEPTION),
               _sctrl(new StatisticsControl(sctrl)),
               _prop(stringToStatisticsProperty(prop)),
-              _actrl(new ApproximateControl(actrl)) {
+              _actrl(new ApproximateControl(actrl)),
+              _numThreads(1) {
         if (nxSample <= 0 || nySample <= 0) {
             throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
                               str(boost::format("You must specify at least one point, not %dx%d") % nxSample %
@@ -127,7 +129,8 @@ public:
               _undersampleStyle(undersampleStyle),
               _sctrl(new StatisticsControl(sctrl)),
               _prop(prop),
-              _actrl(new ApproximateControl(actrl)) {
+              _actrl(new ApproximateControl(actrl)),
+              _numThreads(1) {
         if (nxSample <= 0 || nySample <= 0) {
             throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
                               str(boost::format("You must specify at least one point, not %dx%d") % nxSample %
@@ -157,7 +160,8 @@ public:
               _undersampleStyle(math::stringToUndersampleStyle(undersampleStyle)),
               _sctrl(new StatisticsControl(sctrl)),
               _prop(stringToStatisticsProperty(prop)),
-              _actrl(new ApproximateControl(actrl)) {
+              _actrl(new ApproximateControl(actrl)),
+              _numThreads(1) {
         if (nxSample <= 0 || nySample <= 0) {
             throw LSST_EXCEPT(lsst::pex::exceptions::LengthError,
                               str(boost::format("You must specify at least one point, not %dx%d") % nxSample %
@@ -219,6 +223,22 @@ public:
     std::shared_ptr<ApproximateControl> getApproximateControl() { return _actrl; }
     std::shared_ptr<ApproximateControl const> getApproximateControl() const { return _actrl; }
 
+    /// Number of threads used to compute the statistics of the cells
+    int getNumThreads() const noexcept { return _numThreads; }
+    /**
+     * Set the number of threads used to compute the statistics of the cells
+     *
+     * @param numThreads  number of threads; 1 (the default) runs serially, 0 uses one thread
+     *                    per available hardware thread.  Results do not depend on this value.
+     */
+    void setNumThreads(int numThreads) {
+        if (numThreads < 0) {
+            throw LSST_EXCEPT(lsst::pex::exceptions::InvalidParameterError,
+                              "numThreads may not be negative.");
+        }
+        _numThreads = numThreads;
+    }
+
 private:
     Interpolate::Style _style;           // style of interpolation to use
     int _nxSample;                       // number of grid squares to divide image into to sample in x
@@ -227,6 +247,7 @@ private:
     std::shared_ptr<StatisticsControl> _sctrl;   // statistics control object
     Property _prop;                              // statistics Property
     std::shared_ptr<ApproximateControl> _actrl;  // approximate control object
+    int _numThreads;                             // number of threads used to compute the cells' statistics
 };
 
 /**
@@ -493,9 +514,17 @@ private:
     lsst::afw::image::MaskedImage<InternalPixelT>
             _statsImage;  // statistical properties for the grid of subimages
     mutable std::vector<std::vector<double>> _gridColumns;  // interpolated columns for the bicubic spline
+    struct InterpolationPlan;
+    mutable std::shared_ptr<InterpolationPlan> _plan;  // cached interpolants used by getImage()
 
     void _setGridColumns(Interpolate::Style const interpStyle, UndersampleStyle const undersampleStyle,
                          int const iX, std::vector<int> const& ypix) const;
+    /**
+     * Return the interpolation plan for this style, (re)building _gridColumns if the style or the
+     * statsImage has changed since the plan was made
+     */
+    InterpolationPlan& _getInterpolationPlan(Interpolate::Style const interpStyle,
+                                             UndersampleStyle const undersampleStyle) const;
 
 #if defined(LSST_makeBackground_getImage)
     BOOST_PP_SEQ_FOR_EACH(LSST_makeBackground_getImage, override, LSST_makeBackground_getImage_types);
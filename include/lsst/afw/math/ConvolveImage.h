@@ -49,6 +49,27 @@ namespace math {
  */
 class ConvolutionControl {
 public:
+    /**
+     * How to convolve with a spatially invariant kernel that is neither separable nor a delta function
+     * (e.g. a FixedKernel or AnalyticKernel)
+     *
+     * The FFT algorithm is only used if the output image has floating-point pixels; otherwise the
+     * direct algorithm is always used.
+     *
+     * @note Because AUTO is the default, convolving a floating-point image with a spatially invariant
+     * kernel of at least FFT_MIN_KERNEL_AREA pixels does not give bit-for-bit the same result as
+     * direct convolution: the pixels agree only to within rounding error (roughly epsilon times the
+     * sum of the absolute values of the terms), and values that should be exactly zero may come out
+     * as tiny nonzero numbers.  Use DIRECT if you need reproducible results.
+     */
+    enum Algorithm {
+        AUTO = 0,  ///< use FFTs if the kernel has at least FFT_MIN_KERNEL_AREA pixels
+        DIRECT,    ///< compute each output pixel as a sum over the kernel
+        FFT        ///< multiply blocks of the image by the kernel in Fourier space (overlap-save)
+    };
+    /// The smallest kernel (width*height) for which AUTO uses FFTs
+    static int const FFT_MIN_KERNEL_AREA = 15 * 15;
+
     ConvolutionControl(bool doNormalize = true,  ///< normalize the kernel to sum=1?
                        bool doCopyEdge = false,  ///< copy edge pixels from source image
                        ///< instead of setting them to the standard edge pixel?
@@ -57,17 +78,42 @@ public:
                        )
             : _doNormalize(doNormalize),
               _doCopyEdge(doCopyEdge),
-              _maxInterpolationDistance(maxInterpolationDistance) {}
+              _maxInterpolationDistance(maxInterpolationDistance),
+              _numThreads(1),
+              _algorithm(AUTO) {}
 
     bool getDoNormalize() const { return _doNormalize; }
     bool getDoCopyEdge() const { return _doCopyEdge; }
     int getMaxInterpolationDistance() const { return _maxInterpolationDistance; };
+    int getNumThreads() const { return _numThreads; }
+    Algorithm getAlgorithm() const { return _algorithm; }
 
     void setDoNormalize(bool doNormalize) { _doNormalize = doNormalize; }
     void setDoCopyEdge(bool doCopyEdge) { _doCopyEdge = doCopyEdge; }
     void setMaxInterpolationDistance(int maxInterpolationDistance) {
         _maxInterpolationDistance = maxInterpolationDistance;
     }
+    /**
+     * Set the number of threads used to convolve
+     *
+     * The output is divided into bands of rows (of interpolation subregions, when interpolating)
+     * and each band is convolved by its own thread, with its own copy of the kernel and kernel images.
+     * The bands are chosen so that every output pixel is computed exactly as it is in serial, so the
+     * result does not depend on the number of threads.
+     *
+     * @param numThreads  number of threads; 1 (the default) runs serially, 0 uses one thread
+     *                    per available hardware thread
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if numThreads is negative
+     */
+    void setNumThreads(int numThreads) {
+        if (numThreads < 0) {
+            throw LSST_EXCEPT(lsst::pex::exceptions::InvalidParameterError,
+                              "numThreads may not be negative.");
+        }
+        _numThreads = numThreads;
+    }
+    void setAlgorithm(Algorithm algorithm) { _algorithm = algorithm; }
 
 private:
     bool _doNormalize;              ///< normalize the kernel to sum=1?
@@ -75,6 +121,8 @@ private:
                                     ///< instead of setting them to the standard edge pixel?
     int _maxInterpolationDistance;  ///< maximum width or height of a region
                                     ///< over which to attempt interpolation
+    int _numThreads;                ///< number of threads to use; 0 for one per hardware thread
+    Algorithm _algorithm;           ///< how to convolve with spatially invariant kernels
 };
 
 /**
@@ -131,9 +179,11 @@ inline typename OutImageT::SinglePixel convolveAtAPoint(
  * to the lower left corner of the sub-image, but it will almost certainly change to be
  * the lower left corner of the parent image.
  *
- * All convolution is performed in real space. This allows convolution to handle masked pixels
- * and spatially varying kernels. Although convolution of an Image with a spatially invariant kernel could,
- * in fact, be performed in Fourier space, the code does not do this.
+ * Convolution is normally performed in real space. This allows convolution to handle masked pixels
+ * and spatially varying kernels. Large spatially invariant kernels are, however, convolved with
+ * floating-point images in Fourier space (see ConvolutionControl::Algorithm); the mask is still smeared
+ * in real space, and pixels affected by non-finite input values are computed directly, so the results
+ * agree with real-space convolution to within rounding error.
  *
  * Note that mask bits are smeared by convolution; all nonzero pixels in the kernel smear the mask, even
  * pixels that have very small values. Larger kernels smear the mask more and are also slower to convolve.
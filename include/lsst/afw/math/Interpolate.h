@@ -59,6 +59,17 @@ public:
     virtual double interpolate(double const x) const = 0;
     std::vector<double> interpolate(std::vector<double> const &x) const;
     ndarray::Array<double, 1> interpolate(ndarray::Array<double const, 1> const &x) const;
+    /**
+     * Interpolate to a set of points given in ascending order
+     *
+     * The results are identical to calling interpolate(x[i]) for each point, but subclasses may take
+     * advantage of the ordering to evaluate the points in bulk.
+     *
+     * @param x the points to interpolate to, in ascending order
+     * @param out the interpolated values; must have room for n values
+     * @param n the number of points
+     */
+    virtual void interpolateSorted(double const *x, double *out, std::size_t n) const;
 
 protected:
     /**
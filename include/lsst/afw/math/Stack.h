@@ -27,13 +27,18 @@
 /*
  * Functions to stack images
  */
+#include <utility>
 #include <vector>
+#include "lsst/geom/Box.h"
 #include "lsst/afw/image/Image.h"
 #include "lsst/afw/image/Mask.h"
 #include "lsst/afw/math/Statistics.h"
 
 namespace lsst {
 namespace afw {
+namespace image {
+class ExposureFitsReader;
+}  // namespace image
 namespace math {
 
 /* ****************************************************************** *
@@ -166,6 +171,134 @@ std::vector<PixelT> statisticsStack(
                 std::vector<lsst::afw::image::VariancePixel>(0)  ///< vector containing weights
 );
 
+/* ****************************************************************** *
+ *
+ * out-of-core stacks
+ *
+ * ******************************************************************* */
+
+/**
+ * A function to compute some statistics of a stack of MaskedImages read from disk a strip at a time
+ *
+ * @param[out] out          Output MaskedImage; its (PARENT) bounding box is the region stacked.
+ * @param[in] readers       Readers for the MaskedImages to process; each must contain out's bounding box.
+ * @param[in] flags         Statistics requested.
+ * @param[in] sctrl         Control structure.
+ * @param[in] wvector       Vector of weights.
+ * @param[in] clipped       Mask to set for pixels that were clipped (NOT rejected
+ *                          due to masks).
+ * @param[in] maskMap       Vector of pairs of mask pixel values; any pixel
+ *                          on an input with any of the bits in .first will result
+ *                          in all of the bits in .second being set on the
+ *                          corresponding pixel on the output.
+ * @param[in] stripHeight   Number of rows to read from each input at a time.
+ *
+ * The inputs are never all resident at once.  A first pass reads the bounding box of each input (but no
+ * pixels) to check that it covers the output; a second pass then reads the same strip of rows from every
+ * input, stacks it into the corresponding rows of `out`, and discards it.  Peak memory is therefore
+ * about `readers.size()*stripHeight` rows of input, whatever the size of the images.  As each output
+ * pixel only depends on the input pixels at the same position, the result is identical to stacking the
+ * complete images, for any statistic supported by statisticsStack (including MEDIAN and MEANCLIP).
+ */
+template <typename PixelT>
+void statisticsStack(lsst::afw::image::MaskedImage<PixelT>& out,
+                     std::vector<std::shared_ptr<lsst::afw::image::ExposureFitsReader>> const& readers,
+                     Property flags, StatisticsControl const& sctrl,
+                     std::vector<lsst::afw::image::VariancePixel> const& wvector, image::MaskPixel clipped,
+                     std::vector<std::pair<image::MaskPixel, image::MaskPixel>> const& maskMap,
+                     int stripHeight = 256);
+
+/**
+ * Accumulate a MEAN stack of MaskedImages that are supplied one at a time
+ *
+ * Unlike statisticsStack, the inputs need never be in memory together: each call to add() folds one
+ * image -- or one strip of an image, e.g. as returned by ExposureFitsReader::readMaskedImage(bbox) --
+ * into running per-pixel sums, and getResult() returns the stack.  Memory use is a few numbers per
+ * output pixel, independent of the number of inputs.
+ *
+ * Pixels are rejected (NaNs, StatisticsControl's andMask) and weighted (by inverse variance, or by a
+ * weight per input, if StatisticsControl::getWeighted()) as by statisticsStack with MEAN, and the
+ * output mask and variance are set in the same way.  The mean and variance are accumulated with a
+ * numerically stable single-pass update, so they agree with statisticsStack to within rounding error.
+ *
+ * MEDIAN and MEANCLIP need all the inputs for a pixel at once; use the strip-wise statisticsStack
+ * that takes ExposureFitsReaders for those.
+ */
+template <typename PixelT>
+class StackAccumulator final {
+public:
+    /**
+     * Construct an empty stack
+     *
+     * @param[in] bbox      Bounding box (PARENT) of the stack; every input must lie within it.
+     * @param[in] flags     Statistic requested; must be MEAN (possibly with ERRORS).
+     * @param[in] sctrl     Control structure.
+     * @param[in] maskMap   Vector of pairs of mask pixel values; any pixel
+     *                      on an input with any of the bits in .first will result
+     *                      in all of the bits in .second being set on the
+     *                      corresponding pixel on the output if any input was rejected.
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if flags is not MEAN
+     */
+    StackAccumulator(lsst::geom::Box2I const& bbox, Property flags,
+                     StatisticsControl const& sctrl = StatisticsControl(),
+                     std::vector<std::pair<image::MaskPixel, image::MaskPixel>> const& maskMap = {});
+
+    StackAccumulator(StackAccumulator const&) = default;
+    StackAccumulator(StackAccumulator&&) = default;
+    StackAccumulator& operator=(StackAccumulator const&) = default;
+    StackAccumulator& operator=(StackAccumulator&&) = default;
+    ~StackAccumulator() noexcept = default;
+
+    /**
+     * Add an image (or part of one) to the stack
+     *
+     * If the stack is weighted each pixel is weighted by its inverse variance.
+     *
+     * @throws lsst::pex::exceptions::LengthError if the image is not within the stack's bounding box
+     */
+    void add(lsst::afw::image::MaskedImage<PixelT> const& image);
+
+    /**
+     * Add an image (or part of one) to the stack with the given weight
+     *
+     * The weight is ignored (with a warning) unless the stack is weighted.
+     *
+     * @throws lsst::pex::exceptions::LengthError if the image is not within the stack's bounding box
+     */
+    void add(lsst::afw::image::MaskedImage<PixelT> const& image, lsst::afw::image::VariancePixel weight);
+
+    /// Return the stack of the images added so far
+    std::shared_ptr<lsst::afw::image::MaskedImage<PixelT>> getResult() const;
+
+    /// Return the sum of the weights of the pixels used at each position
+    std::shared_ptr<lsst::afw::image::Image<double>> getWeightSum() const;
+
+    /// Return the bounding box (PARENT) of the stack
+    lsst::geom::Box2I getBBox() const noexcept { return _bbox; }
+
+private:
+    void _add(lsst::afw::image::MaskedImage<PixelT> const& image, bool weightByVariance,
+              lsst::afw::image::VariancePixel weight);
+
+    lsst::geom::Box2I _bbox;
+    StatisticsControl _sctrl;
+    std::vector<std::pair<image::MaskPixel, image::MaskPixel>> _maskMap;
+    std::vector<int> _propagatedBits;             // mask bits with a propagation threshold
+    std::vector<double> _propagationThresholds;   // ... and their thresholds
+    // Per-pixel running sums, indexed by (y - y0)*width + (x - x0)
+    std::vector<double> _sumw;                         // sum(weight)
+    std::vector<double> _sumw2;                        // sum(weight^2)
+    std::vector<double> _mean;                         // weighted mean of the values used
+    std::vector<double> _m2;                           // sum(weight*(value - mean)^2)
+    std::vector<double> _sumvw2;                       // sum(variance*weight^2)
+    std::vector<int> _nUsed;                           // number of pixels used
+    std::vector<int> _nInput;                          // number of pixels supplied
+    std::vector<image::MaskPixel> _orMask;             // OR of the masks of the pixels used
+    std::vector<image::MaskPixel> _allMask;            // OR of the masks of all the pixels supplied
+    std::vector<std::vector<double>> _rejectedWeights;  // [bit][pixel] weight rejected with that bit set
+};
+
 /* ****************************************************************** *
  *
  * x,y stacks
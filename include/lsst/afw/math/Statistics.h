@@ -99,7 +99,9 @@ public:
               _isNanSafe(isNanSafe),
               _useWeights(useWeights),
               _calcErrorFromInputVariance(false),
-              _maskPropagationThresholds() {
+              _maskPropagationThresholds(),
+              _numThreads(1),
+              _vectorize(false) {
         try {
             _noGoodPixelsMask = lsst::afw::image::Mask<>::getPlaneBitMask("NO_DATA");
         } catch (lsst::pex::exceptions::InvalidParameterError const &) {
@@ -128,6 +130,10 @@ public:
     bool getWeighted() const noexcept { return _useWeights == WEIGHTS_TRUE ? true : false; }
     bool getWeightedIsSet() const noexcept { return _useWeights != WEIGHTS_NONE ? true : false; }
     bool getCalcErrorFromInputVariance() const noexcept { return _calcErrorFromInputVariance; }
+    /// Number of threads used by functions that evaluate many Statistics (e.g. statisticsStack)
+    int getNumThreads() const noexcept { return _numThreads; }
+    /// Are the sums of the standard statistics computed with vector instructions?  See setVectorize
+    bool getVectorize() const noexcept { return _vectorize; }
 
     void setNumSigmaClip(double numSigmaClip) {
         if (!(numSigmaClip > 0)) {
@@ -150,6 +156,28 @@ public:
     void setCalcErrorFromInputVariance(bool calcErrorFromInputVariance) noexcept {
         _calcErrorFromInputVariance = calcErrorFromInputVariance;
     }
+    /**
+     * Set the number of threads used by functions that evaluate many Statistics (e.g. statisticsStack)
+     *
+     * @param numThreads  number of threads; 1 (the default) runs serially, 0 uses one thread
+     *                    per available hardware thread.  Results do not depend on this value.
+     */
+    void setNumThreads(int numThreads) {
+        if (numThreads < 0) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              "numThreads may not be negative.");
+        }
+        _numThreads = numThreads;
+    }
+    /**
+     * Compute the sums of the standard statistics (e.g. MEAN, VARIANCE and their clipped versions)
+     * with vector instructions, several pixels at a time?
+     *
+     * This is faster for unweighted float and double images, but changes the order in which pixels are
+     * summed, so results may differ from the default (serial) sums by rounding.  NPOINT, MIN, MAX and
+     * the OR of the masks are unaffected.
+     */
+    void setVectorize(bool vectorize) noexcept { _vectorize = vectorize; }
 
 private:
     friend class Statistics;
@@ -163,6 +191,8 @@ private:
     bool _calcErrorFromInputVariance;  // Calculate errors from the input variances, if available
     std::vector<double> _maskPropagationThresholds;  // Thresholds for when to propagate mask bits,
                                                      // treated like a dict (unset bits are set to 1.0)
+    int _numThreads;                   // Number of threads to use when evaluating many Statistics
+    bool _vectorize;                   // Sum pixels with vector instructions, in a different order
 };
 
 /**
@@ -124,6 +124,9 @@ void basicConvolve(OutImageT& convolvedImage, InImageT const& inImage,
  * Convolve an Image or MaskedImage with a Kernel by computing the kernel image
  * at every point. (If the kernel is not spatially varying then only compute it once).
  *
+ * If the kernel is spatially invariant and convolutionControl's algorithm selects it (see
+ * useFftConvolution) the convolution is done by convolveWithFft.
+ *
  * convolvedImage must be the same size as inImage.
  * convolvedImage has a border in which the output pixels are not set. This border has size:
  * - kernel.getCtr().getX() along the left edge
@@ -148,6 +151,47 @@ void convolveWithBruteForce(OutImageT& convolvedImage, InImageT const& inImage,
                             lsst::afw::math::Kernel const& kernel,
                             lsst::afw::math::ConvolutionControl const& convolutionControl);
 
+/**
+ * Should a spatially invariant kernel be convolved with an image using convolveWithFft?
+ *
+ * @param[in] convolvedImage the image to be convolved into; FFTs are only used for floating-point images
+ * @param[in] kernel convolution kernel
+ * @param[in] convolutionControl convolution control parameters
+ */
+template <typename OutImageT>
+bool useFftConvolution(OutImageT const& convolvedImage, lsst::afw::math::Kernel const& kernel,
+                       lsst::afw::math::ConvolutionControl const& convolutionControl);
+
+/**
+ * Convolve an Image or MaskedImage with a spatially invariant kernel using FFTs
+ *
+ * The image is divided into overlapping blocks whose size is a power of two several times the size of the
+ * kernel; each block is multiplied by the kernel in Fourier space and the pixels not affected by
+ * wrap-around are kept (overlap-save).  The blocks are divided between convolutionControl's threads.
+ *
+ * The results are those of convolveWithBruteForce, to within rounding error:
+ * - the variance is convolved with the square of the kernel;
+ * - the mask of each output pixel is the OR of the masks of the input pixels under non-zero kernel pixels;
+ * - an output pixel with a non-finite input value (image or variance) under a non-zero kernel pixel is
+ *   computed directly, so NaNs and infinities propagate exactly as they do there.
+ * The same pixels are set; the border of edge pixels is left alone.
+ *
+ * @param[out] convolvedImage convolved %image; must have floating-point pixels
+ * @param[in] inImage %image to convolve
+ * @param[in] kernelImage image of the kernel, as returned by Kernel::computeImage
+ * @param[in] kernelCtr center of the kernel
+ * @param[in] convolutionControl convolution control parameters
+ *
+ * @throws lsst::pex::exceptions::InvalidParameterError if convolvedImage doesn't have floating-point pixels
+ *
+ * @warning Low-level convolution function that does not set edge pixels or check dimensions.
+ */
+template <typename OutImageT, typename InImageT>
+void convolveWithFft(OutImageT& convolvedImage, InImageT const& inImage,
+                     lsst::afw::image::Image<lsst::afw::math::Kernel::Pixel> const& kernelImage,
+                     lsst::geom::Point2I const& kernelCtr,
+                     lsst::afw::math::ConvolutionControl const& convolutionControl);
+
 // I would prefer this to be nested in KernelImagesForRegion but SWIG doesn't support that
 class RowOfKernelImagesForRegion;
 
@@ -277,6 +321,20 @@ public:
      */
     static int getMinInterpolationSize() { return _MinInterpolationSize; };
 
+    /**
+     * Compute length of each subregion for a region divided into nDivisions pieces of approximately equal
+     * length.
+     *
+     * These are the widths and heights of the subregions generated by computeNextRow.
+     *
+     * @param length length of region
+     * @param nDivisions number of divisions of region
+     * @returns a list of subspan lengths
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if nDivisions >= length
+     */
+    static std::vector<int> computeSubregionLengths(int length, int nDivisions);
+
 private:
     using LocationList = std::vector<Location>;
 
@@ -304,17 +362,6 @@ private:
 
     // static helper functions
     static inline int _computeNextSubregionLength(int length, int nDivisions);
-    /**
-     * Compute length of each subregion for a region divided into nDivisions pieces of approximately equal
-     * length.
-     *
-     * @param length length of region
-     * @param nDivisions number of divisions of region
-     * @returns a list of subspan lengths
-     *
-     * @throws lsst::pex::exceptions::InvalidParameterError if nDivisions >= length
-     */
-    static std::vector<int> _computeSubregionLengths(int length, int nDivisions);
 
     // member variables
     KernelConstPtr _kernelPtr;
@@ -0,0 +1,224 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_AFW_MATH_DETAIL_LANCZOSWARPTABLE_H
+#define LSST_AFW_MATH_DETAIL_LANCZOSWARPTABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "lsst/afw/image/LsstImageTypes.h"
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+/**
+ * A dense table of the weights of a Lanczos warping kernel, indexed by sub-pixel phase
+ *
+ * The weights for phase i are those of a LanczosWarpingKernel of the same order whose parameters
+ * (the fractional part of the source position) are (i + 0.5)/nPhase; this is exactly what
+ * SeparableKernel::computeCache stores for a cache size of nPhase, so warping with the table gives
+ * the same results as warping with a cached kernel.  Unlike the kernel's cache the table is one
+ * contiguous array, and it also holds the squared weights (for the variance) and the sum of the
+ * weights of each phase.
+ *
+ * Tables are immutable, and are shared between concurrent warps that use the same order and number of phases.
+ */
+class LanczosWarpTable final {
+public:
+    /**
+     * Return the table for a given Lanczos order and number of phases, computing it if necessary
+     *
+     * A table is kept for as long as any caller holds it, so warps with the same parameters that
+     * overlap in time share a table, but tables that are no longer used are freed.
+     * This function is thread-safe.
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if order or nPhase is not positive
+     */
+    static std::shared_ptr<LanczosWarpTable const> get(int order, int nPhase);
+
+    /// Construct a table; prefer get(), which shares tables
+    LanczosWarpTable(int order, int nPhase);
+
+    LanczosWarpTable(LanczosWarpTable const &) = delete;
+    LanczosWarpTable(LanczosWarpTable &&) = delete;
+    LanczosWarpTable &operator=(LanczosWarpTable const &) = delete;
+    LanczosWarpTable &operator=(LanczosWarpTable &&) = delete;
+    ~LanczosWarpTable() noexcept = default;
+
+    int getOrder() const noexcept { return _order; }
+    /// Number of weights per phase (the width and height of the kernel)
+    int getWidth() const noexcept { return 2 * _order; }
+    int getNPhase() const noexcept { return _nPhase; }
+
+    /// The phase for a fractional position in [0, 1), as used to index a SeparableKernel's cache
+    int getPhase(double frac) const noexcept {
+        return std::min(static_cast<int>(frac * _nPhase), _nPhase - 1);
+    }
+
+    /// The weights for a phase
+    double const *getWeights(int phase) const noexcept {
+        return _weights.data() + static_cast<std::size_t>(phase) * getWidth();
+    }
+
+    /// The squared weights for a phase
+    double const *getSquaredWeights(int phase) const noexcept {
+        return _squaredWeights.data() + static_cast<std::size_t>(phase) * getWidth();
+    }
+
+    /// The sum of the weights for a phase
+    double getSum(int phase) const noexcept { return _sums[phase]; }
+
+private:
+    int _order;
+    int _nPhase;
+    std::vector<double> _weights;
+    std::vector<double> _squaredWeights;
+    std::vector<double> _sums;
+};
+
+/**
+ * Return sum(weights[i]*pixels[i]) for i in [0, W), or [0, width) if W is 0
+ *
+ * For the common Lanczos orders W is known at compile time, so the loop is fully unrolled; float and
+ * double pixels are handled two at a time with SSE2 if W is even.
+ */
+template <int W, typename PixelT>
+inline double dotWeights(double const *weights, PixelT const *pixels, int width) {
+    int const n = (W > 0) ? W : width;
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) {
+        sum += weights[i] * static_cast<double>(pixels[i]);
+    }
+    return sum;
+}
+
+#if defined(__SSE2__)
+/// @cond
+template <int W>
+inline double dotWeightsSse2(double const *weights, float const *pixels) {
+    __m128d sum = _mm_setzero_pd();
+    for (int i = 0; i < W; i += 2) {
+        __m128i const p = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(pixels + i));
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(weights + i), _mm_cvtps_pd(_mm_castsi128_ps(p))));
+    }
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+template <int W>
+inline double dotWeightsSse2(double const *weights, double const *pixels) {
+    __m128d sum = _mm_setzero_pd();
+    for (int i = 0; i < W; i += 2) {
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(weights + i), _mm_loadu_pd(pixels + i)));
+    }
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+#define LSST_AFW_MATH_DOT_WEIGHTS_SSE2(W, PIXTYPE)                                     \
+    template <>                                                                        \
+    inline double dotWeights<W, PIXTYPE>(double const *weights, PIXTYPE const *pixels, \
+                                         int) {                                        \
+        return dotWeightsSse2<W>(weights, pixels);                                     \
+    }
+
+LSST_AFW_MATH_DOT_WEIGHTS_SSE2(6, float)
+LSST_AFW_MATH_DOT_WEIGHTS_SSE2(8, float)
+LSST_AFW_MATH_DOT_WEIGHTS_SSE2(10, float)
+LSST_AFW_MATH_DOT_WEIGHTS_SSE2(6, double)
+LSST_AFW_MATH_DOT_WEIGHTS_SSE2(8, double)
+LSST_AFW_MATH_DOT_WEIGHTS_SSE2(10, double)
+
+#undef LSST_AFW_MATH_DOT_WEIGHTS_SSE2
+/// @endcond
+#endif
+
+/**
+ * Apply a separable kernel to a window of an image: sum(yWeights[j] * xWeights[i] * pixels[j][i])
+ *
+ * @param pixels  the pixel at the window's origin
+ * @param stride  the distance between rows of the image, in pixels
+ * @param xWeights, yWeights  the kernel weights along x and y
+ * @param width  the width and height of the window; only used if W is 0
+ */
+template <int W, typename PixelT>
+inline double applyWeights(PixelT const *pixels, std::ptrdiff_t stride, double const *xWeights,
+                           double const *yWeights, int width) {
+    int const n = (W > 0) ? W : width;
+    double sum = 0.0;
+    for (int j = 0; j < n; ++j, pixels += stride) {
+        sum += yWeights[j] * dotWeights<W>(xWeights, pixels, width);
+    }
+    return sum;
+}
+
+/**
+ * Apply a separable kernel to a window of a masked image, in a single pass over its rows
+ *
+ * The image plane is weighted by the kernel, the variance plane by its square, and the mask plane
+ * is the OR of every pixel in the window (the Lanczos weights used for warping are never zero).
+ *
+ * @param image, mask, variance  the pixel at the window's origin in each plane
+ * @param imageStride, maskStride, varianceStride  the distance between rows of each plane, in pixels
+ * @param xWeights, yWeights  the kernel weights along x and y
+ * @param xSquaredWeights, ySquaredWeights  the squares of xWeights and yWeights
+ * @param width  the width and height of the window; only used if W is 0
+ * @param[out] imageSum  the weighted sum of the image plane
+ * @param[out] maskOr  the OR of the mask plane
+ * @param[out] varianceSum  the weighted sum of the variance plane
+ */
+template <int W, typename ImagePixelT, typename VariancePixelT>
+inline void applyWeights(ImagePixelT const *image, lsst::afw::image::MaskPixel const *mask,
+                         VariancePixelT const *variance, std::ptrdiff_t imageStride,
+                         std::ptrdiff_t maskStride, std::ptrdiff_t varianceStride, double const *xWeights,
+                         double const *yWeights, double const *xSquaredWeights,
+                         double const *ySquaredWeights, int width, double &imageSum,
+                         lsst::afw::image::MaskPixel &maskOr, double &varianceSum) {
+    int const n = (W > 0) ? W : width;
+    imageSum = 0.0;
+    maskOr = 0x0;
+    varianceSum = 0.0;
+    for (int j = 0; j < n; ++j, image += imageStride, mask += maskStride, variance += varianceStride) {
+        imageSum += yWeights[j] * dotWeights<W>(xWeights, image, width);
+        varianceSum += ySquaredWeights[j] * dotWeights<W>(xSquaredWeights, variance, width);
+        for (int i = 0; i < n; ++i) {
+            maskOr |= mask[i];
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
+
+#endif  // !defined(LSST_AFW_MATH_DETAIL_LANCZOSWARPTABLE_H)
@@ -0,0 +1,113 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_AFW_MATH_DETAIL_PARALLEL_H
+#define LSST_AFW_MATH_DETAIL_PARALLEL_H
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+/**
+ * Convert a user-supplied thread count into the number of threads to actually use
+ *
+ * @param numThreads  requested number of threads; 0 means one per hardware thread
+ *
+ * @returns a thread count >= 1
+ */
+inline int resolveNumThreads(int numThreads) {
+    if (numThreads <= 0) {
+        numThreads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    return std::max(numThreads, 1);
+}
+
+/**
+ * Split the index range [0, n) into contiguous bands and process each band on its own thread
+ *
+ * `func(begin, end, iBand)` is called once per band; bands are disjoint and their union is [0, n).
+ * If only one band is needed `func` is called on the calling thread, so the serial case costs
+ * nothing extra.
+ *
+ * @param n  number of items (e.g. image rows) to process
+ * @param numThreads  requested number of threads, as passed to resolveNumThreads
+ * @param func  callable with signature `void(int begin, int end, int iBand)`
+ * @param grain  every band boundary except the last is a multiple of `grain`
+ *
+ * @throws Any exception thrown by `func`; if several bands throw, the exception from the
+ *         lowest-numbered band is rethrown once every thread has finished.
+ */
+template <typename Function>
+void parallelForBands(int n, int numThreads, Function &&func, int grain = 1) {
+    if (n <= 0) {
+        return;
+    }
+    grain = std::max(grain, 1);
+    int const nGrains = (n + grain - 1) / grain;
+    int const nBands = std::min(resolveNumThreads(numThreads), nGrains);
+    if (nBands <= 1) {
+        func(0, n, 0);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(nBands);
+    std::vector<std::thread> threads;
+    threads.reserve(nBands - 1);
+    auto bandStart = [n, grain, nGrains, nBands](int iBand) {
+        return std::min(n, grain * static_cast<int>((static_cast<long>(nGrains) * iBand) / nBands));
+    };
+    auto runBand = [&func, &errors, &bandStart](int iBand) {
+        try {
+            func(bandStart(iBand), bandStart(iBand + 1), iBand);
+        } catch (...) {
+            errors[iBand] = std::current_exception();
+        }
+    };
+    for (int iBand = 1; iBand < nBands; ++iBand) {
+        threads.emplace_back(runBand, iBand);
+    }
+    runBand(0);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (auto const &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
+
+#endif  // !defined(LSST_AFW_MATH_DETAIL_PARALLEL_H)
@@ -0,0 +1,129 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_AFW_MATH_DETAIL_PIXELSTACK_H
+#define LSST_AFW_MATH_DETAIL_PIXELSTACK_H
+
+#include <memory>
+#include <vector>
+
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/math/Statistics.h"
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+/**
+ * One row of a stack of MaskedImages, transposed so that the inputs for each column are contiguous
+ *
+ * statisticsStack needs the statistics of the N input pixels at each output position.  Rather than
+ * gathering them one output pixel at a time into a MaskedVector and building a full Statistics object,
+ * a PixelStack copies a whole row of every input into [x][image] buffers once per row, and evaluates
+ * the requested statistic directly on those buffers with no further allocation.
+ *
+ * The kernels follow the same sequence of operations as Statistics, so the results are identical to
+ * those of makeStatistics on the same pixels.  Only the statistics for which isSupported returns true
+ * are handled; everything else must go through Statistics.
+ */
+template <typename PixelT>
+class PixelStack final {
+public:
+    /// The statistics of one column of the stack
+    struct Result {
+        double value;                    ///< value of the requested statistic
+        double error;                    ///< error in the requested statistic (as Statistics::getError)
+        lsst::afw::image::MaskPixel orMask;  ///< as Statistics::getOrMask
+        int nPoint;                      ///< number of pixels used (NPOINT)
+        int nClipped;                    ///< number of pixels clipped (NCLIPPED)
+        int nMasked;                     ///< number of pixels rejected (NMASKED)
+    };
+
+    /**
+     * Can a PixelStack compute this statistic?
+     *
+     * @param flags  the statistic requested (ERRORS is ignored)
+     * @param sctrl  control for the statistics
+     *
+     * MEAN is always supported; MEDIAN and MEANCLIP are supported if NaNs are being rejected.
+     */
+    static bool isSupported(Property flags, StatisticsControl const &sctrl);
+
+    /**
+     * Construct an empty stack
+     *
+     * @param width  number of columns in each row
+     * @param depth  number of images in the stack
+     * @param flags  the statistic to compute; must satisfy isSupported
+     * @param sctrl  control for the statistics
+     * @param weightByVariance  weight each pixel by its inverse variance
+     * @param weights  a weight for each image (ignored if weightByVariance); empty for no weighting
+     */
+    PixelStack(int width, int depth, Property flags, StatisticsControl const &sctrl,
+               bool weightByVariance = false, std::vector<WeightPixel> const &weights = {});
+
+    PixelStack(PixelStack const &) = default;
+    PixelStack(PixelStack &&) = default;
+    PixelStack &operator=(PixelStack const &) = default;
+    PixelStack &operator=(PixelStack &&) = default;
+    ~PixelStack() noexcept = default;
+
+    /**
+     * Copy one row of each of the images into the stack
+     *
+     * @param images  the images to stack; there must be `depth` of them, each `width` pixels wide
+     * @param y  the row to load, in the images' LOCAL coordinates
+     */
+    void loadRow(std::vector<std::shared_ptr<lsst::afw::image::MaskedImage<PixelT>>> const &images, int y);
+
+    /// Compute the requested statistic for column x of the current row
+    Result compute(int x);
+
+    /// Return the mask values of the `depth` pixels in column x of the current row
+    lsst::afw::image::MaskPixel const *getMasks(int x) const { return &_masks[x * _depth]; }
+
+private:
+    int _width;
+    int _depth;
+    Property _flags;
+    StatisticsControl _sctrl;
+    bool _weightByVariance;
+    bool _isWeighted;
+    std::vector<double> _maskPropagationThresholds;
+    std::vector<PixelT> _values;                           // [x][image]
+    std::vector<lsst::afw::image::MaskPixel> _masks;       // [x][image]
+    std::vector<lsst::afw::image::VariancePixel> _variances;  // [x][image]
+    std::vector<WeightPixel> _weights;  // [x][image] if weighting by variance, else [image]
+    std::vector<PixelT> _good;          // scratch space for order statistics
+    std::vector<double> _rejectedWeightsByBit;  // scratch space for mask propagation
+};
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
+
+#endif  // !defined(LSST_AFW_MATH_DETAIL_PIXELSTACK_H)
@@ -0,0 +1,144 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_AFW_MATH_DETAIL_QUANTILES_H
+#define LSST_AFW_MATH_DETAIL_QUANTILES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+/*
+ * The quantile engine used by Statistics (and statisticsStack) for MEDIAN, IQRANGE and MEANCLIP.
+ *
+ * For floating-point data a quantile is interpolated linearly between the two order statistics that
+ * bracket position fraction*(n - 1).  Integer data is full of ties, so there the quantile is found from
+ * the cumulative histogram instead: if the order statistic at floor(fraction*(n - 1)) has value v,
+ * `left` values are smaller than v and `middle` equal it, the quantile is
+ * v - 0.5 + (fraction*n - left)/middle.
+ */
+
+/// The median, lower quartile and upper quartile (in that order)
+using MedianAndQuartiles = std::tuple<double, double, double>;
+
+/**
+ * Compute a single quantile of a vector of values
+ *
+ * @param values  the values; they are partially reordered
+ * @param fraction  the desired quantile, in [0, 1]
+ *
+ * @returns the quantile, or NaN if `values` is empty
+ */
+template <typename T>
+double computeQuantile(std::vector<T> &values, double fraction);
+
+/**
+ * Compute the median and both quartiles of a vector of values
+ *
+ * All the order statistics needed are found in a single recursive partitioning of the data, so this
+ * is much cheaper than three calls to computeQuantile.
+ *
+ * @param values  the values; they are partially reordered
+ *
+ * @returns the median and quartiles, all NaN if `values` is empty
+ */
+template <typename T>
+MedianAndQuartiles computeMedianAndQuartiles(std::vector<T> &values);
+
+/**
+ * Quantiles of integer data from a histogram with one bin per value
+ *
+ * Filling the histogram is a single pass over the data with no copying or reordering, and quantiles
+ * are then found by walking the cumulative counts.  This is only worthwhile if the data cover a range
+ * that isn't much larger than the number of values; see isUsable.
+ *
+ * The results are identical to computeQuantile/computeMedianAndQuartiles on the same values.
+ */
+template <typename T>
+class QuantileHistogram final {
+public:
+    /// Is a histogram implemented for this pixel type?
+    static constexpr bool isSupported = std::is_same<T, int>::value || std::is_same<T, std::uint16_t>::value;
+
+    /**
+     * Is a histogram worth using for these data?
+     *
+     * @param min  smallest value to be added
+     * @param max  largest value to be added
+     * @param n  number of values to be added
+     */
+    static bool isUsable(T min, T max, std::size_t n);
+
+    /**
+     * Construct an empty histogram covering [min, max]
+     *
+     * @param min  smallest value that will be added
+     * @param max  largest value that will be added
+     */
+    QuantileHistogram(T min, T max);
+
+    QuantileHistogram(QuantileHistogram const &) = default;
+    QuantileHistogram(QuantileHistogram &&) = default;
+    QuantileHistogram &operator=(QuantileHistogram const &) = default;
+    QuantileHistogram &operator=(QuantileHistogram &&) = default;
+    ~QuantileHistogram() noexcept = default;
+
+    /// Add a value, which must lie in [min, max]
+    void add(T value) {
+        ++_counts[static_cast<std::size_t>(static_cast<long>(value) - _min)];
+        ++_n;
+    }
+
+    /// Return the number of values added
+    std::size_t size() const noexcept { return _n; }
+
+    /// Return a quantile (fraction in [0, 1]) of the values; NaN if none have been added
+    double getQuantile(double fraction) const;
+
+    /// Return the median and quartiles of the values; NaN if none have been added
+    MedianAndQuartiles getMedianAndQuartiles() const;
+
+private:
+    // Set results[i] to quantile fractions[i]; fractions must be in ascending order
+    void _computeQuantiles(double const *fractions, double *results, int nQuantile) const;
+
+    long _min;
+    std::size_t _n;
+    std::vector<std::size_t> _counts;
+};
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
+
+#endif  // !defined(LSST_AFW_MATH_DETAIL_QUANTILES_H)
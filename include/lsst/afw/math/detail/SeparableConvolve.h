@@ -0,0 +1,102 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_AFW_MATH_DETAIL_SEPARABLECONVOLVE_H
+#define LSST_AFW_MATH_DETAIL_SEPARABLECONVOLVE_H
+
+#include <vector>
+
+#include "lsst/afw/image/LsstImageTypes.h"
+#include "lsst/afw/math/Kernel.h"
+#include "lsst/afw/math/detail/StatisticsKernels.h"
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+/**
+ * The non-zero elements ("taps") of a kernel vector
+ *
+ * Zero elements are dropped so that, as in convolveAtAPoint, a non-finite pixel under a zero element
+ * of the kernel doesn't affect the result.
+ */
+struct KernelTaps {
+    /**
+     * Construct from a kernel vector, such as those computed by SeparableKernel::computeVectors
+     *
+     * @param kernelVec  the kernel vector
+     * @param squared  use the squares of the elements (as is appropriate for a variance plane)?
+     */
+    explicit KernelTaps(std::vector<Kernel::Pixel> const &kernelVec, bool squared = false);
+
+    /// Number of taps
+    int size() const noexcept { return static_cast<int>(values.size()); }
+
+    std::vector<int> offsets;    ///< index of each tap in the kernel vector
+    std::vector<double> values;  ///< value of each tap
+};
+
+/**
+ * Compute a weighted sum of runs of pixels: out[i] = sum_j taps.values[j]*sources[j][i] for i in [0, n)
+ *
+ * This is the inner loop of convolution with a spatially invariant SeparableKernel.  For the pass
+ * along rows sources[j] is (input row + taps.offsets[j]); for the pass along columns it is the start
+ * of the taps.offsets[j]'th row convolved along x.
+ *
+ * The sum is accumulated in double precision, one tap at a time.  The vectorised kernels compute 2
+ * (SSE2) or 4 (AVX2) outputs at once in the same order, and the loop over taps is unrolled at compile
+ * time for the common kernel sizes (e.g. the 6, 8 and 10 non-zero taps of the Lanczos3, 4 and 5
+ * warping kernels, and 5, 7 and 9-tap Gaussians).
+ *
+ * @param sources  a pointer to the first pixel to use for each tap
+ * @param taps  the kernel taps
+ * @param out  the output pixels; may not overlap any of the sources
+ * @param n  number of output pixels
+ * @param level  the kernel to use; a level beyond getMaxSimdLevel() is reduced to it
+ */
+template <typename InPixelT, typename OutPixelT>
+void sumTaps(InPixelT const *const *sources, KernelTaps const &taps, OutPixelT *out, int n,
+             SimdLevel level = getMaxSimdLevel());
+
+/**
+ * Compute the OR of runs of mask pixels: out[i] = OR_j sources[j][i] for i in [0, n)
+ *
+ * This is the mask plane equivalent of sumTaps.
+ *
+ * @param sources  a pointer to the first pixel to use for each tap
+ * @param nTaps  number of taps
+ * @param out  the output pixels; may not overlap any of the sources
+ * @param n  number of output pixels
+ */
+void orTaps(lsst::afw::image::MaskPixel const *const *sources, int nTaps, lsst::afw::image::MaskPixel *out,
+            int n);
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
+
+#endif  // !defined(LSST_AFW_MATH_DETAIL_SEPARABLECONVOLVE_H)
@@ -0,0 +1,97 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_AFW_MATH_DETAIL_STATISTICSKERNELS_H
+#define LSST_AFW_MATH_DETAIL_STATISTICSKERNELS_H
+
+#include <limits>
+
+#include "lsst/afw/image/LsstImageTypes.h"
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+/// The instruction sets that the Statistics accumulator kernels may use
+enum class SimdLevel { SCALAR = 0, SSE2, AVX2 };
+
+/**
+ * Return the most capable SimdLevel supported by both this build and the CPU we're running on
+ *
+ * The CPU is only queried once.
+ */
+SimdLevel getMaxSimdLevel() noexcept;
+
+/// Unweighted sums over the accepted pixels; see accumulatePixels
+struct PixelSums {
+    int n = 0;                              ///< number of pixels accepted
+    double sumx = 0.0;                      ///< sum(value - center)
+    double sumx2 = 0.0;                     ///< sum((value - center)^2)
+    double sumv = 0.0;                      ///< sum(variance); 0 if no variance was provided
+    double min = std::numeric_limits<double>::infinity();   ///< smallest value accepted
+    double max = -std::numeric_limits<double>::infinity();  ///< largest value accepted
+    lsst::afw::image::MaskPixel orMask = 0x0;               ///< OR of the masks of the pixels accepted
+};
+
+/**
+ * Add a contiguous run of pixels to a set of unweighted sums
+ *
+ * This is the inner loop of Statistics' processPixels for the common case of a float or double
+ * image with no weights and no mask-propagation thresholds.  A pixel is accepted if:
+ * - its value is finite (as a float) or `checkFinite` is false;
+ * - its mask has none of the bits in `andMask` set;
+ * - |value - center| <= clipLimit, or `doClip` is false.
+ *
+ * The vectorised kernels process 2 (SSE2) or 4 (AVX2) pixels at a time, with the accept/reject
+ * decision applied as a bitwise blend rather than a branch.  They keep one partial sum per lane, so
+ * `sumx`, `sumx2` and `sumv` differ from those of the SCALAR kernel by the change in the order of
+ * summation (relative errors of order n*epsilon in the worst case, and usually much less); `n`,
+ * `min`, `max` and `orMask` are identical.
+ *
+ * @param img  the pixel values
+ * @param msk  the mask values, or nullptr if all masks are 0
+ * @param var  the variance values, or nullptr if the variance sum isn't wanted
+ * @param n  number of pixels
+ * @param center  value subtracted before summing (the crude mean, or the centre of the clip range)
+ * @param clipLimit  half-width of the clip range
+ * @param andMask  reject pixels with any of these mask bits set
+ * @param checkFinite  reject non-finite values?
+ * @param doClip  reject values more than clipLimit from center?
+ * @param sums  the sums to add to
+ * @param level  the kernel to use; a level beyond getMaxSimdLevel() is reduced to it
+ */
+template <typename PixelT>
+void accumulatePixels(PixelT const *img, lsst::afw::image::MaskPixel const *msk,
+                      lsst::afw::image::VariancePixel const *var, int n, double center, double clipLimit,
+                      lsst::afw::image::MaskPixel andMask, bool checkFinite, bool doClip, PixelSums &sums,
+                      SimdLevel level = getMaxSimdLevel());
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
+
+#endif  // !defined(LSST_AFW_MATH_DETAIL_STATISTICSKERNELS_H)
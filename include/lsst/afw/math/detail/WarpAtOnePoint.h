@@ -21,9 +21,14 @@
  * the GNU General Public License along with this program.  If not,
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
+#include <cstddef>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 #include "lsst/afw/math/Kernel.h"
+#include "lsst/afw/math/warpExposure.h"
+#include "lsst/afw/math/detail/LanczosWarpTable.h"
 #include "lsst/afw/image/Image.h"
 #include "lsst/afw/image/MaskedImage.h"
 #include "lsst/geom/Point.h"
@@ -33,17 +38,47 @@ namespace afw {
 namespace math {
 namespace detail {
 
+/**
+ * The pixel type of the image plane of an Image or MaskedImage
+ */
+template <typename ImageT>
+struct ImagePlanePixel {
+    using type = typename ImageT::Pixel;
+};
+
+template <typename ImagePixelT, typename MaskPixelT, typename VariancePixelT>
+struct ImagePlanePixel<lsst::afw::image::MaskedImage<ImagePixelT, MaskPixelT, VariancePixelT>> {
+    using type = ImagePixelT;
+};
+
 /**
  * A functor that computes one warped pixel
  */
 template <typename DestImageT, typename SrcImageT>
 class WarpAtOnePoint final {
 public:
+    /**
+     * Construct a WarpAtOnePoint
+     *
+     * This copies srcImage and (if a LanczosWarpTable is used) its planes' arrays, which updates their
+     * reference counts; these aren't thread-safe, so a WarpAtOnePoint must be constructed on the thread
+     * that owns srcImage, even if it is then used on another.  The function call operators only read
+     * pixels, so several WarpAtOnePoint may then be used at once.
+     *
+     * @param srcImage  the image to warp
+     * @param control  warping control parameters
+     * @param padValue  value of destination pixels that can't be computed
+     * @param copyKernels  use private copies of the control's warping kernels (whose parameters are set
+     *                     for every pixel), so that several WarpAtOnePoint may be used at once?
+     *                     The control's kernels are then only read, provided that their caches are
+     *                     already up to date (which the first call to its getWarpingKernel and
+     *                     getMaskWarpingKernel ensures).
+     */
     WarpAtOnePoint(SrcImageT const &srcImage, WarpingControl const &control,
-                   typename DestImageT::SinglePixel padValue)
+                   typename DestImageT::SinglePixel padValue, bool copyKernels = false)
             : _srcImage(srcImage),
-              _kernelPtr(control.getWarpingKernel()),
-              _maskKernelPtr(control.getMaskWarpingKernel()),
+              _kernelPtr(_getKernel(control.getWarpingKernel(), copyKernels)),
+              _maskKernelPtr(_getKernel(control.getMaskWarpingKernel(), copyKernels)),
               _hasMaskKernel(control.getMaskWarpingKernel()),
               _kernelCtr(_kernelPtr->getCtr()),
               _maskKernelCtr(_maskKernelPtr ? _maskKernelPtr->getCtr() : lsst::geom::Point2I(0, 0)),
@@ -53,7 +88,9 @@ public:
               _maskXList(_maskKernelPtr ? _maskKernelPtr->getWidth() : 0),
               _maskYList(_maskKernelPtr ? _maskKernelPtr->getHeight() : 0),
               _padValue(padValue),
-              _srcGoodBBox(_kernelPtr->shrinkBBox(srcImage.getBBox(lsst::afw::image::LOCAL))){};
+              _srcGoodBBox(_kernelPtr->shrinkBBox(srcImage.getBBox(lsst::afw::image::LOCAL))) {
+        _initLanczosTable(typename lsst::afw::image::detail::image_traits<SrcImageT>::image_category());
+    }
 
     /**
      * Compute one warped pixel, Image specialization
@@ -81,6 +118,17 @@ public:
             int srcStartX = srcIndFracX.first - _kernelCtr[0];
             int srcStartY = srcIndFracY.first - _kernelCtr[1];
 
+            if (_lanczosTable) {
+                int const xPhase = _lanczosTable->getPhase(srcIndFracX.second);
+                int const yPhase = _lanczosTable->getPhase(srcIndFracY.second);
+                double const kSum = _lanczosTable->getSum(xPhase) * _lanczosTable->getSum(yPhase);
+                double const value = _applyLanczosTable(
+                        _srcImagePixels + srcStartY * _srcImageStride + srcStartX, _srcImageStride,
+                        _lanczosTable->getWeights(xPhase), _lanczosTable->getWeights(yPhase));
+                *destXIter = static_cast<typename DestImageT::SinglePixel>(value * (relativeArea / kSum));
+                return true;
+            }
+
             // Compute warped pixel
             double kSum = _setFracIndex(srcIndFracX.second, srcIndFracY.second);
 
@@ -123,13 +171,38 @@ public:
             int srcStartX = srcIndFracX.first - _kernelCtr[0];
             int srcStartY = srcIndFracY.first - _kernelCtr[1];
 
-            // Compute warped pixel
-            double kSum = _setFracIndex(srcIndFracX.second, srcIndFracY.second);
+            if (_lanczosTable) {
+                int const xPhase = _lanczosTable->getPhase(srcIndFracX.second);
+                int const yPhase = _lanczosTable->getPhase(srcIndFracY.second);
+                double const scale =
+                        relativeArea / (_lanczosTable->getSum(xPhase) * _lanczosTable->getSum(yPhase));
+                double imageSum;
+                lsst::afw::image::MaskPixel maskOr;
+                double varianceSum;
+                _applyLanczosTable(_srcImagePixels + srcStartY * _srcImageStride + srcStartX,
+                                   _srcMaskPixels + srcStartY * _srcMaskStride + srcStartX,
+                                   _srcVariancePixels + srcStartY * _srcVarianceStride + srcStartX, xPhase,
+                                   yPhase, imageSum, maskOr, varianceSum);
+                using DestImagePixel = typename ImagePlanePixel<DestImageT>::type;
+                using DestVariancePixel = typename DestImageT::Variance::Pixel;
+                *destXIter = typename DestImageT::SinglePixel(
+                        static_cast<DestImagePixel>(imageSum * scale), maskOr,
+                        static_cast<DestVariancePixel>(varianceSum * scale * scale));
+                if (_hasMaskKernel) {
+                    std::pair<double, double> srcFracInd(srcIndFracX.second, srcIndFracY.second);
+                    _maskKernelPtr->setKernelParameters(srcFracInd);
+                    _maskKernelPtr->computeVectors(_maskXList, _maskYList, false);
+                }
+            } else {
+                // Compute warped pixel
+                double kSum = _setFracIndex(srcIndFracX.second, srcIndFracY.second);
 
-            typename SrcImageT::const_xy_locator srcLoc = _srcImage.xy_at(srcStartX, srcStartY);
+                typename SrcImageT::const_xy_locator srcLoc = _srcImage.xy_at(srcStartX, srcStartY);
 
-            *destXIter = lsst::afw::math::convolveAtAPoint<DestImageT, SrcImageT>(srcLoc, _xList, _yList);
-            *destXIter *= relativeArea / kSum;
+                *destXIter =
+                        lsst::afw::math::convolveAtAPoint<DestImageT, SrcImageT>(srcLoc, _xList, _yList);
+                *destXIter *= relativeArea / kSum;
+            }
 
             if (_hasMaskKernel) {
                 // compute mask value based on the mask kernel (replacing the value computed above)
@@ -170,6 +243,124 @@ public:
     }
 
 private:
+    /**
+     * Return kernelPtr, or a pointer to a copy of the kernel with the same centre and cache
+     */
+    static std::shared_ptr<lsst::afw::math::SeparableKernel> _getKernel(
+            std::shared_ptr<lsst::afw::math::SeparableKernel> const &kernelPtr, bool copyKernel) {
+        if (!copyKernel || !kernelPtr) {
+            return kernelPtr;
+        }
+        auto copyPtr = std::static_pointer_cast<lsst::afw::math::SeparableKernel>(kernelPtr->clone());
+        copyPtr->setCtr(kernelPtr->getCtr());
+        if (copyPtr->getCacheSize() != kernelPtr->getCacheSize()) {
+            copyPtr->computeCache(kernelPtr->getCacheSize());
+        }
+        return copyPtr;
+    }
+
+    /// Does not use a LanczosWarpTable; masks are not warped with this class
+    void _initLanczosTable(lsst::afw::image::detail::basic_tag) {}
+
+    /**
+     * Use a LanczosWarpTable if the warping kernel is a cached Lanczos kernel and the destination
+     * image plane is floating point, and find the source image plane
+     *
+     * A warping kernel that isn't cached (cache size 0) is evaluated exactly for every pixel, so the
+     * table, which is equivalent to the kernel's cache, is not used.
+     */
+    void _initLanczosTable(lsst::afw::image::detail::Image_tag) {
+        if (_useLanczosTable()) {
+            auto array = _srcImage.getArray();
+            _srcImagePixels = array.getData();
+            _srcImageStride = array.template getStride<0>();
+        }
+    }
+
+    /// As _initLanczosTable(Image_tag), but also find the source mask and variance planes
+    void _initLanczosTable(lsst::afw::image::detail::MaskedImage_tag) {
+        if (_useLanczosTable()) {
+            auto imageArray = _srcImage.getImage()->getArray();
+            _srcImagePixels = imageArray.getData();
+            _srcImageStride = imageArray.template getStride<0>();
+            auto maskArray = _srcImage.getMask()->getArray();
+            _srcMaskPixels = maskArray.getData();
+            _srcMaskStride = maskArray.template getStride<0>();
+            auto varianceArray = _srcImage.getVariance()->getArray();
+            _srcVariancePixels = varianceArray.getData();
+            _srcVarianceStride = varianceArray.template getStride<0>();
+        }
+    }
+
+    /// Set _lanczosTable if it can be used, returning true if so
+    bool _useLanczosTable() {
+        if (!std::is_floating_point<typename ImagePlanePixel<DestImageT>::type>::value) {
+            return false;
+        }
+        auto lanczosPtr = std::dynamic_pointer_cast<lsst::afw::math::LanczosWarpingKernel>(_kernelPtr);
+        if (!lanczosPtr || lanczosPtr->getCacheSize() <= 0) {
+            return false;
+        }
+        int const order = lanczosPtr->getOrder();
+        if (_kernelCtr != lsst::geom::Point2I(order - 1, order - 1)) {
+            return false;
+        }
+        _lanczosTable = LanczosWarpTable::get(order, lanczosPtr->getCacheSize());
+        return true;
+    }
+
+    /// Apply the table's weights to a window of the source image plane, with the width fixed if possible
+    template <typename PixelT>
+    double _applyLanczosTable(PixelT const *pixels, std::ptrdiff_t stride, double const *xWeights,
+                              double const *yWeights) const {
+        int const width = _lanczosTable->getWidth();
+        switch (width) {
+            case 6:
+                return applyWeights<6>(pixels, stride, xWeights, yWeights, width);
+            case 8:
+                return applyWeights<8>(pixels, stride, xWeights, yWeights, width);
+            case 10:
+                return applyWeights<10>(pixels, stride, xWeights, yWeights, width);
+            default:
+                return applyWeights<0>(pixels, stride, xWeights, yWeights, width);
+        }
+    }
+
+    /// Apply the table's weights to a window of the source masked image, with the width fixed if possible
+    template <typename ImagePixelT, typename VariancePixelT>
+    void _applyLanczosTable(ImagePixelT const *image, lsst::afw::image::MaskPixel const *mask,
+                            VariancePixelT const *variance, int xPhase, int yPhase, double &imageSum,
+                            lsst::afw::image::MaskPixel &maskOr, double &varianceSum) const {
+        LanczosWarpTable const &table = *_lanczosTable;
+        int const width = table.getWidth();
+        double const *xWeights = table.getWeights(xPhase);
+        double const *yWeights = table.getWeights(yPhase);
+        double const *xSquaredWeights = table.getSquaredWeights(xPhase);
+        double const *ySquaredWeights = table.getSquaredWeights(yPhase);
+        switch (width) {
+            case 6:
+                applyWeights<6>(image, mask, variance, _srcImageStride, _srcMaskStride, _srcVarianceStride,
+                                xWeights, yWeights, xSquaredWeights, ySquaredWeights, width, imageSum,
+                                maskOr, varianceSum);
+                return;
+            case 8:
+                applyWeights<8>(image, mask, variance, _srcImageStride, _srcMaskStride, _srcVarianceStride,
+                                xWeights, yWeights, xSquaredWeights, ySquaredWeights, width, imageSum,
+                                maskOr, varianceSum);
+                return;
+            case 10:
+                applyWeights<10>(image, mask, variance, _srcImageStride, _srcMaskStride, _srcVarianceStride,
+                                 xWeights, yWeights, xSquaredWeights, ySquaredWeights, width, imageSum,
+                                 maskOr, varianceSum);
+                return;
+            default:
+                applyWeights<0>(image, mask, variance, _srcImageStride, _srcMaskStride, _srcVarianceStride,
+                                xWeights, yWeights, xSquaredWeights, ySquaredWeights, width, imageSum,
+                                maskOr, varianceSum);
+                return;
+        }
+    }
+
     /**
      * Set parameters of kernel (and mask kernel, if present) and update X and Y values
      *
@@ -199,6 +390,14 @@ private:
     std::vector<double> _maskYList;
     typename DestImageT::SinglePixel _padValue;
     lsst::geom::Box2I const _srcGoodBBox;
+    // The following are only set if the warping kernel's weights are looked up in a LanczosWarpTable
+    std::shared_ptr<LanczosWarpTable const> _lanczosTable;
+    typename ImagePlanePixel<SrcImageT>::type const *_srcImagePixels = nullptr;
+    std::ptrdiff_t _srcImageStride = 0;
+    lsst::afw::image::MaskPixel const *_srcMaskPixels = nullptr;
+    std::ptrdiff_t _srcMaskStride = 0;
+    lsst::afw::image::VariancePixel const *_srcVariancePixels = nullptr;
+    std::ptrdiff_t _srcVarianceStride = 0;
 };
 }  // namespace detail
 }  // namespace math
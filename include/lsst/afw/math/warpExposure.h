@@ -299,7 +299,9 @@ public:
               _maskWarpingKernelPtr(),
               _cacheSize(cacheSize),
               _interpLength(interpLength),
-              _growFullMask(growFullMask) {
+              _growFullMask(growFullMask),
+              _interpTolerance(0.0),
+              _numThreads(1) {
         setMaskWarpingKernelName(maskWarpingKernelName);
     }
 
@@ -341,6 +343,39 @@ public:
         _interpLength = interpLength;
     };
 
+    /**
+     * get the interpolation tolerance (pixels)
+     */
+    double getInterpTolerance() const { return _interpTolerance; }
+
+    /**
+     * set the interpolation tolerance
+     *
+     * If the interpolation tolerance is positive (and the interpolation length is also positive),
+     * the interpolation length is adapted to the transform: the destination image is divided into
+     * tiles of interpLength x interpLength pixels, and each tile is split in two along each axis,
+     * repeatedly, until linearly interpolating the transform between the tile's corners agrees with
+     * the true transform to within the tolerance at the midpoints of the tile's edges and at its centre.
+     * The interpolation length then only needs to be small enough that a tile with these midpoints
+     * within tolerance is within tolerance everywhere, and regions of the image where the transform
+     * is nearly linear are interpolated over large tiles.
+     *
+     * 0 (the default) disables this, so that every tile is interpLength x interpLength pixels.
+     *
+     * The interpolation tolerance is not persisted.
+     *
+     * @param interpTolerance  largest allowed error in interpolated source positions (source pixels)
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if interpTolerance is negative
+     */
+    void setInterpTolerance(double interpTolerance) {
+        if (!(interpTolerance >= 0)) {
+            throw LSST_EXCEPT(lsst::pex::exceptions::InvalidParameterError,
+                              "interpTolerance must be non-negative.");
+        }
+        _interpTolerance = interpTolerance;
+    }
+
     /**
      * get the warping kernel
      */
@@ -399,6 +434,37 @@ public:
         _growFullMask = growFullMask;
     }
 
+    /**
+     * get the number of threads used to warp
+     */
+    int getNumThreads() const { return _numThreads; }
+
+    /**
+     * set the number of threads used to warp
+     *
+     * The destination rows are warped in batches of whole interpolation bands.  The source positions
+     * of each batch are computed serially, exactly as they are by a serial warp, then its pixels are
+     * divided between threads, each with its own copies of the warping kernels.  The result,
+     * including the number of good pixels, does not depend on the number of threads.
+     *
+     * When numThreads is not 1 the warping kernels held by this object are only read, so it may be
+     * shared by warps running on several threads.
+     *
+     * The number of threads is not persisted.
+     *
+     * @param numThreads  number of threads; 1 (the default) runs serially, 0 uses one thread
+     *                    per available hardware thread
+     *
+     * @throws lsst::pex::exceptions::InvalidParameterError if numThreads is negative
+     */
+    void setNumThreads(int numThreads) {
+        if (numThreads < 0) {
+            throw LSST_EXCEPT(lsst::pex::exceptions::InvalidParameterError,
+                              "numThreads may not be negative.");
+        }
+        _numThreads = numThreads;
+    }
+
     bool isPersistable() const noexcept override;
 
 protected:
@@ -422,6 +488,8 @@ private:
     int _cacheSize;
     int _interpLength;
     lsst::afw::image::MaskPixel _growFullMask;
+    double _interpTolerance;
+    int _numThreads;
 };
 
 /**
@@ -374,6 +374,50 @@ public:
         return io::FitsReader::apply<CatalogT>(fitsfile, flags);
     }
 
+    /**
+     *  Read part of a FITS binary table from a regular file.
+     *
+     *  @param[in] filename    Name of the file to read.
+     *  @param[in] options     Options that select the part of the table to read.
+     *  @param[in] hdu         Number of the "header-data unit" to read (where 0 is the Primary HDU).
+     *                         The default value of afw::fits::DEFAULT_HDU is interpreted as
+     *                         "the first HDU with NAXIS != 0".
+     *  @param[in] flags       Table-subclass-dependent bitflags that control the details of how to read
+     *                         the catalog.  See e.g. SourceFitsFlags.
+     */
+    static CatalogT readFits(std::string const& filename, io::FitsReadOptions const& options,
+                             int hdu = fits::DEFAULT_HDU, int flags = 0) {
+        return io::FitsReader::apply<CatalogT>(filename, hdu, flags, nullptr, options);
+    }
+
+    /**
+     *  Read part of a FITS binary table from a RAM file.
+     *
+     *  @param[in] manager     Object that manages the memory to be read.
+     *  @param[in] options     Options that select the part of the table to read.
+     *  @param[in] hdu         Number of the "header-data unit" to read (where 0 is the Primary HDU).
+     *                         The default value of afw::fits::DEFAULT_HDU is interpreted as
+     *                         "the first HDU with NAXIS != 0".
+     *  @param[in] flags       Table-subclass-dependent bitflags that control the details of how to read
+     *                         the catalog.  See e.g. SourceFitsFlags.
+     */
+    static CatalogT readFits(fits::MemFileManager& manager, io::FitsReadOptions const& options,
+                             int hdu = fits::DEFAULT_HDU, int flags = 0) {
+        return io::FitsReader::apply<CatalogT>(manager, hdu, flags, nullptr, options);
+    }
+
+    /**
+     *  Read part of a FITS binary table from a file object already at the correct extension.
+     *
+     *  @param[in] fitsfile    Fits file object to read from.
+     *  @param[in] options     Options that select the part of the table to read.
+     *  @param[in] flags       Table-subclass-dependent bitflags that control the details of how to read
+     *                         the catalog.  See e.g. SourceFitsFlags.
+     */
+    static CatalogT readFits(fits::Fits& fitsfile, io::FitsReadOptions const& options, int flags = 0) {
+        return io::FitsReader::apply<CatalogT>(fitsfile, flags, nullptr, options);
+    }
+
     /**
      *  Return a ColumnView of this catalog's records.
      *
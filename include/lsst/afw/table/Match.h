@@ -25,6 +25,8 @@
 #ifndef LSST_AFW_TABLE_MATCH_H
 #define LSST_AFW_TABLE_MATCH_H
 
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 #include "lsst/pex/config.h"
@@ -34,6 +36,7 @@
 #include "lsst/afw/table/Source.h"
 #include "lsst/afw/table/Catalog.h"
 #include "lsst/geom/Angle.h"
+#include "lsst/geom/SpherePoint.h"
 
 namespace lsst {
 namespace afw {
@@ -44,7 +47,7 @@ namespace table {
  */
 class MatchControl {
 public:
-    MatchControl() : findOnlyClosest(true), symmetricMatch(true), includeMismatches(false) {}
+    MatchControl() : findOnlyClosest(true), symmetricMatch(true), includeMismatches(false), numThreads(1) {}
     LSST_CONTROL_FIELD(findOnlyClosest, bool,
                        "Return only the closest match if more than one is found "
                        "(default: true)");
@@ -54,6 +57,9 @@ public:
     LSST_CONTROL_FIELD(includeMismatches, bool,
                        "Include failed matches (i.e. one 'match' is NULL) "
                        "(default: false)");
+    LSST_CONTROL_FIELD(numThreads, int,
+                       "Number of threads to match with; 0 means one per hardware thread. "
+                       "The matches do not depend on this (default: 1)");
 };
 
 /**
@@ -97,7 +103,7 @@ SourceMatchVector matchXy(
         SourceCatalog const &cat2,  ///< second catalog
         double radius,              ///< match radius (pixels)
         MatchControl const &mc =
-                MatchControl()  ///< how to do the matching (obeys MatchControl::findOnlyClosest)
+                MatchControl()  ///< how to do the matching (obeys MatchControl::findOnlyClosest, numThreads)
 );
 
 /**
@@ -109,9 +115,94 @@ SourceMatchVector matchXy(
         SourceCatalog const &cat,  ///< the catalog to self-match
         double radius,             ///< match radius (pixels)
         MatchControl const &mc =
-                MatchControl()  ///< how to do the matching (obeys MatchControl::symmetricMatch)
+                MatchControl()  ///< how to do the matching (obeys MatchControl::symmetricMatch, numThreads)
 );
 
+/**
+ * A spatial index of the coordinates of the records of a catalog, for matching on the sky
+ *
+ * The index is a k-d tree of the unit vectors of the records' coordinates.  Finding the records
+ * within a radius of a position takes a time that grows much more slowly than the size of the catalog,
+ * whatever the declination and radius (unlike a sweep over declination, which degrades near the poles).
+ * An index can be built once and used to match many catalogs against the same catalog.
+ *
+ * The index holds pointers to the catalog's records, so they stay alive as long as the index does;
+ * it holds copies of their coordinates, so changes to those are not seen.
+ *
+ * This is instantiated for Simple and Source catalogs.
+ */
+template <typename Cat>
+class RaDecIndex final {
+public:
+    using Record = typename Cat::Record;
+
+    /**
+     * Index the records of a catalog
+     *
+     * Records whose coordinates contain a NaN are not indexed.
+     */
+    explicit RaDecIndex(Cat const &cat);
+
+    RaDecIndex(RaDecIndex const &) = default;
+    RaDecIndex(RaDecIndex &&) = default;
+    RaDecIndex &operator=(RaDecIndex const &) = default;
+    RaDecIndex &operator=(RaDecIndex &&) = default;
+    ~RaDecIndex() noexcept = default;
+
+    /// Number of indexed records
+    std::size_t size() const noexcept { return _records.size(); }
+
+    /// An indexed record; indices follow the order of the catalog, less the records that are not indexed
+    std::shared_ptr<Record> const &getRecord(std::size_t i) const { return _records[i]; }
+
+    /**
+     * Return the indexed records within an angle of a position, in index order
+     *
+     * @throws pex::exceptions::RangeError if radius is not in the range 0 to 45 degrees
+     */
+    std::vector<std::shared_ptr<Record>> findWithin(lsst::geom::SpherePoint const &coord,
+                                                    lsst::geom::Angle radius) const;
+
+    /**
+     * Find the indexed records near a unit vector
+     *
+     * This is the low-level search used for matching.
+     *
+     * @param[in] x, y, z  the unit vector: (cos(dec)cos(ra), cos(dec)sin(ra), sin(dec))
+     * @param[in] d2Limit  the records found are those whose unit vectors are less than sqrt(d2Limit)
+     *                     from (x, y, z)
+     * @param[out] found  the index and squared unit vector distance of each record found are appended,
+     *                    in no particular order
+     */
+    void findNear(double x, double y, double z, double d2Limit,
+                  std::vector<std::pair<std::size_t, double>> &found) const;
+
+private:
+    // A node of the tree, covering _points[begin, end)
+    struct Node {
+        std::size_t begin;
+        std::size_t end;
+        double min[3];  // bounding box of the node's points
+        double max[3];
+        int left;  // index of the child nodes in _nodes; -1 for a leaf
+        int right;
+    };
+
+    // An indexed unit vector
+    struct Point {
+        double v[3];
+        std::size_t index;  // in _records
+    };
+
+    // Add a node covering _points[begin, end), and its children; return its index in _nodes
+    int _build(std::size_t begin, std::size_t end, int depth);
+
+    std::vector<std::shared_ptr<Record>> _records;
+    std::vector<Point> _points;  // in tree order
+    std::vector<Node> _nodes;   // _nodes[0] is the root
+    int _depth;                 // depth of the deepest leaf
+};
+
 /**
  * Compute all tuples (s1,s2,d) where s1 belings to `cat1`, s2 belongs to `cat2` and
  * d, the distance between s1 and s2, is at most `radius`. If cat1 and
@@ -126,7 +217,26 @@ std::vector<Match<typename Cat1::Record, typename Cat2::Record> > matchRaDec(
         Cat2 const &cat2,          ///< second catalog
         lsst::geom::Angle radius,  ///< match radius
         MatchControl const &mc =
-                MatchControl()  ///< how to do the matching (obeys MatchControl::findOnlyClosest)
+                MatchControl()  ///< how to do the matching (obeys MatchControl::findOnlyClosest, numThreads)
+);
+
+/**
+ * Compute all tuples (s1,s2,d) where s1 belongs to `cat1`, s2 belongs to the catalog indexed by
+ * `index2` and d, the distance between s1 and s2, is at most `radius`.
+ * The match is performed in ra, dec space.
+ *
+ * This is equivalent to matchRaDec(cat1, cat2, radius, mc), but reuses an existing index of cat2.
+ * The matches are in the order of cat1.
+ *
+ * This is instantiated for Simple-Simple, Simple-Source, and Source-Source catalog combinations.
+ */
+template <typename Cat1, typename Cat2>
+std::vector<Match<typename Cat1::Record, typename Cat2::Record> > matchRaDec(
+        Cat1 const &cat1,                ///< first catalog
+        RaDecIndex<Cat2> const &index2,  ///< index of the second catalog
+        lsst::geom::Angle radius,        ///< match radius
+        MatchControl const &mc =
+                MatchControl()  ///< how to do the matching (obeys MatchControl::findOnlyClosest, numThreads)
 );
 
 /*
@@ -141,7 +251,7 @@ std::vector<Match<typename Cat::Record, typename Cat::Record> > matchRaDec(
         Cat const &cat,            ///< the catalog to self-match
         lsst::geom::Angle radius,  ///< match radius
         MatchControl const &mc =
-                MatchControl()  ///< how to do the matching (obeys MatchControl::symmetricMatch)
+                MatchControl()  ///< how to do the matching (obeys MatchControl::symmetricMatch, numThreads)
 );
 
 /**
@@ -0,0 +1,69 @@
+// -*- lsst-c++ -*-
+#ifndef AFW_TABLE_IO_FitsReadOptions_h_INCLUDED
+#define AFW_TABLE_IO_FitsReadOptions_h_INCLUDED
+
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lsst {
+namespace afw {
+namespace table {
+namespace io {
+
+/**
+ *  Options for reading only part of a FITS binary table into a Catalog.
+ *
+ *  The default options read the whole table.
+ */
+struct FitsReadOptions {
+    /**
+     *  Names of the fields to read; if empty, all fields are read.
+     *
+     *  A name selects the field with exactly that name and all fields whose names start with it
+     *  followed by an underscore, so "base_PsfFlux" selects "base_PsfFlux_instFlux",
+     *  "base_PsfFlux_instFluxErr" and "base_PsfFlux_flag".  Names are first resolved through the
+     *  aliases saved with the table, so slots (e.g. "slot_Centroid") may be used too.  Aliases whose
+     *  targets are not read are dropped.  The fields of the table's minimal schema (e.g. "id" and
+     *  "coord") are always read, and fields that FitsReader subclasses read themselves (e.g.
+     *  SourceRecord Footprints) are not affected.
+     *
+     *  A name that selects no column causes pex::exceptions::NotFoundError to be thrown.
+     */
+    std::vector<std::string> columns;
+
+    /// Index of the first row to read.
+    std::size_t firstRow = 0;
+
+    /// Maximum number of rows to read, starting at firstRow.
+    std::size_t nRows = std::numeric_limits<std::size_t>::max();
+
+    /// Names of Flag fields that must be unset (false) for a row to be read.
+    std::vector<std::string> unsetFlags;
+
+    /// Names of Flag fields that must be set (true) for a row to be read.
+    std::vector<std::string> setFlags;
+
+    /**
+     *  Inclusive (min, max) ranges that scalar numeric fields must be in for a row to be read,
+     *  keyed by field name; NaN values are never in range.
+     *
+     *  The fields named here and in unsetFlags and setFlags may be aliases, and need not be among
+     *  the fields read.  A name that is not a field of the right type causes
+     *  pex::exceptions::NotFoundError or pex::exceptions::InvalidParameterError to be thrown.
+     */
+    std::map<std::string, std::pair<double, double>> valueRanges;
+
+    /// Return true if rows are filtered on the values of their fields.
+    bool hasRowFilter() const { return !unsetFlags.empty() || !setFlags.empty() || !valueRanges.empty(); }
+};
+
+}  // namespace io
+}  // namespace table
+}  // namespace afw
+}  // namespace lsst
+
+#endif  // !AFW_TABLE_IO_FitsReadOptions_h_INCLUDED
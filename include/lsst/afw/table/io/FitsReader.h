@@ -2,11 +2,14 @@
 #ifndef AFW_TABLE_IO_FitsReader_h_INCLUDED
 #define AFW_TABLE_IO_FitsReader_h_INCLUDED
 
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "lsst/afw/fits.h"
 #include "lsst/afw/table/Schema.h"
 #include "lsst/afw/table/io/InputArchive.h"
+#include "lsst/afw/table/io/FitsReadOptions.h"
 #include "lsst/afw/table/io/FitsSchemaInputMapper.h"
 #include "lsst/afw/table/BaseRecord.h"
 #include "lsst/afw/table/BaseTable.h"
@@ -66,30 +69,70 @@ public:
      *                       archive argument is provided only for cases in which the catalog itself is
      *                       part of a larger object, and does not "own" its own archive (e.g. CoaddPsf
      *                       persistence).
+     *  @param[in]  options  Options that select the part of the table to read.
      */
     template <typename ContainerT>
     static ContainerT apply(afw::fits::Fits& fits, int ioFlags,
-                            std::shared_ptr<InputArchive> archive = std::shared_ptr<InputArchive>()) {
+                            std::shared_ptr<InputArchive> archive = std::shared_ptr<InputArchive>(),
+                            FitsReadOptions const& options = FitsReadOptions()) {
         std::shared_ptr<daf::base::PropertyList> metadata = std::make_shared<daf::base::PropertyList>();
         fits.readMetadata(*metadata, true);
         FitsReader const* reader = _lookupFitsReader(*metadata);
         FitsSchemaInputMapper mapper(*metadata, true);
+        if (!options.columns.empty()) {
+            mapper.select(options.columns);
+        }
+        if (options.hasRowFilter()) {
+            mapper.setRowFilter(options);
+        }
         reader->_setupArchive(fits, mapper, archive, ioFlags);
         std::shared_ptr<BaseTable> table = reader->makeTable(mapper, metadata, ioFlags, true);
         ContainerT container(std::dynamic_pointer_cast<typename ContainerT::Table>(table));
         if (!container.getTable()) {
             throw LSST_EXCEPT(pex::exceptions::RuntimeError, "Invalid table class for catalog.");
         }
-        std::size_t nRows = fits.countRows();
-        container.reserve(nRows);
-        for (std::size_t row = 0; row < nRows; ++row) {
-            mapper.readRecord(
-                    // We need to be able to support reading Catalog<T const>, since it shares the same
-                    // template
-                    // as Catalog<T> (which invokes this method in readFits).
-                    const_cast<typename std::remove_const<typename ContainerT::Record>::type&>(
-                            *container.addNew()),
-                    fits, row);
+        std::size_t const nTableRows = fits.countRows();
+        if (options.firstRow > nTableRows) {
+            throw LSST_EXCEPT(pex::exceptions::OutOfRangeError,
+                              (boost::format("First row %d is beyond the end of a table with %d rows") %
+                               options.firstRow % nTableRows).str());
+        }
+        std::size_t const beginRow = options.firstRow;
+        std::size_t const endRow = beginRow + std::min(options.nRows, nTableRows - beginRow);
+        // Read the rows in blocks, so the mapper can read each column of a block at once.
+        std::size_t const blockSize = mapper.getBlockSize();
+        std::vector<BaseRecord*> block;
+        auto addBlock = [&container, &block](std::size_t n) {
+            block.clear();
+            for (std::size_t i = 0; i < n; ++i) {
+                // We need to be able to support reading Catalog<T const>, since it shares the same
+                // template as Catalog<T> (which invokes this method in readFits).
+                block.push_back(const_cast<typename std::remove_const<typename ContainerT::Record>::type*>(
+                        container.addNew().get()));
+            }
+        };
+        if (!mapper.hasRowFilter()) {
+            container.reserve(endRow - beginRow);
+            for (std::size_t firstRow = beginRow; firstRow < endRow; firstRow += blockSize) {
+                addBlock(std::min(blockSize, endRow - firstRow));
+                mapper.readRecords(block, fits, firstRow);
+            }
+        } else {
+            // Find the rows that pass the filter first, reading only the columns it uses, so that
+            // only those rows are allocated, and contiguously.
+            std::vector<std::size_t> rows;
+            for (std::size_t firstRow = beginRow; firstRow < endRow; firstRow += blockSize) {
+                mapper.filterRows(fits, firstRow, std::min(blockSize, endRow - firstRow), rows);
+            }
+            container.reserve(rows.size());
+            std::vector<std::size_t> blockRows;
+            for (auto iter = rows.begin(); iter != rows.end();) {
+                auto blockEnd = std::lower_bound(iter, rows.end(), *iter + blockSize);
+                blockRows.assign(iter, blockEnd);
+                addBlock(blockRows.size());
+                mapper.readRecords(block, fits, blockRows);
+                iter = blockEnd;
+            }
         }
         return container;
     }
@@ -102,10 +145,11 @@ public:
      */
     template <typename ContainerT, typename SourceT>
     static ContainerT apply(SourceT& source, int hdu, int ioFlags,
-                            std::shared_ptr<InputArchive> archive = std::shared_ptr<InputArchive>()) {
+                            std::shared_ptr<InputArchive> archive = std::shared_ptr<InputArchive>(),
+                            FitsReadOptions const& options = FitsReadOptions()) {
         afw::fits::Fits fits(source, "r", afw::fits::Fits::AUTO_CLOSE | afw::fits::Fits::AUTO_CHECK);
         fits.setHdu(hdu);
-        return apply<ContainerT>(fits, ioFlags, archive);
+        return apply<ContainerT>(fits, ioFlags, archive, options);
     }
 
     /**
@@ -2,7 +2,10 @@
 #ifndef AFW_TABLE_IO_FitsSchemaInputMapper_h_INCLUDED
 #define AFW_TABLE_IO_FitsSchemaInputMapper_h_INCLUDED
 
+#include <vector>
+
 #include "lsst/afw/fits.h"
+#include "lsst/afw/table/io/FitsReadOptions.h"
 #include "lsst/afw/table/Schema.h"
 #include "lsst/afw/table/io/InputArchive.h"
 #include "lsst/afw/table/BaseRecord.h"
@@ -84,9 +87,9 @@ struct FitsSchemaItem {
  *  for columns or groups of columns via addColumnReader().  They can also be removed from the
  *  "regular" fields via the erase() method.  Those regular fields are filled in by the finalize()
  *  method, which automatically generates mappings for any FitsSchemaItems that have not been
- *  removed by calls to erase().  Once finalize() has been called, readRecord() may be called
- *  repeatedly to read FITS rows into record objects according to the mapping that has been
- *  defined.
+ *  removed by calls to erase().  Once finalize() has been called, readRecord() or readRecords()
+ *  may be called repeatedly to read FITS rows into record objects according to the mapping that
+ *  has been defined.
  */
 class FitsSchemaInputMapper {
 public:
@@ -169,6 +172,30 @@ public:
      */
     void customize(std::unique_ptr<FitsColumnReader> reader);
 
+    /**
+     *  Restrict the regular fields added by finalize() to those selected by the given names.
+     *
+     *  See FitsReadOptions::columns for how names select fields.  Must be called before finalize().
+     *
+     *  @throws pex::exceptions::NotFoundError (from finalize()) if a name selects no column.
+     */
+    void select(std::vector<std::string> const &names);
+
+    /**
+     *  Always add the fields of the given Schema (usually a table's minimal schema) that are present,
+     *  even if they are not selected by the names passed to select().
+     */
+    void require(Schema const &schema);
+
+    /**
+     *  Only read the rows whose fields satisfy the conditions in the given options'
+     *  unsetFlags, setFlags and valueRanges (see FitsReadOptions).
+     *
+     *  Must be called before finalize(), which finds the fields; the rows themselves are found
+     *  with filterRows().
+     */
+    void setRowFilter(FitsReadOptions const &options);
+
     /**
      *  Map any remaining items into regular Schema items, and return the final Schema.
      *
@@ -181,6 +208,56 @@ public:
      */
     void readRecord(BaseRecord &record, afw::fits::Fits &fits, std::size_t row);
 
+    /**
+     *  Return the number of rows readRecords() should be given at a time: PREPPED_ROWS_FACTOR
+     *  divided by the record size, but at least one.
+     *
+     *  Only valid after finalize() has been called.
+     */
+    std::size_t getBlockSize() const;
+
+    /**
+     *  Fill a block of records from consecutive FITS binary table rows.
+     *
+     *  This reads the block one column at a time: each fixed-size column (and the flag column) is
+     *  read for all of the rows with a single CFITSIO call, and then copied into the records.
+     *  Strings, variable-length arrays and custom readers that do not implement
+     *  FitsColumnReader::prepRead are still read one cell at a time.
+     *
+     *  @param[in,out] records   Records to populate, one for each row.
+     *  @param[in]     fits      FITS file manager object.
+     *  @param[in]     firstRow  Index of the row to read into records[0].
+     */
+    void readRecords(std::vector<BaseRecord *> const &records, afw::fits::Fits &fits, std::size_t firstRow);
+
+    /**
+     *  Fill records from the given FITS binary table rows.
+     *
+     *  This works as the other overload, reading every row from the first to the last given and
+     *  keeping only the ones asked for, so rows should be sorted and span no more than
+     *  getBlockSize() rows.
+     *
+     *  @param[in,out] records   Records to populate, one for each row.
+     *  @param[in]     fits      FITS file manager object.
+     *  @param[in]     rows      Indices of the rows to read into each record, in increasing order.
+     */
+    void readRecords(std::vector<BaseRecord *> const &records, afw::fits::Fits &fits,
+                     std::vector<std::size_t> const &rows);
+
+    /// Return true if setRowFilter() set any conditions.  Only valid after finalize() has been called.
+    bool hasRowFilter() const;
+
+    /**
+     *  Find the rows of a block that pass the row filter, reading only the columns it uses.
+     *
+     *  @param[in]     fits      FITS file manager object.
+     *  @param[in]     firstRow  Index of the first row of the block.
+     *  @param[in]     nRows     Number of rows in the block.
+     *  @param[in,out] rows      Vector the indices of the rows that pass are appended to.
+     */
+    void filterRows(afw::fits::Fits &fits, std::size_t firstRow, std::size_t nRows,
+                    std::vector<std::size_t> &rows);
+
 private:
     class Impl;
     std::shared_ptr<Impl> _impl;
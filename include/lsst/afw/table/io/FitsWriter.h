@@ -71,6 +71,7 @@ public:
         for (typename ContainerT::const_iterator i = container.begin(); i != container.end(); ++i) {
             _writeRecord(*i);
         }
+        _flushRecords();
         _finish();
     }
 
@@ -87,7 +88,12 @@ protected:
     /// Write a table and its schema.
     virtual void _writeTable(std::shared_ptr<BaseTable const> const& table, std::size_t nRows);
 
-    /// Write an individual record.
+    /**
+     *  Write an individual record.
+     *
+     *  Values are buffered and written to the file in blocks of rows, so the record may be modified
+     *  or destroyed as soon as this returns.
+     */
     virtual void _writeRecord(BaseRecord const& source);
 
     /// Finish writing a catalog.
@@ -100,6 +106,9 @@ protected:
 private:
     struct ProcessRecords;
 
+    /// Write any records that have been buffered by _writeRecord but not yet written to the file.
+    void _flushRecords();
+
     std::shared_ptr<ProcessRecords> _processor;  // a private Schema::forEach functor that write records
 };
 }  // namespace io
@@ -240,6 +240,14 @@ PyCatalog<Record> declareCatalog(utils::python::WrapperCollection &wrappers, std
                                "filename"_a, "hdu"_a = fits::DEFAULT_HDU, "flags"_a = 0);
                 cls.def_static("readFits", (Catalog(*)(fits::MemFileManager &, int, int)) & Catalog::readFits,
                                "manager"_a, "hdu"_a = fits::DEFAULT_HDU, "flags"_a = 0);
+                cls.def_static("readFits",
+                               (Catalog(*)(std::string const &, io::FitsReadOptions const &, int, int)) &
+                                       Catalog::readFits,
+                               "filename"_a, "options"_a, "hdu"_a = fits::DEFAULT_HDU, "flags"_a = 0);
+                cls.def_static("readFits",
+                               (Catalog(*)(fits::MemFileManager &, io::FitsReadOptions const &, int, int)) &
+                                       Catalog::readFits,
+                               "manager"_a, "options"_a, "hdu"_a = fits::DEFAULT_HDU, "flags"_a = 0);
                 // readFits taking Fits objects not wrapped, because Fits objects are not wrapped.
 
                 /* Methods */
@@ -66,12 +66,13 @@ template <typename PixelT, typename PyClass>
 void declareTemplatedMembers(PyClass &cls) {
     /* Constructors */
     cls.def(py::init<image::Image<PixelT> const &, Threshold const &, int const, bool const,
-                     table::Schema const &>(),
+                     table::Schema const &, int const>(),
             "img"_a, "threshold"_a, "npixMin"_a = 1, "setPeaks"_a = true,
-            "peakSchema"_a = PeakTable::makeMinimalSchema());
+            "peakSchema"_a = PeakTable::makeMinimalSchema(), "numThreads"_a = 1);
     cls.def(py::init<image::MaskedImage<PixelT, image::MaskPixel> const &, Threshold const &,
-                     std::string const &, int const, bool const>(),
-            "img"_a, "threshold"_a, "planeName"_a = "", "npixMin"_a = 1, "setPeaks"_a = true);
+                     std::string const &, int const, bool const, int const>(),
+            "img"_a, "threshold"_a, "planeName"_a = "", "npixMin"_a = 1, "setPeaks"_a = true,
+            "numThreads"_a = 1);
 
     /* Members */
     declareMakeHeavy<int>(cls);
@@ -95,8 +96,9 @@ void wrapFootprintSet(utils::python::WrapperCollection &wrappers) {
                 declareTemplatedMembers<float>(cls);
                 declareTemplatedMembers<double>(cls);
 
-                cls.def(py::init<image::Mask<image::MaskPixel> const &, Threshold const &, int const>(),
-                        "img"_a, "threshold"_a, "npixMin"_a = 1);
+                cls.def(py::init<image::Mask<image::MaskPixel> const &, Threshold const &, int const,
+                                 int const>(),
+                        "img"_a, "threshold"_a, "npixMin"_a = 1, "numThreads"_a = 1);
 
                 cls.def(py::init<lsst::geom::Box2I>(), "region"_a);
                 cls.def(py::init<FootprintSet const &>(), "set"_a);
@@ -247,6 +247,8 @@ void declareSpanSet(lsst::utils::python::WrapperCollection &wrappers) {
         cls.def("intersectNot",
                 (std::shared_ptr<SpanSet>(SpanSet::*)(SpanSet const &) const) & SpanSet::intersectNot);
         cls.def("union", (std::shared_ptr<SpanSet>(SpanSet::*)(SpanSet const &) const) & SpanSet::union_);
+        cls.def_static("unionAll", &SpanSet::unionAll, "spanSets"_a);
+        cls.def_static("intersectAll", &SpanSet::intersectAll, "spanSets"_a);
         cls.def_static("fromShape",
                        (std::shared_ptr<SpanSet>(*)(int, Stencil, lsst::geom::Point2I)) & SpanSet::fromShape,
                        "radius"_a, "stencil"_a = Stencil::CIRCLE, "offset"_a = lsst::geom::Point2I());
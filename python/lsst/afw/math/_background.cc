@@ -124,6 +124,8 @@ void declareBackground(lsst::utils::python::WrapperCollection &wrappers) {
                 (void (BackgroundControl::*)(Property)) & BackgroundControl::setStatisticsProperty);
         cls.def("setStatisticsProperty",
                 (void (BackgroundControl::*)(std::string)) & BackgroundControl::setStatisticsProperty);
+        cls.def("getNumThreads", &BackgroundControl::getNumThreads);
+        cls.def("setNumThreads", &BackgroundControl::setNumThreads);
         cls.def("setApproximateControl", &BackgroundControl::setApproximateControl);
         cls.def("getApproximateControl", (std::shared_ptr<ApproximateControl>(BackgroundControl::*)()) &
                                                  BackgroundControl::getApproximateControl);
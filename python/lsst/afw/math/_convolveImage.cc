@@ -77,17 +77,30 @@ void declareAll(lsst::utils::python::WrapperCollection &wrappers) {
 
 void declareConvolveImage(lsst::utils::python::WrapperCollection &wrappers) {
     using PyClass = py::class_<ConvolutionControl, std::shared_ptr<ConvolutionControl>>;
-    wrappers.wrapType(PyClass(wrappers.module, "ConvolutionControl"), [](auto &mod, auto &clsl) {
+    auto control = wrappers.wrapType(
+            PyClass(wrappers.module, "ConvolutionControl"), [](auto &mod, auto &clsl) {
         clsl.def(py::init<bool, bool, int>(), "doNormalize"_a = true, "doCopyEdge"_a = false,
                  "maxInterpolationDistance"_a = 10);
 
         clsl.def("getDoNormalize", &ConvolutionControl::getDoNormalize);
         clsl.def("getDoCopyEdge", &ConvolutionControl::getDoCopyEdge);
         clsl.def("getMaxInterpolationDistance", &ConvolutionControl::getMaxInterpolationDistance);
+        clsl.def("getNumThreads", &ConvolutionControl::getNumThreads);
         clsl.def("setDoNormalize", &ConvolutionControl::setDoNormalize);
         clsl.def("setDoCopyEdge", &ConvolutionControl::setDoCopyEdge);
         clsl.def("setMaxInterpolationDistance", &ConvolutionControl::setMaxInterpolationDistance);
+        clsl.def("setNumThreads", &ConvolutionControl::setNumThreads);
+        clsl.def("getAlgorithm", &ConvolutionControl::getAlgorithm);
+        clsl.def("setAlgorithm", &ConvolutionControl::setAlgorithm);
+        clsl.attr("FFT_MIN_KERNEL_AREA") = py::cast(int(ConvolutionControl::FFT_MIN_KERNEL_AREA));
     });
+    wrappers.wrapType(py::enum_<ConvolutionControl::Algorithm>(control, "Algorithm"),
+                      [](auto &mod, auto &enm) {
+                          enm.value("AUTO", ConvolutionControl::Algorithm::AUTO);
+                          enm.value("DIRECT", ConvolutionControl::Algorithm::DIRECT);
+                          enm.value("FFT", ConvolutionControl::Algorithm::FFT);
+                          enm.export_values();
+                      });
 }
 }  // namespace
 
@@ -27,6 +27,7 @@
 #include <lsst/utils/python.h>
 #include <pybind11/stl.h>
 
+#include "lsst/afw/image/ExposureFitsReader.h"
 #include "lsst/afw/math/Stack.h"
 
 namespace py = pybind11;
@@ -105,6 +106,40 @@ void declareStatisticsStack(lsst::utils::python::WrapperCollection &wrappers) {
                         std::vector<lsst::afw::image::VariancePixel> const &))statisticsStack<PixelT>,
                 "vectors"_a, "flags"_a, "sctrl"_a = StatisticsControl(),
                 "wvector"_a = std::vector<lsst::afw::image::VariancePixel>(0));
+        mod.def("statisticsStack",
+                (void (*)(lsst::afw::image::MaskedImage<PixelT> &,
+                          std::vector<std::shared_ptr<lsst::afw::image::ExposureFitsReader>> const &,
+                          Property, StatisticsControl const &,
+                          std::vector<lsst::afw::image::VariancePixel> const &, lsst::afw::image::MaskPixel,
+                          std::vector<std::pair<lsst::afw::image::MaskPixel,
+                                                lsst::afw::image::MaskPixel>> const &,
+                          int))statisticsStack<PixelT>,
+                "out"_a, "readers"_a, "flags"_a, "sctrl"_a = StatisticsControl(),
+                "wvector"_a = std::vector<lsst::afw::image::VariancePixel>(0), "clipped"_a = 0,
+                "maskMap"_a =
+                        std::vector<std::pair<lsst::afw::image::MaskPixel, lsst::afw::image::MaskPixel>>(),
+                "stripHeight"_a = 256);
+    });
+}
+
+template <typename PixelT>
+void declareStackAccumulator(lsst::utils::python::WrapperCollection &wrappers, std::string const &suffix) {
+    using Class = StackAccumulator<PixelT>;
+    using MaskMap = std::vector<std::pair<lsst::afw::image::MaskPixel, lsst::afw::image::MaskPixel>>;
+    using PyClass = py::class_<Class, std::shared_ptr<Class>>;
+    std::string const name = "StackAccumulator" + suffix;
+    wrappers.wrapType(PyClass(wrappers.module, name.c_str()), [](auto &mod, auto &cls) {
+        cls.def(py::init<lsst::geom::Box2I const &, Property, StatisticsControl const &, MaskMap const &>(),
+                "bbox"_a, "flags"_a, "sctrl"_a = StatisticsControl(), "maskMap"_a = MaskMap());
+        cls.def("add", py::overload_cast<lsst::afw::image::MaskedImage<PixelT> const &>(&Class::add),
+                "image"_a);
+        cls.def("add",
+                py::overload_cast<lsst::afw::image::MaskedImage<PixelT> const &,
+                                  lsst::afw::image::VariancePixel>(&Class::add),
+                "image"_a, "weight"_a);
+        cls.def("getResult", &Class::getResult);
+        cls.def("getWeightSum", &Class::getWeightSum);
+        cls.def("getBBox", &Class::getBBox);
     });
 }
 
@@ -114,6 +149,8 @@ void wrapStack(lsst::utils::python::WrapperCollection &wrappers) {
     wrappers.addSignatureDependency("lsst.afw.image");
     declareStatisticsStack<float>(wrappers);
     declareStatisticsStack<double>(wrappers);
+    declareStackAccumulator<float>(wrappers, "F");
+    declareStackAccumulator<double>(wrappers, "D");
 }
 }  // namespace math
 }  // namespace afw
@@ -117,6 +117,8 @@ void declareStatistics(lsst::utils::python::WrapperCollection &wrappers) {
         cls.def("getWeighted", &StatisticsControl::getWeighted);
         cls.def("getWeightedIsSet", &StatisticsControl::getWeightedIsSet);
         cls.def("getCalcErrorFromInputVariance", &StatisticsControl::getCalcErrorFromInputVariance);
+        cls.def("getNumThreads", &StatisticsControl::getNumThreads);
+        cls.def("getVectorize", &StatisticsControl::getVectorize);
         cls.def("setNumSigmaClip", &StatisticsControl::setNumSigmaClip);
         cls.def("setNumIter", &StatisticsControl::setNumIter);
         cls.def("setAndMask", &StatisticsControl::setAndMask);
@@ -124,6 +126,8 @@ void declareStatistics(lsst::utils::python::WrapperCollection &wrappers) {
         cls.def("setNanSafe", &StatisticsControl::setNanSafe);
         cls.def("setWeighted", &StatisticsControl::setWeighted);
         cls.def("setCalcErrorFromInputVariance", &StatisticsControl::setCalcErrorFromInputVariance);
+        cls.def("setNumThreads", &StatisticsControl::setNumThreads);
+        cls.def("setVectorize", &StatisticsControl::setVectorize);
     });
 
     wrappers.wrapType(py::enum_<StatisticsControl::WeightsBoolean>(control, "WeightsBoolean"),
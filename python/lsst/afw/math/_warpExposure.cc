@@ -149,6 +149,10 @@ void declareWarpExposure(lsst::utils::python::WrapperCollection &wrappers) {
         cls.def("setCacheSize", &WarpingControl::setCacheSize, "cacheSize"_a);
         cls.def("getInterpLength", &WarpingControl::getInterpLength);
         cls.def("setInterpLength", &WarpingControl::setInterpLength, "interpLength"_a);
+        cls.def("getInterpTolerance", &WarpingControl::getInterpTolerance);
+        cls.def("setInterpTolerance", &WarpingControl::setInterpTolerance, "interpTolerance"_a);
+        cls.def("getNumThreads", &WarpingControl::getNumThreads);
+        cls.def("setNumThreads", &WarpingControl::setNumThreads, "numThreads"_a);
         cls.def("setWarpingKernelName", &WarpingControl::setWarpingKernelName, "warpingKernelName"_a);
         cls.def("getWarpingKernel", &WarpingControl::getWarpingKernel);
         cls.def("setWarpingKernel", &WarpingControl::setWarpingKernel, "warpingKernel"_a);
@@ -91,6 +91,13 @@ class WarperConfig(pexConfig.Config):
         doc="``interpLength`` argument to `lsst.afw.math.warpExposure`",
         default=_DefaultInterpLength,
     )
+    interpTolerance = pexConfig.Field(
+        dtype=float,
+        doc="Largest allowed error (source pixels) in interpolated source positions; if positive, "
+            "tiles of ``interpLength`` pixels are split until they are within this tolerance, "
+            "see `lsst.afw.math.WarpingControl.setInterpTolerance`",
+        default=0.0,
+    )
     cacheSize = pexConfig.Field(
         dtype=int,
         doc="``cacheSize`` argument to `lsst.afw.math.SeparableKernel.computeCache`",
@@ -119,6 +126,9 @@ class Warper:
         see `WarperConfig.maskWarpingKernelName`
     growFullMask : `int`, optional
         mask bits to grow to full width of image/variance kernel
+    interpTolerance : `float`, optional
+        largest allowed error (source pixels) in interpolated source
+        positions; see `WarperConfig.interpTolerance`
     """
     ConfigClass = WarperConfig
 
@@ -127,9 +137,11 @@ class Warper:
                  interpLength=_DefaultInterpLength,
                  cacheSize=_DefaultCacheSize,
                  maskWarpingKernelName="",
-                 growFullMask=afwImage.Mask.getPlaneBitMask("EDGE"),):
+                 growFullMask=afwImage.Mask.getPlaneBitMask("EDGE"),
+                 interpTolerance=0.0):
         self._warpingControl = WarpingControl(
             warpingKernelName, maskWarpingKernelName, cacheSize, interpLength, growFullMask)
+        self._warpingControl.setInterpTolerance(interpTolerance)
 
     @classmethod
     def fromConfig(cls, config):
@@ -146,6 +158,7 @@ class Warper:
             interpLength=config.interpLength,
             cacheSize=config.cacheSize,
             growFullMask=config.growFullMask,
+            interpTolerance=config.interpTolerance,
         )
 
     def getWarpingKernel(self):
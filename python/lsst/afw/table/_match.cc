@@ -70,9 +70,25 @@ void declareMatch2(WrapperCollection &wrappers, std::string const &prefix) {
                 (MatchList(*)(Catalog1 const &, Catalog2 const &, lsst::geom::Angle,
                               MatchControl const &))matchRaDec<Catalog1, Catalog2>,
                 "cat1"_a, "cat2"_a, "radius"_a, "mc"_a = MatchControl());
+        mod.def("matchRaDec",
+                (MatchList(*)(Catalog1 const &, RaDecIndex<Catalog2> const &, lsst::geom::Angle,
+                              MatchControl const &))matchRaDec<Catalog1, Catalog2>,
+                "cat1"_a, "index2"_a, "radius"_a, "mc"_a = MatchControl());
     });
 };
 
+/// @internal Declare the spatial index of one type of catalog
+template <typename Catalog>
+void declareRaDecIndex(WrapperCollection &wrappers, std::string const &prefix) {
+    using Class = RaDecIndex<Catalog>;
+    using PyClass = py::class_<Class, std::shared_ptr<Class>>;
+    wrappers.wrapType(PyClass(wrappers.module, (prefix + "RaDecIndex").c_str()), [](auto &mod, auto &cls) {
+        cls.def(py::init<Catalog const &>(), "cat"_a);
+        cls.def("__len__", &Class::size);
+        cls.def("findWithin", &Class::findWithin, "coord"_a, "radius"_a);
+    });
+}
+
 /// @internal Declare match code templated on one type of catalog
 template <typename Catalog>
 void declareMatch1(WrapperCollection &wrappers) {
@@ -92,8 +108,11 @@ void wrapMatch(WrapperCollection &wrappers) {
         LSST_DECLARE_CONTROL_FIELD(cls, MatchControl, findOnlyClosest);
         LSST_DECLARE_CONTROL_FIELD(cls, MatchControl, symmetricMatch);
         LSST_DECLARE_CONTROL_FIELD(cls, MatchControl, includeMismatches);
+        LSST_DECLARE_CONTROL_FIELD(cls, MatchControl, numThreads);
     });
 
+    declareRaDecIndex<SimpleCatalog>(wrappers, "Simple");
+    declareRaDecIndex<SourceCatalog>(wrappers, "Source");
     declareMatch2<SimpleCatalog, SimpleCatalog>(wrappers, "Simple");
     declareMatch2<SimpleCatalog, SourceCatalog>(wrappers, "Reference");
     declareMatch2<SourceCatalog, SourceCatalog>(wrappers, "Source");
@@ -20,9 +20,11 @@
  */
 
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 #include "lsst/utils/python.h"
 
+#include "lsst/afw/table/io/FitsReadOptions.h"
 #include "lsst/afw/table/io/FitsSchemaInputMapper.h"
 
 namespace py = pybind11;
@@ -39,6 +41,17 @@ void wrapFits(utils::python::WrapperCollection& wrappers) {
                 [](std::size_t n) { FitsSchemaInputMapper::PREPPED_ROWS_FACTOR = n; });
         mod.def("getPreppedRowsFactor", []() { return FitsSchemaInputMapper::PREPPED_ROWS_FACTOR; });
     });
+    wrappers.wrapType(py::class_<FitsReadOptions>(wrappers.module, "FitsReadOptions"),
+                      [](auto& mod, auto& cls) {
+                          cls.def(py::init<>());
+                          cls.def_readwrite("columns", &FitsReadOptions::columns);
+                          cls.def_readwrite("firstRow", &FitsReadOptions::firstRow);
+                          cls.def_readwrite("nRows", &FitsReadOptions::nRows);
+                          cls.def_readwrite("unsetFlags", &FitsReadOptions::unsetFlags);
+                          cls.def_readwrite("setFlags", &FitsReadOptions::setFlags);
+                          cls.def_readwrite("valueRanges", &FitsReadOptions::valueRanges);
+                          cls.def("hasRowFilter", &FitsReadOptions::hasRowFilter);
+                      });
 }
 
 }  // namespace io
@@ -19,7 +19,9 @@
  * the GNU General Public License along with this program.  If not,
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
+#include <algorithm>
 #include <cstdint>
+#include <unordered_map>
 
 #include "lsst/afw/detection/FootprintMerge.h"
 #include "lsst/afw/table/IdFactory.h"
@@ -202,6 +204,82 @@ private:
     std::shared_ptr<afw::table::SourceRecord> _source;
 };
 
+namespace {
+
+/*
+ * An index of boxes by the cells of a uniform grid that they cover.
+ *
+ * Boxes are identified by their position in a list, and may grow, but are never removed; find()
+ * returns all boxes that may overlap the given one, and callers must check the candidates themselves.
+ */
+class BoxGrid final {
+public:
+    void insert(std::size_t id, lsst::geom::Box2I const &box) {
+        if (box.isEmpty()) return;
+        for (int cy = cellOf(box.getMinY()); cy <= cellOf(box.getMaxY()); ++cy) {
+            for (int cx = cellOf(box.getMinX()); cx <= cellOf(box.getMaxX()); ++cx) {
+                _cells[key(cx, cy)].push_back(id);
+            }
+        }
+    }
+
+    // Register a box that has grown from oldBox to newBox in the cells oldBox did not already cover.
+    void grow(std::size_t id, lsst::geom::Box2I const &oldBox, lsst::geom::Box2I const &newBox) {
+        if (oldBox.isEmpty()) {
+            insert(id, newBox);
+            return;
+        }
+        if (newBox.isEmpty()) return;
+        int const oldMinX = cellOf(oldBox.getMinX()), oldMaxX = cellOf(oldBox.getMaxX());
+        int const oldMinY = cellOf(oldBox.getMinY()), oldMaxY = cellOf(oldBox.getMaxY());
+        for (int cy = cellOf(newBox.getMinY()); cy <= cellOf(newBox.getMaxY()); ++cy) {
+            for (int cx = cellOf(newBox.getMinX()); cx <= cellOf(newBox.getMaxX()); ++cx) {
+                if (cx >= oldMinX && cx <= oldMaxX && cy >= oldMinY && cy <= oldMaxY) continue;
+                _cells[key(cx, cy)].push_back(id);
+            }
+        }
+    }
+
+    // Set candidates to the sorted ids of all boxes that share a cell with box.
+    void find(lsst::geom::Box2I const &box, std::vector<std::size_t> &candidates) const {
+        candidates.clear();
+        if (box.isEmpty()) return;
+        for (int cy = cellOf(box.getMinY()); cy <= cellOf(box.getMaxY()); ++cy) {
+            for (int cx = cellOf(box.getMinX()); cx <= cellOf(box.getMaxX()); ++cx) {
+                auto iter = _cells.find(key(cx, cy));
+                if (iter != _cells.end()) {
+                    candidates.insert(candidates.end(), iter->second.begin(), iter->second.end());
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+private:
+    // Width and height of the grid cells, in pixels
+    static int const CELL_SIZE = 64;
+
+    static int cellOf(int coord) {
+        return coord >= 0 ? coord / CELL_SIZE : -((CELL_SIZE - 1 - coord) / CELL_SIZE);
+    }
+
+    static std::uint64_t key(int cx, int cy) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+               static_cast<std::uint32_t>(cy);
+    }
+
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> _cells;
+};
+
+// Grow a FootprintMerge's bounding box by one pixel to allow for touching
+lsst::geom::Box2I growForTouching(lsst::geom::Box2I box) {
+    box.grow(lsst::geom::Extent2I(1, 1));
+    return box;
+}
+
+}  // namespace
+
 FootprintMergeList::FootprintMergeList(afw::table::Schema &sourceSchema,
                                        std::vector<std::string> const &filterList,
                                        afw::table::Schema const &initialPeakSchema)
@@ -248,6 +326,18 @@ void FootprintMergeList::addCatalog(std::shared_ptr<afw::table::SourceTable> sou
     // If list is empty or merging not requested, don't check for any matches, just add all the objects
     bool checkForMatches = !_mergeList.empty() && doMerge;
 
+    // Index the existing FootprintMerges by position in _mergeList, so each Footprint is only compared
+    // to those nearby.  FootprintMerges merged into another are reset to null rather than erased, so
+    // positions stay valid (and the list order is kept) until the catalog has been processed.
+    BoxGrid grid;
+    std::vector<std::size_t> candidates;
+    bool mergedAway = false;
+    if (checkForMatches) {
+        for (std::size_t i = 0; i < _mergeList.size(); ++i) {
+            grid.insert(i, growForTouching(_mergeList[i]->getBBox()));
+        }
+    }
+
     for (afw::table::SourceCatalog::const_iterator srcIter = inputCat.begin(); srcIter != inputCat.end();
          ++srcIter) {
         // Only consider unblended objects
@@ -258,16 +348,22 @@ void FootprintMergeList::addCatalog(std::shared_ptr<afw::table::SourceTable> sou
         // Empty pointer to account for the first match in the catalog.  If there is more than one
         // match, subsequent matches will be merged with this one
         std::shared_ptr<FootprintMerge> first = std::shared_ptr<FootprintMerge>();
+        std::size_t firstIndex = 0;
+        lsst::geom::Box2I firstBox;
 
         if (checkForMatches) {
-            FootprintMergeVec::iterator iter = _mergeList.begin();
-            while (iter != _mergeList.end()) {
-                // Grow by one pixel to allow for touching
-                lsst::geom::Box2I box((**iter).getBBox());
-                box.grow(lsst::geom::Extent2I(1, 1));
-                if (box.overlaps(foot->getBBox()) && (**iter).overlaps(*foot)) {
+            // Candidates are sorted by position, so they are visited in the same (priority) order as
+            // the whole list would be
+            grid.find(foot->getBBox(), candidates);
+            for (std::size_t index : candidates) {
+                std::shared_ptr<FootprintMerge> &merge = _mergeList[index];
+                if (!merge) continue;
+                lsst::geom::Box2I box = growForTouching(merge->getBBox());
+                if (box.overlaps(foot->getBBox()) && merge->overlaps(*foot)) {
                     if (!first) {
-                        first = *iter;
+                        first = merge;
+                        firstIndex = index;
+                        firstBox = box;
                         // Spatially extend existing FootprintMerge in order to connect subsequent,
                         // now-overlapping FootprintMerges. If a subsequent FootprintMerge overlaps with
                         // the new footprint, it's now guaranteed to overlap with this first FootprintMerge.
@@ -276,24 +372,31 @@ void FootprintMergeList::addCatalog(std::shared_ptr<afw::table::SourceTable> sou
                         first->addSpans(foot);
                     } else {
                         // Add existing merged Footprint to first
-                        first->add(**iter, _filterMap, minNewPeakDist, maxSamePeakDist);
-                        iter = _mergeList.erase(iter);
-                        continue;
+                        first->add(*merge, _filterMap, minNewPeakDist, maxSamePeakDist);
+                        merge.reset();
+                        mergedAway = true;
                     }
                 }
-                ++iter;
-            } // while mergeList
-        } //     if checkForMatches
+            }  // for candidates
+        }      // if checkForMatches
 
         if (first) {
             // Now merge footprint including peaks into the newly-connected, higher-priority FootprintMerge
             first->add(foot, _peakSchemaMapper, keyIter->second, minNewPeakDist, maxSamePeakDist);
+            grid.grow(firstIndex, firstBox, growForTouching(first->getBBox()));
         } else {
-           // Footprint did not overlap with any existing FootprintMerges. Add to MergeList
+            // Footprint did not overlap with any existing FootprintMerges. Add to MergeList
             _mergeList.push_back(std::make_shared<FootprintMerge>(foot, sourceTable, _peakTable,
                                                                   _peakSchemaMapper, keyIter->second));
+            if (checkForMatches) {
+                grid.insert(_mergeList.size() - 1, growForTouching(_mergeList.back()->getBBox()));
+            }
         }
     }
+
+    if (mergedAway) {
+        _mergeList.erase(std::remove(_mergeList.begin(), _mergeList.end(), nullptr), _mergeList.end());
+    }
 }
 
 void FootprintMergeList::getFinalSources(afw::table::SourceCatalog &outputCat) {
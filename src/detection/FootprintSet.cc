@@ -54,6 +54,7 @@
 #include "lsst/pex/exceptions.h"
 #include "lsst/afw/image/MaskedImage.h"
 #include "lsst/afw/math/Statistics.h"
+#include "lsst/afw/math/detail/Parallel.h"
 #include "lsst/afw/detection/Peak.h"
 #include "lsst/afw/detection/FootprintSet.h"
 #include "lsst/afw/detection/FootprintCtrl.h"
@@ -479,8 +480,17 @@ int resolve_alias(std::vector<int> const &aliases, /* list of aliases */
 }  // namespace
 
 namespace {
+/*
+ * The position and value of a peak found in a Footprint, to be added to it as a PeakRecord later
+ */
+struct PeakPosition {
+    int x, y;
+    float value;
+};
+
 template <typename ImageT>
-void findPeaksInFootprint(ImageT const &image, bool polarity, Footprint &foot, std::size_t const margin = 0) {
+void findPeaksInFootprint(ImageT const &image, bool polarity, Footprint const &foot,
+                          std::vector<PeakPosition> &peaks, std::size_t const margin = 0) {
     auto spanSet = foot.getSpans();
     if (spanSet->size() == 0) {
         return;
@@ -512,7 +522,7 @@ void findPeaksInFootprint(ImageT const &image, bool polarity, Footprint &foot, s
                 }
             }
 
-            foot.addPeak(x + image.getX0(), y + image.getY0(), val);
+            peaks.push_back(PeakPosition{x + image.getX0(), y + image.getY0(), static_cast<float>(val)});
         }
     }
 }
@@ -543,7 +553,7 @@ public:
         }
     }
 
-    void addRecord(Footprint &foot) const { foot.addPeak(_x, _y, _polarity ? _max : _min); }
+    PeakPosition getPeak() const { return PeakPosition{_x, _y, static_cast<float>(_polarity ? _max : _min)}; }
 
 private:
     bool _polarity;
@@ -551,28 +561,49 @@ private:
     double _min, _max;
 };
 
+/*
+ * Find the peaks of a Footprint, in the order they are to be added to it; if it has no local maxima,
+ * its peak is its brightest (faintest, for negative polarity) pixel.  The Footprint is not modified,
+ * so this may be called for many Footprints at once.
+ */
 template <typename ImageT, typename ThresholdT>
-void findPeaks(std::shared_ptr<Footprint> foot, ImageT const &img, bool polarity, ThresholdT) {
-    findPeaksInFootprint(img, polarity, *foot, 1);
-
-    // We use getInternal() here to get the vector of shared_ptr that Catalog uses internally,
-    // which causes the STL algorithm to copy pointers instead of PeakRecords (which is what
-    // it'd try to do if we passed Catalog's own iterators).
-    std::stable_sort(foot->getPeaks().getInternal().begin(), foot->getPeaks().getInternal().end(),
-                     SortPeaks());
+void findPeaks(Footprint const &foot, ImageT const &img, bool polarity, ThresholdT,
+               std::vector<PeakPosition> &peaks) {
+    findPeaksInFootprint(img, polarity, foot, peaks, 1);
 
-    if (foot->getPeaks().empty()) {
+    if (peaks.empty()) {
+        // Visit the pixels in the same order as SpanSet::applyFunctor, but without copying img's array,
+        // whose reference count isn't safe to share between threads
         FindMaxInFootprint<typename ImageT::Pixel> maxFinder(polarity);
-        foot->getSpans()->applyFunctor(maxFinder, ndarray::ndImage(img.getArray(), img.getXY0()));
-        maxFinder.addRecord(*foot);
+        for (auto const &span : *foot.getSpans()) {
+            int const y = span.getY();
+            for (int x = span.getMinX(); x <= span.getMaxX(); ++x) {
+                maxFinder(lsst::geom::Point2I(x, y), img(x - img.getX0(), y - img.getY0()));
+            }
+        }
+        peaks.push_back(maxFinder.getPeak());
     }
 }
 
 // No need to search for peaks when processing a Mask
 template <typename ImageT>
-void findPeaks(std::shared_ptr<Footprint>, ImageT const &, bool, ThresholdBitmask_traits) {
+void findPeaks(Footprint const &, ImageT const &, bool, ThresholdBitmask_traits,
+               std::vector<PeakPosition> &) {
     ;
 }
+
+// Add the peaks found by findPeaks to a Footprint, sorted by decreasing value
+void addPeaks(Footprint &foot, std::vector<PeakPosition> const &peaks) {
+    for (auto const &peak : peaks) {
+        foot.addPeak(peak.x, peak.y, peak.value);
+    }
+
+    // We use getInternal() here to get the vector of shared_ptr that Catalog uses internally,
+    // which causes the STL algorithm to copy pointers instead of PeakRecords (which is what
+    // it'd try to do if we passed Catalog's own iterators).
+    std::stable_sort(foot.getPeaks().getInternal().begin(), foot.getPeaks().getInternal().end(),
+                     SortPeaks());
+}
 }  // namespace
 
 /*
@@ -609,9 +640,63 @@ static inline IterT advancePtr(IterT varPtr, ThresholdPixelLevel_traits) {
     return varPtr + 1;
 }
 
+/*
+ * Find the runs of pixels that belong in Footprints in rows [yBegin, yEnd) of img, appending them to
+ * spans in row order; their IDs are left as 0.
+ */
+template <typename ImagePixelT, typename VariancePixelT, typename ThresholdTraitT>
+static void findSpansInRows(std::vector<IdSpan> &spans, int const yBegin, int const yEnd,
+                            image::ImageBase<ImagePixelT> const &img, image::Image<VariancePixelT> const *var,
+                            double const footprintThreshold, double const includeThreshold,
+                            double const includeThresholdMultiplier, bool const polarity) {
+    using x_iterator = typename image::Image<ImagePixelT>::x_iterator;
+    using x_var_iterator = typename image::Image<VariancePixelT>::x_iterator;
+
+    int const width = img.getWidth();
+    for (int y = yBegin; y != yEnd; ++y) {
+        bool in_span = false;                            /* in a span? */
+        int x0 = 0;                                      /* start of current span */
+        bool good = (includeThresholdMultiplier == 1.0); /* Span exceeds the threshold? */
+
+        x_iterator pixPtr = img.row_begin(y);
+        x_var_iterator varPtr = (var == nullptr) ? nullptr : var->row_begin(y);
+        for (int x = 0; x < width; ++x, ++pixPtr, varPtr = advancePtr(varPtr, ThresholdTraitT())) {
+            ImagePixelT const pixVal = *pixPtr;
+
+            if (isBadPixel(pixVal) ||
+                !inFootprint(pixVal, varPtr, polarity, footprintThreshold, ThresholdTraitT())) {
+                if (in_span) {
+                    spans.emplace_back(0, y, x0, x - 1, good);
+
+                    in_span = false;
+                    good = false;
+                }
+            } else { /* a pixel to fix */
+                if (!in_span) {
+                    x0 = x;
+                    in_span = true;
+                }
+
+                if (!good && inFootprint(pixVal, varPtr, polarity, includeThreshold, ThresholdTraitT())) {
+                    good = true;
+                }
+            }
+        }
+
+        if (in_span) {
+            spans.emplace_back(0, y, x0, width - 1, good);
+        }
+    }
+}
+
 /*
  * Here's the working routine for the FootprintSet constructors; see documentation
  * of the constructors themselves
+ *
+ * The runs of pixels above threshold are found in parallel bands of rows, and then given object IDs by
+ * connecting each run to the (8-connected) runs in the previous row.  This replays, run by run, the
+ * choice of IDs and aliases of a pixel-by-pixel scan of the whole image, so the Footprints and their
+ * order don't depend on the number of threads.  The Footprints' peaks are then found in parallel.
  */
 template <typename ImagePixelT, typename MaskPixelT, typename VariancePixelT, typename ThresholdTraitT>
 static void findFootprints(
@@ -625,106 +710,92 @@ static void findFootprints(
         int const npixMin,                        // minimum number of pixels in an object
         bool const setPeaks,                      // should I set the Peaks list?
         table::Schema const &peakSchema =
-                PeakTable::makeMinimalSchema()  // Schema to use when defining peak catalog.
+                PeakTable::makeMinimalSchema(),  // Schema to use when defining peak catalog.
+        int const numThreads = 1                 // number of threads; 0 for one per hardware thread
 ) {
+    if (numThreads < 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          str(boost::format("numThreads may not be negative: %d") % numThreads));
+    }
+
     int id;       /* object ID */
-    int in_span;  /* object ID of current IdSpan */
     int nobj = 0; /* number of objects found */
-    int x0 = 0;   /* unpacked from a IdSpan */
 
     double includeThreshold = footprintThreshold * includeThresholdMultiplier;  // Threshold for inclusion
 
     int const row0 = img.getY0();
     int const col0 = img.getX0();
     int const height = img.getHeight();
-    int const width = img.getWidth();
     /*
-     * Storage for arrays that identify objects by ID. We want to be able to
-     * refer to idp[-1] and idp[width], hence the (width + 2)
+     * Find the runs of pixels in each band of rows, and concatenate them in row order
      */
-    std::vector<int> id1(width + 2);
-    std::fill(id1.begin(), id1.end(), 0);
-    std::vector<int> id2(width + 2);
-    std::fill(id2.begin(), id2.end(), 0);
-    std::vector<int>::iterator idc = id1.begin() + 1;  // object IDs in current/
-    std::vector<int>::iterator idp = id2.begin() + 1;  //                       previous row
+    std::vector<std::vector<IdSpan>> bandSpans(math::detail::resolveNumThreads(numThreads));
+    math::detail::parallelForBands(height, numThreads, [&](int begin, int end, int iBand) {
+        findSpansInRows<ImagePixelT, VariancePixelT, ThresholdTraitT>(
+                bandSpans[iBand], begin, end, img, var, footprintThreshold, includeThreshold,
+                includeThresholdMultiplier, polarity);
+    });
+
+    std::vector<IdSpan> spans;  // y:x0,x1 for objects
+    {
+        std::size_t nSpans = 0;
+        for (auto const &band : bandSpans) {
+            nSpans += band.size();
+        }
+        spans.reserve(nSpans);
+        for (auto &band : bandSpans) {
+            spans.insert(spans.end(), band.begin(), band.end());
+            std::vector<IdSpan>().swap(band);
+        }
+    }
+    // rowStart[y] is the index of the first span in row y (or later)
+    std::vector<std::size_t> rowStart(height + 1);
+    {
+        std::size_t i = 0;
+        for (int y = 0; y <= height; ++y) {
+            while (i < spans.size() && spans[i].y < y) {
+                ++i;
+            }
+            rowStart[y] = i;
+        }
+    }
 
     std::vector<int> aliases;          // aliases for initially disjoint parts of Footprints
     aliases.reserve(1 + height / 20);  // initial size of aliases
+    aliases.push_back(0);              // 0 --> 0
+    /*
+     * Go through the spans identifying objects.  A span takes the ID of the run in the previous row
+     * that touches its first pixel (or a new ID if there isn't one), and the runs that touch the rest
+     * of it are aliased to that ID in turn.
+     */
+    for (int y = 0; y < height; ++y) {
+        std::size_t prev = (y == 0) ? rowStart[0] : rowStart[y - 1];
+        std::size_t const prevEnd = rowStart[y];
+        for (std::size_t i = rowStart[y]; i != rowStart[y + 1]; ++i) {
+            IdSpan &span = spans[i];
+            // Skip runs in the previous row that end left of this span's neighbourhood
+            while (prev != prevEnd && spans[prev].x1 < span.x0 - 1) {
+                ++prev;
+            }
 
-    std::vector<IdSpan> spans;          // y:x0,x1 for objects
-    spans.reserve(aliases.capacity());  // initial size of spans
-
-    aliases.push_back(0);  // 0 --> 0
-                           /*
-                            * Go through image identifying objects
-                            */
-    using x_iterator = typename image::Image<ImagePixelT>::x_iterator;
-    using x_var_iterator = typename image::Image<VariancePixelT>::x_iterator;
-
-    in_span = 0;  // not in a span
-    for (int y = 0; y != height; ++y) {
-        if (idc == id1.begin() + 1) {
-            idc = id2.begin() + 1;
-            idp = id1.begin() + 1;
-        } else {
-            idc = id1.begin() + 1;
-            idp = id2.begin() + 1;
-        }
-        std::fill_n(idc - 1, width + 2, 0);
-
-        in_span = 0;                                     /* not in a span */
-        bool good = (includeThresholdMultiplier == 1.0); /* Span exceeds the threshold? */
-
-        x_iterator pixPtr = img.row_begin(y);
-        x_var_iterator varPtr = (var == nullptr) ? nullptr : var->row_begin(y);
-        for (int x = 0; x < width; ++x, ++pixPtr, varPtr = advancePtr(varPtr, ThresholdTraitT())) {
-            ImagePixelT const pixVal = *pixPtr;
-
-            if (isBadPixel(pixVal) ||
-                !inFootprint(pixVal, varPtr, polarity, footprintThreshold, ThresholdTraitT())) {
-                if (in_span) {
-                    spans.emplace_back(in_span, y, x0, x - 1, good);
-
-                    in_span = 0;
-                    good = false;
-                }
-            } else { /* a pixel to fix */
-                if (idc[x - 1] != 0) {
-                    id = idc[x - 1];
-                } else if (idp[x - 1] != 0) {
-                    id = idp[x - 1];
-                } else if (idp[x] != 0) {
-                    id = idp[x];
-                } else if (idp[x + 1] != 0) {
-                    id = idp[x + 1];
-                } else {
-                    id = ++nobj;
-                    aliases.push_back(id);
-                }
-
-                idc[x] = id;
-                if (!in_span) {
-                    x0 = x;
-                    in_span = id;
-                }
-                /*
-                 * Do we need to merge ID numbers? If so, make suitable entries in aliases[]
-                 */
-                if (idp[x + 1] != 0 && idp[x + 1] != id) {
-                    aliases[resolve_alias(aliases, idp[x + 1])] = resolve_alias(aliases, id);
-
-                    idc[x] = id = idp[x + 1];
-                }
-
-                if (!good && inFootprint(pixVal, varPtr, polarity, includeThreshold, ThresholdTraitT())) {
-                    good = true;
+            std::size_t touching = prev;
+            if (touching != prevEnd && spans[touching].x0 <= span.x0 + 1) {
+                id = resolve_alias(aliases, spans[touching].id);
+                ++touching;
+            } else {
+                id = ++nobj;
+                aliases.push_back(id);
+            }
+            /*
+             * Do we need to merge ID numbers? If so, make suitable entries in aliases[]
+             */
+            for (; touching != prevEnd && spans[touching].x0 <= span.x1 + 1; ++touching) {
+                int const other = resolve_alias(aliases, spans[touching].id);
+                if (other != id) {
+                    aliases[other] = id;
                 }
             }
-        }
-
-        if (in_span) {
-            spans.emplace_back(in_span, y, x0, width - 1, good);
+            span.id = id;
         }
     }
     /*
@@ -771,40 +842,55 @@ static void findFootprints(
      * Find all peaks within those Footprints
      */
     if (setPeaks) {
-        using fiterator = FootprintSet::FootprintList::iterator;
-        for (auto const &_footprint : *_footprints) {
-            findPeaks(_footprint, img, polarity, ThresholdTraitT());
+        FootprintSet::FootprintList const &footprints = *_footprints;
+        std::vector<std::vector<PeakPosition>> peaks(footprints.size());
+        math::detail::parallelForBands(footprints.size(), numThreads, [&](int begin, int end, int) {
+            for (int i = begin; i != end; ++i) {
+                findPeaks(*footprints[i], img, polarity, ThresholdTraitT(), peaks[i]);
+            }
+        });
+        // The Footprints share a PeakTable, whose record allocation and IdFactory aren't thread-safe,
+        // so the PeakRecords are made here, in the order of the serial scan
+        for (std::size_t i = 0; i != footprints.size(); ++i) {
+            if (!peaks[i].empty()) {
+                addPeaks(*footprints[i], peaks[i]);
+            }
         }
     }
 }
 
 template <typename ImagePixelT>
 FootprintSet::FootprintSet(image::Image<ImagePixelT> const &img, Threshold const &threshold,
-                           int const npixMin, bool const setPeaks, table::Schema const &peakSchema)
+                           int const npixMin, bool const setPeaks, table::Schema const &peakSchema,
+                           int const numThreads)
         : _footprints(new FootprintList()), _region(img.getBBox()) {
     using VariancePixelT = float;
 
     findFootprints<ImagePixelT, image::MaskPixel, VariancePixelT, ThresholdLevel_traits>(
             _footprints.get(), _region, img, nullptr, threshold.getValue(img),
-            threshold.getIncludeMultiplier(), threshold.getPolarity(), npixMin, setPeaks, peakSchema);
+            threshold.getIncludeMultiplier(), threshold.getPolarity(), npixMin, setPeaks, peakSchema,
+            numThreads);
 }
 
 // NOTE: not a template to appease swig (see note by instantiations at bottom)
 
 template <typename MaskPixelT>
-FootprintSet::FootprintSet(image::Mask<MaskPixelT> const &msk, Threshold const &threshold, int const npixMin)
+FootprintSet::FootprintSet(image::Mask<MaskPixelT> const &msk, Threshold const &threshold, int const npixMin,
+                           int const numThreads)
         : _footprints(new FootprintList()), _region(msk.getBBox()) {
     switch (threshold.getType()) {
         case Threshold::BITMASK:
             findFootprints<MaskPixelT, MaskPixelT, float, ThresholdBitmask_traits>(
                     _footprints.get(), _region, msk, nullptr, threshold.getValue(),
-                    threshold.getIncludeMultiplier(), threshold.getPolarity(), npixMin, false);
+                    threshold.getIncludeMultiplier(), threshold.getPolarity(), npixMin, false,
+                    PeakTable::makeMinimalSchema(), numThreads);
             break;
 
         case Threshold::VALUE:
             findFootprints<MaskPixelT, MaskPixelT, float, ThresholdLevel_traits>(
                     _footprints.get(), _region, msk, nullptr, threshold.getValue(),
-                    threshold.getIncludeMultiplier(), threshold.getPolarity(), npixMin, false);
+                    threshold.getIncludeMultiplier(), threshold.getPolarity(), npixMin, false,
+                    PeakTable::makeMinimalSchema(), numThreads);
             break;
 
         default:
@@ -816,7 +902,7 @@ FootprintSet::FootprintSet(image::Mask<MaskPixelT> const &msk, Threshold const &
 template <typename ImagePixelT, typename MaskPixelT>
 FootprintSet::FootprintSet(const image::MaskedImage<ImagePixelT, MaskPixelT> &maskedImg,
                            Threshold const &threshold, std::string const &planeName, int const npixMin,
-                           bool const setPeaks)
+                           bool const setPeaks, int const numThreads)
         : _footprints(new FootprintList()),
           _region(lsst::geom::Point2I(maskedImg.getX0(), maskedImg.getY0()),
                   lsst::geom::Extent2I(maskedImg.getWidth(), maskedImg.getHeight())) {
@@ -827,13 +913,13 @@ FootprintSet::FootprintSet(const image::MaskedImage<ImagePixelT, MaskPixelT> &ma
             findFootprints<ImagePixelT, MaskPixelT, VariancePixelT, ThresholdPixelLevel_traits>(
                     _footprints.get(), _region, *maskedImg.getImage(), maskedImg.getVariance().get(),
                     threshold.getValue(maskedImg), threshold.getIncludeMultiplier(), threshold.getPolarity(),
-                    npixMin, setPeaks);
+                    npixMin, setPeaks, PeakTable::makeMinimalSchema(), numThreads);
             break;
         default:
             findFootprints<ImagePixelT, MaskPixelT, VariancePixelT, ThresholdLevel_traits>(
                     _footprints.get(), _region, *maskedImg.getImage(), maskedImg.getVariance().get(),
                     threshold.getValue(maskedImg), threshold.getIncludeMultiplier(), threshold.getPolarity(),
-                    npixMin, setPeaks);
+                    npixMin, setPeaks, PeakTable::makeMinimalSchema(), numThreads);
             break;
     }
     // Set Mask if requested
@@ -984,13 +1070,15 @@ std::ostream &operator<<(std::ostream &os, FootprintSet const &rhs) {
 
 #define INSTANTIATE(PIXEL)                                                                              \
     template FootprintSet::FootprintSet(image::Image<PIXEL> const &, Threshold const &, int const,      \
-                                        bool const, table::Schema const &);                             \
+                                        bool const, table::Schema const &, int const);                  \
     template FootprintSet::FootprintSet(image::MaskedImage<PIXEL, image::MaskPixel> const &,            \
-                                        Threshold const &, std::string const &, int const, bool const); \
+                                        Threshold const &, std::string const &, int const, bool const,  \
+                                        int const);                                                     \
     template void FootprintSet::makeHeavy(image::MaskedImage<PIXEL, image::MaskPixel> const &,          \
                                           HeavyFootprintCtrl const *)
 
-template FootprintSet::FootprintSet(image::Mask<image::MaskPixel> const &, Threshold const &, int const);
+template FootprintSet::FootprintSet(image::Mask<image::MaskPixel> const &, Threshold const &, int const,
+                                    int const);
 
 template void FootprintSet::setMask(image::Mask<image::MaskPixel> *, std::string const &);
 template void FootprintSet::setMask(std::shared_ptr<image::Mask<image::MaskPixel>>, std::string const &);
@@ -23,6 +23,9 @@
 
 #include <algorithm>
 #include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
 #include "lsst/afw/geom/SpanSet.h"
 #include "lsst/afw/table/io/CatalogVector.h"
 #include "lsst/afw/table/io/OutputArchive.h"
@@ -170,72 +173,375 @@ std::shared_ptr<SpanSet> maskIntersect(SpanSet const& spanSet, image::Mask<T> co
     return std::make_shared<SpanSet>(std::move(newVec));
 }
 
+/* Run-length morphology with the CIRCLE, BOX and MANHATTAN stencils
+ *
+ * These stencils are symmetric, and their rows get no wider away from the centre, so each is the union
+ * of a few boxes: one for each distinct row half-width w, whose half-height h is the largest |dy| of a
+ * row at least that wide.  Dilating (eroding) by a box is separable: each row is dilated (eroded) by w
+ * horizontally, then rows are combined by union (intersection) over a sliding window of 2h + 1 rows,
+ * which the van Herk/Gil-Werman algorithm does with three row operations per row whatever the value
+ * of h.  The rows produced for the boxes are then combined by union (intersection).  Every row
+ * operation takes and returns sorted, non-contiguous runs, so the result is already normalized.
+ */
+
+// The sorted, non-contiguous [min, max] runs of one row of a SpanSet
+using RowRuns = std::vector<std::pair<int, int>>;
+
+// Append a run to a row, merging it with the last run if they are contiguous; runs must be appended in
+// order of their minima
+void appendRun(RowRuns& row, int min, int max) {
+    if (!row.empty() && min <= row.back().second + 1) {
+        row.back().second = std::max(row.back().second, max);
+    } else {
+        row.emplace_back(min, max);
+    }
+}
+
+void unionRuns(RowRuns const& a, RowRuns const& b, RowRuns& out) {
+    out.clear();
+    auto aIter = a.begin();
+    auto bIter = b.begin();
+    while (aIter != a.end() || bIter != b.end()) {
+        if (bIter == b.end() || (aIter != a.end() && aIter->first <= bIter->first)) {
+            appendRun(out, aIter->first, aIter->second);
+            ++aIter;
+        } else {
+            appendRun(out, bIter->first, bIter->second);
+            ++bIter;
+        }
+    }
+}
+
+void intersectRuns(RowRuns const& a, RowRuns const& b, RowRuns& out) {
+    out.clear();
+    auto aIter = a.begin();
+    auto bIter = b.begin();
+    while (aIter != a.end() && bIter != b.end()) {
+        int const min = std::max(aIter->first, bIter->first);
+        int const max = std::min(aIter->second, bIter->second);
+        if (min <= max) {
+            out.emplace_back(min, max);
+        }
+        if (aIter->second < bIter->second) {
+            ++aIter;
+        } else {
+            ++bIter;
+        }
+    }
+}
+
+// Dilate (grow > 0) or erode (grow < 0) the runs of a row horizontally by |grow| pixels
+void growRuns(RowRuns const& row, int grow, RowRuns& out) {
+    out.clear();
+    for (auto const& run : row) {
+        int const min = run.first - grow;
+        int const max = run.second + grow;
+        if (min <= max) {
+            appendRun(out, min, max);
+        }
+    }
+}
+
+/* Combine each window of `window` consecutive rows, returning the result for rows [j, j + window) as
+ * element j, with the van Herk/Gil-Werman algorithm: rows are split into blocks of `window` rows, and
+ * each window is the combination of the suffix of one block with the prefix of the next.
+ *
+ * combine must be associative, commutative and idempotent, like unionRuns and intersectRuns.
+ */
+template <typename Combine>
+std::vector<RowRuns> combineWindows(std::vector<RowRuns> const& rows, int window, Combine combine) {
+    int const nRows = rows.size();
+    std::vector<RowRuns> result(std::max(nRows - window + 1, 0));
+    if (result.empty() || window == 1) {
+        std::copy(rows.begin(), rows.begin() + result.size(), result.begin());
+        return result;
+    }
+    std::vector<RowRuns> prefix(nRows);  // rows from the start of each row's block to the row
+    std::vector<RowRuns> suffix(nRows);  // rows from each row to the end of its block
+    for (int i = 0; i < nRows; ++i) {
+        if (i % window == 0) {
+            prefix[i] = rows[i];
+        } else {
+            combine(prefix[i - 1], rows[i], prefix[i]);
+        }
+    }
+    for (int i = nRows - 1; i >= 0; --i) {
+        if (i == nRows - 1 || (i + 1) % window == 0) {
+            suffix[i] = rows[i];
+        } else {
+            combine(rows[i], suffix[i + 1], suffix[i]);
+        }
+    }
+    for (std::size_t j = 0; j < result.size(); ++j) {
+        combine(suffix[j], prefix[j + window - 1], result[j]);
+    }
+    return result;
+}
+
+/* Dilate or erode a non-empty SpanSet with a stencil made by SpanSet::fromShape with r > 0
+ *
+ * spanSet - SpanSet to dilate or erode
+ * stencil - the stencil
+ * dilate - dilate if true, erode if false
+ */
+std::shared_ptr<SpanSet> stencilMorphology(SpanSet const& spanSet, SpanSet const& stencil, bool dilate) {
+    // (half-width, half-height) of the boxes making up the stencil, from its rows with dy >= 0
+    std::vector<std::pair<int, int>> boxes;
+    for (auto const& spn : stencil) {
+        if (spn.getY() < 0) {
+            continue;
+        }
+        if (!boxes.empty() && boxes.back().first == spn.getMaxX()) {
+            boxes.back().second = spn.getY();
+        } else {
+            boxes.emplace_back(spn.getMaxX(), spn.getY());
+        }
+    }
+    int const r = boxes.back().second;
+
+    // The rows of spanSet, including any empty ones, from its minimum y.  SpanSets made without
+    // normalization may have unsorted or overlapping spans, so sort and merge the runs of each row.
+    auto yRange = std::minmax_element(spanSet.begin(), spanSet.end(), [](Span const& a, Span const& b) {
+        return a.getY() < b.getY();
+    });
+    int const minY = yRange.first->getY();
+    int const nRows = yRange.second->getY() - minY + 1;
+    std::vector<RowRuns> rows(nRows);
+    for (auto const& spn : spanSet) {
+        rows[spn.getY() - minY].emplace_back(spn.getMinX(), spn.getMaxX());
+    }
+    RowRuns merged;
+    for (auto& row : rows) {
+        if (row.size() > 1) {
+            std::sort(row.begin(), row.end());
+            merged.clear();
+            for (auto const& run : row) {
+                appendRun(merged, run.first, run.second);
+            }
+            std::swap(row, merged);
+        }
+    }
+
+    // Output rows run from minY - r to maxY + r when dilating, and from minY + r to maxY - r when eroding
+    int const nOutRows = dilate ? nRows + 2 * r : nRows - 2 * r;
+    if (nOutRows <= 0) {
+        return std::make_shared<SpanSet>();
+    }
+    int const outMinY = dilate ? minY - r : minY + r;
+
+    std::vector<RowRuns> outRows;
+    std::vector<RowRuns> boxRows;
+    RowRuns combined;
+    for (auto const& box : boxes) {
+        int const w = box.first;
+        int const h = box.second;
+        // Grow the rows horizontally, then pad (dilating) or trim (eroding) them so that window j of
+        // 2h + 1 rows is centred on output row j
+        int const pad = dilate ? r + h : 0;
+        int const first = dilate ? 0 : r - h;
+        int const last = dilate ? nRows : nRows - (r - h);
+        boxRows.assign(last - first + 2 * pad, RowRuns());
+        for (int i = first; i < last; ++i) {
+            growRuns(rows[i], dilate ? w : -w, boxRows[i - first + pad]);
+        }
+        std::vector<RowRuns> windowRows = dilate ? combineWindows(boxRows, 2 * h + 1, unionRuns)
+                                                 : combineWindows(boxRows, 2 * h + 1, intersectRuns);
+        if (outRows.empty()) {
+            outRows = std::move(windowRows);
+        } else {
+            for (int j = 0; j < nOutRows; ++j) {
+                if (dilate) {
+                    unionRuns(outRows[j], windowRows[j], combined);
+                } else {
+                    intersectRuns(outRows[j], windowRows[j], combined);
+                }
+                std::swap(outRows[j], combined);
+            }
+        }
+    }
+
+    std::vector<Span> tempVec;
+    for (int j = 0; j < nOutRows; ++j) {
+        for (auto const& run : outRows[j]) {
+            tempVec.emplace_back(outMinY + j, run.first, run.second);
+        }
+    }
+    // The runs are sorted and non-contiguous, so there is nothing to normalize
+    return std::make_shared<SpanSet>(std::move(tempVec), false);
+}
+
+/* Sorted-merge set operations
+ *
+ * The Spans of a normalized SpanSet are sorted by row and then by column, and the Spans in a row are
+ * neither overlapping nor contiguous.  Set operations can therefore walk their operands together in a
+ * single pass, and produce Spans which are already normalized, so the result needs no normalization.
+ */
+
+// Whether Spans are normalized: sorted, with the Spans in each row neither overlapping nor contiguous
+bool spansNormalized(std::vector<Span> const& spans) {
+    auto const outOfOrder = [](Span const& a, Span const& b) {
+        return b.getY() < a.getY() || (b.getY() == a.getY() && b.getMinX() <= a.getMaxX() + 1);
+    };
+    return std::adjacent_find(spans.begin(), spans.end(), outOfOrder) == spans.end();
+}
+
+// Append a Span to sorted Spans, merging it with the last Span if they are contiguous; Spans must be
+// appended in sorted order
+void appendSpan(std::vector<Span>& spans, Span const& spn) {
+    if (!spans.empty() && spans.back().getY() == spn.getY() && spn.getMinX() <= spans.back().getMaxX() + 1) {
+        if (spn.getMaxX() > spans.back().getMaxX()) {
+            spans.back() = Span(spn.getY(), spans.back().getMinX(), spn.getMaxX());
+        }
+    } else {
+        spans.push_back(spn);
+    }
+}
+
+// Append the Spans in either of two ranges of normalized Spans to out
+void unionSpans(SpanSet::const_iterator a, SpanSet::const_iterator aEnd, SpanSet::const_iterator b,
+                SpanSet::const_iterator bEnd, std::vector<Span>& out) {
+    while (a != aEnd && b != bEnd) {
+        Span const aSpan = *a;
+        Span const bSpan = *b;
+        if (bSpan < aSpan) {
+            appendSpan(out, bSpan);
+            ++b;
+        } else {
+            appendSpan(out, aSpan);
+            ++a;
+        }
+    }
+    for (; a != aEnd; ++a) {
+        appendSpan(out, *a);
+    }
+    for (; b != bEnd; ++b) {
+        appendSpan(out, *b);
+    }
+}
+
+// Append the pixels in both of two ranges of normalized Spans to out
+template <typename IterA, typename IterB>
+void intersectSpans(IterA a, IterA aEnd, IterB b, IterB bEnd, std::vector<Span>& out) {
+    while (a != aEnd && b != bEnd) {
+        Span const aSpan = *a;
+        Span const bSpan = *b;
+        if (aSpan.getY() != bSpan.getY()) {
+            if (aSpan.getY() < bSpan.getY()) {
+                ++a;
+            } else {
+                ++b;
+            }
+            continue;
+        }
+        int const min = std::max(aSpan.getMinX(), bSpan.getMinX());
+        int const max = std::min(aSpan.getMaxX(), bSpan.getMaxX());
+        if (min <= max) {
+            out.emplace_back(aSpan.getY(), min, max);
+        }
+        // The Span which ends first can overlap nothing further in the other range
+        if (aSpan.getMaxX() < bSpan.getMaxX()) {
+            ++a;
+        } else {
+            ++b;
+        }
+    }
+}
+
+// Append the pixels in the first of two ranges of normalized Spans but not in the second to out
+void intersectNotSpans(SpanSet::const_iterator a, SpanSet::const_iterator aEnd, SpanSet::const_iterator b,
+                       SpanSet::const_iterator bEnd, std::vector<Span>& out) {
+    for (; a != aEnd; ++a) {
+        Span const aSpan = *a;
+        int const y = aSpan.getY();
+        // Skip the Spans of b which lie before this one; they lie before all later ones too
+        while (b != bEnd && (b->getY() < y || (b->getY() == y && b->getMaxX() < aSpan.getMinX()))) {
+            ++b;
+        }
+        // Remove the Spans of b which overlap this one.  The last of them may also overlap the next
+        // Span in the row, so b is not advanced past them.
+        int x0 = aSpan.getMinX();
+        for (auto bIter = b; bIter != bEnd; ++bIter) {
+            Span const bSpan = *bIter;
+            if (bSpan.getY() != y || bSpan.getMinX() > aSpan.getMaxX()) {
+                break;
+            }
+            if (bSpan.getMinX() > x0) {
+                out.emplace_back(y, x0, bSpan.getMinX() - 1);
+            }
+            x0 = std::max(x0, bSpan.getMaxX() + 1);
+        }
+        if (x0 <= aSpan.getMaxX()) {
+            out.emplace_back(y, x0, aSpan.getMaxX());
+        }
+    }
+}
+
+// The Spans of every empty SpanSet
+std::shared_ptr<std::vector<Span> const> const& emptySpans() {
+    static auto const spans = std::make_shared<std::vector<Span> const>();
+    return spans;
+}
+
 }  // namespace
 
 // Default constructor, creates a null SpanSet which may be useful for
 // comparisons
-SpanSet::SpanSet() : _spanVector(), _bbox(), _area(0) {}
+SpanSet::SpanSet() : _spans(emptySpans()), _offset(), _bbox(), _area(0), _normalized(true) {}
 
 // Construct a SpanSet from an lsst::geom::Box2I object
-SpanSet::SpanSet(lsst::geom::Box2I const& box) : _bbox(box), _area(box.getArea()) {
+SpanSet::SpanSet(lsst::geom::Box2I const& box)
+        : _spans(emptySpans()), _offset(), _bbox(box), _area(box.getArea()), _normalized(true) {
     int beginY = box.getMinY();
 
     int beginX = box.getMinX();
     int maxX = box.getMaxX();
 
+    std::vector<Span> tempVec;
+    tempVec.reserve(box.getHeight());
     for (int i = beginY; i < _bbox.getEndY(); ++i) {
-        _spanVector.emplace_back(i, beginX, maxX);
+        tempVec.emplace_back(i, beginX, maxX);
+    }
+    if (!tempVec.empty()) {
+        _spans = std::make_shared<std::vector<Span> const>(std::move(tempVec));
     }
 }
 
 // Construct a SpanSet from a std vector by copying
-SpanSet::SpanSet(std::vector<Span> const& vec, bool normalize) : _spanVector(vec) {
-    // If the incoming vector is zero, should create an empty spanSet
-    if (_spanVector.empty()) {
-        _bbox = lsst::geom::Box2I();
-        _area = 0;
-    } else {
-        if (normalize) {
-            _runNormalize();
-        }
-        _initialize();
-    }
+SpanSet::SpanSet(std::vector<Span> const& vec, bool normalize)
+        : _offset(), _bbox(), _area(0), _normalized(true) {
+    _initialize(std::vector<Span>(vec), normalize);
 }
 
 // Construct a SpanSet from a std vector by moving
-SpanSet::SpanSet(std::vector<Span>&& vec, bool normalize) : _spanVector(std::move(vec)) {
-    // If the incoming vector is zero, should create an empty SpanSet
-    if (_spanVector.size() == 0) {
-        _bbox = lsst::geom::Box2I();
-        _area = 0;
-    } else {
-        if (normalize) {
-            _runNormalize();
-        }
-        _initialize();
-    }
+SpanSet::SpanSet(std::vector<Span>&& vec, bool normalize)
+        : _offset(), _bbox(), _area(0), _normalized(true) {
+    _initialize(std::move(vec), normalize);
 }
 
-void SpanSet::_runNormalize() {
-    // This bit of code is not safe if the _spanVector is empty. However, this function will only be executed
-    // with a non-empty _spanVector as it is called internally by the class constructors, and cannot be
+SpanSet::SpanSet(std::shared_ptr<std::vector<Span> const> spans, lsst::geom::Extent2I const& offset,
+                 lsst::geom::Box2I const& bbox, std::size_t area, bool normalized)
+        : _spans(std::move(spans)), _offset(offset), _bbox(bbox), _area(area), _normalized(normalized) {}
+
+void SpanSet::_runNormalize(std::vector<Span>& spans) {
+    // This bit of code is not safe if spans is empty. However, this function will only be executed
+    // with a non-empty vector as it is called internally by the class constructors, and cannot be
     // executed from outside the class
 
     // Ensure the span set is sorted according to Span < operator
-    std::sort(_spanVector.begin(), _spanVector.end());
+    std::sort(spans.begin(), spans.end());
 
     // Create a new vector to hold the possibly combined Spans
     std::vector<Span> newSpans;
     // Reserve the size of the original as it is the maximum possible size
-    newSpans.reserve(_spanVector.size());
+    newSpans.reserve(spans.size());
     // push back the first element, as it is certain to be included
-    newSpans.push_back(*_spanVector.begin());
+    newSpans.push_back(*spans.begin());
 
     // With the sorted span array, spans that are contiguous with the end of the last span in the new vector
     // should be combined with the last span in the new vector. Only when there is no longer continuity
     // between spans should a new span be added.
     // Start iteration from "1" as the 0th element is already in the newSpans vector
-    for (auto iter = ++(_spanVector.begin()); iter != _spanVector.end(); ++iter) {
+    for (auto iter = ++(spans.begin()); iter != spans.end(); ++iter) {
         auto& newSpansEnd = newSpans.back();
         if (spansContiguous(newSpansEnd, *iter)) {
             newSpansEnd = Span(newSpansEnd.getY(), std::min(newSpansEnd.getMinX(), iter->getMinX()),
@@ -245,38 +551,54 @@ void SpanSet::_runNormalize() {
         }
     }
 
-    // Set the new normalized vector of spans to the internal span vector container
-    _spanVector = std::move(newSpans);
+    // Replace the spans with the normalized vector of spans
+    spans = std::move(newSpans);
 }
 
-void SpanSet::_initialize() {
-    /* This function exists to handle common functionality for most of the constructors. It  calculates the
-     * bounding box for the SpanSet, and the area covered by the SpanSet
+void SpanSet::_initialize(std::vector<Span>&& spans, bool normalize) {
+    /* This function exists to handle common functionality for most of the constructors. It normalizes
+     * the spans if requested, stores them, and calculates the bounding box for the SpanSet, and the area
+     * covered by the SpanSet
      */
 
-    /* Because the array is sorted, the minimum and maximum values for Y will
+    // Create an empty SpanSet if the incoming vector is empty
+    if (spans.empty()) {
+        _spans = emptySpans();
+        _bbox = lsst::geom::Box2I();
+        _area = 0;
+        return;
+    }
+    if (normalize) {
+        _runNormalize(spans);
+    }
+    _normalized = normalize || spansNormalized(spans);
+
+    /* If the array is sorted, the minimum and maximum values for Y will
        be in the first and last elements, only need to find the min and max X
        values */
 
-    // This bit of code will only be executed with a non-empty _spanVector internally
-    // and is not accessable from outside the class
-
-    int minX = _spanVector[0].getMinX();
-    int maxX = _spanVector[0].getMaxX();
+    int minX = spans[0].getMinX();
+    int maxX = spans[0].getMaxX();
+    int minY = spans.front().getY();
+    int maxY = spans.back().getY();
     _area = 0;
 
-    for (const auto& span : _spanVector) {
+    for (const auto& span : spans) {
         if (span.getMinX() < minX) {
             minX = span.getMinX();
         }
         if (span.getMaxX() > maxX) {
             maxX = span.getMaxX();
         }
+        if (!_normalized) {
+            minY = std::min(minY, span.getY());
+            maxY = std::max(maxY, span.getY());
+        }
         // Plus one, because end point is inclusive
         _area += span.getMaxX() - span.getMinX() + 1;
     }
-    _bbox = lsst::geom::Box2I(lsst::geom::Point2I(minX, _spanVector.front().getY()),
-                              lsst::geom::Point2I(maxX, _spanVector.back().getY()));
+    _bbox = lsst::geom::Box2I(lsst::geom::Point2I(minX, minY), lsst::geom::Point2I(maxX, maxY));
+    _spans = std::make_shared<std::vector<Span> const>(std::move(spans));
 }
 
 // Getter for the area property
@@ -320,40 +642,40 @@ lsst::geom::Box2I SpanSet::getBBox() const { return _bbox; }
 
 void SpanSet::_label(
         Span const& spn, std::vector<std::size_t>& labelVector, std::size_t currentLabel,
-        std::unordered_map<int, std::vector<std::pair<std::size_t, const Span*>>>& sortMap) const {
+        std::unordered_map<int, std::vector<std::pair<std::size_t, Span>>>& sortMap) const {
     auto currentIndex = spn.getY();
     if (currentIndex > 0) {
         // loop over the prevous row
         for (auto const& tup : sortMap[currentIndex - 1]) {
-            if (!labelVector[tup.first] && spansOverlap(spn, *(tup.second), false)) {
+            if (!labelVector[tup.first] && spansOverlap(spn, tup.second, false)) {
                 labelVector[tup.first] = currentLabel;
-                _label(*(tup.second), labelVector, currentLabel, sortMap);
+                _label(tup.second, labelVector, currentLabel, sortMap);
             }
         }
     }
-    if (currentIndex <= _spanVector.back().getY() - 1) {
+    if (currentIndex <= back().getY() - 1) {
         // loop over the next row
         for (auto& tup : sortMap[currentIndex + 1]) {
-            if (!labelVector[tup.first] && spansOverlap(spn, *(tup.second), false)) {
+            if (!labelVector[tup.first] && spansOverlap(spn, tup.second, false)) {
                 labelVector[tup.first] = currentLabel;
-                _label(*(tup.second), labelVector, currentLabel, sortMap);
+                _label(tup.second, labelVector, currentLabel, sortMap);
             }
         }
     }
 }
 
 std::pair<std::vector<std::size_t>, std::size_t> SpanSet::_makeLabels() const {
-    std::vector<std::size_t> labelVector(_spanVector.size(), 0);
+    std::vector<std::size_t> labelVector(size(), 0);
     std::size_t currentLabel = 1;
     std::size_t index = 0;
     // Create a sorted array of arrays
-    std::unordered_map<int, std::vector<std::pair<std::size_t, const Span*>>> sortMap;
+    std::unordered_map<int, std::vector<std::pair<std::size_t, Span>>> sortMap;
     std::size_t tempIndex = 0;
-    for (auto const& spn : _spanVector) {
-        sortMap[spn.getY()].push_back(std::make_pair(tempIndex, &spn));
+    for (auto const& spn : *this) {
+        sortMap[spn.getY()].push_back(std::make_pair(tempIndex, spn));
         tempIndex++;
     }
-    for (auto const& currentSpan : _spanVector) {
+    for (auto const& currentSpan : *this) {
         if (!labelVector[index]) {
             labelVector[index] = currentLabel;
             _label(currentSpan, labelVector, currentLabel, sortMap);
@@ -398,8 +720,9 @@ std::vector<std::shared_ptr<SpanSet>> SpanSet::split() const {
 
     // loop over the current SpanSet's spans sorting each of the spans according to the label
     // that was assigned
-    for (std::size_t i = 0; i < _spanVector.size(); ++i) {
-        subSpanLists[labels[i] - 1].push_back(_spanVector[i]);
+    auto spanIter = begin();
+    for (std::size_t i = 0; i < size(); ++i, ++spanIter) {
+        subSpanLists[labels[i] - 1].push_back(*spanIter);
     }
     // Transform each of the vectors of Spans into a SpanSet
     for (std::size_t i = 0; i < numberOfLabels - 1; ++i) {
@@ -427,21 +750,31 @@ std::shared_ptr<SpanSet> SpanSet::shiftedBy(lsst::geom::Extent2I const& offset)
 }
 
 std::shared_ptr<SpanSet> SpanSet::makeShift(int x, int y) const {
-    // Implementation method common to all overloads of the shiftedBy method
-    std::vector<Span> tempVec;
-    tempVec.reserve(_spanVector.size());
-    for (auto const& spn : _spanVector) {
-        tempVec.emplace_back(spn.getY() + y, spn.getMinX() + x, spn.getMaxX() + x);
+    // Implementation method common to all overloads of the shiftedBy method. The new SpanSet shares
+    // the Spans of this one, and only has a different offset
+    lsst::geom::Extent2I const shift(x, y);
+    lsst::geom::Box2I bbox(_bbox);
+    bbox.shift(shift);
+    return std::shared_ptr<SpanSet>(new SpanSet(_spans, _offset + shift, bbox, _area, _normalized));
+}
+
+std::shared_ptr<SpanSet> SpanSet::_makeNormalized() const {
+    if (_normalized) {
+        return makeShift(0, 0);
     }
-    return std::make_shared<SpanSet>(std::move(tempVec), false);
+    return std::make_shared<SpanSet>(begin(), end());
 }
 
 std::shared_ptr<SpanSet> SpanSet::clippedTo(lsst::geom::Box2I const& box) const {
     /* Return a copy of the current SpanSet but only with values which are contained within
      * the supplied box
      */
+    // Nothing is clipped if the box contains the whole SpanSet
+    if (box.contains(_bbox)) {
+        return makeShift(0, 0);
+    }
     std::vector<Span> tempVec;
-    for (auto const& spn : _spanVector) {
+    for (auto const& spn : *this) {
         if (spn.getY() >= box.getMinY() && spn.getY() <= box.getMaxY() &&
             spansOverlap(spn, Span(spn.getY(), box.getMinX(), box.getMaxX()))) {
             tempVec.emplace_back(spn.getY(), std::max(box.getMinX(), spn.getMinX()),
@@ -454,7 +787,7 @@ std::shared_ptr<SpanSet> SpanSet::clippedTo(lsst::geom::Box2I const& box) const
 bool SpanSet::overlaps(SpanSet const& other) const {
     // Function to check if two SpanSets overlap
     for (auto const& otherSpan : other) {
-        for (auto const& spn : _spanVector) {
+        for (auto const& spn : *this) {
             if (spansOverlap(otherSpan, spn)) {
                 return true;
             }
@@ -471,7 +804,7 @@ bool SpanSet::contains(SpanSet const& other) const {
     // Function to check if a SpanSet is entirely contained within this
     for (auto const& otherSpn : other) {
         std::size_t counter = 0;
-        for (auto const& spn : _spanVector) {
+        for (auto const& spn : *this) {
             // Check that the end points of the span from other are contained in the
             // span from this
             if (spn.contains(lsst::geom::Point2I(otherSpn.getMinX(), otherSpn.getY())) &&
@@ -491,7 +824,7 @@ bool SpanSet::contains(SpanSet const& other) const {
 
 bool SpanSet::contains(lsst::geom::Point2I const& point) const {
     // Check to see if a given point is found within any spans in this
-    for (auto& spn : _spanVector) {
+    for (auto const& spn : *this) {
         if (spn.contains(point)) {
             return true;
         }
@@ -503,7 +836,7 @@ lsst::geom::Point2D SpanSet::computeCentroid() const {
     // Find the centroid of the SpanSet
     std::size_t n = 0;
     double xc = 0, yc = 0;
-    for (auto const& spn : _spanVector) {
+    for (auto const& spn : *this) {
         int const y = spn.getY();
         int const x0 = spn.getMinX();
         int const x1 = spn.getMaxX();
@@ -525,7 +858,7 @@ ellipses::Quadrupole SpanSet::computeShape() const {
     double const yc = cen.getY();
 
     double sumxx = 0, sumxy = 0, sumyy = 0;
-    for (auto const& spn : _spanVector) {
+    for (auto const& spn : *this) {
         int const y = spn.getY();
         int const x0 = spn.getX0();
         int const x1 = spn.getX1();
@@ -542,22 +875,28 @@ ellipses::Quadrupole SpanSet::computeShape() const {
 }
 
 std::shared_ptr<SpanSet> SpanSet::dilated(int r, Stencil s) const {
-    // Return a dilated SpanSet made with the given stencil, by creating a SpanSet
-    // from the stencil and forwarding to the appropriate overloaded method
-    std::shared_ptr<SpanSet> stencilToSpanSet = fromShape(r, s);
-    return dilated(*stencilToSpanSet);
+    if (r < 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          "The radius of a stencil may not be negative: " + std::to_string(r));
+    }
+    // A stencil with r = 0 is a single pixel, which adds nothing
+    if (r == 0 || empty()) {
+        return makeShift(0, 0);
+    }
+    // Return a dilated SpanSet made with the given stencil, one row at a time
+    return stencilMorphology(*this, *fromShape(r, s), true);
 }
 
 std::shared_ptr<SpanSet> SpanSet::dilated(SpanSet const& other) const {
     // Handle a null SpanSet nothing should be dilated
     if (other.size() == 0) {
-        return std::make_shared<SpanSet>(_spanVector.begin(), _spanVector.end(), false);
+        return makeShift(0, 0);
     }
 
     // Return a dilated Spanset by the given SpanSet
     std::vector<Span> tempVec;
 
-    for (auto const& spn : _spanVector) {
+    for (auto const& spn : *this) {
         for (auto const& otherSpn : other) {
             int const xmin = spn.getMinX() + otherSpn.getMinX();
             int const xmax = spn.getMaxX() + otherSpn.getMaxX();
@@ -570,16 +909,22 @@ std::shared_ptr<SpanSet> SpanSet::dilated(SpanSet const& other) const {
 }
 
 std::shared_ptr<SpanSet> SpanSet::eroded(int r, Stencil s) const {
-    // Return an eroded SpanSet made with the given stencil, by creating a SpanSet
-    // from the stencil and forwarding to the appropriate overloaded method
-    std::shared_ptr<SpanSet> stencilToSpanSet = fromShape(r, s);
-    return eroded(*stencilToSpanSet);
+    if (r < 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          "The radius of a stencil may not be negative: " + std::to_string(r));
+    }
+    // A stencil with r = 0 is a single pixel, which takes nothing away
+    if (r == 0 || empty()) {
+        return makeShift(0, 0);
+    }
+    // Return an eroded SpanSet made with the given stencil, one row at a time
+    return stencilMorphology(*this, *fromShape(r, s), false);
 }
 
 std::shared_ptr<SpanSet> SpanSet::eroded(SpanSet const& other) const {
     // Handle a null SpanSet nothing should be eroded
     if (other.size() == 0 || this->size() == 0) {
-        return std::make_shared<SpanSet>(_spanVector.begin(), _spanVector.end(), false);
+        return makeShift(0, 0);
     }
 
     // Return a SpanSet eroded by the given SpanSet
@@ -587,7 +932,7 @@ std::shared_ptr<SpanSet> SpanSet::eroded(SpanSet const& other) const {
 
     // Calculate all possible primary runs.
     std::vector<PrimaryRun> primaryRuns;
-    for (auto const& spn : _spanVector) {
+    for (auto const& spn : *this) {
         int m = 0;
         for (auto const& otherSpn : other) {
             if ((otherSpn.getMaxX() - otherSpn.getMinX()) <= (spn.getMaxX() - spn.getMinX())) {
@@ -600,6 +945,11 @@ std::shared_ptr<SpanSet> SpanSet::eroded(SpanSet const& other) const {
         }
     }
 
+    // If every row of other is wider than every Span, nothing survives the erosion
+    if (primaryRuns.empty()) {
+        return std::make_shared<SpanSet>();
+    }
+
     // Iterate over the primary runs in such a way that we consider all values of m
     // for a given y, then all m for y+1 etc.
     std::sort(primaryRuns.begin(), primaryRuns.end(), comparePrimaryRun);
@@ -676,13 +1026,17 @@ std::shared_ptr<SpanSet> SpanSet::eroded(SpanSet const& other) const {
 }
 
 bool SpanSet::operator==(SpanSet const& other) const {
-    // Check the equivalence of this SpanSet with another
-    return _spanVector == other._spanVector;
+    // Check the equivalence of this SpanSet with another; SpanSets sharing their Spans and offset
+    // are equal without comparing the Spans
+    if (_spans == other._spans && _offset == other._offset) {
+        return true;
+    }
+    return size() == other.size() && std::equal(begin(), end(), other.begin());
 }
 
 bool SpanSet::operator!=(SpanSet const& other) const {
     // Check the equivalence of this SpanSet with another
-    return _spanVector != other._spanVector;
+    return !(*this == other);
 }
 
 std::shared_ptr<SpanSet> SpanSet::fromShape(int r, Stencil s, lsst::geom::Point2I offset) {
@@ -724,117 +1078,173 @@ std::shared_ptr<SpanSet> SpanSet::intersect(SpanSet const& other) const {
     }
     // Handel intersecting a SpanSet with itself
     if (other == *this) {
-        return std::make_shared<SpanSet>(this->_spanVector);
+        return makeShift(0, 0);
     }
-    std::vector<Span> tempVec;
-    auto otherIter = other.begin();
-    for (auto const& spn : _spanVector) {
-        while (otherIter != other.end() && otherIter->getY() <= spn.getY()) {
-            if (spansOverlap(spn, *otherIter)) {
-                auto newMin = std::max(spn.getMinX(), otherIter->getMinX());
-                auto newMax = std::min(spn.getMaxX(), otherIter->getMaxX());
-                auto newSpan = Span(spn.getY(), newMin, newMax);
-                tempVec.push_back(newSpan);
-            }
-            ++otherIter;
-        }
+    if (!_normalized || !other._normalized) {
+        return _makeNormalized()->intersect(*other._makeNormalized());
     }
-    return std::make_shared<SpanSet>(std::move(tempVec));
+    std::vector<Span> tempVec;
+    intersectSpans(begin(), end(), other.begin(), other.end(), tempVec);
+    return std::make_shared<SpanSet>(std::move(tempVec), false);
 }
 
 std::shared_ptr<SpanSet> SpanSet::intersectNot(SpanSet const& other) const {
     // Check if the bounding boxes overlap, if not simply return a copy of this
     if (!getBBox().overlaps(other.getBBox())) {
-        return std::make_shared<SpanSet>(this->begin(), this->end());
+        return makeShift(0, 0);
     }
     // Handle calling a SpanSet's intersectNot with itself as an argument
     if (other == *this) {
         return std::make_shared<SpanSet>();
     }
-    /* This function must find all the areas in this and not in other. These SpanSets
-     * may be overlapping with this less than other a1|    b1|   a2|    b2|,
-     * with this greater than other b1|    a1|     b2|    a2|,
-     * with this containing other a1|    b1|     b2|     a2|,
-     * or with other containing this  b1|    a1|    a2|   b2|
-     */
+    if (!_normalized || !other._normalized) {
+        return _makeNormalized()->intersectNot(*other._makeNormalized());
+    }
     std::vector<Span> tempVec;
-    auto otherIter = other.begin();
-    for (auto const& spn : _spanVector) {
-        bool added = false;
-        bool spanStarted = false;
-        int spanBottom = 0;
-        while (otherIter != other.end() && otherIter->getY() <= spn.getY()) {
-            if (spansOverlap(spn, *otherIter)) {
-                added = true;
-                /* To handle one span containing the other, the spans will be added
-                 * piecewise, and let the SpanSet constructor normalize spans which
-                 * end up contiguous. In the case where this is contained in other,
-                 * these statements will all be false, and nothing will be added,
-                 * which is the expected behavior.
-                 *
-                 * Intersection with the logical not of another SpanSet requires that the Intersection
-                 * be tested against the condition that multiple Spans may be present in the other
-                 * SpanSet at the same Y coordinate. I.E. If one row in *this would contain two
-                 * disconnected Spans in other, the result should be three new Spans.
-                 */
-                // Check if a span is in the process of being created
-                if (!spanStarted) {
-                    // If the minimum value of the Span in  *this is less than that of other, add a new Span
-                    if (spn.getMinX() < otherIter->getMinX()) {
-                        tempVec.emplace_back(spn.getY(), spn.getMinX(), otherIter->getMinX() - 1);
-                    }
-                    // Conversely if the maximum value of the Span in *this is greater than that of other,
-                    // Start a new span, and record what the minimum value of that span should be. This is
-                    // because SpanSets can be disconnected, and the function must check if there are any
-                    // additional Spans which fall in the same row
-                    if (spn.getMaxX() > otherIter->getMaxX()) {
-                        spanStarted = true;
-                        spanBottom = otherIter->getMaxX() + 1;
-                    }
-                } else {
-                    // A span is in the process of being created and should be finished and added
-                    tempVec.emplace_back(spn.getY(), spanBottom, std::min(spn.getMaxX(), otherIter->getMinX() - 1));
-                    spanStarted = false;
-                    // Check if the span in *this extends past that of the Span from other, if so
-                    // begin a new Span
-                    if (spn.getMaxX() > otherIter->getMaxX()) {
-                        spanStarted = true;
-                        spanBottom = otherIter->getMaxX() + 1;
-                    }
-                }
-            }
-            if (otherIter->getMaxX() > spn.getMaxX()) {
-                break;
-            }
-            ++otherIter;
+    tempVec.reserve(size());
+    intersectNotSpans(begin(), end(), other.begin(), other.end(), tempVec);
+    return std::make_shared<SpanSet>(std::move(tempVec), false);
+}
+
+std::shared_ptr<SpanSet> SpanSet::union_(SpanSet const& other) const {
+    // The union with a null SpanSet is the other SpanSet
+    if (other.empty()) {
+        return makeShift(0, 0);
+    }
+    if (empty()) {
+        return other.makeShift(0, 0);
+    }
+    if (!_normalized || !other._normalized) {
+        return _makeNormalized()->union_(*other._makeNormalized());
+    }
+    std::vector<Span> tempVec;
+    tempVec.reserve(size() + other.size());
+    unionSpans(begin(), end(), other.begin(), other.end(), tempVec);
+    return std::make_shared<SpanSet>(std::move(tempVec), false);
+}
+
+std::shared_ptr<SpanSet> SpanSet::unionAll(std::vector<std::shared_ptr<SpanSet>> const& spanSets) {
+    // The SpanSets are merged, which requires their Spans to be normalized
+    auto const notNormalized = [](std::shared_ptr<SpanSet> const& spanSet) { return !spanSet->_normalized; };
+    if (std::any_of(spanSets.begin(), spanSets.end(), notNormalized)) {
+        std::vector<std::shared_ptr<SpanSet>> normalized;
+        normalized.reserve(spanSets.size());
+        for (auto const& spanSet : spanSets) {
+            normalized.push_back(spanSet->_makeNormalized());
         }
-        // Check if a span has been started but not finished, if that is the case that means there are
-        // no further spans on this row to consider and the span should be closed and added
-        if (spanStarted) {
-            tempVec.emplace_back(spn.getY(), spanBottom, spn.getMaxX());
+        return unionAll(normalized);
+    }
+    // Cursors into the SpanSets with Spans left to merge, kept in a heap with the smallest Span on top
+    using Cursor = std::pair<const_iterator, const_iterator>;
+    auto const later = [](Cursor const& a, Cursor const& b) { return *(b.first) < *(a.first); };
+    std::vector<Cursor> cursors;
+    cursors.reserve(spanSets.size());
+    std::size_t totalSize = 0;
+    for (auto const& spanSet : spanSets) {
+        if (!spanSet->empty()) {
+            cursors.emplace_back(spanSet->begin(), spanSet->end());
+            totalSize += spanSet->size();
         }
-        /* If added is still zero, that means it did not overlap any of the spans in other
-         * and should be included in the new span
-         */
-        if (!added) {
-            tempVec.emplace_back(spn);
+    }
+    if (cursors.empty()) {
+        return std::make_shared<SpanSet>();
+    }
+    std::make_heap(cursors.begin(), cursors.end(), later);
+
+    std::vector<Span> tempVec;
+    tempVec.reserve(totalSize);
+    while (!cursors.empty()) {
+        std::pop_heap(cursors.begin(), cursors.end(), later);
+        auto& cursor = cursors.back();
+        appendSpan(tempVec, *(cursor.first));
+        if (++cursor.first == cursor.second) {
+            cursors.pop_back();
+        } else {
+            std::push_heap(cursors.begin(), cursors.end(), later);
         }
     }
-    return std::make_shared<SpanSet>(std::move(tempVec));
+    return std::make_shared<SpanSet>(std::move(tempVec), false);
 }
 
-std::shared_ptr<SpanSet> SpanSet::union_(SpanSet const& other) const {
-    /* Simply include Spans from both SpanSets in a new vector and let the SpanSet
-     * constructor normalize any of the SpanSets which may be contiguous
-     */
-    std::size_t combineSize = size() + other.size();
+std::shared_ptr<SpanSet> SpanSet::intersectAll(std::vector<std::shared_ptr<SpanSet>> const& spanSets) {
+    if (spanSets.empty()) {
+        return std::make_shared<SpanSet>();
+    }
+    // Only rows in the bounding boxes of all the SpanSets can be in the result
+    lsst::geom::Box2I bbox = spanSets.front()->getBBox();
+    for (auto const& spanSet : spanSets) {
+        bbox.clip(spanSet->getBBox());
+    }
+    if (bbox.isEmpty()) {
+        return std::make_shared<SpanSet>();
+    }
+    if (spanSets.size() == 1) {
+        return spanSets.front()->makeShift(0, 0);
+    }
+    // The SpanSets are merged, which requires their Spans to be normalized
+    auto const notNormalized = [](std::shared_ptr<SpanSet> const& spanSet) { return !spanSet->_normalized; };
+    if (std::any_of(spanSets.begin(), spanSets.end(), notNormalized)) {
+        std::vector<std::shared_ptr<SpanSet>> normalized;
+        normalized.reserve(spanSets.size());
+        for (auto const& spanSet : spanSets) {
+            normalized.push_back(spanSet->_makeNormalized());
+        }
+        return intersectAll(normalized);
+    }
+
+    // Cursors into the SpanSets, which move forward one row present in all of them at a time
+    using Cursor = std::pair<const_iterator, const_iterator>;
+    std::vector<Cursor> cursors;
+    cursors.reserve(spanSets.size());
+    for (auto const& spanSet : spanSets) {
+        cursors.emplace_back(spanSet->begin(), spanSet->end());
+    }
+    auto const belowRow = [](Span const& spn, int y) { return spn.getY() < y; };
+    auto const rowEnd = [](Cursor const& cursor) {
+        int const y = cursor.first->getY();
+        auto iter = cursor.first;
+        while (iter != cursor.second && iter->getY() == y) {
+            ++iter;
+        }
+        return iter;
+    };
+
     std::vector<Span> tempVec;
-    tempVec.reserve(combineSize);
-    // Copy this
-    tempVec.insert(tempVec.end(), _spanVector.begin(), _spanVector.end());
-    // Copy other
-    tempVec.insert(tempVec.end(), other.begin(), other.end());
-    return std::make_shared<SpanSet>(std::move(tempVec));
+    std::vector<Span> row;
+    std::vector<Span> newRow;
+    int y = bbox.getMinY();
+    while (y <= bbox.getMaxY()) {
+        // Move each cursor to the first row at or after y, skipping the rows missing from any SpanSet
+        int nextY = y;
+        for (auto& cursor : cursors) {
+            cursor.first = std::lower_bound(cursor.first, cursor.second, y, belowRow);
+            if (cursor.first == cursor.second) {
+                nextY = bbox.getMaxY() + 1;
+                break;
+            }
+            nextY = std::max(nextY, cursor.first->getY());
+        }
+        if (nextY != y) {
+            y = nextY;
+            continue;
+        }
+        // Every SpanSet has Spans in row y; intersect them, stopping if nothing is left
+        auto cursorEnd = rowEnd(cursors.front());
+        row.assign(cursors.front().first, cursorEnd);
+        cursors.front().first = cursorEnd;
+        for (auto cursor = cursors.begin() + 1; cursor != cursors.end(); ++cursor) {
+            cursorEnd = rowEnd(*cursor);
+            if (!row.empty()) {
+                newRow.clear();
+                intersectSpans(row.begin(), row.end(), cursor->first, cursorEnd, newRow);
+                std::swap(row, newRow);
+            }
+            cursor->first = cursorEnd;
+        }
+        tempVec.insert(tempVec.end(), row.begin(), row.end());
+        ++y;
+    }
+    return std::make_shared<SpanSet>(std::move(tempVec), false);
 }
 
 std::shared_ptr<SpanSet> SpanSet::transformedBy(lsst::geom::LinearTransform const& t) const {
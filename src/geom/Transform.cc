@@ -106,6 +106,36 @@ typename FromEndpoint::Array Transform<FromEndpoint, ToEndpoint>::applyInverse(
     return _fromEndpoint.arrayFromData(rawToData);
 }
 
+namespace {
+
+void checkRawData(ndarray::Array<double const, 2, 2> const &from, ndarray::Array<double, 2, 2> const &to,
+                  int nFromAxes, int nToAxes) {
+    if (from.getSize<0>() != static_cast<std::size_t>(nFromAxes) ||
+        to.getSize<0>() != static_cast<std::size_t>(nToAxes) || from.getSize<1>() != to.getSize<1>()) {
+        std::ostringstream os;
+        os << "Arrays of shape (" << from.getSize<0>() << ", " << from.getSize<1>() << ") and ("
+           << to.getSize<0>() << ", " << to.getSize<1>() << ") do not match transform from " << nFromAxes
+           << " to " << nToAxes << " axes";
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, os.str());
+    }
+}
+
+}  // namespace
+
+template <class FromEndpoint, class ToEndpoint>
+void Transform<FromEndpoint, ToEndpoint>::applyForwardData(ndarray::Array<double const, 2, 2> const &from,
+                                                           ndarray::Array<double, 2, 2> const &to) const {
+    checkRawData(from, to, _fromEndpoint.getNAxes(), _toEndpoint.getNAxes());
+    _mapping->applyForward(from, to);
+}
+
+template <class FromEndpoint, class ToEndpoint>
+void Transform<FromEndpoint, ToEndpoint>::applyInverseData(ndarray::Array<double const, 2, 2> const &from,
+                                                           ndarray::Array<double, 2, 2> const &to) const {
+    checkRawData(from, to, _toEndpoint.getNAxes(), _fromEndpoint.getNAxes());
+    _mapping->applyInverse(from, to);
+}
+
 template <class FromEndpoint, class ToEndpoint>
 std::shared_ptr<Transform<ToEndpoint, FromEndpoint>> Transform<FromEndpoint, ToEndpoint>::inverted() const {
     auto inverse = std::dynamic_pointer_cast<ast::Mapping>(_mapping->inverted());
@@ -25,7 +25,9 @@
 /*
  * Background estimation class code
  */
+#include <algorithm>
 #include <limits>
+#include <memory>
 #include <vector>
 #include <cmath>
 #include "lsst/afw/image/MaskedImage.h"
@@ -33,6 +35,7 @@
 #include "lsst/afw/math/Approximate.h"
 #include "lsst/afw/math/Background.h"
 #include "lsst/afw/math/Statistics.h"
+#include "lsst/afw/math/detail/Parallel.h"
 
 namespace lsst {
 namespace ex = pex::exceptions;
@@ -74,8 +77,81 @@ void cullNan(std::vector<double> const& values, std::vector<double> const& refs,
         }
     }
 }
+
+// Build the interpolant in x for row iY of the image from the interpolated grid columns
+std::shared_ptr<Interpolate> makeRowInterpolate(std::vector<double> const& xcen,
+                                                std::vector<std::vector<double>> const& gridColumns,
+                                                int const iY, Interpolate::Style const interpStyle,
+                                                UndersampleStyle const undersampleStyle) {
+    int const nxSample = xcen.size();
+
+    // N.b. There's no API to set defaultValue to other than NaN (due to issues with persistence
+    // that I don't feel like fixing;  #2825).  If we want to address this, this is the place
+    // to start, but note that NaN is treated specially -- it means, "Interpolate" so to allow
+    // us to put a NaN into the outputs some changes will be needed
+    double defaultValue = std::numeric_limits<double>::quiet_NaN();
+
+    std::vector<double> bg_x(nxSample);
+    for (int iX = 0; iX < nxSample; iX++) {
+        bg_x[iX] = static_cast<double>(gridColumns[iX][iY]);
+    }
+    std::vector<double> xcenTmp, bgTmp;
+    cullNan(xcen, bg_x, xcenTmp, bgTmp, defaultValue);
+
+    try {
+        return makeInterpolate(xcenTmp, bgTmp, interpStyle);
+    } catch (pex::exceptions::OutOfRangeError& e) {
+        switch (undersampleStyle) {
+            case THROW_EXCEPTION:
+                LSST_EXCEPT_ADD(e, str(boost::format("Interpolating in y (iY = %d)") % iY));
+                throw;
+            case REDUCE_INTERP_ORDER: {
+                if (bgTmp.empty()) {
+                    xcenTmp.push_back(0);
+                    bgTmp.push_back(defaultValue);
+
+                    return makeInterpolate(xcenTmp, bgTmp, Interpolate::CONSTANT);
+                } else {
+                    return makeInterpolate(xcenTmp, bgTmp, lookupMaxInterpStyle(bgTmp.size()));
+                }
+            }
+            case INCREASE_NXNYSAMPLE:
+                LSST_EXCEPT_ADD(
+                        e, "The BackgroundControl UndersampleStyle INCREASE_NXNYSAMPLE is not supported.");
+                throw;
+            default:
+                LSST_EXCEPT_ADD(e, str(boost::format("The selected BackgroundControl "
+                                                     "UndersampleStyle %d is not defined.") %
+                                       undersampleStyle));
+                throw;
+        }
+    } catch (ex::Exception& e) {
+        LSST_EXCEPT_ADD(e, str(boost::format("Interpolating in y (iY = %d)") % iY));
+        throw;
+    }
+}
+
+// Are two sets of pixel values the same?  NaNs compare equal to each other.
+template <typename T>
+bool sameValues(std::vector<T> const& a, std::vector<T> const& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](T lhs, T rhs) { return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs)); });
+}
 }  // namespace
 
+/*
+ * The parts of getImage() that don't depend on the requested bbox, cached so that repeated calls are
+ * cheap.  The grid columns live in _gridColumns; here we keep the styles they were computed for, the
+ * statsImage values they were computed from (so that we notice changes made by operator+= or through
+ * getStatsImage()), and the interpolant in x for each row of the image, built when first needed.
+ */
+struct BackgroundMI::InterpolationPlan {
+    Interpolate::Style interpStyle;
+    UndersampleStyle undersampleStyle;
+    std::vector<InternalPixelT> statsValues;
+    std::vector<std::shared_ptr<Interpolate>> rows;
+};
+
 template <typename ImageT>
 BackgroundMI::BackgroundMI(ImageT const& img, BackgroundControl const& bgCtrl)
         : Background(img, bgCtrl), _statsImage(image::MaskedImage<InternalPixelT>()) {
@@ -89,20 +165,32 @@ BackgroundMI::BackgroundMI(ImageT const& img, BackgroundControl const& bgCtrl)
     image::MaskedImage<InternalPixelT>::Image& im = *_statsImage.getImage();
     image::MaskedImage<InternalPixelT>::Variance& var = *_statsImage.getVariance();
 
+    // The cells are independent, so they may be processed in parallel; each writes only its own pixel
+    // of _statsImage.  Cells are numbered column by column, as in the serial loop.  The subimages share
+    // the reference count of img's pixels, which isn't thread-safe, so they are all made here.
+    std::vector<ImageT> subimages;
+    subimages.reserve(nxSample * nySample);
     for (int iX = 0; iX < nxSample; ++iX) {
         for (int iY = 0; iY < nySample; ++iY) {
-            ImageT subimg = ImageT(img,
+            subimages.emplace_back(img,
                                    lsst::geom::Box2I(lsst::geom::Point2I(_xorig[iX], _yorig[iY]),
                                                      lsst::geom::Extent2I(_xsize[iX], _ysize[iY])),
                                    image::LOCAL);
-
-            std::pair<double, double> res = makeStatistics(subimg, bgCtrl.getStatisticsProperty() | ERRORS,
-                                                           *bgCtrl.getStatisticsControl())
-                                                    .getResult();
+        }
+    }
+    auto processCells = [&](int begin, int end, int) {
+        for (int iCell = begin; iCell != end; ++iCell) {
+            int const iX = iCell / nySample;
+            int const iY = iCell % nySample;
+            std::pair<double, double> res =
+                    makeStatistics(subimages[iCell], bgCtrl.getStatisticsProperty() | ERRORS,
+                                   *bgCtrl.getStatisticsControl())
+                            .getResult();
             im(iX, iY) = res.first;
             var(iX, iY) = res.second;
         }
-    }
+    };
+    detail::parallelForBands(nxSample * nySample, bgCtrl.getNumThreads(), processCells);
 }
 BackgroundMI::BackgroundMI(lsst::geom::Box2I const imageBBox,
                            image::MaskedImage<InternalPixelT> const& statsImage)
@@ -176,6 +264,38 @@ BackgroundMI& BackgroundMI::operator-=(float const delta) {
     return *this;
 }
 
+BackgroundMI::InterpolationPlan& BackgroundMI::_getInterpolationPlan(
+        Interpolate::Style const interpStyle, UndersampleStyle const undersampleStyle) const {
+    image::MaskedImage<InternalPixelT>::Image const& im = *_statsImage.getImage();
+    std::vector<InternalPixelT> statsValues(im.begin(), im.end());
+
+    if (_plan && _plan->interpStyle == interpStyle && _plan->undersampleStyle == undersampleStyle &&
+        sameValues(_plan->statsValues, statsValues)) {
+        return *_plan;
+    }
+    _plan.reset();  // _gridColumns are about to be invalidated
+
+    int const height = _imgBBox.getHeight();
+    std::vector<int> ypix(height);
+    for (int iY = 0; iY < height; ++iY) {
+        ypix[iY] = iY;
+    }
+
+    _gridColumns.resize(_statsImage.getWidth());
+    for (int iX = 0; iX < _statsImage.getWidth(); ++iX) {
+        _setGridColumns(interpStyle, undersampleStyle, iX, ypix);
+    }
+
+    auto plan = std::make_shared<InterpolationPlan>();
+    plan->interpStyle = interpStyle;
+    plan->undersampleStyle = undersampleStyle;
+    plan->statsValues = std::move(statsValues);
+    plan->rows.resize(height);
+    _plan = plan;
+
+    return *_plan;
+}
+
 template <typename PixelT>
 std::shared_ptr<image::Image<PixelT>> BackgroundMI::doGetImage(
         lsst::geom::Box2I const& bbox,
@@ -252,21 +372,9 @@ std::shared_ptr<image::Image<PixelT>> BackgroundMI::doGetImage(
     }
 
     // =============================================================
-    // --> We'll store nxSample fully-interpolated columns to interpolate the rows over
-    // make a vector containing the y pixel coords for the column
-    int const width = _imgBBox.getWidth();
-    int const height = _imgBBox.getHeight();
-    auto const bboxOff = bbox.getMin() - _imgBBox.getMin();
-
-    std::vector<int> ypix(height);
-    for (int iY = 0; iY < height; ++iY) {
-        ypix[iY] = iY;
-    }
-
-    _gridColumns.resize(width);
-    for (int iX = 0; iX < nxSample; ++iX) {
-        _setGridColumns(interpStyle, undersampleStyle, iX, ypix);
-    }
+    // --> We'll store nxSample fully-interpolated columns to interpolate the rows over; these, and the
+    // interpolants for the rows, are cached between calls
+    InterpolationPlan& plan = _getInterpolationPlan(interpStyle, undersampleStyle);
 
     // create a shared_ptr to put the background image in and return to caller
     // start with xy0 = 0 and set final xy0 later
@@ -274,63 +382,25 @@ std::shared_ptr<image::Image<PixelT>> BackgroundMI::doGetImage(
             std::shared_ptr<image::Image<PixelT>>(new image::Image<PixelT>(bbox.getDimensions()));
 
     // go through row by row
-    // - interpolate on the gridcolumns that were pre-computed by the constructor
+    // - interpolate on the gridcolumns that were pre-computed by _getInterpolationPlan
     // - copy the values to an ImageT to return to the caller.
-    std::vector<double> xcenTmp, bgTmp;
-
-    // N.b. There's no API to set defaultValue to other than NaN (due to issues with persistence
-    // that I don't feel like fixing;  #2825).  If we want to address this, this is the place
-    // to start, but note that NaN is treated specially -- it means, "Interpolate" so to allow
-    // us to put a NaN into the outputs some changes will be needed
-    double defaultValue = std::numeric_limits<double>::quiet_NaN();
+    auto const bboxOff = bbox.getMin() - _imgBBox.getMin();
+    std::vector<double> xpix(bbox.getWidth());
+    for (int x = 0; x < bbox.getWidth(); ++x) {
+        xpix[x] = bboxOff.getX() + x;
+    }
+    std::vector<double> bgRow(bbox.getWidth());
 
     for (int y = 0, iY = bboxOff.getY(); y < bbox.getHeight(); ++y, ++iY) {
-        // build an interp object for this row
-        std::vector<double> bg_x(nxSample);
-        for (int iX = 0; iX < nxSample; iX++) {
-            bg_x[iX] = static_cast<double>(_gridColumns[iX][iY]);
-        }
-        cullNan(_xcen, bg_x, xcenTmp, bgTmp, defaultValue);
-
-        std::shared_ptr<Interpolate> intobj;
-        try {
-            intobj = makeInterpolate(xcenTmp, bgTmp, interpStyle);
-        } catch (pex::exceptions::OutOfRangeError& e) {
-            switch (undersampleStyle) {
-                case THROW_EXCEPTION:
-                    LSST_EXCEPT_ADD(e, str(boost::format("Interpolating in y (iY = %d)") % iY));
-                    throw;
-                case REDUCE_INTERP_ORDER: {
-                    if (bgTmp.empty()) {
-                        xcenTmp.push_back(0);
-                        bgTmp.push_back(defaultValue);
-
-                        intobj = makeInterpolate(xcenTmp, bgTmp, Interpolate::CONSTANT);
-                        break;
-                    } else {
-                        intobj = makeInterpolate(xcenTmp, bgTmp, lookupMaxInterpStyle(bgTmp.size()));
-                    }
-                } break;
-                case INCREASE_NXNYSAMPLE:
-                    LSST_EXCEPT_ADD(
-                            e,
-                            "The BackgroundControl UndersampleStyle INCREASE_NXNYSAMPLE is not supported.");
-                    throw;
-                default:
-                    LSST_EXCEPT_ADD(e, str(boost::format("The selected BackgroundControl "
-                                                         "UndersampleStyle %d is not defined.") %
-                                           undersampleStyle));
-                    throw;
-            }
-        } catch (ex::Exception& e) {
-            LSST_EXCEPT_ADD(e, str(boost::format("Interpolating in y (iY = %d)") % iY));
-            throw;
+        std::shared_ptr<Interpolate>& intobj = plan.rows[iY];
+        if (!intobj) {
+            intobj = makeRowInterpolate(_xcen, _gridColumns, iY, interpStyle, undersampleStyle);
         }
 
         // fill the image with interpolated values
-        for (int iX = bboxOff.getX(), x = 0; x < bbox.getWidth(); ++iX, ++x) {
-            (*bg)(x, y) = static_cast<PixelT>(intobj->interpolate(iX));
-        }
+        intobj->interpolateSorted(xpix.data(), bgRow.data(), bgRow.size());
+        std::transform(bgRow.begin(), bgRow.end(), bg->row_begin(y),
+                       [](double val) { return static_cast<PixelT>(val); });
     }
     bg->setXY0(bbox.getMin());
 
@@ -174,6 +174,7 @@ class InterpolateGsl : public Interpolate {
 public:
     ~InterpolateGsl() override;
     double interpolate(double const x) const override;
+    void interpolateSorted(double const *x, double *out, std::size_t n) const override;
 
 private:
     InterpolateGsl(std::vector<double> const &x, std::vector<double> const &y,
@@ -253,6 +254,24 @@ double InterpolateGsl::interpolate(double const xInterp) const {
     return ::gsl_interp_eval(_interp, &_x[0], &_y[0], xInterp, _acc);
 }
 
+void InterpolateGsl::interpolateSorted(double const *x, double *out, std::size_t n) const {
+    // The points are sorted, so only those at the ends can need extrapolating, and the accelerator
+    // finds each interior point's interval in (amortised) constant time
+    std::size_t const begin = std::lower_bound(x, x + n, _x.front()) - x;
+    std::size_t const end = std::upper_bound(x + begin, x + n, _x.back()) - x;
+    for (std::size_t i = 0; i < begin; ++i) {
+        out[i] = interpolate(x[i]);
+    }
+    double const *xa = &_x[0];
+    double const *ya = &_y[0];
+    for (std::size_t i = begin; i < end; ++i) {
+        out[i] = ::gsl_interp_eval(_interp, xa, ya, x[i], _acc);
+    }
+    for (std::size_t i = end; i < n; ++i) {
+        out[i] = interpolate(x[i]);
+    }
+}
+
 Interpolate::Style stringToInterpStyle(std::string const &style) {
     static std::map<std::string, Interpolate::Style> gslInterpTypeStrings;
     if (gslInterpTypeStrings.empty()) {
@@ -300,6 +319,12 @@ std::vector<double> Interpolate::interpolate(std::vector<double> const &x) const
     return out;
 }
 
+void Interpolate::interpolateSorted(double const *x, double *out, std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = interpolate(x[i]);
+    }
+}
+
 ndarray::Array<double, 1> Interpolate::interpolate(ndarray::Array<double const, 1> const &x) const {
     int const num = x.getShape()[0];
     ndarray::Array<double, 1> out = ndarray::allocate(ndarray::makeVector(num));
@@ -26,13 +26,19 @@
  * Provide functions to stack images
  *
  */
+#include <algorithm>
 #include <vector>
 #include <cassert>
+#include <cmath>
+#include <limits>
 #include <memory>
 
 #include "lsst/pex/exceptions.h"
+#include "lsst/afw/image/ExposureFitsReader.h"
 #include "lsst/afw/math/Stack.h"
 #include "lsst/afw/math/MaskedVector.h"
+#include "lsst/afw/math/detail/Parallel.h"
+#include "lsst/afw/math/detail/PixelStack.h"
 #include "lsst/log/Log.h"
 
 namespace pexExcept = lsst::pex::exceptions;
@@ -46,6 +52,8 @@ namespace afw {
 namespace math {
 
 namespace {
+double const NaN = std::numeric_limits<double>::quiet_NaN();
+
 using WeightVector = std::vector<WeightPixel>;  // vector of weights (yes, really)
                                                 /**
                                                  * @internal A bit counter (to make sure that only one type of statistics has been requested)
@@ -107,6 +115,48 @@ void checkImageSizes(ImageT const &out, std::vector<std::shared_ptr<ImageT>> con
  *
  * ************************************************************************** */
 
+/**
+ * @internal Compute the mask of one output pixel of a MaskedImage stack
+ *
+ * @param orMask  the OR of the masks of the pixels used (Statistics::getOrMask)
+ * @param nPoint  number of pixels used
+ * @param nClipped  number of pixels clipped
+ * @param nMasked  number of pixels rejected
+ * @param sctrl  control for the statistics
+ * @param clipped  mask to set if any pixel was clipped
+ * @param maskMap  mask to set if any input pixel with the given mask bits was rejected
+ * @param hasMaskBits  callable returning true if any input pixel has any of the given mask bits set
+ */
+template <typename HasMaskBitsT>
+image::MaskPixel computeStackMask(image::MaskPixel orMask, int nPoint, int nClipped, int nMasked,
+                                  StatisticsControl const &sctrl, image::MaskPixel const clipped,
+                                  std::vector<std::pair<image::MaskPixel, image::MaskPixel>> const &maskMap,
+                                  HasMaskBitsT const &hasMaskBits) {
+    image::MaskPixel msk(orMask);
+    if (nPoint == 0) {
+        msk = sctrl.getNoGoodPixelsMask();
+    } else if (nPoint == 1) {
+        /*
+         * you should be using sctrl.setCalcErrorFromInputVariance(true) if you want to avoid
+         * getting a variance of NaN when you only have one input
+         */
+    }
+    // Check to see if any pixels were rejected due to clipping
+    if (nClipped > 0) {
+        msk |= clipped;
+    }
+    // Check to see if any pixels were rejected by masking, and apply
+    // any associated masks to the result.
+    if (nMasked > 0) {
+        for (auto const &pair : maskMap) {
+            if (hasMaskBits(pair.first)) {
+                msk |= pair.second;
+            }
+        }
+    }
+    return msk;
+}
+
 //@{
 /**
  * @internal A function to handle MaskedImage stacking
@@ -115,6 +165,9 @@ void checkImageSizes(ImageT const &out, std::vector<std::shared_ptr<ImageT>> con
  *   to handle cases when we are, or are not, weighting
  *
  * Additionally, we may or may not want to weight based on the variance -- another template boolean
+ *
+ * The statistics that detail::PixelStack supports are computed from a transposed copy of each row of
+ * the inputs; anything else goes through a MaskedVector and makeStatistics one pixel at a time.
  */
 template <typename PixelT, bool isWeighted, bool useVariance>
 void computeMaskedImageStack(image::MaskedImage<PixelT> &imgStack,
@@ -122,86 +175,107 @@ void computeMaskedImageStack(image::MaskedImage<PixelT> &imgStack,
                              Property flags, StatisticsControl const &sctrl, image::MaskPixel const clipped,
                              std::vector<std::pair<image::MaskPixel, image::MaskPixel>> const &maskMap,
                              WeightVector const &wvector = WeightVector()) {
-    // get a list of row_begin iterators
     using x_iterator = typename image::MaskedImage<PixelT>::x_iterator;
-    std::vector<x_iterator> rows;
-    rows.reserve(images.size());
+    using OutPixel = typename image::MaskedImage<PixelT>::Pixel;
 
-    MaskedVector<PixelT> pixelSet(images.size());  // a pixel from x,y for each image
-    WeightVector weights;                          // weights; non-const version
-    //
     StatisticsControl sctrlTmp(sctrl);
-
+    if (isWeighted) {
+        sctrlTmp.setWeighted(true);
+    }
     if (useVariance) {  // weight using the variance image
         assert(isWeighted);
         assert(wvector.empty());
-
-        weights.resize(images.size());
-
-        sctrlTmp.setWeighted(true);
-    } else if (isWeighted) {
-        weights.assign(wvector.begin(), wvector.end());
-
-        sctrlTmp.setWeighted(true);
     }
-    assert(weights.empty() || weights.size() == images.size());
-
-    // loop over x,y ... the loop over the stack to fill pixelSet
-    // - get the stats on pixelSet and put the value in the output image at x,y
-    for (int y = 0; y != imgStack.getHeight(); ++y) {
-        for (unsigned int i = 0; i < images.size(); ++i) {
-            x_iterator ptr = images[i]->row_begin(y);
-            if (y == 0) {
-                rows.push_back(ptr);
-            } else {
-                rows[i] = ptr;
+    Property const eflags = static_cast<Property>(flags | NPOINT | ERRORS | NCLIPPED | NMASKED);
+    int const nImages = images.size();
+
+    // Stack using a transposed copy of each row of the inputs
+    auto stackRowsTransposed = [&](int yBegin, int yEnd, int) {
+        detail::PixelStack<PixelT> pixelStack(imgStack.getWidth(), nImages, flags, sctrlTmp, useVariance,
+                                              isWeighted ? wvector : WeightVector());
+
+        for (int y = yBegin; y != yEnd; ++y) {
+            pixelStack.loadRow(images, y);
+
+            x_iterator ptr = imgStack.row_begin(y);
+            for (int x = 0; x != imgStack.getWidth(); ++x, ++ptr) {
+                auto const stat = pixelStack.compute(x);
+                image::MaskPixel const *masks = pixelStack.getMasks(x);
+
+                PixelT variance = ::pow(stat.error, 2);
+                image::MaskPixel const msk = computeStackMask(
+                        stat.orMask, stat.nPoint, stat.nClipped, stat.nMasked, sctrlTmp, clipped, maskMap,
+                        [masks, nImages](image::MaskPixel bits) {
+                            return std::any_of(masks, masks + nImages,
+                                               [bits](image::MaskPixel m) { return (m & bits) != 0; });
+                        });
+
+                *ptr = OutPixel(stat.value, msk, variance);
             }
         }
-
-        for (x_iterator ptr = imgStack.row_begin(y), end = imgStack.row_end(y); ptr != end; ++ptr) {
-            typename MaskedVector<PixelT>::iterator psPtr = pixelSet.begin();
-            WeightVector::iterator wtPtr = weights.begin();
-            for (unsigned int i = 0; i < images.size(); ++rows[i], ++i, ++psPtr, ++wtPtr) {
-                *psPtr = *rows[i];
-                if (useVariance) {  // we're weighting using the variance
-                    *wtPtr = 1.0 / rows[i].variance();
-                }
+    };
+
+    // Stack one pixel at a time, using a MaskedVector and makeStatistics
+    auto stackRows = [&](int yBegin, int yEnd, int) {
+        // get a list of row_begin iterators
+        std::vector<x_iterator> rows;
+        rows.reserve(images.size());
+
+        MaskedVector<PixelT> pixelSet(images.size());  // a pixel from x,y for each image
+        WeightVector weights;                          // weights; non-const version
+        if (useVariance) {
+            weights.resize(images.size());
+        } else if (isWeighted) {
+            weights.assign(wvector.begin(), wvector.end());
+        }
+        assert(weights.empty() || weights.size() == images.size());
+
+        // loop over x,y ... the loop over the stack to fill pixelSet
+        // - get the stats on pixelSet and put the value in the output image at x,y
+        for (int y = yBegin; y != yEnd; ++y) {
+            rows.clear();
+            for (unsigned int i = 0; i < images.size(); ++i) {
+                rows.push_back(images[i]->row_begin(y));
             }
 
-            Property const eflags = static_cast<Property>(flags | NPOINT | ERRORS | NCLIPPED | NMASKED);
-            Statistics stat = isWeighted ? makeStatistics(pixelSet, weights, eflags, sctrlTmp)
-                                         : makeStatistics(pixelSet, eflags, sctrlTmp);
-
-            PixelT variance = ::pow(stat.getError(flags), 2);
-            image::MaskPixel msk(stat.getOrMask());
-            int const npoint = stat.getValue(NPOINT);
-            if (npoint == 0) {
-                msk = sctrlTmp.getNoGoodPixelsMask();
-            } else if (npoint == 1) {
-                /*
-                 * you should be using sctrl.setCalcErrorFromInputVariance(true) if you want to avoid
-                 * getting a variance of NaN when you only have one input
-                 */
-            }
-            // Check to see if any pixels were rejected due to clipping
-            if (stat.getValue(NCLIPPED) > 0) {
-                msk |= clipped;
-            }
-            // Check to see if any pixels were rejected by masking, and apply
-            // any associated masks to the result.
-            if (stat.getValue(NMASKED) > 0) {
-                for (auto const &pair : maskMap) {
-                    for (auto pp = pixelSet.begin(); pp != pixelSet.end(); ++pp) {
-                        if ((*pp).mask() & pair.first) {
-                            msk |= pair.second;
-                            break;
-                        }
+            for (x_iterator ptr = imgStack.row_begin(y), end = imgStack.row_end(y); ptr != end; ++ptr) {
+                typename MaskedVector<PixelT>::iterator psPtr = pixelSet.begin();
+                WeightVector::iterator wtPtr = weights.begin();
+                for (unsigned int i = 0; i < images.size(); ++rows[i], ++i, ++psPtr, ++wtPtr) {
+                    *psPtr = *rows[i];
+                    if (useVariance) {  // we're weighting using the variance
+                        *wtPtr = 1.0 / rows[i].variance();
                     }
                 }
-            }
 
-            *ptr = typename image::MaskedImage<PixelT>::Pixel(stat.getValue(flags), msk, variance);
+                Statistics stat = isWeighted ? makeStatistics(pixelSet, weights, eflags, sctrlTmp)
+                                             : makeStatistics(pixelSet, eflags, sctrlTmp);
+
+                PixelT variance = ::pow(stat.getError(flags), 2);
+                image::MaskPixel const msk = computeStackMask(
+                        stat.getOrMask(), stat.getValue(NPOINT), stat.getValue(NCLIPPED),
+                        stat.getValue(NMASKED), sctrlTmp, clipped, maskMap,
+                        [&pixelSet](image::MaskPixel bits) {
+                            for (auto pp = pixelSet.begin(); pp != pixelSet.end(); ++pp) {
+                                if ((*pp).mask() & bits) {
+                                    return true;
+                                }
+                            }
+                            return false;
+                        });
+
+                *ptr = OutPixel(stat.getValue(flags), msk, variance);
+            }
         }
+    };
+
+    // Each output pixel depends only on the input pixels at the same position, so the output is
+    // split into bands of rows which are processed independently (possibly in parallel); every
+    // band has its own scratch space, so the result is identical to processing the rows in order.
+    if (detail::PixelStack<PixelT>::isSupported(flags, sctrlTmp)) {
+        detail::parallelForBands(imgStack.getHeight(), sctrl.getNumThreads(), stackRowsTransposed);
+    } else {
+        detail::parallelForBands(imgStack.getHeight(), sctrl.getNumThreads(), stackRows);
     }
 }
 template <typename PixelT, bool isWeighted, bool useVariance>
@@ -295,6 +369,212 @@ void statisticsStack(image::MaskedImage<PixelT> &out,
     }
 }
 
+/* ************************************************************************** *
+ *
+ * out-of-core MaskedImage stacks
+ *
+ * ************************************************************************** */
+
+template <typename PixelT>
+void statisticsStack(image::MaskedImage<PixelT> &out,
+                     std::vector<std::shared_ptr<image::ExposureFitsReader>> const &readers, Property flags,
+                     StatisticsControl const &sctrl, WeightVector const &wvector, image::MaskPixel clipped,
+                     std::vector<std::pair<image::MaskPixel, image::MaskPixel>> const &maskMap,
+                     int stripHeight) {
+    checkObjectsAndWeights(readers, wvector);
+    checkOnlyOneFlag(flags);
+    if (stripHeight <= 0) {
+        throw LSST_EXCEPT(pexExcept::InvalidParameterError,
+                          str(boost::format("stripHeight must be positive, not %d") % stripHeight));
+    }
+
+    // Check that every input covers the output before reading any pixels
+    lsst::geom::Box2I const bbox = out.getBBox(image::PARENT);
+    for (unsigned int i = 0; i < readers.size(); ++i) {
+        lsst::geom::Box2I const inputBBox = readers[i]->readBBox(image::PARENT);
+        if (!inputBBox.contains(bbox)) {
+            throw LSST_EXCEPT(pexExcept::LengthError,
+                              (boost::format("Image %d (%s) does not contain the output bounding box %s") %
+                               i % inputBBox % bbox)
+                                      .str());
+        }
+    }
+
+    // Read, stack and discard one strip of rows of all the inputs at a time
+    std::vector<std::shared_ptr<image::MaskedImage<PixelT>>> strips(readers.size());
+    for (int y0 = bbox.getMinY(); y0 <= bbox.getMaxY(); y0 += stripHeight) {
+        lsst::geom::Box2I const stripBBox(
+                lsst::geom::Point2I(bbox.getMinX(), y0),
+                lsst::geom::Point2I(bbox.getMaxX(), std::min(y0 + stripHeight - 1, bbox.getMaxY())));
+        for (unsigned int i = 0; i < readers.size(); ++i) {
+            strips[i] = std::make_shared<image::MaskedImage<PixelT>>(
+                    readers[i]->readMaskedImage<PixelT>(stripBBox, image::PARENT));
+        }
+        image::MaskedImage<PixelT> outStrip(out, stripBBox, image::PARENT);
+        statisticsStack(outStrip, strips, flags, sctrl, wvector, clipped, maskMap);
+    }
+}
+
+template <typename PixelT>
+StackAccumulator<PixelT>::StackAccumulator(
+        lsst::geom::Box2I const &bbox, Property flags, StatisticsControl const &sctrl,
+        std::vector<std::pair<image::MaskPixel, image::MaskPixel>> const &maskMap)
+        : _bbox(bbox), _sctrl(sctrl), _maskMap(maskMap) {
+    if ((flags & ~ERRORS) != MEAN) {
+        throw LSST_EXCEPT(pexExcept::InvalidParameterError,
+                          "StackAccumulator can only compute a MEAN; "
+                          "use statisticsStack a strip at a time for other statistics");
+    }
+    // A threshold >= 1 can never be exceeded, so only bits with smaller thresholds need tracking
+    for (int bit = 0; bit < static_cast<int>(8 * sizeof(image::MaskPixel)); ++bit) {
+        double const threshold = sctrl.getMaskPropagationThreshold(bit);
+        if (threshold < 1.0) {
+            _propagatedBits.push_back(bit);
+            _propagationThresholds.push_back(threshold);
+        }
+    }
+
+    std::size_t const nPix = static_cast<std::size_t>(bbox.getWidth()) * bbox.getHeight();
+    _sumw.assign(nPix, 0.0);
+    _sumw2.assign(nPix, 0.0);
+    _mean.assign(nPix, 0.0);
+    _m2.assign(nPix, 0.0);
+    _sumvw2.assign(_sctrl.getCalcErrorFromInputVariance() ? nPix : 0, 0.0);
+    _nUsed.assign(nPix, 0);
+    _nInput.assign(nPix, 0);
+    _orMask.assign(nPix, 0x0);
+    _allMask.assign(nPix, 0x0);
+    _rejectedWeights.assign(_propagatedBits.size(), std::vector<double>(nPix, 0.0));
+}
+
+template <typename PixelT>
+void StackAccumulator<PixelT>::add(image::MaskedImage<PixelT> const &image) {
+    _add(image, _sctrl.getWeighted(), 1.0);
+}
+
+template <typename PixelT>
+void StackAccumulator<PixelT>::add(image::MaskedImage<PixelT> const &image, image::VariancePixel weight) {
+    if (!_sctrl.getWeighted()) {
+        LOGL_WARN(_log,
+                  "Weights passed on to StackAccumulator are ignored as sctrl.getWeighted() is False."
+                  "Set sctrl.setWeighted(True) for them to be used.");
+        weight = 1.0;
+    }
+    _add(image, false, weight);
+}
+
+template <typename PixelT>
+void StackAccumulator<PixelT>::_add(image::MaskedImage<PixelT> const &image, bool weightByVariance,
+                                    image::VariancePixel weight) {
+    lsst::geom::Box2I const imageBBox = image.getBBox(image::PARENT);
+    if (!_bbox.contains(imageBBox)) {
+        throw LSST_EXCEPT(pexExcept::LengthError,
+                          (boost::format("Image bounding box %s is not within the stack's %s") % imageBBox %
+                           _bbox)
+                                  .str());
+    }
+
+    int const andMask = _sctrl.getAndMask();
+    bool const nanSafe = _sctrl.getNanSafe();
+    bool const isWeighted = _sctrl.getWeighted();
+    bool const calcErrorFromInputVariance = _sctrl.getCalcErrorFromInputVariance();
+    int const nBits = _propagatedBits.size();
+
+    // Rows of the stack are independent, so they may be updated in parallel
+    auto addRows = [&](int yBegin, int yEnd, int) {
+        for (int y = yBegin; y != yEnd; ++y) {
+            std::size_t index = static_cast<std::size_t>(imageBBox.getMinY() - _bbox.getMinY() + y) *
+                                        _bbox.getWidth() +
+                                (imageBBox.getMinX() - _bbox.getMinX());
+            auto imPtr = image.getImage()->row_begin(y);
+            auto mskPtr = image.getMask()->row_begin(y);
+            auto varPtr = image.getVariance()->row_begin(y);
+            for (int x = 0; x != image.getWidth(); ++x, ++index, ++imPtr, ++mskPtr, ++varPtr) {
+                image::MaskPixel const msk = *mskPtr;
+                double const var = *varPtr;
+                // weights are single precision, as they are in statisticsStack
+                double const w = weightByVariance ? static_cast<WeightPixel>(1.0 / var) : weight;
+
+                ++_nInput[index];
+                _allMask[index] |= msk;
+                if ((!nanSafe || std::isfinite(static_cast<float>(*imPtr))) && !(msk & andMask)) {
+                    double const value = *imPtr;
+                    // West (1979)'s weighted update of the mean and the sum of squared deviations
+                    _sumw[index] += w;
+                    _sumw2[index] += w * w;
+                    double const delta = value - _mean[index];
+                    if (_sumw[index] != 0) {
+                        _mean[index] += delta * w / _sumw[index];
+                    }
+                    _m2[index] += w * delta * (value - _mean[index]);
+                    if (calcErrorFromInputVariance) {
+                        _sumvw2[index] += isWeighted ? var * w * w : var;
+                    }
+                    _orMask[index] |= msk;
+                    ++_nUsed[index];
+                } else {
+                    for (int i = 0; i < nBits; ++i) {
+                        if (msk & (1 << _propagatedBits[i])) {
+                            _rejectedWeights[i][index] += w;
+                        }
+                    }
+                }
+            }
+        }
+    };
+    detail::parallelForBands(image.getHeight(), _sctrl.getNumThreads(), addRows);
+}
+
+template <typename PixelT>
+std::shared_ptr<image::MaskedImage<PixelT>> StackAccumulator<PixelT>::getResult() const {
+    auto out = std::make_shared<image::MaskedImage<PixelT>>(_bbox);
+    int const nBits = _propagatedBits.size();
+
+    std::size_t index = 0;
+    for (int y = 0; y != out->getHeight(); ++y) {
+        for (auto ptr = out->row_begin(y), end = out->row_end(y); ptr != end; ++ptr, ++index) {
+            int const n = _nUsed[index];
+            double const sumw = _sumw[index];
+            double const sumw2 = _sumw2[index];
+
+            // N.b. as in Statistics, if sumw == 0 or sumw*sumw == sumw2 (e.g. n == 1) we'll get NaNs
+            double const mean = (n > 0 && sumw != 0) ? _mean[index] : NaN;
+            double variance = _m2[index] / sumw;              // biased estimator
+            variance *= sumw * sumw / (sumw * sumw - sumw2);  // debias
+            double const meanVar = _sctrl.getCalcErrorFromInputVariance()
+                                           ? _sumvw2[index] / (sumw * sumw)
+                                           : variance * sumw2 / (sumw * sumw);
+
+            image::MaskPixel orMask = _orMask[index];
+            for (int i = 0; i < nBits; ++i) {
+                double const rejected = _rejectedWeights[i][index];
+                if (rejected / (sumw + rejected) > _propagationThresholds[i]) {
+                    orMask |= (1 << _propagatedBits[i]);
+                }
+            }
+            image::MaskPixel const allMask = _allMask[index];
+            image::MaskPixel const msk = computeStackMask(
+                    orMask, n, 0, _nInput[index] - n, _sctrl, 0x0, _maskMap,
+                    [allMask](image::MaskPixel bits) { return (allMask & bits) != 0; });
+
+            *ptr = typename image::MaskedImage<PixelT>::Pixel(mean, msk, meanVar);
+        }
+    }
+    return out;
+}
+
+template <typename PixelT>
+std::shared_ptr<image::Image<double>> StackAccumulator<PixelT>::getWeightSum() const {
+    auto out = std::make_shared<image::Image<double>>(_bbox);
+    std::size_t index = 0;
+    for (int y = 0; y != out->getHeight(); ++y) {
+        for (auto ptr = out->row_begin(y), end = out->row_end(y); ptr != end; ++ptr, ++index) {
+            *ptr = _sumw[index];
+        }
+    }
+    return out;
+}
+
 namespace {
 /* ************************************************************************** *
  *
@@ -315,30 +595,31 @@ template <typename PixelT, bool isWeighted>
 void computeImageStack(image::Image<PixelT> &imgStack,
                        std::vector<std::shared_ptr<image::Image<PixelT>>> &images, Property flags,
                        StatisticsControl const &sctrl, WeightVector const &weights = WeightVector()) {
-    MaskedVector<PixelT> pixelSet(images.size());  // a pixel from x,y for each image
     StatisticsControl sctrlTmp(sctrl);
 
-    // set the mask to be an infinite iterator
-    MaskImposter<image::MaskPixel> msk;
-
     if (!weights.empty()) {
         sctrlTmp.setWeighted(true);
     }
 
-    // get the desired statistic
-    for (int y = 0; y != imgStack.getHeight(); ++y) {
-        for (int x = 0; x != imgStack.getWidth(); ++x) {
-            for (unsigned int i = 0; i != images.size(); ++i) {
-                (*pixelSet.getImage())(i, 0) = (*images[i])(x, y);
-            }
+    // get the desired statistic, processing independent bands of rows (possibly in parallel)
+    auto stackRows = [&](int yBegin, int yEnd, int) {
+        MaskedVector<PixelT> pixelSet(images.size());  // a pixel from x,y for each image
 
-            if (isWeighted) {
-                imgStack(x, y) = makeStatistics(pixelSet, weights, flags, sctrlTmp).getValue();
-            } else {
-                imgStack(x, y) = makeStatistics(pixelSet, weights, flags, sctrlTmp).getValue();
+        for (int y = yBegin; y != yEnd; ++y) {
+            for (int x = 0; x != imgStack.getWidth(); ++x) {
+                for (unsigned int i = 0; i != images.size(); ++i) {
+                    (*pixelSet.getImage())(i, 0) = (*images[i])(x, y);
+                }
+
+                if (isWeighted) {
+                    imgStack(x, y) = makeStatistics(pixelSet, weights, flags, sctrlTmp).getValue();
+                } else {
+                    imgStack(x, y) = makeStatistics(pixelSet, weights, flags, sctrlTmp).getValue();
+                }
             }
         }
-    }
+    };
+    detail::parallelForBands(imgStack.getHeight(), sctrl.getNumThreads(), stackRows);
 }
 
 }  // end anonymous namespace
@@ -563,7 +844,12 @@ std::shared_ptr<image::MaskedImage<PixelT>> statisticsStack(image::MaskedImage<P
                                                                        StatisticsControl const &sctrl);      \
     template std::shared_ptr<image::MaskedImage<TYPE>> statisticsStack(                                      \
             image::MaskedImage<TYPE> const &image, Property flags, char dimension,                           \
-            StatisticsControl const &sctrl);
+            StatisticsControl const &sctrl);                                                                 \
+    template void statisticsStack<TYPE>(                                                                     \
+            image::MaskedImage<TYPE> & out, std::vector<std::shared_ptr<image::ExposureFitsReader>> const &, \
+            Property flags, StatisticsControl const &sctrl, WeightVector const &wvector, image::MaskPixel,   \
+            std::vector<std::pair<image::MaskPixel, image::MaskPixel>> const &, int);                        \
+    template class StackAccumulator<TYPE>;
 
 INSTANTIATE_STACKS(double)
 INSTANTIATE_STACKS(float)
@@ -36,6 +36,8 @@
 #include "lsst/pex/exceptions.h"
 #include "lsst/afw/image/Image.h"
 #include "lsst/afw/math/Statistics.h"
+#include "lsst/afw/math/detail/Quantiles.h"
+#include "lsst/afw/math/detail/StatisticsKernels.h"
 #include "lsst/geom/Angle.h"
 
 using namespace std;
@@ -139,6 +141,128 @@ inline double varianceError(double const variance, int const n) {
 /// @internal return type for processPixels
 using StandardReturn = std::tuple<int, double, Statistics::Value, Statistics::Value, double, double, image::MaskPixel>;
 
+/**
+ * @internal Convert the sums accumulated by processPixels into a StandardReturn
+ *
+ * @param useWeights  were the sums weighted?  If not, sumw and sumw2 are ignored
+ * @param rejectedWeightsByBit  the summed weight of the rejected pixels with each mask bit set;
+ *                              ignored if maskPropagationThresholds is empty
+ * @param meanCrude  the value that was subtracted from each pixel before summing
+ *
+ * The other parameters are the sums named in processPixels.
+ */
+StandardReturn finishStandard(bool const useWeights, int const n, double sumw, double sumw2, double sumx,
+                              double const sumx2, double const sumvw2, double min, double max,
+                              image::MaskPixel allPixelOrMask, std::vector<double> &rejectedWeightsByBit,
+                              double const meanCrude, bool const calcErrorFromInputVariance,
+                              std::vector<double> const &maskPropagationThresholds) {
+    if (n == 0) {
+        min = NaN;
+        max = NaN;
+    }
+
+    // estimate of population mean and variance.
+    double mean, variance;
+    if (!useWeights) {
+        sumw = sumw2 = n;
+    }
+
+    for (int bit = 0, nBits = maskPropagationThresholds.size(); bit < nBits; ++bit) {
+        double hypotheticalTotalWeight = sumw + rejectedWeightsByBit[bit];
+        rejectedWeightsByBit[bit] /= hypotheticalTotalWeight;
+        if (rejectedWeightsByBit[bit] > maskPropagationThresholds[bit]) {
+            allPixelOrMask |= (1 << bit);
+        }
+    }
+
+    // N.b. if sumw == 0 or sumw*sumw == sumw2 (e.g. n == 1) we'll get NaNs
+    // N.b. the estimator of the variance assumes that the sample points all have the same variance;
+    // otherwise, what is it that we're estimating?
+    mean = sumx / sumw;
+    variance = sumx2 / sumw - ::pow(mean, 2);         // biased estimator
+    variance *= sumw * sumw / (sumw * sumw - sumw2);  // debias
+
+    double meanVar;  // (standard error of mean)^2
+    if (calcErrorFromInputVariance) {
+        meanVar = sumvw2 / (sumw * sumw);
+    } else {
+        meanVar = variance * sumw2 / (sumw * sumw);
+    }
+
+    double varVar = varianceError(variance, n);  // error in variance; incorrect if useWeights is true
+
+    sumx += sumw * meanCrude;
+    mean += meanCrude;
+
+    return StandardReturn(n, sumx, Statistics::Value(mean, meanVar), Statistics::Value(variance, varVar), min,
+                          max, allPixelOrMask);
+}
+
+/// @internal Return a pointer to the start of a row of an image
+///
+/// This uses the image's row iterator rather than getArray(), which would copy the array (and its
+/// reference count, which isn't thread-safe) for every row.
+template <typename PixelT>
+PixelT const *getRowPointer(image::ImageBase<PixelT> const &img, int const y) {
+    return &(*img.row_begin(y));
+}
+
+/// @internal Return a pointer to the start of a row of an imposter (nullptr, as it has no pixels)
+template <typename PixelT>
+PixelT const *getRowPointer(MaskImposter<PixelT> const &, int const) {
+    return nullptr;
+}
+
+/// @internal Is this a MaskImposter that pretends that every pixel has a non-zero value?
+template <typename MaskT>
+bool isNonZeroImposter(MaskT const &) {
+    return false;
+}
+
+template <typename PixelT>
+bool isNonZeroImposter(MaskImposter<PixelT> const &msk) {
+    return *msk.row_begin(0) != 0;
+}
+
+/**
+ * @internal Accumulate the unweighted sums for processPixels using detail::accumulatePixels
+ *
+ * @returns false if the image types aren't supported by the kernels; sums is then untouched, and the
+ *          caller must do the work itself
+ *
+ * This general version handles no types at all.
+ */
+template <typename IsFinite, typename InClipRange, typename ImageT, typename MaskT, typename VarianceT>
+bool accumulateWithKernels(ImageT const &, MaskT const &, VarianceT const &, int const, double const,
+                           double const, int const, bool const, detail::PixelSums &, detail::SimdLevel) {
+    return false;
+}
+
+/**
+ * @internal Accumulate the unweighted sums for processPixels using detail::accumulatePixels
+ *
+ * The kernels need contiguous rows, so this version handles floating-point Images with a Mask (or no
+ * mask) and a variance Image (or no variance).
+ */
+template <typename IsFinite, typename InClipRange, typename PixelT, typename MaskT, typename VarianceT>
+typename enable_if<is_floating_point<PixelT>::value, bool>::type accumulateWithKernels(
+        image::Image<PixelT> const &img, MaskT const &msk, VarianceT const &var, int const stride,
+        double const center, double const cliplimit, int const andMask,
+        bool const calcErrorFromInputVariance, detail::PixelSums &sums, detail::SimdLevel const simdLevel) {
+    if (isNonZeroImposter(msk)) {
+        return false;  // not worth a special case
+    }
+    bool const checkFinite = is_same<IsFinite, CheckFinite>::value;
+    bool const doClip = is_same<InClipRange, CheckClipRange>::value;
+    for (int iY = 0; iY < img.getHeight(); iY += stride) {
+        detail::accumulatePixels(getRowPointer(img, iY), getRowPointer(msk, iY),
+                                 calcErrorFromInputVariance ? getRowPointer(var, iY) : nullptr,
+                                 img.getWidth(), center, cliplimit, andMask, checkFinite, doClip, sums,
+                                 simdLevel);
+    }
+    return true;
+}
+
 /*
  * Functions which convert the booleans into calls to the proper templated types, one type per
  * recursion level
@@ -151,6 +275,9 @@ using StandardReturn = std::tuple<int, double, Statistics::Value, Statistics::Va
  * user requests a test (eg check for NaNs), the function is instantiated with the appropriate functor.
  * Otherwise, an 'AlwaysTrue' or 'AlwaysFalse' object is passed in.  The compiler then compiles-out
  * a test which is always false, or removes the conditional for a test which is always true.
+ *
+ * N.b. detail::PixelStack (used by statisticsStack) repeats this calculation on contiguous data;
+ * keep the two in step.
  */
 template <typename IsFinite, typename HasValueLtMin, typename HasValueGtMax, typename InClipRange,
           bool useWeights, typename ImageT, typename MaskT, typename VarianceT, typename WeightT>
@@ -159,7 +286,8 @@ StandardReturn processPixels(ImageT const &img, MaskT const &msk, VarianceT cons
                              double const meanCrude, double const cliplimit,
                              bool const weightsAreMultiplicative, int const andMask,
                              bool const calcErrorFromInputVariance,
-                             std::vector<double> const &maskPropagationThresholds) {
+                             std::vector<double> const &maskPropagationThresholds,
+                             detail::SimdLevel const simdLevel) {
     int n = 0;
     double sumw = 0.0;   // sum(weight)  (N.b. weight will be 1.0 if !useWeights)
     double sumw2 = 0.0;  // sum(weight^2)
@@ -175,6 +303,23 @@ StandardReturn processPixels(ImageT const &img, MaskT const &msk, VarianceT cons
 
     std::vector<double> rejectedWeightsByBit(maskPropagationThresholds.size(), 0.0);
 
+    // The common unweighted case, with no mask propagation, can use the vectorised kernels
+    if (!useWeights && maskPropagationThresholds.empty()) {
+        detail::PixelSums sums;
+        if (accumulateWithKernels<IsFinite, InClipRange>(img, msk, var, stride, meanCrude, cliplimit, andMask,
+                                                         calcErrorFromInputVariance, sums, simdLevel)) {
+            if (HasValueLtMin()(sums.min, min)) {
+                min = sums.min;
+            }
+            if (HasValueGtMax()(sums.max, max)) {
+                max = sums.max;
+            }
+            return finishStandard(useWeights, sums.n, sumw, sumw2, sums.sumx, sums.sumx2, sums.sumv, min, max,
+                                  sums.orMask, rejectedWeightsByBit, meanCrude, calcErrorFromInputVariance,
+                                  maskPropagationThresholds);
+        }
+    }
+
     for (int iY = 0; iY < img.getHeight(); iY += stride) {
         typename MaskT::x_iterator mptr = msk.row_begin(iY);
         typename VarianceT::x_iterator vptr = var.row_begin(iY);
@@ -246,46 +391,9 @@ StandardReturn processPixels(ImageT const &img, MaskT const &msk, VarianceT cons
             }
         }
     }
-    if (n == 0) {
-        min = NaN;
-        max = NaN;
-    }
-
-    // estimate of population mean and variance.
-    double mean, variance;
-    if (!useWeights) {
-        sumw = sumw2 = n;
-    }
-
-    for (int bit = 0, nBits = maskPropagationThresholds.size(); bit < nBits; ++bit) {
-        double hypotheticalTotalWeight = sumw + rejectedWeightsByBit[bit];
-        rejectedWeightsByBit[bit] /= hypotheticalTotalWeight;
-        if (rejectedWeightsByBit[bit] > maskPropagationThresholds[bit]) {
-            allPixelOrMask |= (1 << bit);
-        }
-    }
-
-    // N.b. if sumw == 0 or sumw*sumw == sumw2 (e.g. n == 1) we'll get NaNs
-    // N.b. the estimator of the variance assumes that the sample points all have the same variance;
-    // otherwise, what is it that we're estimating?
-    mean = sumx / sumw;
-    variance = sumx2 / sumw - ::pow(mean, 2);         // biased estimator
-    variance *= sumw * sumw / (sumw * sumw - sumw2);  // debias
-
-    double meanVar;  // (standard error of mean)^2
-    if (calcErrorFromInputVariance) {
-        meanVar = sumvw2 / (sumw * sumw);
-    } else {
-        meanVar = variance * sumw2 / (sumw * sumw);
-    }
-
-    double varVar = varianceError(variance, n);  // error in variance; incorrect if useWeights is true
-
-    sumx += sumw * meanCrude;
-    mean += meanCrude;
-
-    return StandardReturn(n, sumx, Statistics::Value(mean, meanVar), Statistics::Value(variance, varVar), min,
-                          max, allPixelOrMask);
+    return finishStandard(useWeights, n, sumw, sumw2, sumx, sumx2, sumvw2, min, max, allPixelOrMask,
+                          rejectedWeightsByBit, meanCrude, calcErrorFromInputVariance,
+                          maskPropagationThresholds);
 }
 
 template <typename IsFinite, typename HasValueLtMin, typename HasValueGtMax, typename InClipRange,
@@ -295,15 +403,16 @@ StandardReturn processPixels(ImageT const &img, MaskT const &msk, VarianceT cons
                              double const meanCrude, double const cliplimit,
                              bool const weightsAreMultiplicative, int const andMask,
                              bool const calcErrorFromInputVariance, bool doGetWeighted,
-                             std::vector<double> const &maskPropagationThresholds) {
+                             std::vector<double> const &maskPropagationThresholds,
+                             detail::SimdLevel const simdLevel) {
     if (doGetWeighted) {
         return processPixels<IsFinite, HasValueLtMin, HasValueGtMax, InClipRange, true>(
                 img, msk, var, weights, flags, nCrude, 1, meanCrude, cliplimit, weightsAreMultiplicative,
-                andMask, calcErrorFromInputVariance, maskPropagationThresholds);
+                andMask, calcErrorFromInputVariance, maskPropagationThresholds, simdLevel);
     } else {
         return processPixels<IsFinite, HasValueLtMin, HasValueGtMax, InClipRange, false>(
                 img, msk, var, weights, flags, nCrude, 1, meanCrude, cliplimit, weightsAreMultiplicative,
-                andMask, calcErrorFromInputVariance, maskPropagationThresholds);
+                andMask, calcErrorFromInputVariance, maskPropagationThresholds, simdLevel);
     }
 }
 
@@ -314,15 +423,18 @@ StandardReturn processPixels(ImageT const &img, MaskT const &msk, VarianceT cons
                              double const meanCrude, double const cliplimit,
                              bool const weightsAreMultiplicative, int const andMask,
                              bool const calcErrorFromInputVariance, bool doCheckFinite, bool doGetWeighted,
-                             std::vector<double> const &maskPropagationThresholds) {
+                             std::vector<double> const &maskPropagationThresholds,
+                             detail::SimdLevel const simdLevel) {
     if (doCheckFinite) {
         return processPixels<CheckFinite, HasValueLtMin, HasValueGtMax, InClipRange, useWeights>(
                 img, msk, var, weights, flags, nCrude, 1, meanCrude, cliplimit, weightsAreMultiplicative,
-                andMask, calcErrorFromInputVariance, doGetWeighted, maskPropagationThresholds);
+                andMask, calcErrorFromInputVariance, doGetWeighted, maskPropagationThresholds,
+                simdLevel);
     } else {
         return processPixels<AlwaysTrue, HasValueLtMin, HasValueGtMax, InClipRange, useWeights>(
                 img, msk, var, weights, flags, nCrude, 1, meanCrude, cliplimit, weightsAreMultiplicative,
-                andMask, calcErrorFromInputVariance, doGetWeighted, maskPropagationThresholds);
+                andMask, calcErrorFromInputVariance, doGetWeighted, maskPropagationThresholds,
+                simdLevel);
     }
 }
 
@@ -340,6 +452,7 @@ StandardReturn processPixels(ImageT const &img, MaskT const &msk, VarianceT cons
  * @param doCheckFinite check for NaN/Inf
  * @param doGetWeighted use the weights
  * @param maskPropagationThresholds
+ * @param simdLevel the accumulator kernels to use, for the cases they handle
  *
  * @note An overloaded version below is used to get clipped versions
  */
@@ -347,7 +460,8 @@ template <typename ImageT, typename MaskT, typename VarianceT, typename WeightT>
 StandardReturn getStandard(ImageT const &img, MaskT const &msk, VarianceT const &var, WeightT const &weights,
                            int const flags, bool const weightsAreMultiplicative, int const andMask,
                            bool const calcErrorFromInputVariance, bool doCheckFinite, bool doGetWeighted,
-                           std::vector<double> const &maskPropagationThresholds) {
+                           std::vector<double> const &maskPropagationThresholds,
+                           detail::SimdLevel const simdLevel) {
     // =====================================================
     // a crude estimate of the mean, used for numerical stability of variance
     int nCrude = 0;
@@ -366,7 +480,7 @@ StandardReturn getStandard(ImageT const &img, MaskT const &msk, VarianceT const
     StandardReturn values = processPixels<ChkFin, AlwaysF, AlwaysF, AlwaysT, true>(
             img, msk, var, weights, flags, nCrude, strideCrude, meanCrude, cliplimit,
             weightsAreMultiplicative, andMask, calcErrorFromInputVariance, doCheckFinite, doGetWeighted,
-            maskPropagationThresholds);
+            maskPropagationThresholds, simdLevel);
     nCrude = std::get<0>(values);
     double sumCrude = std::get<1>(values);
 
@@ -382,11 +496,13 @@ StandardReturn getStandard(ImageT const &img, MaskT const &msk, VarianceT const
     if (flags & (MIN | MAX)) {
         return processPixels<ChkFin, ChkMin, ChkMax, AlwaysT, true>(
                 img, msk, var, weights, flags, nCrude, 1, meanCrude, cliplimit, weightsAreMultiplicative,
-                andMask, calcErrorFromInputVariance, true, doGetWeighted, maskPropagationThresholds);
+                andMask, calcErrorFromInputVariance, true, doGetWeighted, maskPropagationThresholds,
+                simdLevel);
     } else {
         return processPixels<ChkFin, AlwaysF, AlwaysF, AlwaysT, true>(
                 img, msk, var, weights, flags, nCrude, 1, meanCrude, cliplimit, weightsAreMultiplicative,
-                andMask, calcErrorFromInputVariance, doCheckFinite, doGetWeighted, maskPropagationThresholds);
+                andMask, calcErrorFromInputVariance, doCheckFinite, doGetWeighted, maskPropagationThresholds,
+                simdLevel);
     }
 }
 
@@ -407,6 +523,7 @@ StandardReturn getStandard(ImageT const &img, MaskT const &msk, VarianceT const
  *   @param doCheckFinite check for NaN/Inf
  *   @param doGetWeighted use the weights,
  *   @param maskPropagationThresholds
+ *   @param simdLevel the accumulator kernels to use, for the cases they handle
  */
 template <typename ImageT, typename MaskT, typename VarianceT, typename WeightT>
 StandardReturn getStandard(ImageT const &img, MaskT const &msk, VarianceT const &var, WeightT const &weights,
@@ -414,7 +531,8 @@ StandardReturn getStandard(ImageT const &img, MaskT const &msk, VarianceT const
 
                            bool const weightsAreMultiplicative, int const andMask,
                            bool const calcErrorFromInputVariance, bool doCheckFinite, bool doGetWeighted,
-                           std::vector<double> const &maskPropagationThresholds) {
+                           std::vector<double> const &maskPropagationThresholds,
+                           detail::SimdLevel const simdLevel) {
     double const center = clipinfo.first;
     double const cliplimit = clipinfo.second;
 
@@ -431,287 +549,95 @@ StandardReturn getStandard(ImageT const &img, MaskT const &msk, VarianceT const
     if (flags & (MIN | MAX)) {
         return processPixels<ChkFin, ChkMin, ChkMax, ChkClip, true>(
                 img, msk, var, weights, flags, nCrude, stride, center, cliplimit, weightsAreMultiplicative,
-                andMask, calcErrorFromInputVariance, true, doGetWeighted, maskPropagationThresholds);
+                andMask, calcErrorFromInputVariance, true, doGetWeighted, maskPropagationThresholds,
+                simdLevel);
     } else {  // fast loop ... just the mean & variance
         return processPixels<ChkFin, AlwaysF, AlwaysF, ChkClip, true>(
                 img, msk, var, weights, flags, nCrude, stride, center, cliplimit, weightsAreMultiplicative,
-                andMask, calcErrorFromInputVariance, doCheckFinite, doGetWeighted, maskPropagationThresholds);
+                andMask, calcErrorFromInputVariance, doCheckFinite, doGetWeighted, maskPropagationThresholds,
+                simdLevel);
     }
 }
 
+using MedianQuartileReturn = detail::MedianAndQuartiles;
+
 /**
- * @internal A wrapper using the nth_element() built-in to compute percentiles for an image
- *
- * @param img       an afw::Image
- * @param fraction the desired percentile.
+ * @internal Call func(value) for each pixel that isn't masked (and, for IsFinite == ChkFin, is finite)
  *
- * Specialisation for non-integral types (where ties are not a problem)
+ * Because it loops over the pixels, it's been templated over the NaN test to avoid
+ * code repetition of the loops.
  */
-template <typename Pixel>
-typename enable_if<!is_integral<Pixel>::value, double>::type 
-percentile(std::vector<Pixel> &img, double const fraction) {
-    assert(fraction >= 0.0 && fraction <= 1.0);
-
-    int const n = img.size();
-
-    if (n > 1) {
-        double const idx = fraction * (n - 1);
-
-        // interpolate linearly between the adjacent values
-        // For efficiency:
-        // - if we're asked for a fraction > 0.5,
-        //    we'll do the second partial sort on shorter (upper) portion
-        // - otherwise, the shorter portion will be the lower one, we'll partial-sort that.
-
-        int const q1 = static_cast<int>(idx);
-        int const q2 = q1 + 1;
-
-        auto mid1 = img.begin() + q1;
-        auto mid2 = img.begin() + q2;
-        if (fraction > 0.5) {
-            std::nth_element(img.begin(), mid1, img.end());
-            std::nth_element(mid1, mid2, img.end());
-        } else {
-            std::nth_element(img.begin(), mid2, img.end());
-            std::nth_element(img.begin(), mid1, mid2);
-        }
-
-        double val1 = static_cast<double>(*mid1);
-        double val2 = static_cast<double>(*mid2);
-        double w1 = (static_cast<double>(q2) - idx);
-        double w2 = (idx - static_cast<double>(q1));
-        return w1 * val1 + w2 * val2;
-
-    } else if (n == 1) {
-        return img[0];
-    } else {
-        return NaN;
-    }
-}
-
-namespace {
-    //
-    // Helper function to estimate a floating-point quantile from integer data
-    //
-    // The data has been partially sorted, using nth_element
-    //
-    // begin:   iterator to a point which we know to be below our median
-    // end:     iterator to a point which we know to be beyond our median
-    // naive:   the integer value of the desired quantile
-    // target:  the number of points that should be to the left of the quantile.
-    //          N.b. if begin isn't the start of the data, this may not be the
-    //          desired number of points.  Caveat Callor
-    template<typename T>
-    double
-    computeQuantile(typename std::vector<T>::const_iterator begin,
-                    typename std::vector<T>::const_iterator end,
-                    T const naive,
-                    double const target
-                   )
-    {
-        // investigate the cumulative histogram near naive
-        std::size_t left = 0;           // number of values less than naive
-        std::size_t middle = 0;         // number of values equal to naive
-
-        for (auto ptr = begin; ptr != end; ++ptr) {
-            auto const val = *ptr;
-            if (val < naive) {
-                ++left;
-            } else if (val == naive) {
-                ++middle;
+template <typename IsFinite, typename ImageT, typename MaskT, typename Function>
+void forEachGoodPixel(ImageT const &img, MaskT const &msk, int const andMask, Function &&func) {
+    for (int i_y = 0; i_y < img.getHeight(); ++i_y) {
+        typename MaskT::x_iterator mptr = msk.row_begin(i_y);
+        for (typename ImageT::x_iterator ptr = img.row_begin(i_y), end = img.row_end(i_y); ptr != end;
+             ++ptr) {
+            if (IsFinite()(*ptr) && !(*mptr & andMask)) {
+                func(*ptr);
             }
-        }
-
-        return naive - 0.5 + (target - left)/middle;
-    }
-
-    /**
-     * A wrapper using the nth_element() built-in to compute percentiles for a vector
-     *
-     * @param img       an afw::Image
-     * @param fraction the desired percentile.
-     *
-     * This is the specialisation for integral types where we have to handle ties carefully.
-     */
-    template <typename Pixel>
-    typename enable_if<is_integral<Pixel>::value, double>::type 
-    percentile(std::vector<Pixel> &img, double const fraction) {
-        assert(fraction >= 0.0 && fraction <= 1.0);
-
-        auto const n = img.size();
-
-        if (n == 0) {
-            return NaN;
-        } else if (n == 1) {
-            return img[0];
-        } else {
-            // We need to handle ties.  The proper way to do this is to analyse the cumulative curve after
-            // building the histograms (which is faster than a generic partitioning algorithm), but it's a
-            // nuisance as we don't know the range of values
-            //
-            // This code looks clean enough, but actually the call to nth_element is expensive
-            // and we *still* have to go through the array a second time
-
-            double const idx = fraction*(n - 1);
-
-            auto midP = img.begin() + static_cast<int>(idx);
-            std::nth_element(img.begin(), midP, img.end());
-            auto const naiveP = *midP;           // value of desired element
-
-            return computeQuantile(img.begin(), img.end(), naiveP, fraction*n);
+            ++mptr;
         }
     }
 }
 
-using MedianQuartileReturn = std::tuple<double, double, double>;
-namespace {
-    /**
-     * A wrapper using the nth_element() built-in to compute median and Quartiles for an image
-     *
-     * @param img       an afw::Image
-     *
-     * Specialisation for non-integral types (where ties are not a problem)
-     */
-    template <typename Pixel>
-    typename enable_if<!is_integral<Pixel>::value, MedianQuartileReturn>::type
-    medianAndQuartiles(std::vector<Pixel> &img) {
-        int const n = img.size();
-
-        if (n > 1) {
-            double const idx50 = 0.50 * (n - 1);
-            double const idx25 = 0.25 * (n - 1);
-            double const idx75 = 0.75 * (n - 1);
-
-            // For efficiency:
-            // - partition at 50th, then partition the two half further to get 25th and 75th
-            // - to get the adjacent points (for interpolation), partition between 25/50, 50/75, 75/end
-            //   these should be much smaller partitions
-
-            int const q50a = static_cast<int>(idx50);
-            int const q50b = q50a + 1;
-            int const q25a = static_cast<int>(idx25);
-            int const q25b = q25a + 1;
-            int const q75a = static_cast<int>(idx75);
-            int const q75b = q75a + 1;
-
-            auto mid50a = img.begin() + q50a;
-            auto mid50b = img.begin() + q50b;
-            auto mid25a = img.begin() + q25a;
-            auto mid25b = img.begin() + q25b;
-            auto mid75a = img.begin() + q75a;
-            auto mid75b = img.begin() + q75b;
-
-            // get the 50th percentile, then get the 25th and 75th on the smaller partitions
-            std::nth_element(img.begin(), mid50a, img.end());
-            std::nth_element(mid50a, mid75a, img.end());
-            std::nth_element(img.begin(), mid25a, mid50a);
-
-            // and the adjacent points for each ... use the smallest segments available.
-            std::nth_element(mid50a, mid50b, mid75a);
-            std::nth_element(mid25a, mid25b, mid50a);
-            std::nth_element(mid75a, mid75b, img.end());
-
-            // interpolate linearly between the adjacent values
-            double val50a = static_cast<double>(*mid50a);
-            double val50b = static_cast<double>(*mid50b);
-            double w50a = (static_cast<double>(q50b) - idx50);
-            double w50b = (idx50 - static_cast<double>(q50a));
-            double median = w50a * val50a + w50b * val50b;
-
-            double val25a = static_cast<double>(*mid25a);
-            double val25b = static_cast<double>(*mid25b);
-            double w25a = (static_cast<double>(q25b) - idx25);
-            double w25b = (idx25 - static_cast<double>(q25a));
-            double q1 = w25a * val25a + w25b * val25b;
-
-            double val75a = static_cast<double>(*mid75a);
-            double val75b = static_cast<double>(*mid75b);
-            double w75a = (static_cast<double>(q75b) - idx75);
-            double w75b = (idx75 - static_cast<double>(q75a));
-            double q3 = w75a * val75a + w75b * val75b;
-
-            return MedianQuartileReturn(median, q1, q3);
-        } else if (n == 1) {
-            return MedianQuartileReturn(img[0], img[0], img[0]);
-        } else {
-            return MedianQuartileReturn(NaN, NaN, NaN);
-        }
-    }
+/**
+ * @internal Compute the median (and, optionally, the quartiles) of the good pixels in an image
+ *
+ * @param img  the image
+ * @param msk  its mask
+ * @param andMask  pixels with any of these mask bits set are ignored
+ * @param nGood  the expected number of good pixels (only used to size buffers)
+ * @param wantQuartiles  compute the quartiles as well as the median?  If false they are NaN
+ *
+ * This is the general case, which copies the pixels (as the selection algorithm must reorder them).
+ */
+template <typename IsFinite, typename ImageT, typename MaskT>
+MedianQuartileReturn medianAndQuartiles(ImageT const &img, MaskT const &msk, int const andMask,
+                                        int const nGood, bool const wantQuartiles, std::false_type) {
+    // Note need to keep track of allPixelOrMask here ... processPixels() does that
+    // and it always gets called
+    std::vector<typename ImageT::Pixel> imgcp;
+    imgcp.reserve(nGood);
+    forEachGoodPixel<IsFinite>(img, msk, andMask,
+                               [&imgcp](typename ImageT::Pixel val) { imgcp.push_back(val); });
 
-    /**
-     * A wrapper using the nth_element() built-in to compute median and Quartiles for an image
-     *
-     * @param img       an afw::Image
-     *
-     * This is the specialisation for integral types where we have to handle ties carefully.
-     */
-    template <typename Pixel>
-    typename enable_if<is_integral<Pixel>::value, MedianQuartileReturn>::type
-    medianAndQuartiles(std::vector<Pixel> &img) {
-        auto const n = img.size();
-
-        if (n == 0) {
-            return MedianQuartileReturn(NaN, NaN, NaN);
-        } else if (n == 1) {
-            return MedianQuartileReturn(img[0], img[0], img[0]);
-        } else {
-            // We need to handle ties.  The proper way to do this is to analyse the cumulative curve after
-            // building the histograms (which is faster than a generic partitioning algorithm), but it's a
-            // nuisance as we don't know the range of values
-            //
-            // This code looks clean enough, but actually the call to nth_element is expensive
-            // and we *still* have to go through the array a second time.
-        
-            // For efficiency:
-            // - partition at 50th, then partition the two halves further to get 25th and 75th
-
-            auto mid25 = img.begin() + static_cast<int>(0.25*(n - 1));
-            auto mid50 = img.begin() + static_cast<int>(0.50*(n - 1));
-            auto mid75 = img.begin() + static_cast<int>(0.75*(n - 1));
-
-            // get the 50th percentile, then get the 25th and 75th on the smaller partitions
-            std::nth_element(img.begin(), mid50, img.end());
-            std::nth_element(img.begin(), mid25, mid50);
-            std::nth_element(mid50,       mid75, img.end());
-
-            double const q1     = computeQuantile(img.begin(), mid50,     *mid25,
-                                                  0.25*n);
-            double const median = computeQuantile(mid25,       mid75,     *mid50,
-                                                  0.50*n - (mid25 - img.begin()));
-            double const q3     = computeQuantile(mid50,       img.end(), *mid75,
-                                                  0.75*n - (mid50 - img.begin()));
-
-            return MedianQuartileReturn(median, q1, q3);
-        }
+    if (wantQuartiles) {
+        return detail::computeMedianAndQuartiles(imgcp);
     }
+    return MedianQuartileReturn(detail::computeQuantile(imgcp, 0.5), NaN, NaN);
 }
 
 /**
- * @internal A function to copy an image into a vector
+ * @internal Compute the median (and, optionally, the quartiles) of the good pixels in an integer image
  *
- * This is used for percentile and iq_range as these must reorder the values.
- * Because it loops over the pixels, it's been templated over the NaN test to avoid
- * code repetition of the loops.
+ * Integer images usually cover a modest range of values, in which case we histogram the pixels
+ * in place rather than copying and partially sorting them; the results are identical.
  */
-template <typename IsFinite, typename ImageT, typename MaskT, typename VarianceT>
-std::shared_ptr<std::vector<typename ImageT::Pixel> > makeVectorCopy(ImageT const &img, MaskT const &msk,
-                                                                     VarianceT const &, int const andMask) {
-    // Note need to keep track of allPixelOrMask here ... processPixels() does that
-    // and it always gets called
-    std::shared_ptr<std::vector<typename ImageT::Pixel> > imgcp(new std::vector<typename ImageT::Pixel>(0));
-
-    for (int i_y = 0; i_y < img.getHeight(); ++i_y) {
-        typename MaskT::x_iterator mptr = msk.row_begin(i_y);
-        for (typename ImageT::x_iterator ptr = img.row_begin(i_y), end = img.row_end(i_y); ptr != end;
-             ++ptr) {
-            if (IsFinite()(*ptr) && !(*mptr & andMask)) {
-                imgcp->push_back(*ptr);
-            }
-            ++mptr;
-        }
+template <typename IsFinite, typename ImageT, typename MaskT>
+MedianQuartileReturn medianAndQuartiles(ImageT const &img, MaskT const &msk, int const andMask,
+                                        int const nGood, bool const wantQuartiles, std::true_type) {
+    using Pixel = typename ImageT::Pixel;
+
+    Pixel min = std::numeric_limits<Pixel>::max();
+    Pixel max = std::numeric_limits<Pixel>::lowest();
+    std::size_t n = 0;
+    forEachGoodPixel<IsFinite>(img, msk, andMask, [&min, &max, &n](Pixel val) {
+        min = std::min(min, val);
+        max = std::max(max, val);
+        ++n;
+    });
+    if (n <= 1 || !detail::QuantileHistogram<Pixel>::isUsable(min, max, n)) {
+        return medianAndQuartiles<IsFinite>(img, msk, andMask, nGood, wantQuartiles, std::false_type());
     }
 
-    return imgcp;
+    detail::QuantileHistogram<Pixel> histogram(min, max);
+    forEachGoodPixel<IsFinite>(img, msk, andMask, [&histogram](Pixel val) { histogram.add(val); });
+
+    if (wantQuartiles) {
+        return histogram.getMedianAndQuartiles();
+    }
+    return MedianQuartileReturn(histogram.getQuantile(0.5), NaN, NaN);
 }
 }  // namespace
 
@@ -854,11 +780,15 @@ void Statistics::doStatistics(ImageT const &img, MaskT const &msk, VarianceT con
     // Check that an int's large enough to hold the number of pixels
     assert(img.getWidth() * static_cast<double>(img.getHeight()) < std::numeric_limits<int>::max());
 
+    // The vectorised kernels change the order of summation, so are only used on request
+    detail::SimdLevel const simdLevel =
+            _sctrl.getVectorize() ? detail::getMaxSimdLevel() : detail::SimdLevel::SCALAR;
+
     // get the standard statistics
     StandardReturn standard =
             getStandard(img, msk, var, weights, flags, _weightsAreMultiplicative, _sctrl.getAndMask(),
                         _sctrl.getCalcErrorFromInputVariance(), _sctrl.getNanSafe(), _sctrl.getWeighted(),
-                        _sctrl._maskPropagationThresholds);
+                        _sctrl._maskPropagationThresholds, simdLevel);
 
     _n = std::get<0>(standard);
     _sum = std::get<1>(standard);
@@ -875,22 +805,20 @@ void Statistics::doStatistics(ImageT const &img, MaskT const &msk, VarianceT con
         _nMasked = num - _n;
     }
 
-    // copy the image for any routines that will use median or quantiles
+    // get the median and quartiles for any routines that need them
     if (flags & (MEDIAN | IQRANGE | MEANCLIP | STDEVCLIP | VARIANCECLIP)) {
-        // make a vector copy of the image to get the median and quartiles (will move values)
-        std::shared_ptr<std::vector<typename ImageT::Pixel> > imgcp;
-        if (_sctrl.getNanSafe()) {
-            imgcp = makeVectorCopy<ChkFin>(img, msk, var, _sctrl.getAndMask());
-        } else {
-            imgcp = makeVectorCopy<AlwaysT>(img, msk, var, _sctrl.getAndMask());
-        }
-
-        // if we *only* want the median, just use percentile(), otherwise use medianAndQuartiles()
-        if ((flags & (MEDIAN)) && !(flags & (IQRANGE | MEANCLIP | STDEVCLIP | VARIANCECLIP))) {
-            _median = Value(percentile(*imgcp, 0.5), NaN);
-        } else {
-            MedianQuartileReturn mq = medianAndQuartiles(*imgcp);
-            _median = Value(std::get<0>(mq), NaN);
+        // if we *only* want the median, don't bother with the quartiles
+        bool const wantQuartiles = flags & (IQRANGE | MEANCLIP | STDEVCLIP | VARIANCECLIP);
+        using UseHistogram =
+                std::integral_constant<bool, detail::QuantileHistogram<typename ImageT::Pixel>::isSupported>;
+        MedianQuartileReturn const mq =
+                _sctrl.getNanSafe()
+                        ? medianAndQuartiles<ChkFin>(img, msk, _sctrl.getAndMask(), _n, wantQuartiles,
+                                                     UseHistogram())
+                        : medianAndQuartiles<AlwaysT>(img, msk, _sctrl.getAndMask(), _n, wantQuartiles,
+                                                      UseHistogram());
+        _median = Value(std::get<0>(mq), NaN);
+        if (wantQuartiles) {
             _iqrange = std::get<2>(mq) - std::get<1>(mq);
         }
 
@@ -905,7 +833,7 @@ void Statistics::doStatistics(ImageT const &img, MaskT const &msk, VarianceT con
                 StandardReturn clipped = getStandard(
                         img, msk, var, weights, flags, clipinfo, _weightsAreMultiplicative,
                         _sctrl.getAndMask(), _sctrl.getCalcErrorFromInputVariance(), _sctrl.getNanSafe(),
-                        _sctrl.getWeighted(), _sctrl._maskPropagationThresholds);
+                        _sctrl.getWeighted(), _sctrl._maskPropagationThresholds, simdLevel);
 
                 int const nClip = std::get<0>(clipped);             // number after clipping
                 _nClipped = _n - nClip;                             // number clipped
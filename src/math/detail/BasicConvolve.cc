@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 
 #include "lsst/pex/exceptions.h"
@@ -37,6 +38,8 @@
 #include "lsst/afw/math/ConvolveImage.h"
 #include "lsst/afw/math/Kernel.h"
 #include "lsst/afw/math/detail/Convolve.h"
+#include "lsst/afw/math/detail/Parallel.h"
+#include "lsst/afw/math/detail/SeparableConvolve.h"
 
 namespace pexExcept = lsst::pex::exceptions;
 
@@ -137,6 +140,136 @@ namespace afw {
 namespace math {
 namespace detail {
 
+namespace {
+
+/*
+ * Convolve one plane of an image with a spatially invariant separable kernel, setting the good pixels
+ * of outPlane
+ *
+ * Each band of output rows keeps a circular buffer of the last kernel-height input rows convolved
+ * along x (by rowOp), and computes each output row from it (with columnOp).  The ops are called as
+ * op(sources, out, n) where sources[j] points to the first pixel to use for the j'th offset.
+ *
+ * The row pointers are computed from the planes' strides, as indexing an ndarray from several threads
+ * at once races on its (non-atomic) reference count.
+ */
+template <typename OutPixelT, typename InPixelT, typename RowOp, typename ColumnOp>
+void convolvePlaneSeparable(image::ImageBase<OutPixelT>& outPlane, image::ImageBase<InPixelT> const& inPlane,
+                            std::vector<int> const& xOffsets, std::vector<int> const& yOffsets,
+                            lsst::geom::Box2I const& goodBBox, int kHeight, int numThreads, RowOp rowOp,
+                            ColumnOp columnOp) {
+    typename image::ImageBase<OutPixelT>::Array const outArray = outPlane.getArray();
+    typename image::ImageBase<InPixelT>::ConstArray const inArray = inPlane.getArray();
+    OutPixelT* const outData = outArray.getData() + goodBBox.getMinX();
+    std::ptrdiff_t const outStride = outArray.template getStride<0>();
+    InPixelT const* const inData = inArray.getData();
+    std::ptrdiff_t const inStride = inArray.template getStride<0>();
+    int const goodWidth = goodBBox.getWidth();
+
+    auto convolveRows = [&](int begin, int end, int) {
+        std::vector<OutPixelT> buffer(static_cast<std::size_t>(goodWidth) * kHeight);
+        std::vector<InPixelT const*> rowSources(xOffsets.size());
+        std::vector<OutPixelT const*> columnSources(yOffsets.size());
+
+        auto convolveInputRow = [&](int inY) {
+            InPixelT const* inRow = inData + inY * inStride;
+            for (std::size_t j = 0; j < xOffsets.size(); ++j) {
+                rowSources[j] = inRow + xOffsets[j];
+            }
+            rowOp(rowSources.data(), buffer.data() + static_cast<std::size_t>(inY % kHeight) * goodWidth,
+                  goodWidth);
+        };
+
+        for (int inY = begin; inY < begin + kHeight - 1; ++inY) {
+            convolveInputRow(inY);
+        }
+        for (int y = begin; y < end; ++y) {
+            convolveInputRow(y + kHeight - 1);
+            for (std::size_t j = 0; j < yOffsets.size(); ++j) {
+                columnSources[j] =
+                        buffer.data() + static_cast<std::size_t>((y + yOffsets[j]) % kHeight) * goodWidth;
+            }
+            columnOp(columnSources.data(), outData + (goodBBox.getMinY() + y) * outStride, goodWidth);
+        }
+    };
+    parallelForBands(goodBBox.getHeight(), numThreads, convolveRows);
+}
+
+template <typename PixelT>
+using IsFloatingPoint = std::is_floating_point<PixelT>;
+
+/*
+ * Convolve with a spatially invariant separable kernel using the vectorised kernels of
+ * detail/SeparableConvolve.h, if the images have floating-point pixels
+ *
+ * @returns false (having done nothing) if the images are of a type that the vectorised kernels
+ *          can't handle
+ */
+template <typename OutImageT, typename InImageT>
+bool convolveSeparableVectorised(OutImageT&, InImageT const&, std::vector<Kernel::Pixel> const&,
+                                 std::vector<Kernel::Pixel> const&, lsst::geom::Box2I const&, int) {
+    return false;
+}
+
+template <typename OutPixelT, typename InPixelT>
+typename std::enable_if<IsFloatingPoint<OutPixelT>::value && IsFloatingPoint<InPixelT>::value, bool>::type
+convolveSeparableVectorised(image::Image<OutPixelT>& convolvedImage, image::Image<InPixelT> const& inImage,
+                            std::vector<Kernel::Pixel> const& kernelXVec,
+                            std::vector<Kernel::Pixel> const& kernelYVec, lsst::geom::Box2I const& goodBBox,
+                            int numThreads) {
+    KernelTaps const xTaps(kernelXVec);
+    KernelTaps const yTaps(kernelYVec);
+    convolvePlaneSeparable(
+            convolvedImage, inImage, xTaps.offsets, yTaps.offsets, goodBBox, kernelYVec.size(), numThreads,
+            [&xTaps](InPixelT const* const* sources, OutPixelT* out, int n) {
+                sumTaps(sources, xTaps, out, n);
+            },
+            [&yTaps](OutPixelT const* const* sources, OutPixelT* out, int n) {
+                sumTaps(sources, yTaps, out, n);
+            });
+    return true;
+}
+
+template <typename OutPixelT, typename InPixelT>
+typename std::enable_if<IsFloatingPoint<OutPixelT>::value && IsFloatingPoint<InPixelT>::value, bool>::type
+convolveSeparableVectorised(image::MaskedImage<OutPixelT>& convolvedImage,
+                            image::MaskedImage<InPixelT> const& inImage,
+                            std::vector<Kernel::Pixel> const& kernelXVec,
+                            std::vector<Kernel::Pixel> const& kernelYVec, lsst::geom::Box2I const& goodBBox,
+                            int numThreads) {
+    convolveSeparableVectorised(*convolvedImage.getImage(), *inImage.getImage(), kernelXVec, kernelYVec,
+                                goodBBox, numThreads);
+
+    // The variance is convolved with the square of the kernel
+    KernelTaps const xTaps2(kernelXVec, true);
+    KernelTaps const yTaps2(kernelYVec, true);
+    convolvePlaneSeparable(
+            *convolvedImage.getVariance(), *inImage.getVariance(), xTaps2.offsets, yTaps2.offsets, goodBBox,
+            kernelYVec.size(), numThreads,
+            [&xTaps2](image::VariancePixel const* const* sources, image::VariancePixel* out, int n) {
+                sumTaps(sources, xTaps2, out, n);
+            },
+            [&yTaps2](image::VariancePixel const* const* sources, image::VariancePixel* out, int n) {
+                sumTaps(sources, yTaps2, out, n);
+            });
+
+    // The mask is the OR of the pixels under the non-zero elements of the kernel
+    KernelTaps const xTaps(kernelXVec);
+    KernelTaps const yTaps(kernelYVec);
+    convolvePlaneSeparable(
+            *convolvedImage.getMask(), *inImage.getMask(), xTaps.offsets, yTaps.offsets, goodBBox,
+            kernelYVec.size(), numThreads,
+            [&xTaps](image::MaskPixel const* const* sources, image::MaskPixel* out, int n) {
+                orTaps(sources, xTaps.size(), out, n);
+            },
+            [&yTaps](image::MaskPixel const* const* sources, image::MaskPixel* out, int n) {
+                orTaps(sources, yTaps.size(), out, n);
+            });
+    return true;
+}
+
+}  // namespace
+
 template <typename OutImageT, typename InImageT>
 void basicConvolve(OutImageT& convolvedImage, InImageT const& inImage, math::Kernel const& kernel,
                    math::ConvolutionControl const& convolutionControl) {
@@ -213,7 +346,7 @@ void basicConvolve(OutImageT& convolvedImage, InImageT const& inImage,
         // use the standard algorithm for the spatially invariant case
         LOGL_DEBUG("TRACE2.lsst.afw.math.convolve.basicConvolve",
                    "basicConvolve for LinearCombinationKernel: spatially invariant; using brute force");
-        return convolveWithBruteForce(convolvedImage, inImage, kernel, convolutionControl.getDoNormalize());
+        return convolveWithBruteForce(convolvedImage, inImage, kernel, convolutionControl);
     } else {
         // refactor the kernel if this is reasonable and possible;
         // then use the standard algorithm for the spatially varying case
@@ -236,8 +369,7 @@ void basicConvolve(OutImageT& convolvedImage, InImageT const& inImage,
             LOGL_DEBUG("TRACE2.lsst.afw.math.convolve.basicConvolve",
                        "basicConvolve for LinearCombinationKernel: maxInterpolationError < 0; using brute "
                        "force");
-            return convolveWithBruteForce(convolvedImage, inImage, *refKernelPtr,
-                                          convolutionControl.getDoNormalize());
+            return convolveWithBruteForce(convolvedImage, inImage, *refKernelPtr, convolutionControl);
         }
     }
 }
@@ -259,32 +391,46 @@ void basicConvolve(OutImageT& convolvedImage, InImageT const& inImage, math::Sep
     lsst::geom::Box2I const fullBBox = inImage.getBBox(image::LOCAL);
     lsst::geom::Box2I const goodBBox = kernel.shrinkBBox(fullBBox);
 
-    KernelVector kernelXVec(kernel.getWidth());
-    KernelVector kernelYVec(kernel.getHeight());
-
     if (kernel.isSpatiallyVarying()) {
         LOGL_DEBUG("TRACE2.lsst.afw.math.convolve.basicConvolve",
                    "SeparableKernel basicConvolve: kernel is spatially varying");
 
-        for (int cnvY = goodBBox.getMinY(); cnvY <= goodBBox.getMaxY(); ++cnvY) {
-            double const rowPos = inImage.indexToPosition(cnvY, image::Y);
-
-            InXYLocator inImLoc = inImage.xy_at(0, cnvY - goodBBox.getMinY());
-            OutXIterator cnvXIter = convolvedImage.row_begin(cnvY) + goodBBox.getMinX();
-            for (int cnvX = goodBBox.getMinX(); cnvX <= goodBBox.getMaxX();
-                 ++cnvX, ++inImLoc.x(), ++cnvXIter) {
-                double const colPos = inImage.indexToPosition(cnvX, image::X);
-
-                KernelPixel kSum = kernel.computeVectors(kernelXVec, kernelYVec,
-                                                         convolutionControl.getDoNormalize(), colPos, rowPos);
-
-                // why does this trigger warnings? It did not in the past.
-                *cnvXIter = math::convolveAtAPoint<OutImageT, InImageT>(inImLoc, kernelXVec, kernelYVec);
-                if (convolutionControl.getDoNormalize()) {
-                    *cnvXIter = *cnvXIter / kSum;
+        // Each band of rows has its own copy of the kernel (computeVectors sets its parameters)
+        // and its own kernel vectors.  The copies are made here, as cloning a kernel may copy images,
+        // whose reference counts aren't thread-safe.
+        std::vector<std::shared_ptr<Kernel>> bandKernels(
+                resolveNumThreads(convolutionControl.getNumThreads()));
+        for (auto& bandKernelPtr : bandKernels) {
+            bandKernelPtr = kernel.clone();
+        }
+        auto convolveRows = [&](int begin, int end, int iBand) {
+            SeparableKernel const& bandKernel =
+                    *dynamic_cast<SeparableKernel const*>(bandKernels[iBand].get());
+            KernelVector kernelXVec(kernel.getWidth());
+            KernelVector kernelYVec(kernel.getHeight());
+
+            for (int cnvY = goodBBox.getMinY() + begin; cnvY < goodBBox.getMinY() + end; ++cnvY) {
+                double const rowPos = inImage.indexToPosition(cnvY, image::Y);
+
+                InXYLocator inImLoc = inImage.xy_at(0, cnvY - goodBBox.getMinY());
+                OutXIterator cnvXIter = convolvedImage.row_begin(cnvY) + goodBBox.getMinX();
+                for (int cnvX = goodBBox.getMinX(); cnvX <= goodBBox.getMaxX();
+                     ++cnvX, ++inImLoc.x(), ++cnvXIter) {
+                    double const colPos = inImage.indexToPosition(cnvX, image::X);
+
+                    KernelPixel kSum = bandKernel.computeVectors(
+                            kernelXVec, kernelYVec, convolutionControl.getDoNormalize(), colPos, rowPos);
+
+                    // why does this trigger warnings? It did not in the past.
+                    *cnvXIter =
+                            math::convolveAtAPoint<OutImageT, InImageT>(inImLoc, kernelXVec, kernelYVec);
+                    if (convolutionControl.getDoNormalize()) {
+                        *cnvXIter = *cnvXIter / kSum;
+                    }
                 }
             }
-        }
+        };
+        parallelForBands(goodBBox.getHeight(), convolutionControl.getNumThreads(), convolveRows);
     } else {
         // kernel is spatially invariant
         // The basic sequence:
@@ -298,56 +444,74 @@ void basicConvolve(OutImageT& convolvedImage, InImageT const& inImage, math::Sep
         LOGL_DEBUG("TRACE2.lsst.afw.math.convolve.basicConvolve",
                    "SeparableKernel basicConvolve: kernel is spatially invariant");
 
+        KernelVector kernelXVec(kernel.getWidth());
+        KernelVector kernelYVec(kernel.getHeight());
         kernel.computeVectors(kernelXVec, kernelYVec, convolutionControl.getDoNormalize());
-        KernelIterator const kernelXVecBegin = kernelXVec.begin();
-        KernelIterator const kernelYVecBegin = kernelYVec.begin();
-
-        // buffer for x-convolved data
-        OutImageT buffer(lsst::geom::Extent2I(goodBBox.getWidth(), kernel.getHeight()));
-
-        // pre-fill x-convolved data buffer with all but one row of data
-        int yInd = 0;  // during initial fill bufY = inImageY
-        int const yPrefillEnd = buffer.getHeight() - 1;
-        for (; yInd < yPrefillEnd; ++yInd) {
-            OutXIterator bufXIter = buffer.x_at(0, yInd);
-            OutXIterator const bufXEnd = buffer.x_at(goodBBox.getWidth(), yInd);
-            InXIterator inXIter = inImage.x_at(0, yInd);
-            for (; bufXIter != bufXEnd; ++bufXIter, ++inXIter) {
-                *bufXIter = kernelDotProduct<OutPixel, InXIterator, KernelIterator, KernelPixel>(
-                        inXIter, kernelXVecBegin, kernel.getWidth());
-            }
+
+        if (convolveSeparableVectorised(convolvedImage, inImage, kernelXVec, kernelYVec, goodBBox,
+                                        convolutionControl.getNumThreads())) {
+            return;
         }
 
-        // compute output pixels using the sequence described above
-        int inY = yPrefillEnd;
-        int bufY = yPrefillEnd;
-        int cnvY = goodBBox.getMinY();
-        while (true) {
-            // fill next buffer row and compute output row
-            InXIterator inXIter = inImage.x_at(0, inY);
-            OutXIterator bufXIter = buffer.x_at(0, bufY);
-            OutXIterator cnvXIter = convolvedImage.x_at(goodBBox.getMinX(), cnvY);
-            for (int bufX = 0; bufX < goodBBox.getWidth(); ++bufX, ++cnvXIter, ++bufXIter, ++inXIter) {
-                // note: bufXIter points to the row of the buffer that is being updated,
-                // whereas bufYIter points to row 0 of the buffer
-                *bufXIter = kernelDotProduct<OutPixel, InXIterator, KernelIterator, KernelPixel>(
-                        inXIter, kernelXVecBegin, kernel.getWidth());
-
-                OutYIterator bufYIter = buffer.y_at(bufX, 0);
-                *cnvXIter = kernelDotProduct<OutPixel, OutYIterator, KernelIterator, KernelPixel>(
-                        bufYIter, kernelYVecBegin, kernel.getHeight());
+        // Bands of output rows are processed independently, each with its own buffer and copy of the
+        // kernel y vector.  The bands start at multiples of the kernel height, so the x-convolved data
+        // for each output row is in the same order in the circular buffer as it is in serial, and the
+        // dot products are summed in the same order.
+        auto convolveRows = [&](int begin, int end, int) {
+            KernelIterator const kernelXVecBegin = kernelXVec.begin();
+            KernelVector bandKernelYVec(kernelYVec);
+            KernelIterator const kernelYVecBegin = bandKernelYVec.begin();
+
+            // buffer for x-convolved data
+            OutImageT buffer(lsst::geom::Extent2I(goodBBox.getWidth(), kernel.getHeight()));
+
+            // pre-fill x-convolved data buffer with all but one row of data
+            int yInd = 0;  // during initial fill bufY = inImageY - begin
+            int const yPrefillEnd = buffer.getHeight() - 1;
+            for (; yInd < yPrefillEnd; ++yInd) {
+                OutXIterator bufXIter = buffer.x_at(0, yInd);
+                OutXIterator const bufXEnd = buffer.x_at(goodBBox.getWidth(), yInd);
+                InXIterator inXIter = inImage.x_at(0, begin + yInd);
+                for (; bufXIter != bufXEnd; ++bufXIter, ++inXIter) {
+                    *bufXIter = kernelDotProduct<OutPixel, InXIterator, KernelIterator, KernelPixel>(
+                            inXIter, kernelXVecBegin, kernel.getWidth());
+                }
             }
 
-            // test for done now, instead of the start of the loop,
-            // to avoid an unnecessary extra rotation of the kernel Y vector
-            if (cnvY >= goodBBox.getMaxY()) break;
+            // compute output pixels using the sequence described above
+            int inY = begin + yPrefillEnd;
+            int bufY = yPrefillEnd;
+            int cnvY = goodBBox.getMinY() + begin;
+            int const cnvEndY = goodBBox.getMinY() + end;  // end index + 1
+            while (true) {
+                // fill next buffer row and compute output row
+                InXIterator inXIter = inImage.x_at(0, inY);
+                OutXIterator bufXIter = buffer.x_at(0, bufY);
+                OutXIterator cnvXIter = convolvedImage.x_at(goodBBox.getMinX(), cnvY);
+                for (int bufX = 0; bufX < goodBBox.getWidth(); ++bufX, ++cnvXIter, ++bufXIter, ++inXIter) {
+                    // note: bufXIter points to the row of the buffer that is being updated,
+                    // whereas bufYIter points to row 0 of the buffer
+                    *bufXIter = kernelDotProduct<OutPixel, InXIterator, KernelIterator, KernelPixel>(
+                            inXIter, kernelXVecBegin, kernel.getWidth());
+
+                    OutYIterator bufYIter = buffer.y_at(bufX, 0);
+                    *cnvXIter = kernelDotProduct<OutPixel, OutYIterator, KernelIterator, KernelPixel>(
+                            bufYIter, kernelYVecBegin, kernel.getHeight());
+                }
 
-            // update y indices, including bufY, and rotate the kernel y vector to match
-            ++inY;
-            bufY = (bufY + 1) % kernel.getHeight();
-            ++cnvY;
-            std::rotate(kernelYVec.begin(), kernelYVec.end() - 1, kernelYVec.end());
-        }
+                // test for done now, instead of the start of the loop,
+                // to avoid an unnecessary extra rotation of the kernel Y vector
+                if (cnvY + 1 >= cnvEndY) break;
+
+                // update y indices, including bufY, and rotate the kernel y vector to match
+                ++inY;
+                bufY = (bufY + 1) % kernel.getHeight();
+                ++cnvY;
+                std::rotate(bandKernelYVec.begin(), bandKernelYVec.end() - 1, bandKernelYVec.end());
+            }
+        };
+        parallelForBands(goodBBox.getHeight(), convolutionControl.getNumThreads(), convolveRows,
+                         kernel.getHeight());
     }
 }
 
@@ -377,54 +541,78 @@ void convolveWithBruteForce(OutImageT& convolvedImage, InImageT const& inImage,
     int const cnvStartX = kernel.getCtr().getX();
     int const cnvStartY = kernel.getCtr().getY();
     int const cnvEndX = cnvStartX + cnvWidth;   // end index + 1
-    int const cnvEndY = cnvStartY + cnvHeight;  // end index + 1
-
-    KernelImage kernelImage(kernel.getDimensions());
-    KernelXYLocator const kernelLoc = kernelImage.xy_at(0, 0);
 
     if (kernel.isSpatiallyVarying()) {
         LOGL_DEBUG("TRACE4.lsst.afw.math.convolve.convolveWithBruteForce",
                    "convolveWithBruteForce: kernel is spatially varying");
 
-        for (int cnvY = cnvStartY; cnvY != cnvEndY; ++cnvY) {
-            double const rowPos = inImage.indexToPosition(cnvY, image::Y);
+        // Each band of rows has its own copy of the kernel (computeImage sets its parameters)
+        // and its own kernel image.  The copies are made here, as cloning a kernel may copy images
+        // (the basis kernels of a LinearCombinationKernel), whose reference counts aren't thread-safe.
+        std::vector<std::shared_ptr<Kernel>> bandKernels(
+                resolveNumThreads(convolutionControl.getNumThreads()));
+        for (auto& bandKernelPtr : bandKernels) {
+            bandKernelPtr = kernel.clone();
+        }
+        auto convolveRows = [&](int begin, int end, int iBand) {
+            Kernel const& bandKernel = *bandKernels[iBand];
+            KernelImage kernelImage(kernel.getDimensions());
+            KernelXYLocator const kernelLoc = kernelImage.xy_at(0, 0);
 
-            InXYLocator inImLoc = inImage.xy_at(0, cnvY - cnvStartY);
-            OutXIterator cnvXIter = convolvedImage.x_at(cnvStartX, cnvY);
-            for (int cnvX = cnvStartX; cnvX != cnvEndX; ++cnvX, ++inImLoc.x(), ++cnvXIter) {
-                double const colPos = inImage.indexToPosition(cnvX, image::X);
+            for (int cnvY = cnvStartY + begin; cnvY != cnvStartY + end; ++cnvY) {
+                double const rowPos = inImage.indexToPosition(cnvY, image::Y);
 
-                KernelPixel kSum = kernel.computeImage(kernelImage, false, colPos, rowPos);
-                *cnvXIter = math::convolveAtAPoint<OutImageT, InImageT>(inImLoc, kernelLoc, kWidth, kHeight);
-                if (doNormalize) {
-                    *cnvXIter = *cnvXIter / kSum;
+                InXYLocator inImLoc = inImage.xy_at(0, cnvY - cnvStartY);
+                OutXIterator cnvXIter = convolvedImage.x_at(cnvStartX, cnvY);
+                for (int cnvX = cnvStartX; cnvX != cnvEndX; ++cnvX, ++inImLoc.x(), ++cnvXIter) {
+                    double const colPos = inImage.indexToPosition(cnvX, image::X);
+
+                    KernelPixel kSum = bandKernel.computeImage(kernelImage, false, colPos, rowPos);
+                    *cnvXIter =
+                            math::convolveAtAPoint<OutImageT, InImageT>(inImLoc, kernelLoc, kWidth, kHeight);
+                    if (doNormalize) {
+                        *cnvXIter = *cnvXIter / kSum;
+                    }
                 }
             }
-        }
+        };
+        parallelForBands(cnvHeight, convolutionControl.getNumThreads(), convolveRows);
     } else {
         LOGL_DEBUG("TRACE4.lsst.afw.math.convolve.convolveWithBruteForce",
                    "convolveWithBruteForce: kernel is spatially invariant");
 
+        KernelImage kernelImage(kernel.getDimensions());
         (void)kernel.computeImage(kernelImage, doNormalize);
 
-        for (int inStartY = 0, cnvY = cnvStartY; inStartY < cnvHeight; ++inStartY, ++cnvY) {
-            KernelXIterator kernelXIter = kernelImage.x_at(0, 0);
-            InXIterator inXIter = inImage.x_at(0, inStartY);
-            OutXIterator cnvXIter = convolvedImage.x_at(cnvStartX, cnvY);
-            for (int x = 0; x < cnvWidth; ++x, ++cnvXIter, ++inXIter) {
-                *cnvXIter = kernelDotProduct<OutPixel, InXIterator, KernelXIterator, KernelPixel>(
-                        inXIter, kernelXIter, kWidth);
-            }
-            for (int kernelY = 1, inY = inStartY + 1; kernelY < kHeight; ++inY, ++kernelY) {
-                KernelXIterator kernelXIter = kernelImage.x_at(0, kernelY);
-                InXIterator inXIter = inImage.x_at(0, inY);
+        if (useFftConvolution(convolvedImage, kernel, convolutionControl)) {
+            LOGL_DEBUG("TRACE4.lsst.afw.math.convolve.convolveWithBruteForce",
+                       "convolveWithBruteForce: using FFTs");
+            convolveWithFft(convolvedImage, inImage, kernelImage, kernel.getCtr(), convolutionControl);
+            return;
+        }
+
+        // the kernel image is only read, so may be shared by all the bands
+        auto convolveRows = [&](int begin, int end, int) {
+            for (int inStartY = begin, cnvY = cnvStartY + begin; inStartY < end; ++inStartY, ++cnvY) {
+                KernelXIterator kernelXIter = kernelImage.x_at(0, 0);
+                InXIterator inXIter = inImage.x_at(0, inStartY);
                 OutXIterator cnvXIter = convolvedImage.x_at(cnvStartX, cnvY);
                 for (int x = 0; x < cnvWidth; ++x, ++cnvXIter, ++inXIter) {
-                    *cnvXIter += kernelDotProduct<OutPixel, InXIterator, KernelXIterator, KernelPixel>(
+                    *cnvXIter = kernelDotProduct<OutPixel, InXIterator, KernelXIterator, KernelPixel>(
                             inXIter, kernelXIter, kWidth);
                 }
+                for (int kernelY = 1, inY = inStartY + 1; kernelY < kHeight; ++inY, ++kernelY) {
+                    KernelXIterator kernelXIter = kernelImage.x_at(0, kernelY);
+                    InXIterator inXIter = inImage.x_at(0, inY);
+                    OutXIterator cnvXIter = convolvedImage.x_at(cnvStartX, cnvY);
+                    for (int x = 0; x < cnvWidth; ++x, ++cnvXIter, ++inXIter) {
+                        *cnvXIter += kernelDotProduct<OutPixel, InXIterator, KernelXIterator, KernelPixel>(
+                                inXIter, kernelXIter, kWidth);
+                    }
+                }
             }
-        }
+        };
+        parallelForBands(cnvHeight, convolutionControl.getNumThreads(), convolveRows);
     }
 }
 
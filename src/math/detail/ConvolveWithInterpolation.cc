@@ -26,6 +26,7 @@
  * Definition of convolveWithInterpolation and helper functions declared in detail/ConvolveImage.h
  */
 #include <sstream>
+#include <vector>
 
 #include "lsst/pex/exceptions.h"
 #include "lsst/log/Log.h"
@@ -33,6 +34,7 @@
 #include "lsst/afw/image/MaskedImage.h"
 #include "lsst/afw/math/Kernel.h"
 #include "lsst/afw/math/detail/Convolve.h"
+#include "lsst/afw/math/detail/Parallel.h"
 
 namespace pexExcept = lsst::pex::exceptions;
 
@@ -55,15 +57,12 @@ void convolveWithInterpolation(OutImageT &outImage, InImageT const &inImage, mat
     lsst::geom::Box2I fullBBox = lsst::geom::Box2I(
             lsst::geom::Point2I(0, 0), lsst::geom::Extent2I(outImage.getWidth(), outImage.getHeight()));
     lsst::geom::Box2I goodBBox = kernel.shrinkBBox(fullBBox);
-    KernelImagesForRegion goodRegion(KernelImagesForRegion(kernel.clone(), goodBBox, inImage.getXY0(),
-                                                           convolutionControl.getDoNormalize()));
     LOGL_DEBUG("TRACE5.lsst.afw.math.convolve.convolveWithInterpolation",
                "convolveWithInterpolation: full bbox minimum=(%d, %d), extent=(%d, %d)", fullBBox.getMinX(),
                fullBBox.getMinY(), fullBBox.getWidth(), fullBBox.getHeight());
     LOGL_DEBUG("TRACE5.lsst.afw.math.convolve.convolveWithInterpolation",
                "convolveWithInterpolation: goodRegion bbox minimum=(%d, %d), extent=(%d, %d)",
-               goodRegion.getBBox().getMinX(), goodRegion.getBBox().getMinY(),
-               goodRegion.getBBox().getWidth(), goodRegion.getBBox().getHeight());
+               goodBBox.getMinX(), goodBBox.getMinY(), goodBBox.getWidth(), goodBBox.getHeight());
 
     // divide good region into subregions small enough to interpolate over
     int nx = 1 + (goodBBox.getWidth() / convolutionControl.getMaxInterpolationDistance());
@@ -71,17 +70,42 @@ void convolveWithInterpolation(OutImageT &outImage, InImageT const &inImage, mat
     LOGL_DEBUG("TRACE3.lsst.afw.math.convolve.convolveWithInterpolation",
                "convolveWithInterpolation: divide into %d x %d subregions", nx, ny);
 
-    ConvolveWithInterpolationWorkingImages workingImages(kernel.getDimensions());
-    RowOfKernelImagesForRegion regionRow(nx, ny);
-    while (goodRegion.computeNextRow(regionRow)) {
-        for (auto const &rgnIter : regionRow) {
-            LOGL_DEBUG("TRACE5.lsst.afw.math.convolve.convolveWithInterpolation",
-                       "convolveWithInterpolation: bbox minimum=(%d, %d), extent=(%d, %d)",
-                       rgnIter->getBBox().getMinX(), rgnIter->getBBox().getMinY(),
-                       rgnIter->getBBox().getWidth(), rgnIter->getBBox().getHeight());
-            convolveRegionWithInterpolation(outImage, inImage, *rgnIter, workingImages);
-        }
+    // Rows of subregions may be convolved independently, so divide them into bands, one per thread.
+    // Each band starts a new KernelImagesForRegion covering the rest of the good region; this divides
+    // the remaining height into the same subregions as a single region would (the division only
+    // depends on the remaining height and number of rows), so the kernel images, and hence the
+    // output, are exactly those computed in serial.
+    // Each band also needs its own copy of the kernel; these are made here, as cloning a kernel may copy
+    // images (the basis kernels of a LinearCombinationKernel), whose reference counts aren't thread-safe.
+    std::vector<int> const heights = KernelImagesForRegion::computeSubregionLengths(goodBBox.getHeight(), ny);
+    std::vector<std::shared_ptr<Kernel const>> bandKernels(
+            resolveNumThreads(convolutionControl.getNumThreads()));
+    for (auto &bandKernelPtr : bandKernels) {
+        bandKernelPtr = kernel.clone();
     }
+    auto convolveBand = [&](int begin, int end, int iBand) {
+        int startY = goodBBox.getMinY();
+        for (int j = 0; j < begin; ++j) {
+            startY += heights[j];
+        }
+        lsst::geom::Box2I const bandBBox(lsst::geom::Point2I(goodBBox.getMinX(), startY),
+                                         goodBBox.getMax());
+        KernelImagesForRegion goodRegion(bandKernels[iBand], bandBBox, inImage.getXY0(),
+                                         convolutionControl.getDoNormalize());
+
+        ConvolveWithInterpolationWorkingImages workingImages(kernel.getDimensions());
+        RowOfKernelImagesForRegion regionRow(nx, ny - begin);
+        for (int j = begin; j < end && goodRegion.computeNextRow(regionRow); ++j) {
+            for (auto const &rgnIter : regionRow) {
+                LOGL_DEBUG("TRACE5.lsst.afw.math.convolve.convolveWithInterpolation",
+                           "convolveWithInterpolation: bbox minimum=(%d, %d), extent=(%d, %d)",
+                           rgnIter->getBBox().getMinX(), rgnIter->getBBox().getMinY(),
+                           rgnIter->getBBox().getWidth(), rgnIter->getBBox().getHeight());
+                convolveRegionWithInterpolation(outImage, inImage, *rgnIter, workingImages);
+            }
+        }
+    };
+    parallelForBands(ny, convolutionControl.getNumThreads(), convolveBand);
 }
 
 template <typename OutImageT, typename InImageT>
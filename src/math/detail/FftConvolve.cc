@@ -0,0 +1,521 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Definition of convolveWithFft and useFftConvolution, declared in detail/Convolve.h
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fftw3.h"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/geom.h"
+#include "lsst/afw/image/MaskedImage.h"
+#include "lsst/afw/math/ConvolveImage.h"
+#include "lsst/afw/math/Kernel.h"
+#include "lsst/afw/math/detail/Convolve.h"
+#include "lsst/afw/math/detail/Parallel.h"
+
+namespace pexExcept = lsst::pex::exceptions;
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+namespace {
+
+using KernelImage = image::Image<Kernel::Pixel>;
+
+// FFTW's planner (unlike the execution of a plan) isn't thread-safe
+std::mutex fftwPlannerMutex;
+
+/// An array allocated with fftw_malloc, and so aligned as FFTW's SIMD code prefers
+template <typename T>
+class FftwArray final {
+public:
+    explicit FftwArray(std::size_t n) : _data(static_cast<T *>(fftw_malloc(sizeof(T) * n))) {
+        if (!_data) {
+            throw std::bad_alloc();
+        }
+    }
+    FftwArray(FftwArray const &) = delete;
+    FftwArray(FftwArray &&) = delete;
+    FftwArray &operator=(FftwArray const &) = delete;
+    FftwArray &operator=(FftwArray &&) = delete;
+    ~FftwArray() noexcept { fftw_free(_data); }
+
+    T *get() const noexcept { return _data; }
+
+private:
+    T *_data;
+};
+
+/*
+ * Forward and inverse real 2-d transforms of a block of nx x ny pixels
+ *
+ * The plans may be executed on any fftw_malloc'ed arrays of the right sizes, from any number of threads
+ * at once.
+ */
+class FftPlan final {
+public:
+    FftPlan(int nx, int ny) : _nx(nx), _ny(ny) {
+        FftwArray<double> real(getNReal());
+        FftwArray<fftw_complex> complex(getNComplex());
+        std::lock_guard<std::mutex> lock(fftwPlannerMutex);
+        _forward = fftw_plan_dft_r2c_2d(ny, nx, real.get(), complex.get(), FFTW_ESTIMATE);
+        _inverse = fftw_plan_dft_c2r_2d(ny, nx, complex.get(), real.get(), FFTW_ESTIMATE);
+        if (!_forward || !_inverse) {
+            _destroy();
+            throw LSST_EXCEPT(pexExcept::RuntimeError, "Unable to plan FFTs for convolution");
+        }
+    }
+    FftPlan(FftPlan const &) = delete;
+    FftPlan(FftPlan &&) = delete;
+    FftPlan &operator=(FftPlan const &) = delete;
+    FftPlan &operator=(FftPlan &&) = delete;
+    ~FftPlan() noexcept {
+        std::lock_guard<std::mutex> lock(fftwPlannerMutex);
+        _destroy();
+    }
+
+    int getNx() const noexcept { return _nx; }
+    int getNy() const noexcept { return _ny; }
+    /// Number of pixels in a block
+    std::size_t getNReal() const noexcept { return static_cast<std::size_t>(_nx) * _ny; }
+    /// Number of elements in the (Hermitian-packed) transform of a block
+    std::size_t getNComplex() const noexcept { return static_cast<std::size_t>(_nx / 2 + 1) * _ny; }
+
+    void forward(double *in, fftw_complex *out) const { fftw_execute_dft_r2c(_forward, in, out); }
+    /// Inverse transform; unnormalised, and destroys its input
+    void inverse(fftw_complex *in, double *out) const { fftw_execute_dft_c2r(_inverse, in, out); }
+
+private:
+    void _destroy() noexcept {
+        if (_forward) {
+            fftw_destroy_plan(_forward);
+        }
+        if (_inverse) {
+            fftw_destroy_plan(_inverse);
+        }
+    }
+
+    int _nx;
+    int _ny;
+    fftw_plan _forward = nullptr;
+    fftw_plan _inverse = nullptr;
+};
+
+/*
+ * The size of the FFT blocks along one axis: a power of two several times the size of the kernel, so that
+ * most of each block is usable output, but no larger than is needed to cover the image
+ */
+int getBlockSize(int kernelSize, int imageSize) {
+    int const minSize = std::max(64, 4 * kernelSize);
+    int size = 1;
+    while (size < minSize && size < imageSize) {
+        size *= 2;
+    }
+    return size;
+}
+
+/*
+ * Set out to the transform of the kernel image (or of its square), wrapped so that multiplying a block's
+ * transform by it correlates the block with the kernel: kernel pixel (i, j) goes to (-i, -j) modulo the
+ * block size
+ */
+void transformKernel(KernelImage const &kernelImage, bool squared, FftPlan const &plan, fftw_complex *out) {
+    int const nx = plan.getNx();
+    int const ny = plan.getNy();
+    FftwArray<double> buffer(plan.getNReal());
+    std::fill(buffer.get(), buffer.get() + plan.getNReal(), 0.0);
+    for (int j = 0; j < kernelImage.getHeight(); ++j) {
+        for (int i = 0; i < kernelImage.getWidth(); ++i) {
+            double const value = kernelImage(i, j);
+            buffer.get()[static_cast<std::size_t>((ny - j) % ny) * nx + (nx - i) % nx] =
+                    squared ? value * value : value;
+        }
+    }
+    plan.forward(buffer.get(), out);
+}
+
+/*
+ * Correlate one plane of an image with the kernel whose transform is kernelTransform, setting the good
+ * pixels of outPlane
+ *
+ * Each block of the input is transformed, multiplied by the kernel's transform and transformed back; the
+ * first (block size - kernel size + 1) rows and columns of the result aren't affected by wrap-around, and
+ * the blocks are overlapped so that these cover the output.  Non-finite input values are replaced by
+ * zero; the output pixels that they affect are fixed by fixNonFinitePixels.  If nonNegative (as for a
+ * variance plane convolved with the square of a kernel) negative output values, which round-off in the
+ * transforms can give where the exact result is zero or tiny, are set to zero.
+ */
+template <typename OutPixelT, typename InPixelT>
+void convolvePlane(image::Image<OutPixelT> &outPlane, image::Image<InPixelT> const &inPlane,
+                   FftPlan const &plan, fftw_complex const *kernelTransform,
+                   lsst::geom::Extent2I const &kernelDimensions, lsst::geom::Point2I const &kernelCtr,
+                   int numThreads, bool nonNegative = false) {
+    int const nx = plan.getNx();
+    int const ny = plan.getNy();
+    int const width = inPlane.getWidth();
+    int const height = inPlane.getHeight();
+    int const cnvWidth = width + 1 - kernelDimensions.getX();
+    int const cnvHeight = height + 1 - kernelDimensions.getY();
+    int const validX = nx + 1 - kernelDimensions.getX();  // output columns per block
+    int const validY = ny + 1 - kernelDimensions.getY();  // output rows per block
+    int const nBlockX = (cnvWidth + validX - 1) / validX;
+    int const nBlockY = (cnvHeight + validY - 1) / validY;
+    double const scale = 1.0 / static_cast<double>(plan.getNReal());  // FFTW doesn't normalise
+
+    auto convolveBlockRows = [&](int begin, int end, int) {
+        FftwArray<double> block(plan.getNReal());
+        FftwArray<fftw_complex> transform(plan.getNComplex());
+        for (int by = 0; by < end - begin; ++by) {
+            int const y0 = (begin + by) * validY;
+            int const nInRows = std::min(ny, height - y0);
+            int const nOutRows = std::min(validY, cnvHeight - y0);
+            for (int bx = 0; bx < nBlockX; ++bx) {
+                int const x0 = bx * validX;
+                int const nInCols = std::min(nx, width - x0);
+                int const nOutCols = std::min(validX, cnvWidth - x0);
+
+                std::fill(block.get(), block.get() + plan.getNReal(), 0.0);
+                for (int y = 0; y < nInRows; ++y) {
+                    typename image::Image<InPixelT>::const_x_iterator inPtr = inPlane.x_at(x0, y0 + y);
+                    double *blockRow = block.get() + static_cast<std::size_t>(y) * nx;
+                    for (int x = 0; x < nInCols; ++x, ++inPtr) {
+                        double const value = *inPtr;
+                        blockRow[x] = std::isfinite(value) ? value : 0.0;
+                    }
+                }
+
+                plan.forward(block.get(), transform.get());
+                fftw_complex *t = transform.get();
+                for (std::size_t i = 0; i < plan.getNComplex(); ++i) {
+                    double const re = t[i][0] * kernelTransform[i][0] - t[i][1] * kernelTransform[i][1];
+                    double const im = t[i][0] * kernelTransform[i][1] + t[i][1] * kernelTransform[i][0];
+                    t[i][0] = re;
+                    t[i][1] = im;
+                }
+                plan.inverse(transform.get(), block.get());
+
+                for (int y = 0; y < nOutRows; ++y) {
+                    typename image::Image<OutPixelT>::x_iterator outPtr =
+                            outPlane.x_at(x0 + kernelCtr.getX(), y0 + y + kernelCtr.getY());
+                    double const *blockRow = block.get() + static_cast<std::size_t>(y) * nx;
+                    for (int x = 0; x < nOutCols; ++x, ++outPtr) {
+                        double const value = scale * blockRow[x];
+                        *outPtr = static_cast<OutPixelT>(nonNegative && value < 0.0 ? 0.0 : value);
+                    }
+                }
+            }
+        }
+    };
+    parallelForBands(nBlockY, numThreads, convolveBlockRows);
+}
+
+/*
+ * Set out (cnvWidth x cnvHeight) to the OR of the values of in (width x height) under the non-zero pixels
+ * of the kernel
+ *
+ * If the kernel has no zero pixels the OR is separable, and is done as an OR over kernel-width runs of
+ * each row followed by an OR over kernel-height runs of each column.
+ */
+template <typename T>
+void orUnderKernel(std::vector<T> const &in, int width, int height, KernelImage const &kernelImage,
+                   std::vector<T> &out, int numThreads) {
+    int const kWidth = kernelImage.getWidth();
+    int const kHeight = kernelImage.getHeight();
+    int const cnvWidth = width + 1 - kWidth;
+    int const cnvHeight = height + 1 - kHeight;
+
+    std::vector<std::pair<int, int>> offsets;  // (x, y) of the non-zero kernel pixels
+    for (int j = 0; j < kHeight; ++j) {
+        for (int i = 0; i < kWidth; ++i) {
+            if (kernelImage(i, j) != 0) {
+                offsets.emplace_back(i, j);
+            }
+        }
+    }
+
+    out.assign(static_cast<std::size_t>(cnvWidth) * cnvHeight, 0);
+    if (offsets.size() == static_cast<std::size_t>(kWidth) * kHeight) {
+        std::vector<T> rowOr(static_cast<std::size_t>(cnvWidth) * height, 0);
+        parallelForBands(height, numThreads, [&](int begin, int end, int) {
+            for (int y = begin; y < end; ++y) {
+                T *dest = rowOr.data() + static_cast<std::size_t>(y) * cnvWidth;
+                for (int i = 0; i < kWidth; ++i) {
+                    T const *src = in.data() + static_cast<std::size_t>(y) * width + i;
+                    for (int x = 0; x < cnvWidth; ++x) {
+                        dest[x] |= src[x];
+                    }
+                }
+            }
+        });
+        parallelForBands(cnvHeight, numThreads, [&](int begin, int end, int) {
+            for (int y = begin; y < end; ++y) {
+                T *dest = out.data() + static_cast<std::size_t>(y) * cnvWidth;
+                for (int j = 0; j < kHeight; ++j) {
+                    T const *src = rowOr.data() + static_cast<std::size_t>(y + j) * cnvWidth;
+                    for (int x = 0; x < cnvWidth; ++x) {
+                        dest[x] |= src[x];
+                    }
+                }
+            }
+        });
+    } else {
+        parallelForBands(cnvHeight, numThreads, [&](int begin, int end, int) {
+            for (int y = begin; y < end; ++y) {
+                T *dest = out.data() + static_cast<std::size_t>(y) * cnvWidth;
+                for (auto const &offset : offsets) {
+                    T const *src = in.data() + static_cast<std::size_t>(y + offset.second) * width +
+                                   offset.first;
+                    for (int x = 0; x < cnvWidth; ++x) {
+                        dest[x] |= src[x];
+                    }
+                }
+            }
+        });
+    }
+}
+
+/*
+ * Accessors that let us treat Images and MaskedImages alike
+ */
+template <typename PixelT>
+image::Image<PixelT> &getImagePlane(image::Image<PixelT> &img) {
+    return img;
+}
+template <typename PixelT>
+image::Image<PixelT> const &getImagePlane(image::Image<PixelT> const &img) {
+    return img;
+}
+template <typename PixelT>
+image::Image<PixelT> &getImagePlane(image::MaskedImage<PixelT> &mimg) {
+    return *mimg.getImage();
+}
+template <typename PixelT>
+image::Image<PixelT> const &getImagePlane(image::MaskedImage<PixelT> const &mimg) {
+    return *mimg.getImage();
+}
+
+/*
+ * Convolve the variance with the square of the kernel, and smear the mask; nothing to do for an Image
+ */
+template <typename OutPixelT, typename InPixelT>
+void convolveVarianceAndMask(image::Image<OutPixelT> &, image::Image<InPixelT> const &, FftPlan const &,
+                             KernelImage const &, lsst::geom::Point2I const &, int) {}
+
+template <typename OutPixelT, typename InPixelT>
+void convolveVarianceAndMask(image::MaskedImage<OutPixelT> &convolvedImage,
+                             image::MaskedImage<InPixelT> const &inImage, FftPlan const &plan,
+                             KernelImage const &kernelImage, lsst::geom::Point2I const &kernelCtr,
+                             int numThreads) {
+    FftwArray<fftw_complex> kernelTransform(plan.getNComplex());
+    transformKernel(kernelImage, true, plan, kernelTransform.get());
+    convolvePlane(*convolvedImage.getVariance(), *inImage.getVariance(), plan, kernelTransform.get(),
+                  kernelImage.getDimensions(), kernelCtr, numThreads, true);
+
+    using MaskT = typename image::MaskedImage<InPixelT>::Mask;
+    MaskT const &inMask = *inImage.getMask();
+    int const width = inMask.getWidth();
+    int const height = inMask.getHeight();
+    std::vector<image::MaskPixel> inMaskPixels(static_cast<std::size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        std::copy(inMask.row_begin(y), inMask.row_end(y),
+                  inMaskPixels.begin() + static_cast<std::size_t>(y) * width);
+    }
+    std::vector<image::MaskPixel> outMaskPixels;
+    orUnderKernel(inMaskPixels, width, height, kernelImage, outMaskPixels, numThreads);
+
+    MaskT &outMask = *convolvedImage.getMask();
+    int const cnvWidth = width + 1 - kernelImage.getWidth();
+    int const cnvHeight = height + 1 - kernelImage.getHeight();
+    for (int y = 0; y < cnvHeight; ++y) {
+        auto const begin = outMaskPixels.begin() + static_cast<std::size_t>(y) * cnvWidth;
+        std::copy(begin, begin + cnvWidth, outMask.x_at(kernelCtr.getX(), y + kernelCtr.getY()));
+    }
+}
+
+/*
+ * Flag the non-finite pixels of an image (and, for a MaskedImage, its variance)
+ *
+ * @returns true if any pixels were flagged
+ */
+template <typename PixelT>
+bool flagNonFinite(image::Image<PixelT> const &img, std::vector<std::uint8_t> &flags) {
+    bool found = false;
+    flags.assign(static_cast<std::size_t>(img.getWidth()) * img.getHeight(), 0);
+    for (int y = 0; y < img.getHeight(); ++y) {
+        std::uint8_t *flag = flags.data() + static_cast<std::size_t>(y) * img.getWidth();
+        for (auto ptr = img.row_begin(y), end = img.row_end(y); ptr != end; ++ptr, ++flag) {
+            if (!std::isfinite(static_cast<double>(*ptr))) {
+                *flag = 1;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+template <typename PixelT>
+bool flagNonFinite(image::MaskedImage<PixelT> const &mimg, std::vector<std::uint8_t> &flags) {
+    bool found = flagNonFinite(*mimg.getImage(), flags);
+    auto const &variance = *mimg.getVariance();
+    for (int y = 0; y < variance.getHeight(); ++y) {
+        std::uint8_t *flag = flags.data() + static_cast<std::size_t>(y) * variance.getWidth();
+        for (auto ptr = variance.row_begin(y), end = variance.row_end(y); ptr != end; ++ptr, ++flag) {
+            if (!std::isfinite(*ptr)) {
+                *flag = 1;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+/*
+ * Recompute directly every output pixel with a non-finite input value under a non-zero kernel pixel, so
+ * that NaNs and infinities propagate as they do in direct convolution
+ */
+template <typename OutImageT, typename InImageT>
+void fixNonFinitePixels(OutImageT &convolvedImage, InImageT const &inImage, KernelImage const &kernelImage,
+                        lsst::geom::Point2I const &kernelCtr, int numThreads) {
+    std::vector<std::uint8_t> isNonFinite;
+    if (!flagNonFinite(inImage, isNonFinite)) {
+        return;
+    }
+    std::vector<std::uint8_t> isAffected;
+    orUnderKernel(isNonFinite, inImage.getWidth(), inImage.getHeight(), kernelImage, isAffected, numThreads);
+
+    int const kWidth = kernelImage.getWidth();
+    int const kHeight = kernelImage.getHeight();
+    int const cnvWidth = inImage.getWidth() + 1 - kWidth;
+    int const cnvHeight = inImage.getHeight() + 1 - kHeight;
+    KernelImage::const_xy_locator const kernelLoc = kernelImage.xy_at(0, 0);
+    parallelForBands(cnvHeight, numThreads, [&](int begin, int end, int) {
+        for (int y = begin; y < end; ++y) {
+            std::uint8_t const *affected = isAffected.data() + static_cast<std::size_t>(y) * cnvWidth;
+            for (int x = 0; x < cnvWidth; ++x) {
+                if (affected[x]) {
+                    *convolvedImage.x_at(x + kernelCtr.getX(), y + kernelCtr.getY()) =
+                            math::convolveAtAPoint<OutImageT, InImageT>(inImage.xy_at(x, y), kernelLoc,
+                                                                        kWidth, kHeight);
+                }
+            }
+        }
+    });
+}
+
+}  // namespace
+
+template <typename OutImageT>
+bool useFftConvolution(OutImageT const &convolvedImage, math::Kernel const &kernel,
+                       math::ConvolutionControl const &convolutionControl) {
+    using OutPixel = typename std::decay<decltype(getImagePlane(convolvedImage))>::type::Pixel;
+    if (kernel.isSpatiallyVarying() || !std::is_floating_point<OutPixel>::value) {
+        return false;
+    }
+    switch (convolutionControl.getAlgorithm()) {
+        case ConvolutionControl::DIRECT:
+            return false;
+        case ConvolutionControl::FFT:
+            return true;
+        case ConvolutionControl::AUTO:
+            return kernel.getWidth() * kernel.getHeight() >= ConvolutionControl::FFT_MIN_KERNEL_AREA;
+    }
+    throw LSST_EXCEPT(pexExcept::InvalidParameterError, "Unknown convolution algorithm");
+}
+
+template <typename OutImageT, typename InImageT>
+void convolveWithFft(OutImageT &convolvedImage, InImageT const &inImage, KernelImage const &kernelImage,
+                     lsst::geom::Point2I const &kernelCtr,
+                     math::ConvolutionControl const &convolutionControl) {
+    using OutPixel = typename std::decay<decltype(getImagePlane(convolvedImage))>::type::Pixel;
+    if (!std::is_floating_point<OutPixel>::value) {
+        throw LSST_EXCEPT(pexExcept::InvalidParameterError,
+                          "FFT convolution requires an output image with floating-point pixels");
+    }
+    int const numThreads = convolutionControl.getNumThreads();
+
+    FftPlan const plan(getBlockSize(kernelImage.getWidth(), inImage.getWidth()),
+                       getBlockSize(kernelImage.getHeight(), inImage.getHeight()));
+    FftwArray<fftw_complex> kernelTransform(plan.getNComplex());
+    transformKernel(kernelImage, false, plan, kernelTransform.get());
+
+    convolvePlane(getImagePlane(convolvedImage), getImagePlane(inImage), plan, kernelTransform.get(),
+                  kernelImage.getDimensions(), kernelCtr, numThreads);
+    convolveVarianceAndMask(convolvedImage, inImage, plan, kernelImage, kernelCtr, numThreads);
+    fixNonFinitePixels(convolvedImage, inImage, kernelImage, kernelCtr, numThreads);
+}
+
+/*
+ * Explicit instantiation
+ */
+/// @cond
+#define IMAGE(PIXTYPE) image::Image<PIXTYPE>
+#define MASKEDIMAGE(PIXTYPE) image::MaskedImage<PIXTYPE, image::MaskPixel, image::VariancePixel>
+// Instantiate Image or MaskedImage versions
+#define INSTANTIATE_IM_OR_MI(IMGMACRO, OUTPIXTYPE, INPIXTYPE)                                       \
+    template void convolveWithFft(IMGMACRO(OUTPIXTYPE) &, IMGMACRO(INPIXTYPE) const &,              \
+                                  KernelImage const &, lsst::geom::Point2I const &,                 \
+                                  math::ConvolutionControl const &);
+// Instantiate both Image and MaskedImage versions
+#define INSTANTIATE(OUTPIXTYPE, INPIXTYPE)             \
+    INSTANTIATE_IM_OR_MI(IMAGE, OUTPIXTYPE, INPIXTYPE) \
+    INSTANTIATE_IM_OR_MI(MASKEDIMAGE, OUTPIXTYPE, INPIXTYPE)
+
+INSTANTIATE(double, double)
+INSTANTIATE(double, float)
+INSTANTIATE(double, int)
+INSTANTIATE(double, std::uint16_t)
+INSTANTIATE(float, float)
+INSTANTIATE(float, int)
+INSTANTIATE(float, std::uint16_t)
+INSTANTIATE(int, int)
+INSTANTIATE(std::uint16_t, std::uint16_t)
+
+#define INSTANTIATE_USE_FFT(PIXTYPE)                                                                  \
+    template bool useFftConvolution(IMAGE(PIXTYPE) const &, math::Kernel const &,                    \
+                                    math::ConvolutionControl const &);                               \
+    template bool useFftConvolution(MASKEDIMAGE(PIXTYPE) const &, math::Kernel const &,              \
+                                    math::ConvolutionControl const &);
+
+INSTANTIATE_USE_FFT(double)
+INSTANTIATE_USE_FFT(float)
+INSTANTIATE_USE_FFT(int)
+INSTANTIATE_USE_FFT(std::uint16_t)
+/// @endcond
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
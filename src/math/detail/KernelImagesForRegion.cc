@@ -178,7 +178,7 @@ void KernelImagesForRegion::_computeImage(Location location) const {
                              image::indexToPosition(pixelIndex.getY() + _xy0[1]));
 }
 
-std::vector<int> KernelImagesForRegion::_computeSubregionLengths(int length, int nDivisions) {
+std::vector<int> KernelImagesForRegion::computeSubregionLengths(int length, int nDivisions) {
     if ((nDivisions > length) || (nDivisions < 1)) {
         std::ostringstream os;
         os << "nDivisions = " << nDivisions << " not in range [1, " << length << " = length]";
@@ -190,7 +190,7 @@ std::vector<int> KernelImagesForRegion::_computeSubregionLengths(int length, int
         int subLength = _computeNextSubregionLength(remLength, remNDiv);
         if (subLength < 1) {
             std::ostringstream os;
-            os << "Bug! _computeSubregionLengths(length=" << length << ", nDivisions=" << nDivisions
+            os << "Bug! computeSubregionLengths(length=" << length << ", nDivisions=" << nDivisions
                << ") computed sublength = " << subLength << " < 0; remLength = " << remLength;
             throw LSST_EXCEPT(pexExcept::RuntimeError, os.str());
         }
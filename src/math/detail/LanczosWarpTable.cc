@@ -0,0 +1,98 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Definition of LanczosWarpTable, declared in detail/LanczosWarpTable.h
+ */
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/math/FunctionLibrary.h"
+#include "lsst/afw/math/Kernel.h"
+#include "lsst/afw/math/detail/LanczosWarpTable.h"
+
+namespace pexExcept = lsst::pex::exceptions;
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+std::shared_ptr<LanczosWarpTable const> LanczosWarpTable::get(int order, int nPhase) {
+    static std::mutex mutex;
+    // Hold the tables weakly, so a table is freed once no warper uses it
+    static std::map<std::pair<int, int>, std::weak_ptr<LanczosWarpTable const>> tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const key = std::make_pair(order, nPhase);
+    auto const iter = tables.find(key);
+    if (iter != tables.end()) {
+        if (auto table = iter->second.lock()) {
+            return table;
+        }
+    }
+    auto table = std::make_shared<LanczosWarpTable const>(order, nPhase);
+    // Forget tables that have been freed, so the map only holds tables that are in use
+    for (auto i = tables.begin(); i != tables.end();) {
+        i = i->second.expired() ? tables.erase(i) : std::next(i);
+    }
+    tables[key] = table;
+    return table;
+}
+
+LanczosWarpTable::LanczosWarpTable(int order, int nPhase) : _order(order), _nPhase(nPhase) {
+    if (order <= 0 || nPhase <= 0) {
+        throw LSST_EXCEPT(pexExcept::InvalidParameterError,
+                          "Lanczos order and number of phases must be positive");
+    }
+    int const width = getWidth();
+    int const ctr = order - 1;  // as for LanczosWarpingKernel
+    _weights.resize(static_cast<std::size_t>(nPhase) * width);
+    _squaredWeights.resize(_weights.size());
+    _sums.resize(nPhase);
+
+    // The same arithmetic as SeparableKernel::computeCache and basicComputeVectors
+    LanczosFunction1<Kernel::Pixel> func(order);
+    for (int i = 0; i < nPhase; ++i) {
+        func.setParameter(0, (i + 0.5) / static_cast<double>(nPhase));
+        double sum = 0.0;
+        for (int j = 0; j < width; ++j) {
+            double const weight = func(static_cast<double>(j - ctr));
+            _weights[static_cast<std::size_t>(i) * width + j] = weight;
+            _squaredWeights[static_cast<std::size_t>(i) * width + j] = weight * weight;
+            sum += weight;
+        }
+        _sums[i] = sum;
+    }
+}
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
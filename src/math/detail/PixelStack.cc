@@ -0,0 +1,331 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Definition of the PixelStack class declared in detail/PixelStack.h
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/geom/Angle.h"
+#include "lsst/afw/math/detail/PixelStack.h"
+#include "lsst/afw/math/detail/Quantiles.h"
+
+namespace pexExcept = lsst::pex::exceptions;
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+namespace {
+
+double const NaN = std::numeric_limits<double>::quiet_NaN();
+double const IQ_TO_STDEV = 0.741301109252802;  // 1 sigma in units of iqrange (assume Gaussian)
+
+/*
+ * The sums accumulated over one column of the stack; the equivalent of Statistics.cc's StandardReturn
+ */
+struct Moments {
+    int n;
+    double sum;
+    Statistics::Value mean;  // (mean, variance of mean)
+    double variance;
+    image::MaskPixel orMask;
+};
+
+/*
+ * Accumulate the moments of one column of the stack
+ *
+ * This is processPixels() from Statistics.cc, specialised to contiguous data; the operations (and
+ * their order) must be kept in step with that function so that the results are identical.
+ */
+template <bool useWeights, bool checkFinite, bool doClip, typename PixelT>
+Moments accumulate(PixelT const *val, image::MaskPixel const *msk, image::VariancePixel const *var,
+                   WeightPixel const *wt, int const depth, double const center, double const cliplimit,
+                   int const andMask, bool const calcErrorFromInputVariance,
+                   std::vector<double> const &maskPropagationThresholds,
+                   std::vector<double> &rejectedWeightsByBit) {
+    int n = 0;
+    double sumw = 0.0;
+    double sumw2 = 0.0;
+    double sumx = 0;
+    double sumx2 = 0;
+    double sumvw2 = 0.0;
+    image::MaskPixel allPixelOrMask = 0x0;
+
+    int const nBits = maskPropagationThresholds.size();
+    rejectedWeightsByBit.assign(nBits, 0.0);
+
+    for (int i = 0; i < depth; ++i) {
+        if ((!checkFinite || std::isfinite(static_cast<float>(val[i]))) && !(msk[i] & andMask) &&
+            (!doClip || static_cast<double>(std::fabs(val[i] - center)) <= cliplimit)) {
+            double const delta = (val[i] - center);
+
+            if (useWeights) {
+                double const weight = wt[i];
+
+                sumw += weight;
+                sumw2 += weight * weight;
+                sumx += weight * delta;
+                sumx2 += weight * delta * delta;
+
+                if (calcErrorFromInputVariance) {
+                    double const v = var[i];
+                    sumvw2 += v * weight * weight;
+                }
+            } else {
+                sumx += delta;
+                sumx2 += delta * delta;
+
+                if (calcErrorFromInputVariance) {
+                    double const v = var[i];
+                    sumvw2 += v;
+                }
+            }
+
+            allPixelOrMask |= msk[i];
+            n++;
+        } else {
+            for (int bit = 0; bit < nBits; ++bit) {
+                if (msk[i] & (1 << bit)) {
+                    rejectedWeightsByBit[bit] += useWeights ? static_cast<double>(wt[i]) : 1.0;
+                }
+            }
+        }
+    }
+
+    if (!useWeights) {
+        sumw = sumw2 = n;
+    }
+
+    for (int bit = 0; bit < nBits; ++bit) {
+        double hypotheticalTotalWeight = sumw + rejectedWeightsByBit[bit];
+        rejectedWeightsByBit[bit] /= hypotheticalTotalWeight;
+        if (rejectedWeightsByBit[bit] > maskPropagationThresholds[bit]) {
+            allPixelOrMask |= (1 << bit);
+        }
+    }
+
+    double mean = sumx / sumw;
+    double variance = sumx2 / sumw - ::pow(mean, 2);
+    variance *= sumw * sumw / (sumw * sumw - sumw2);
+
+    double meanVar;
+    if (calcErrorFromInputVariance) {
+        meanVar = sumvw2 / (sumw * sumw);
+    } else {
+        meanVar = variance * sumw2 / (sumw * sumw);
+    }
+
+    sumx += sumw * center;
+    mean += center;
+
+    return Moments{n, sumx, Statistics::Value(mean, meanVar), variance, allPixelOrMask};
+}
+
+/// Dispatch the run-time weighting and NaN-checking choices to the templated accumulate()
+template <bool doClip, typename PixelT>
+Moments accumulate(bool useWeights, bool checkFinite, PixelT const *val, image::MaskPixel const *msk,
+                   image::VariancePixel const *var, WeightPixel const *wt, int const depth,
+                   double const center, double const cliplimit, int const andMask,
+                   bool const calcErrorFromInputVariance,
+                   std::vector<double> const &maskPropagationThresholds,
+                   std::vector<double> &rejectedWeightsByBit) {
+    if (useWeights) {
+        if (checkFinite) {
+            return accumulate<true, true, doClip>(val, msk, var, wt, depth, center, cliplimit, andMask,
+                                                  calcErrorFromInputVariance, maskPropagationThresholds,
+                                                  rejectedWeightsByBit);
+        } else {
+            return accumulate<true, false, doClip>(val, msk, var, wt, depth, center, cliplimit, andMask,
+                                                   calcErrorFromInputVariance, maskPropagationThresholds,
+                                                   rejectedWeightsByBit);
+        }
+    } else {
+        if (checkFinite) {
+            return accumulate<false, true, doClip>(val, msk, var, wt, depth, center, cliplimit, andMask,
+                                                   calcErrorFromInputVariance, maskPropagationThresholds,
+                                                   rejectedWeightsByBit);
+        } else {
+            return accumulate<false, false, doClip>(val, msk, var, wt, depth, center, cliplimit, andMask,
+                                                    calcErrorFromInputVariance, maskPropagationThresholds,
+                                                    rejectedWeightsByBit);
+        }
+    }
+}
+
+}  // namespace
+
+template <typename PixelT>
+bool PixelStack<PixelT>::isSupported(Property flags, StatisticsControl const &sctrl) {
+    switch (flags & ~ERRORS) {
+        case MEAN:
+            return true;
+        case MEDIAN:
+        case MEANCLIP:
+            return sctrl.getNanSafe();
+        default:
+            return false;
+    }
+}
+
+template <typename PixelT>
+PixelStack<PixelT>::PixelStack(int width, int depth, Property flags, StatisticsControl const &sctrl,
+                               bool weightByVariance, std::vector<WeightPixel> const &weights)
+        : _width(width),
+          _depth(depth),
+          _flags(static_cast<Property>(flags & ~ERRORS)),
+          _sctrl(sctrl),
+          _weightByVariance(weightByVariance),
+          _isWeighted(weightByVariance || !weights.empty()),
+          _maskPropagationThresholds(),
+          _values(width * depth),
+          _masks(width * depth),
+          _variances(width * depth),
+          _weights(weightByVariance ? width * depth : 0),
+          _good(),
+          _rejectedWeightsByBit() {
+    if (!isSupported(flags, sctrl)) {
+        throw LSST_EXCEPT(pexExcept::InvalidParameterError,
+                          "PixelStack cannot compute the requested statistic");
+    }
+    if (!weightByVariance && !weights.empty()) {
+        if (static_cast<int>(weights.size()) != depth) {
+            throw LSST_EXCEPT(pexExcept::LengthError, "Number of weights must match the stack depth");
+        }
+        _weights = weights;
+    }
+    _good.reserve(depth);
+    // Unset bits are never propagated; StatisticsControl reports them with a threshold of 1.0
+    for (int bit = 0; bit < static_cast<int>(8 * sizeof(image::MaskPixel)); ++bit) {
+        _maskPropagationThresholds.push_back(sctrl.getMaskPropagationThreshold(bit));
+    }
+    while (!_maskPropagationThresholds.empty() && _maskPropagationThresholds.back() == 1.0) {
+        _maskPropagationThresholds.pop_back();
+    }
+}
+
+template <typename PixelT>
+void PixelStack<PixelT>::loadRow(std::vector<std::shared_ptr<image::MaskedImage<PixelT>>> const &images,
+                                 int y) {
+    if (static_cast<int>(images.size()) != _depth) {
+        throw LSST_EXCEPT(pexExcept::LengthError, "Number of images must match the stack depth");
+    }
+    for (int i = 0; i < _depth; ++i) {
+        auto imPtr = images[i]->getImage()->row_begin(y);
+        auto mskPtr = images[i]->getMask()->row_begin(y);
+        auto varPtr = images[i]->getVariance()->row_begin(y);
+        for (int x = 0, j = i; x < _width; ++x, j += _depth, ++imPtr, ++mskPtr, ++varPtr) {
+            _values[j] = *imPtr;
+            _masks[j] = *mskPtr;
+            _variances[j] = *varPtr;
+            if (_weightByVariance) {
+                _weights[j] = 1.0 / *varPtr;
+            }
+        }
+    }
+}
+
+template <typename PixelT>
+typename PixelStack<PixelT>::Result PixelStack<PixelT>::compute(int x) {
+    int const offset = x * _depth;
+    PixelT const *val = &_values[offset];
+    image::MaskPixel const *msk = &_masks[offset];
+    image::VariancePixel const *var = &_variances[offset];
+    WeightPixel const *wt = _weightByVariance ? &_weights[offset] : _weights.data();
+
+    int const andMask = _sctrl.getAndMask();
+    bool const nanSafe = _sctrl.getNanSafe();
+    bool const calcErrorFromInputVariance = _sctrl.getCalcErrorFromInputVariance();
+    std::vector<double> const noThresholds;
+
+    // a crude estimate of the mean, used for numerical stability of the variance
+    Moments const crude = accumulate<false>(_isWeighted, nanSafe, val, msk, var, wt, _depth, 0.0, -1,
+                                            andMask, calcErrorFromInputVariance, noThresholds,
+                                            _rejectedWeightsByBit);
+    double const meanCrude = (crude.n > 0) ? crude.sum / crude.n : 0.0;
+
+    Moments const standard = accumulate<false>(_isWeighted, nanSafe, val, msk, var, wt, _depth, meanCrude,
+                                               -1, andMask, calcErrorFromInputVariance,
+                                               _maskPropagationThresholds, _rejectedWeightsByBit);
+
+    Result result{NaN, NaN, standard.orMask, standard.n, 0, _depth - standard.n};
+    if (_flags == MEAN) {
+        result.value = standard.mean.first;
+        result.error = ::sqrt(standard.mean.second);
+        return result;
+    }
+
+    _good.clear();
+    for (int i = 0; i < _depth; ++i) {
+        if ((!nanSafe || std::isfinite(static_cast<float>(val[i]))) && !(msk[i] & andMask)) {
+            _good.push_back(val[i]);
+        }
+    }
+
+    if (_flags == MEDIAN) {
+        result.value = computeQuantile(_good, 0.5);
+        result.error = sqrt(geom::HALFPI * standard.variance / standard.n);
+        return result;
+    }
+
+    // MEANCLIP
+    MedianAndQuartiles const mq = computeMedianAndQuartiles(_good);
+    double const median = std::get<0>(mq);
+    double const iqrange = std::get<2>(mq) - std::get<1>(mq);
+    Statistics::Value meanclip(NaN, NaN);
+    double varianceclip = NaN;
+    for (int iIter = 0; iIter < _sctrl.getNumIter(); ++iIter) {
+        double const center = (iIter > 0) ? meanclip.first : median;
+        double const hwidth = (iIter > 0 && standard.n > 1)
+                                      ? _sctrl.getNumSigmaClip() * std::sqrt(varianceclip)
+                                      : _sctrl.getNumSigmaClip() * IQ_TO_STDEV * iqrange;
+        Moments clipped{0, NaN, Statistics::Value(NaN, NaN), NaN, 0x0};
+        if (!std::isnan(center) && !std::isnan(hwidth)) {
+            clipped = accumulate<true>(_isWeighted, nanSafe, val, msk, var, wt, _depth, center, hwidth,
+                                       andMask, calcErrorFromInputVariance, noThresholds,
+                                       _rejectedWeightsByBit);
+        }
+        result.nClipped = standard.n - clipped.n;
+        meanclip = clipped.mean;
+        varianceclip = clipped.variance;
+    }
+    result.value = meanclip.first;
+    result.error = ::sqrt(meanclip.second);
+    return result;
+}
+
+/// @cond
+template class PixelStack<float>;
+template class PixelStack<double>;
+/// @endcond
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
@@ -0,0 +1,286 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Definition of the quantile engine declared in detail/Quantiles.h
+ */
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/math/detail/Quantiles.h"
+
+namespace pexExcept = lsst::pex::exceptions;
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+namespace {
+
+double const NaN = std::numeric_limits<double>::quiet_NaN();
+
+/*
+ * Rearrange [base + lo, base + hi) so that each of the ranks (positions relative to base) holds the
+ * value it would hold if the range were sorted
+ *
+ * The ranks must be sorted, unique, and lie in [lo, hi).  The range is partitioned about the middle
+ * rank and the two halves are processed recursively, so each element is only visited O(log(nRank))
+ * times.  A rank at either end of its subrange is found with a linear min/max scan rather than a
+ * full partition; this is common as we often need the neighbour of an order statistic.
+ */
+template <typename Iterator>
+void selectRanks(Iterator base, int lo, int hi, int const *rankBegin, int const *rankEnd) {
+    while (rankBegin != rankEnd) {
+        if (rankEnd - rankBegin == 1) {
+            int const rank = *rankBegin;
+            if (rank == lo) {
+                std::iter_swap(base + lo, std::min_element(base + lo, base + hi));
+            } else if (rank == hi - 1) {
+                std::iter_swap(base + rank, std::max_element(base + lo, base + hi));
+            } else {
+                std::nth_element(base + lo, base + rank, base + hi);
+            }
+            return;
+        }
+        int const *pivot = rankBegin + (rankEnd - rankBegin - 1) / 2;
+        std::nth_element(base + lo, base + *pivot, base + hi);
+        selectRanks(base, lo, *pivot, rankBegin, pivot);
+        lo = *pivot + 1;
+        rankBegin = pivot + 1;
+    }
+}
+
+/*
+ * Select the order statistics at the given ranks, which may be unsorted and contain duplicates
+ */
+template <typename T>
+void selectRanks(std::vector<T> &values, std::vector<int> ranks) {
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+    selectRanks(values.begin(), 0, static_cast<int>(values.size()), ranks.data(),
+                ranks.data() + ranks.size());
+}
+
+/// Linearly interpolate between the order statistics at floor(idx) and floor(idx) + 1
+template <typename T>
+double interpolate(std::vector<T> const &values, double const idx) {
+    int const n = values.size();
+    int const q1 = static_cast<int>(idx);
+    int const q2 = q1 + 1;
+    double const val1 = static_cast<double>(values[q1]);
+    double const val2 = static_cast<double>(values[std::min(q2, n - 1)]);
+    double const w1 = (static_cast<double>(q2) - idx);
+    double const w2 = (idx - static_cast<double>(q1));
+    return w1 * val1 + w2 * val2;
+}
+
+/// The rank of the order statistic that a quantile is interpolated from
+int lowerRank(int const n, double const fraction) { return static_cast<int>(fraction * (n - 1)); }
+
+/*
+ * Floating-point data; interpolate between adjacent order statistics
+ */
+template <typename T>
+double computeQuantileImpl(std::vector<T> &values, double const fraction, std::false_type) {
+    int const n = values.size();
+    int const q = lowerRank(n, fraction);
+    selectRanks(values, {q, std::min(q + 1, n - 1)});
+    return interpolate(values, fraction * (n - 1));
+}
+
+template <typename T>
+MedianAndQuartiles computeMedianAndQuartilesImpl(std::vector<T> &values, std::false_type) {
+    int const n = values.size();
+    int const q25 = lowerRank(n, 0.25);
+    int const q50 = lowerRank(n, 0.50);
+    int const q75 = lowerRank(n, 0.75);
+    selectRanks(values, {q25, q25 + 1, q50, q50 + 1, q75, std::min(q75 + 1, n - 1)});
+    return MedianAndQuartiles(interpolate(values, 0.50 * (n - 1)), interpolate(values, 0.25 * (n - 1)),
+                              interpolate(values, 0.75 * (n - 1)));
+}
+
+/*
+ * Integer data; use the cumulative histogram near the order statistic to handle ties
+ */
+template <typename T>
+double computeQuantileImpl(std::vector<T> &values, double const fraction, std::true_type) {
+    int const n = values.size();
+    int const q = lowerRank(n, fraction);
+    selectRanks(values, {q});
+    T const naive = values[q];
+
+    std::size_t left = 0;    // number of values less than naive
+    std::size_t middle = 0;  // number of values equal to naive
+    for (auto const val : values) {
+        if (val < naive) {
+            ++left;
+        } else if (val == naive) {
+            ++middle;
+        }
+    }
+    return naive - 0.5 + (fraction * n - left) / middle;
+}
+
+template <typename T>
+MedianAndQuartiles computeMedianAndQuartilesImpl(std::vector<T> &values, std::true_type) {
+    int const n = values.size();
+    double const fractions[3] = {0.25, 0.50, 0.75};
+    T naive[3];
+    std::size_t left[3] = {0, 0, 0};
+    std::size_t middle[3] = {0, 0, 0};
+
+    selectRanks(values, {lowerRank(n, fractions[0]), lowerRank(n, fractions[1]), lowerRank(n, fractions[2])});
+    for (int i = 0; i != 3; ++i) {
+        naive[i] = values[lowerRank(n, fractions[i])];
+    }
+    // A single pass to count the values below and at all three order statistics
+    for (auto const val : values) {
+        for (int i = 0; i != 3; ++i) {
+            if (val < naive[i]) {
+                ++left[i];
+            } else if (val == naive[i]) {
+                ++middle[i];
+            }
+        }
+    }
+
+    double results[3];
+    for (int i = 0; i != 3; ++i) {
+        results[i] = naive[i] - 0.5 + (fractions[i] * n - left[i]) / middle[i];
+    }
+    return MedianAndQuartiles(results[1], results[0], results[2]);
+}
+
+}  // namespace
+
+template <typename T>
+double computeQuantile(std::vector<T> &values, double fraction) {
+    assert(fraction >= 0.0 && fraction <= 1.0);
+
+    if (values.empty()) {
+        return NaN;
+    } else if (values.size() == 1) {
+        return values[0];
+    }
+    return computeQuantileImpl(values, fraction, std::is_integral<T>());
+}
+
+template <typename T>
+MedianAndQuartiles computeMedianAndQuartiles(std::vector<T> &values) {
+    if (values.empty()) {
+        return MedianAndQuartiles(NaN, NaN, NaN);
+    } else if (values.size() == 1) {
+        return MedianAndQuartiles(values[0], values[0], values[0]);
+    }
+    return computeMedianAndQuartilesImpl(values, std::is_integral<T>());
+}
+
+template <typename T>
+bool QuantileHistogram<T>::isUsable(T min, T max, std::size_t n) {
+    // The histogram must be cleared and walked as well as filled, so don't let it get much bigger
+    // than the data; but small histograms are always cheap
+    std::size_t const minBins = 4096;
+    if (max < min) {
+        return false;
+    }
+    std::size_t const nBins = static_cast<std::size_t>(static_cast<long>(max) - static_cast<long>(min)) + 1;
+    return nBins <= std::max(n, minBins);
+}
+
+template <typename T>
+QuantileHistogram<T>::QuantileHistogram(T min, T max) : _min(min), _n(0), _counts() {
+    if (max < min) {
+        throw LSST_EXCEPT(pexExcept::InvalidParameterError, "Histogram maximum is smaller than its minimum");
+    }
+    _counts.assign(static_cast<std::size_t>(static_cast<long>(max) - _min) + 1, 0);
+}
+
+template <typename T>
+double QuantileHistogram<T>::getQuantile(double fraction) const {
+    assert(fraction >= 0.0 && fraction <= 1.0);
+
+    double result;
+    _computeQuantiles(&fraction, &result, 1);
+    return result;
+}
+
+template <typename T>
+MedianAndQuartiles QuantileHistogram<T>::getMedianAndQuartiles() const {
+    double const fractions[3] = {0.25, 0.50, 0.75};
+    double results[3];
+    _computeQuantiles(fractions, results, 3);
+    return MedianAndQuartiles(results[1], results[0], results[2]);
+}
+
+template <typename T>
+void QuantileHistogram<T>::_computeQuantiles(double const *fractions, double *results, int nQuantile) const {
+    if (_n == 0) {
+        std::fill(results, results + nQuantile, NaN);
+        return;
+    }
+
+    std::size_t left = 0;  // number of values in bins below i
+    std::size_t i = 0;
+    for (int iq = 0; iq != nQuantile; ++iq) {
+        if (_n == 1) {
+            // as computeQuantile: no interpolation for a single value
+            while (_counts[i] == 0) {
+                ++i;
+            }
+            results[iq] = _min + static_cast<long>(i);
+            continue;
+        }
+        std::size_t const rank = lowerRank(static_cast<int>(_n), fractions[iq]);
+        while (left + _counts[i] <= rank) {
+            left += _counts[i];
+            ++i;
+        }
+        double const naive = _min + static_cast<long>(i);
+        results[iq] = naive - 0.5 + (fractions[iq] * _n - left) / _counts[i];
+    }
+}
+
+/// @cond
+#define INSTANTIATE_QUANTILES(T)                                                 \
+    template double computeQuantile<T>(std::vector<T> & values, double fraction); \
+    template MedianAndQuartiles computeMedianAndQuartiles<T>(std::vector<T> & values)
+
+INSTANTIATE_QUANTILES(double);
+INSTANTIATE_QUANTILES(float);
+INSTANTIATE_QUANTILES(int);
+INSTANTIATE_QUANTILES(std::uint16_t);
+INSTANTIATE_QUANTILES(std::uint64_t);
+
+template class QuantileHistogram<int>;
+template class QuantileHistogram<std::uint16_t>;
+/// @endcond
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
@@ -0,0 +1,234 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Definition of the separable convolution kernels declared in detail/SeparableConvolve.h
+ *
+ * As in StatisticsKernels.cc, the AVX2 kernel is compiled with a function-level target attribute and
+ * is only used if getMaxSimdLevel says that the CPU can execute it.
+ */
+#include <algorithm>
+
+#include "lsst/afw/math/detail/SeparableConvolve.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LSST_AFW_MATH_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+namespace {
+
+using image::MaskPixel;
+
+/*
+ * The reference implementation, for outputs [i, n)
+ *
+ * If N is positive it is the number of taps, known at compile time; otherwise nTaps is used.
+ */
+template <int N, typename InPixelT, typename OutPixelT>
+inline void sumTapsScalar(InPixelT const *const *sources, double const *values, int nTaps, OutPixelT *out,
+                          int i, int n) {
+    int const nt = (N > 0) ? N : nTaps;
+    for (; i < n; ++i) {
+        double sum = 0.0;
+        for (int j = 0; j < nt; ++j) {
+            sum += values[j] * static_cast<double>(sources[j][i]);
+        }
+        out[i] = static_cast<OutPixelT>(sum);
+    }
+}
+
+#if defined(__SSE2__)
+inline __m128d load2(float const *ptr) {
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(ptr))));
+}
+
+inline __m128d load2(double const *ptr) { return _mm_loadu_pd(ptr); }
+
+inline void store2(float *ptr, __m128d x) {
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(ptr), _mm_castps_si128(_mm_cvtpd_ps(x)));
+}
+
+inline void store2(double *ptr, __m128d x) { _mm_storeu_pd(ptr, x); }
+
+template <int N, typename InPixelT, typename OutPixelT>
+void sumTapsSse2(InPixelT const *const *sources, double const *values, int nTaps, OutPixelT *out, int n) {
+    int const nt = (N > 0) ? N : nTaps;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = _mm_setzero_pd();
+        for (int j = 0; j < nt; ++j) {
+            __m128d const value = _mm_set1_pd(values[j]);
+            sum0 = _mm_add_pd(sum0, _mm_mul_pd(value, load2(sources[j] + i)));
+            sum1 = _mm_add_pd(sum1, _mm_mul_pd(value, load2(sources[j] + i + 2)));
+        }
+        store2(out + i, sum0);
+        store2(out + i + 2, sum1);
+    }
+    sumTapsScalar<N>(sources, values, nTaps, out, i, n);
+}
+#endif
+
+#if defined(LSST_AFW_MATH_HAVE_AVX2_KERNEL)
+__attribute__((target("avx2"))) inline __m256d load4(float const *ptr) {
+    return _mm256_cvtps_pd(_mm_loadu_ps(ptr));
+}
+
+__attribute__((target("avx2"))) inline __m256d load4(double const *ptr) { return _mm256_loadu_pd(ptr); }
+
+__attribute__((target("avx2"))) inline void store4(float *ptr, __m256d x) {
+    _mm_storeu_ps(ptr, _mm256_cvtpd_ps(x));
+}
+
+__attribute__((target("avx2"))) inline void store4(double *ptr, __m256d x) { _mm256_storeu_pd(ptr, x); }
+
+template <int N, typename InPixelT, typename OutPixelT>
+__attribute__((target("avx2"))) void sumTapsAvx2(InPixelT const *const *sources, double const *values,
+                                                 int nTaps, OutPixelT *out, int n) {
+    int const nt = (N > 0) ? N : nTaps;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+        for (int j = 0; j < nt; ++j) {
+            __m256d const value = _mm256_set1_pd(values[j]);
+            sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(value, load4(sources[j] + i)));
+            sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(value, load4(sources[j] + i + 4)));
+        }
+        store4(out + i, sum0);
+        store4(out + i + 4, sum1);
+    }
+    for (; i + 4 <= n; i += 4) {
+        __m256d sum = _mm256_setzero_pd();
+        for (int j = 0; j < nt; ++j) {
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_set1_pd(values[j]), load4(sources[j] + i)));
+        }
+        store4(out + i, sum);
+    }
+    sumTapsScalar<N>(sources, values, nTaps, out, i, n);
+}
+#endif
+
+template <int N, typename InPixelT, typename OutPixelT>
+void sumTapsImpl(InPixelT const *const *sources, double const *values, int nTaps, OutPixelT *out, int n,
+                 SimdLevel level) {
+    switch (level) {
+#if defined(LSST_AFW_MATH_HAVE_AVX2_KERNEL)
+        case SimdLevel::AVX2:
+            sumTapsAvx2<N>(sources, values, nTaps, out, n);
+            return;
+#endif
+#if defined(__SSE2__)
+        case SimdLevel::SSE2:
+            sumTapsSse2<N>(sources, values, nTaps, out, n);
+            return;
+#endif
+        default:
+            sumTapsScalar<N>(sources, values, nTaps, out, 0, n);
+            return;
+    }
+}
+
+}  // namespace
+
+KernelTaps::KernelTaps(std::vector<Kernel::Pixel> const &kernelVec, bool squared) {
+    for (std::size_t i = 0; i < kernelVec.size(); ++i) {
+        Kernel::Pixel const value = kernelVec[i];
+        if (value != 0) {
+            offsets.push_back(static_cast<int>(i));
+            values.push_back(squared ? value * value : value);
+        }
+    }
+}
+
+template <typename InPixelT, typename OutPixelT>
+void sumTaps(InPixelT const *const *sources, KernelTaps const &taps, OutPixelT *out, int n, SimdLevel level) {
+    level = std::min(level, getMaxSimdLevel());
+    double const *values = taps.values.data();
+    int const nTaps = taps.size();
+    switch (nTaps) {
+        case 3:
+            sumTapsImpl<3>(sources, values, nTaps, out, n, level);
+            return;
+        case 4:
+            sumTapsImpl<4>(sources, values, nTaps, out, n, level);
+            return;
+        case 5:
+            sumTapsImpl<5>(sources, values, nTaps, out, n, level);
+            return;
+        case 6:
+            sumTapsImpl<6>(sources, values, nTaps, out, n, level);
+            return;
+        case 7:
+            sumTapsImpl<7>(sources, values, nTaps, out, n, level);
+            return;
+        case 8:
+            sumTapsImpl<8>(sources, values, nTaps, out, n, level);
+            return;
+        case 9:
+            sumTapsImpl<9>(sources, values, nTaps, out, n, level);
+            return;
+        case 10:
+            sumTapsImpl<10>(sources, values, nTaps, out, n, level);
+            return;
+        default:
+            sumTapsImpl<0>(sources, values, nTaps, out, n, level);
+            return;
+    }
+}
+
+void orTaps(MaskPixel const *const *sources, int nTaps, MaskPixel *out, int n) {
+    std::fill(out, out + n, 0x0);
+    for (int j = 0; j < nTaps; ++j) {
+        MaskPixel const *src = sources[j];
+        for (int i = 0; i < n; ++i) {
+            out[i] |= src[i];
+        }
+    }
+}
+
+/// @cond
+#define INSTANTIATE_SUM_TAPS(IN, OUT)                                                               \
+    template void sumTaps<IN, OUT>(IN const *const *sources, KernelTaps const &taps, OUT *out, int n, \
+                                   SimdLevel level)
+
+INSTANTIATE_SUM_TAPS(float, float);
+INSTANTIATE_SUM_TAPS(float, double);
+INSTANTIATE_SUM_TAPS(double, float);
+INSTANTIATE_SUM_TAPS(double, double);
+/// @endcond
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
@@ -0,0 +1,336 @@
+// -*- LSST-C++ -*-
+
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Definition of the Statistics accumulator kernels declared in detail/StatisticsKernels.h
+ *
+ * The AVX2 kernel is compiled with a function-level target attribute, so the library as a whole
+ * needs no special compiler flags; getMaxSimdLevel checks at run time that the CPU can execute it.
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "lsst/afw/math/detail/StatisticsKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LSST_AFW_MATH_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace lsst {
+namespace afw {
+namespace math {
+namespace detail {
+
+namespace {
+
+using image::MaskPixel;
+using image::VariancePixel;
+
+/*
+ * The reference implementation; the same sequence of operations as Statistics.cc's processPixels
+ */
+template <typename PixelT>
+void accumulateScalar(PixelT const *img, MaskPixel const *msk, VariancePixel const *var, int n,
+                      double center, double clipLimit, MaskPixel andMask, bool checkFinite, bool doClip,
+                      PixelSums &sums) {
+    for (int i = 0; i < n; ++i) {
+        PixelT const val = img[i];
+        MaskPixel const mval = msk ? msk[i] : 0x0;
+        if ((!checkFinite || std::isfinite(static_cast<float>(val))) && !(mval & andMask) &&
+            (!doClip || std::fabs(val - center) <= clipLimit)) {
+            double const delta = (val - center);
+            sums.sumx += delta;
+            sums.sumx2 += delta * delta;
+            if (var) {
+                sums.sumv += static_cast<double>(var[i]);
+            }
+            sums.orMask |= mval;
+            if (static_cast<double>(val) < sums.min) {
+                sums.min = val;
+            }
+            if (static_cast<double>(val) > sums.max) {
+                sums.max = val;
+            }
+            ++sums.n;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+/*
+ * Load two pixels, both as doubles and (for the finiteness test) as floats in the low lanes
+ */
+inline void load2(float const *ptr, __m128d &x, __m128 &xf) {
+    xf = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(ptr)));
+    x = _mm_cvtps_pd(xf);
+}
+
+inline void load2(double const *ptr, __m128d &x, __m128 &xf) {
+    x = _mm_loadu_pd(ptr);
+    xf = _mm_cvtpd_ps(x);
+}
+
+template <typename PixelT>
+void accumulateSse2(PixelT const *img, MaskPixel const *msk, VariancePixel const *var, int n,
+                    double center, double clipLimit, MaskPixel andMask, bool checkFinite, bool doClip,
+                    PixelSums &sums) {
+    __m128d const centerV = _mm_set1_pd(center);
+    __m128d const clipLimitV = _mm_set1_pd(clipLimit);
+    __m128d const signBitD = _mm_set1_pd(-0.0);
+    __m128 const signBitF = _mm_set1_ps(-0.0f);
+    __m128 const infF = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128d const posInf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    __m128d const negInf = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+    __m128i const andMaskV = _mm_set1_epi32(andMask);
+    __m128i const zeroI = _mm_setzero_si128();
+
+    __m128d sumx = _mm_setzero_pd();
+    __m128d sumx2 = _mm_setzero_pd();
+    __m128d sumv = _mm_setzero_pd();
+    __m128d minV = posInf;
+    __m128d maxV = negInf;
+    __m128i orMask = zeroI;
+    int nGood = 0;
+
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x;
+        __m128 xf;
+        load2(img + i, x, xf);
+
+        __m128i good32 = _mm_cmpeq_epi32(zeroI, zeroI);  // all ones
+        if (checkFinite) {
+            good32 = _mm_castps_si128(_mm_cmplt_ps(_mm_andnot_ps(signBitF, xf), infF));  // false for NaN
+        }
+        __m128i m = zeroI;
+        if (msk) {
+            m = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(msk + i));
+            good32 = _mm_and_si128(good32, _mm_cmpeq_epi32(_mm_and_si128(m, andMaskV), zeroI));
+        }
+        __m128d good = _mm_castsi128_pd(_mm_unpacklo_epi32(good32, good32));
+
+        __m128d const delta = _mm_sub_pd(x, centerV);
+        if (doClip) {
+            good = _mm_and_pd(good, _mm_cmple_pd(_mm_andnot_pd(signBitD, delta), clipLimitV));
+        }
+
+        __m128d const d = _mm_and_pd(good, delta);
+        sumx = _mm_add_pd(sumx, d);
+        sumx2 = _mm_add_pd(sumx2, _mm_mul_pd(d, d));
+        if (var) {
+            __m128d const v = _mm_cvtps_pd(
+                    _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(var + i))));
+            sumv = _mm_add_pd(sumv, _mm_and_pd(good, v));
+        }
+        // N.b. _mm_min_pd(a, b) returns b if a is a NaN, so NaNs never replace the current extremum
+        minV = _mm_min_pd(_mm_or_pd(_mm_and_pd(good, x), _mm_andnot_pd(good, posInf)), minV);
+        maxV = _mm_max_pd(_mm_or_pd(_mm_and_pd(good, x), _mm_andnot_pd(good, negInf)), maxV);
+        // m only has two (low) lanes; pick out the low 32 bits of each 64-bit lane of good to match
+        __m128i const goodLo = _mm_shuffle_epi32(_mm_castpd_si128(good), _MM_SHUFFLE(3, 1, 2, 0));
+        orMask = _mm_or_si128(orMask, _mm_and_si128(m, goodLo));
+        int const goodBits = _mm_movemask_pd(good);
+        nGood += (goodBits & 0x1) + (goodBits >> 1);
+    }
+
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, sumx);
+    sums.sumx += lanes[0] + lanes[1];
+    _mm_store_pd(lanes, sumx2);
+    sums.sumx2 += lanes[0] + lanes[1];
+    _mm_store_pd(lanes, sumv);
+    sums.sumv += lanes[0] + lanes[1];
+    _mm_store_pd(lanes, minV);
+    sums.min = std::min(sums.min, std::min(lanes[0], lanes[1]));
+    _mm_store_pd(lanes, maxV);
+    sums.max = std::max(sums.max, std::max(lanes[0], lanes[1]));
+    alignas(16) MaskPixel maskLanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(maskLanes), orMask);
+    sums.orMask |= maskLanes[0] | maskLanes[1] | maskLanes[2] | maskLanes[3];
+    sums.n += nGood;
+
+    accumulateScalar(img + i, msk ? msk + i : nullptr, var ? var + i : nullptr, n - i, center, clipLimit,
+                     andMask, checkFinite, doClip, sums);
+}
+#endif
+
+#if defined(LSST_AFW_MATH_HAVE_AVX2_KERNEL)
+/*
+ * Load four pixels, both as doubles and (for the finiteness test) as floats
+ */
+__attribute__((target("avx2"))) inline void load4(float const *ptr, __m256d &x, __m128 &xf) {
+    xf = _mm_loadu_ps(ptr);
+    x = _mm256_cvtps_pd(xf);
+}
+
+__attribute__((target("avx2"))) inline void load4(double const *ptr, __m256d &x, __m128 &xf) {
+    x = _mm256_loadu_pd(ptr);
+    xf = _mm256_cvtpd_ps(x);
+}
+
+template <typename PixelT>
+__attribute__((target("avx2"))) void accumulateAvx2(PixelT const *img, MaskPixel const *msk,
+                                                    VariancePixel const *var, int n, double center,
+                                                    double clipLimit, MaskPixel andMask, bool checkFinite,
+                                                    bool doClip, PixelSums &sums) {
+    __m256d const centerV = _mm256_set1_pd(center);
+    __m256d const clipLimitV = _mm256_set1_pd(clipLimit);
+    __m256d const signBitD = _mm256_set1_pd(-0.0);
+    __m128 const signBitF = _mm_set1_ps(-0.0f);
+    __m128 const infF = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m256d const posInf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d const negInf = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    __m128i const andMaskV = _mm_set1_epi32(andMask);
+    __m128i const zeroI = _mm_setzero_si128();
+    __m256i const evenLanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+    __m256d sumx = _mm256_setzero_pd();
+    __m256d sumx2 = _mm256_setzero_pd();
+    __m256d sumv = _mm256_setzero_pd();
+    __m256d minV = posInf;
+    __m256d maxV = negInf;
+    __m128i orMask = zeroI;
+    int nGood = 0;
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x;
+        __m128 xf;
+        load4(img + i, x, xf);
+
+        __m128i good32 = _mm_cmpeq_epi32(zeroI, zeroI);  // all ones
+        if (checkFinite) {
+            good32 = _mm_castps_si128(_mm_cmplt_ps(_mm_andnot_ps(signBitF, xf), infF));  // false for NaN
+        }
+        __m128i m = zeroI;
+        if (msk) {
+            m = _mm_loadu_si128(reinterpret_cast<__m128i const *>(msk + i));
+            good32 = _mm_and_si128(good32, _mm_cmpeq_epi32(_mm_and_si128(m, andMaskV), zeroI));
+        }
+        __m256d good = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(good32));
+
+        __m256d const delta = _mm256_sub_pd(x, centerV);
+        if (doClip) {
+            good = _mm256_and_pd(good,
+                                 _mm256_cmp_pd(_mm256_andnot_pd(signBitD, delta), clipLimitV, _CMP_LE_OQ));
+            // narrow the 64-bit lanes back to 32 bits for the mask
+            good32 = _mm256_castsi256_si128(
+                    _mm256_permutevar8x32_epi32(_mm256_castpd_si256(good), evenLanes));
+        }
+
+        __m256d const d = _mm256_and_pd(good, delta);
+        sumx = _mm256_add_pd(sumx, d);
+        sumx2 = _mm256_add_pd(sumx2, _mm256_mul_pd(d, d));
+        if (var) {
+            __m256d const v = _mm256_cvtps_pd(_mm_loadu_ps(var + i));
+            sumv = _mm256_add_pd(sumv, _mm256_and_pd(good, v));
+        }
+        // N.b. _mm256_min_pd(a, b) returns b if a is a NaN, so NaNs never replace the current extremum
+        minV = _mm256_min_pd(_mm256_blendv_pd(posInf, x, good), minV);
+        maxV = _mm256_max_pd(_mm256_blendv_pd(negInf, x, good), maxV);
+        orMask = _mm_or_si128(orMask, _mm_and_si128(m, good32));
+        nGood += __builtin_popcount(_mm256_movemask_pd(good));
+    }
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, sumx);
+    sums.sumx += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm256_store_pd(lanes, sumx2);
+    sums.sumx2 += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm256_store_pd(lanes, sumv);
+    sums.sumv += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm256_store_pd(lanes, minV);
+    sums.min = std::min({sums.min, lanes[0], lanes[1], lanes[2], lanes[3]});
+    _mm256_store_pd(lanes, maxV);
+    sums.max = std::max({sums.max, lanes[0], lanes[1], lanes[2], lanes[3]});
+    alignas(16) MaskPixel maskLanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(maskLanes), orMask);
+    sums.orMask |= maskLanes[0] | maskLanes[1] | maskLanes[2] | maskLanes[3];
+    sums.n += nGood;
+
+    accumulateScalar(img + i, msk ? msk + i : nullptr, var ? var + i : nullptr, n - i, center, clipLimit,
+                     andMask, checkFinite, doClip, sums);
+}
+#endif
+
+SimdLevel findMaxSimdLevel() noexcept {
+#if defined(LSST_AFW_MATH_HAVE_AVX2_KERNEL)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+#if defined(__SSE2__)
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+}  // namespace
+
+SimdLevel getMaxSimdLevel() noexcept {
+    static SimdLevel const maxLevel = findMaxSimdLevel();
+    return maxLevel;
+}
+
+template <typename PixelT>
+void accumulatePixels(PixelT const *img, MaskPixel const *msk, VariancePixel const *var, int n,
+                      double center, double clipLimit, MaskPixel andMask, bool checkFinite, bool doClip,
+                      PixelSums &sums, SimdLevel level) {
+    level = std::min(level, getMaxSimdLevel());
+    switch (level) {
+#if defined(LSST_AFW_MATH_HAVE_AVX2_KERNEL)
+        case SimdLevel::AVX2:
+            accumulateAvx2(img, msk, var, n, center, clipLimit, andMask, checkFinite, doClip, sums);
+            return;
+#endif
+#if defined(__SSE2__)
+        case SimdLevel::SSE2:
+            accumulateSse2(img, msk, var, n, center, clipLimit, andMask, checkFinite, doClip, sums);
+            return;
+#endif
+        default:
+            accumulateScalar(img, msk, var, n, center, clipLimit, andMask, checkFinite, doClip, sums);
+            return;
+    }
+}
+
+/// @cond
+#define INSTANTIATE_KERNELS(T)                                                                              \
+    template void accumulatePixels<T>(T const *img, MaskPixel const *msk, VariancePixel const *var, int n, \
+                                      double center, double clipLimit, MaskPixel andMask, bool checkFinite, \
+                                      bool doClip, PixelSums &sums, SimdLevel level)
+
+INSTANTIATE_KERNELS(float);
+INSTANTIATE_KERNELS(double);
+/// @endcond
+
+}  // namespace detail
+}  // namespace math
+}  // namespace afw
+}  // namespace lsst
@@ -25,10 +25,12 @@
  * Support for warping an %image to a new Wcs.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -44,6 +46,7 @@
 #include "lsst/afw/geom.h"
 #include "lsst/afw/math/Kernel.h"
 #include "lsst/afw/image/PhotoCalib.h"
+#include "lsst/afw/math/detail/Parallel.h"
 #include "lsst/afw/math/detail/WarpAtOnePoint.h"
 #include "lsst/afw/table/io/InputArchive.h"
 #include "lsst/afw/table/io/OutputArchive.h"
@@ -435,6 +438,405 @@ inline double computeRelativeArea(
     return std::abs(dSrcA.getX() * dSrcB.getY() - dSrcA.getY() * dSrcB.getX());
 }
 
+/*
+ * The source positions of blocks of whole destination rows, and the relative areas of their pixels
+ *
+ * The positions of every pixel in a block of rows (plus column -1, which is needed for the relative
+ * areas) are computed with one call to Transform::applyForwardData, in arrays that are reused from one
+ * block to the next.  The relative area of each pixel is computed from its source position and those
+ * of its neighbours in the row above, exactly as when the rows are transformed one at a time; the row
+ * above a block is kept from the previous block.
+ */
+class SrcPosGrid final {
+public:
+    // Number of destination positions to transform at once
+    static int const BLOCK_SIZE = 1 << 14;
+
+    /**
+     * Construct a grid and compute the source positions of destination row -1
+     *
+     * @param localDestToParentSrc  transform from local destination pixels to parent source pixels
+     * @param width  width of the destination image
+     */
+    SrcPosGrid(geom::TransformPoint2ToPoint2 const &localDestToParentSrc, int width)
+            : _localDestToParentSrc(localDestToParentSrc), _width(width), _nRows(0) {
+        _transformRows(-1, 0);
+        _prevSrcX.assign(_srcX(), _srcX() + _width + 1);
+        _prevSrcY.assign(_srcY(), _srcY() + _width + 1);
+        _nRows = 0;
+    }
+
+    /// Compute the source positions and relative areas of destination rows [beginRow, endRow)
+    void compute(int beginRow, int endRow) {
+        if (_nRows > 0) {
+            std::size_t const lastRow = static_cast<std::size_t>(_nRows - 1) * (_width + 1);
+            std::copy(_srcX() + lastRow, _srcX() + lastRow + _width + 1, _prevSrcX.begin());
+            std::copy(_srcY() + lastRow, _srcY() + lastRow + _width + 1, _prevSrcY.begin());
+        }
+        _transformRows(beginRow, endRow);
+        _relativeArea.resize(static_cast<std::size_t>(_nRows) * _width);
+        double const *upX = _prevSrcX.data();
+        double const *upY = _prevSrcY.data();
+        for (int row = 0; row < _nRows; ++row) {
+            double const *srcX = _srcX() + static_cast<std::size_t>(row) * (_width + 1);
+            double const *srcY = _srcY() + static_cast<std::size_t>(row) * (_width + 1);
+            double *relativeArea = _relativeArea.data() + static_cast<std::size_t>(row) * _width;
+            for (int col = 0; col < _width; ++col) {
+                relativeArea[col] = computeRelativeArea(lsst::geom::Point2D(srcX[col + 1], srcY[col + 1]),
+                                                        lsst::geom::Point2D(upX[col], upY[col]),
+                                                        lsst::geom::Point2D(upX[col + 1], upY[col + 1]));
+            }
+            upX = srcX;
+            upY = srcY;
+        }
+    }
+
+    /// Source position of a destination pixel; row is relative to the beginRow of the last compute
+    lsst::geom::Point2D getSrcPos(int row, int col) const {
+        std::size_t const i = static_cast<std::size_t>(row) * (_width + 1) + col + 1;
+        return lsst::geom::Point2D(_srcX()[i], _srcY()[i]);
+    }
+
+    /// Relative area of a destination pixel; row is relative to the beginRow of the last compute
+    double getRelativeArea(int row, int col) const {
+        return _relativeArea[static_cast<std::size_t>(row) * _width + col];
+    }
+
+private:
+    // Transform the destination positions of rows [beginRow, endRow), columns [-1, width)
+    void _transformRows(int beginRow, int endRow) {
+        int const nRows = endRow - beginRow;
+        std::size_t const nPoints = static_cast<std::size_t>(nRows) * (_width + 1);
+        if (_destData.getSize<1>() != nPoints) {
+            _destData = ndarray::allocate(ndarray::makeVector(std::size_t(2), nPoints));
+            _srcData = ndarray::allocate(ndarray::makeVector(std::size_t(2), nPoints));
+        }
+        double *destX = _destData.getData();
+        double *destY = destX + nPoints;
+        for (int row = beginRow; row < endRow; ++row) {
+            for (int col = -1; col < _width; ++col, ++destX, ++destY) {
+                *destX = col;
+                *destY = row;
+            }
+        }
+        _localDestToParentSrc.applyForwardData(_destData, _srcData);
+        _nRows = nRows;
+    }
+
+    double const *_srcX() const { return _srcData.getData(); }
+    double const *_srcY() const { return _srcData.getData() + _srcData.getSize<1>(); }
+
+    geom::TransformPoint2ToPoint2 const &_localDestToParentSrc;
+    int _width;
+    int _nRows;                              // number of rows in the last block
+    ndarray::Array<double, 2, 2> _destData;  // destination positions of the block: x..., y...
+    ndarray::Array<double, 2, 2> _srcData;   // source positions of the block: x..., y...
+    std::vector<double> _prevSrcX;           // source positions of the row above the block
+    std::vector<double> _prevSrcY;
+    std::vector<double> _relativeArea;  // relative area of each pixel of the block
+};
+
+/*
+ * The source positions of bands of destination rows, interpolated over tiles that adapt to the transform
+ *
+ * A band is first divided into tiles of interpLength x interpLength pixels, as for a fixed
+ * interpolation length.  A tile covers columns (c0, c1] and rows (r0, r1] and the source position of
+ * each of its pixels is interpolated bilinearly between the source positions of its corners.  Before a
+ * tile is used the transform is evaluated at the midpoints of its edges and at its centre; if the
+ * interpolated position at any of these points is in error by more than the tolerance then the tile is
+ * split in two along each axis longer than one pixel, and the new tiles are checked in turn.  The
+ * points checked in all tiles of one generation are transformed with a single call to
+ * Transform::applyForwardData, in buffers that are reused.
+ *
+ * Column -1, and row -1 of the first band, are interpolated along the edges of the first tiles; like
+ * the other positions outside (or at the boundary of) a band's pixels, they are only used to compute
+ * relative areas.
+ */
+class AdaptiveSrcPosBand final {
+public:
+    /**
+     * Construct an AdaptiveSrcPosBand
+     *
+     * @param localDestToParentSrc  transform from local destination pixels to parent source pixels
+     * @param width  width of the destination image
+     * @param interpLength  largest width and height of a tile
+     * @param tolerance  largest allowed error in an interpolated source position
+     */
+    AdaptiveSrcPosBand(geom::TransformPoint2ToPoint2 const &localDestToParentSrc, int width, int interpLength,
+                       double tolerance)
+            : _localDestToParentSrc(localDestToParentSrc),
+              _width(width),
+              _tolerance(tolerance),
+              _prevEndRow(-1),
+              _nRows(0) {
+        for (int prevEndCol = -1; prevEndCol < width - 1; prevEndCol += interpLength) {
+            _edgeColList.push_back(prevEndCol);
+        }
+        _edgeColList.push_back(width - 1);
+    }
+
+    /**
+     * Compute the source positions of destination rows (prevEndRow, endRow]
+     *
+     * prevEndRow must be -1 for the first band, and the endRow of the previous band after that.
+     */
+    void compute(int prevEndRow, int endRow) {
+        std::size_t const rowSize = _width + 1;
+        if (_nRows > 0) {
+            // the last row of the previous band is the row before this one
+            std::copy_n(_srcPosList.begin() + (_nRows - 1) * rowSize, rowSize, _srcPosList.begin());
+        }
+        _prevEndRow = prevEndRow;
+        _nRows = endRow - prevEndRow + 1;
+        _srcPosList.resize(_nRows * rowSize);
+
+        // Start with the tiles of interpLength x interpLength pixels
+        _destPosList.clear();
+        for (int edgeCol : _edgeColList) {
+            _destPosList.emplace_back(edgeCol, prevEndRow);
+            _destPosList.emplace_back(edgeCol, endRow);
+        }
+        _transform();
+        _tileList.clear();
+        for (std::size_t i = 1; i < _edgeColList.size(); ++i) {
+            _addTile(Tile{_edgeColList[i - 1], prevEndRow, _edgeColList[i], endRow,
+                          _transformedList[2 * i - 2], _transformedList[2 * i], _transformedList[2 * i - 1],
+                          _transformedList[2 * i + 1]});
+        }
+
+        while (!_tileList.empty()) {
+            // Transform the midpoints of each tile's edges, and its centre
+            _destPosList.clear();
+            for (Tile const &tile : _tileList) {
+                int const midCol = tile.midCol();
+                int const midRow = tile.midRow();
+                _destPosList.emplace_back(midCol, tile.r0);
+                _destPosList.emplace_back(tile.c0, midRow);
+                _destPosList.emplace_back(midCol, midRow);
+                _destPosList.emplace_back(tile.c1, midRow);
+                _destPosList.emplace_back(midCol, tile.r1);
+            }
+            _transform();
+
+            _tileList.swap(_parentTileList);
+            _tileList.clear();
+            for (std::size_t i = 0; i < _parentTileList.size(); ++i) {
+                Tile const &tile = _parentTileList[i];
+                lsst::geom::Point2D const *midSrcPos = &_transformedList[5 * i];
+                if (_isAccurate(tile, &_destPosList[5 * i], midSrcPos)) {
+                    _fill(tile);
+                    continue;
+                }
+                // Split the tile; grid[ix][iy] is the source position of column (c0, midCol, c1)[ix]
+                // and row (r0, midRow, r1)[iy]
+                lsst::geom::Point2D const grid[3][3] = {{tile.p00, midSrcPos[1], tile.p01},
+                                                        {midSrcPos[0], midSrcPos[2], midSrcPos[4]},
+                                                        {tile.p10, midSrcPos[3], tile.p11}};
+                int const cols[3] = {tile.c0, tile.midCol(), tile.c1};
+                int const rows[3] = {tile.r0, tile.midRow(), tile.r1};
+                int const xStep = (tile.c1 - tile.c0 > 1) ? 1 : 2;
+                int const yStep = (tile.r1 - tile.r0 > 1) ? 1 : 2;
+                for (int ix = 0; ix < 2; ix += xStep) {
+                    for (int iy = 0; iy < 2; iy += yStep) {
+                        int const ix1 = ix + xStep;
+                        int const iy1 = iy + yStep;
+                        _addTile(Tile{cols[ix], rows[iy], cols[ix1], rows[iy1], grid[ix][iy], grid[ix1][iy],
+                                      grid[ix][iy1], grid[ix1][iy1]});
+                    }
+                }
+            }
+        }
+    }
+
+    /// Source position of destination pixel (col, row), for col in [-1, width) and row in
+    /// [prevEndRow, endRow] of the last call to compute
+    lsst::geom::Point2D const &getSrcPos(int col, int row) const {
+        return _srcPosList[static_cast<std::size_t>(row - _prevEndRow) * (_width + 1) + col + 1];
+    }
+
+private:
+    // A tile covering columns (c0, c1] and rows (r0, r1], and the source positions of its corners
+    struct Tile {
+        int c0, r0, c1, r1;
+        lsst::geom::Point2D p00, p10, p01, p11;  // source positions of (c0, r0), (c1, r0), (c0, r1), (c1, r1)
+
+        int midCol() const { return c0 + (c1 - c0) / 2; }
+        int midRow() const { return r0 + (r1 - r0) / 2; }
+
+        // Interpolated source position of destination pixel (col, row)
+        lsst::geom::Point2D interpolate(int col, int row) const {
+            double const u = static_cast<double>(col - c0) / (c1 - c0);
+            double const v = static_cast<double>(row - r0) / (r1 - r0);
+            return lsst::geom::Point2D(
+                    lerp(lerp(p00.getX(), p10.getX(), u), lerp(p01.getX(), p11.getX(), u), v),
+                    lerp(lerp(p00.getY(), p10.getY(), u), lerp(p01.getY(), p11.getY(), u), v));
+        }
+
+        // Linear interpolation that gives a or b exactly at t = 0 or 1, even if the other is not finite
+        static double lerp(double a, double b, double t) {
+            return (t == 0.0) ? a : (t == 1.0) ? b : a + (b - a) * t;
+        }
+    };
+
+    // Fill a tile that can't be split; otherwise add it to the tiles to check
+    void _addTile(Tile const &tile) {
+        if (tile.c1 - tile.c0 <= 1 && tile.r1 - tile.r0 <= 1) {
+            _fill(tile);  // every pixel is a corner
+        } else {
+            _tileList.push_back(tile);
+        }
+    }
+
+    // Are the positions interpolated at the checked points of a tile within tolerance?
+    bool _isAccurate(Tile const &tile, lsst::geom::Point2D const *destPos,
+                     lsst::geom::Point2D const *srcPos) const {
+        for (int i = 0; i < 5; ++i) {
+            lsst::geom::Point2D const interpPos = tile.interpolate(static_cast<int>(destPos[i].getX()),
+                                                                   static_cast<int>(destPos[i].getY()));
+            bool const isFinite = std::isfinite(srcPos[i].getX()) && std::isfinite(srcPos[i].getY());
+            bool const isInterpFinite = std::isfinite(interpPos.getX()) && std::isfinite(interpPos.getY());
+            if (isFinite != isInterpFinite) {
+                return false;
+            }
+            if (isFinite && !((srcPos[i] - interpPos).computeNorm() <= _tolerance)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Set the source positions of the pixels of a tile, including the left or top edge at -1
+    void _fill(Tile const &tile) {
+        int const beginCol = (tile.c0 < 0) ? tile.c0 : tile.c0 + 1;
+        int const beginRow = (tile.r0 < 0) ? tile.r0 : tile.r0 + 1;
+        for (int row = beginRow; row <= tile.r1; ++row) {
+            lsst::geom::Point2D *srcPos =
+                    &_srcPosList[static_cast<std::size_t>(row - _prevEndRow) * (_width + 1) + beginCol + 1];
+            for (int col = beginCol; col <= tile.c1; ++col, ++srcPos) {
+                *srcPos = tile.interpolate(col, row);
+            }
+        }
+    }
+
+    // Transform _destPosList to _transformedList
+    void _transform() {
+        std::size_t const nPoints = _destPosList.size();
+        _destData.resize(2 * nPoints);
+        _srcData.resize(2 * nPoints);
+        for (std::size_t i = 0; i < nPoints; ++i) {
+            _destData[i] = _destPosList[i].getX();
+            _destData[nPoints + i] = _destPosList[i].getY();
+        }
+        auto const shape = ndarray::makeVector(std::size_t(2), nPoints);
+        auto const strides = ndarray::makeVector(static_cast<std::ptrdiff_t>(nPoints), std::ptrdiff_t(1));
+        ndarray::Array<double const, 2, 2> destArray = ndarray::external(_destData.data(), shape, strides);
+        ndarray::Array<double, 2, 2> srcArray = ndarray::external(_srcData.data(), shape, strides);
+        _localDestToParentSrc.applyForwardData(destArray, srcArray);
+        _transformedList.clear();
+        for (std::size_t i = 0; i < nPoints; ++i) {
+            _transformedList.emplace_back(_srcData[i], _srcData[nPoints + i]);
+        }
+    }
+
+    geom::TransformPoint2ToPoint2 const &_localDestToParentSrc;
+    int _width;
+    double _tolerance;
+    int _prevEndRow;
+    int _nRows;                                     // number of rows in _srcPosList
+    std::vector<int> _edgeColList;                  // c0 and c1 of the largest tiles
+    std::vector<lsst::geom::Point2D> _srcPosList;   // source positions of rows [prevEndRow, endRow]
+    std::vector<Tile> _tileList;                    // tiles to check
+    std::vector<Tile> _parentTileList;              // tiles being checked
+    std::vector<lsst::geom::Point2D> _destPosList;  // points to transform...
+    std::vector<lsst::geom::Point2D> _transformedList;  // ...and the transformed points
+    std::vector<double> _destData;                      // _destPosList as raw data
+    std::vector<double> _srcData;                       // _transformedList as raw data
+};
+
+/*
+ * Warp the pixels of a destination image in batches of whole rows, using one or more threads
+ *
+ * The source position and relative area of each destination pixel are added in order, serially, by
+ * add(); warp() then warps the pixels added since the last call, dividing them between threads.  Each
+ * thread has its own WarpAtOnePoint, with its own copies of the warping kernels, so the result does
+ * not depend on the number of threads.
+ */
+template <typename DestImageT, typename SrcImageT>
+class BatchWarper final {
+public:
+    BatchWarper(DestImageT &destImage, SrcImageT const &srcImage, WarpingControl const &control,
+                typename DestImageT::SinglePixel padValue)
+            : _destImage(destImage),
+              _numThreads(detail::resolveNumThreads(control.getNumThreads())),
+              _width(destImage.getWidth()),
+              _startRow(0),
+              _warpers(_numThreads) {
+        // The warpers are all made here, on the calling thread, as each copies srcImage, whose reference
+        // counts aren't thread-safe.  The first is made first, so any update of the control's kernel
+        // caches happens before the others copy the kernels; it only uses the control's kernels itself
+        // if it is going to be the only one.
+        _warpers[0] = std::make_unique<Warper>(srcImage, control, padValue, _numThreads > 1);
+        for (int i = 1; i < _numThreads; ++i) {
+            _warpers[i] = std::make_unique<Warper>(srcImage, control, padValue, true);
+        }
+        std::size_t const batchSize = static_cast<std::size_t>(MIN_PIXELS_PER_THREAD) * _numThreads;
+        _srcPosList.reserve(batchSize + _width);
+        _relativeAreaList.reserve(batchSize + _width);
+    }
+
+    /// Add the next destination pixel
+    void add(lsst::geom::Point2D const &srcPos, double relativeArea) {
+        _srcPosList.push_back(srcPos);
+        _relativeAreaList.push_back(relativeArea);
+    }
+
+    /// Are there enough pixels to be worth warping now?
+    bool isFull() const {
+        return _relativeAreaList.size() >= static_cast<std::size_t>(MIN_PIXELS_PER_THREAD) * _numThreads;
+    }
+
+    /**
+     * Warp the pixels added since the last call, which must make up whole rows
+     *
+     * @returns the number of good pixels
+     */
+    int warp() {
+        int const nPixels = _relativeAreaList.size();
+        std::vector<int> numGoodPixels(_numThreads, 0);
+        detail::parallelForBands(nPixels, _numThreads, [&](int begin, int end, int iBand) {
+            Warper &warpAtOnePoint = *_warpers[iBand];
+            for (int i = begin; i < end;) {
+                int col = i % _width;
+                typename DestImageT::x_iterator destXIter = _destImage.x_at(col, _startRow + i / _width);
+                for (; col < _width && i < end; ++col, ++i, ++destXIter) {
+                    if (warpAtOnePoint(destXIter, _srcPosList[i], _relativeAreaList[i],
+                                       typename image::detail::image_traits<DestImageT>::image_category())) {
+                        ++numGoodPixels[iBand];
+                    }
+                }
+            }
+        });
+        _startRow += nPixels / _width;
+        _srcPosList.clear();
+        _relativeAreaList.clear();
+        return std::accumulate(numGoodPixels.begin(), numGoodPixels.end(), 0);
+    }
+
+private:
+    using Warper = detail::WarpAtOnePoint<DestImageT, SrcImageT>;
+
+    // Enough pixels to make starting a thread worthwhile
+    static int const MIN_PIXELS_PER_THREAD = 1 << 14;
+
+    DestImageT &_destImage;
+    int _numThreads;
+    int _width;
+    int _startRow;  // destination row of the first pixel in the batch
+    std::vector<std::unique_ptr<Warper>> _warpers;
+    std::vector<lsst::geom::Point2D> _srcPosList;
+    std::vector<double> _relativeAreaList;
+};
+
 }  // namespace
 
 template <typename DestImageT, typename SrcImageT>
@@ -497,9 +899,31 @@ int warpImage(DestImageT &destImage, SrcImageT const &srcImage,
     int const maxCol = destWidth - 1;
     int const maxRow = destHeight - 1;
 
-    detail::WarpAtOnePoint<DestImageT, SrcImageT> warpAtOnePoint(srcImage, control, padValue);
+    BatchWarper<DestImageT, SrcImageT> batchWarper(destImage, srcImage, control, padValue);
+
+    if (interpLength > 0 && control.getInterpTolerance() > 0) {
+        // Use interpolation over tiles that are split until they are accurate enough
+        AdaptiveSrcPosBand srcPosBand(*localDestToParentSrc, destWidth, interpLength,
+                                      control.getInterpTolerance());
+        for (int prevEndRow = -1, endRow; prevEndRow < maxRow; prevEndRow = endRow) {
+            endRow = std::min(prevEndRow + interpLength, maxRow);
+            srcPosBand.compute(prevEndRow, endRow);
+            for (int row = prevEndRow + 1; row <= endRow; ++row) {
+                for (int col = 0; col < destWidth; ++col) {
+                    lsst::geom::Point2D const &srcPos = srcPosBand.getSrcPos(col, row);
+                    double relativeArea = computeRelativeArea(srcPos, srcPosBand.getSrcPos(col - 1, row),
+                                                              srcPosBand.getSrcPos(col, row - 1));
+                    batchWarper.add(srcPos, relativeArea);
+                }  // for col
+            }      // for row
+
+            // Warp whole interpolation bands at a time
+            if (endRow == maxRow || batchWarper.isFull()) {
+                numGoodPixels += batchWarper.warp();
+            }
+        }  // for row band
 
-    if (interpLength > 0) {
+    } else if (interpLength > 0) {
         // Use interpolation. Note that 1 produces the same result as no interpolation
         // but uses this code branch, thus providing an easy way to compare the two branches.
 
@@ -590,7 +1014,6 @@ int warpImage(DestImageT &destImage, SrcImageT const &srcImage,
             }
 
             for (int row = prevEndRow + 1; row <= endRow; ++row) {
-                typename DestImageT::x_iterator destXIter = destImage.row_begin(row);
                 srcPosView[-1] += yDeltaSrcPosList[0];
                 for (int colBand = 1, endBand = edgeColList.size(); colBand < endBand; ++colBand) {
                     // Next vertical interpolation band
@@ -605,59 +1028,44 @@ int warpImage(DestImageT &destImage, SrcImageT const &srcImage,
                     lsst::geom::Point2D rightSrcPos = srcPosView[endCol] + yDeltaSrcPosList[colBand];
                     lsst::geom::Extent2D xDeltaSrcPos = (rightSrcPos - leftSrcPos) * invWidthList[colBand];
 
-                    for (int col = prevEndCol + 1; col <= endCol; ++col, ++destXIter) {
+                    for (int col = prevEndCol + 1; col <= endCol; ++col) {
                         lsst::geom::Point2D leftSrcPos = srcPosView[col - 1];
                         lsst::geom::Point2D srcPos = leftSrcPos + xDeltaSrcPos;
                         double relativeArea = computeRelativeArea(srcPos, leftSrcPos, srcPosView[col]);
 
                         srcPosView[col] = srcPos;
 
-                        if (warpAtOnePoint(
-                                    destXIter, srcPos, relativeArea,
-                                    typename image::detail::image_traits<DestImageT>::image_category())) {
-                            ++numGoodPixels;
-                        }
+                        batchWarper.add(srcPos, relativeArea);
                     }  // for col
                 }      // for col band
             }          // for row
+
+            // Warp whole interpolation bands at a time
+            if (endRow == maxRow || batchWarper.isFull()) {
+                numGoodPixels += batchWarper.warp();
+            }
         }              // while next row band
 
     } else {
         // No interpolation
 
-        // prevSrcPosList = source positions from the previous row; these are used to compute pixel area;
-        // to begin, compute sources positions corresponding to destination row = -1
-        std::vector<lsst::geom::Point2D> destPosList;
-        destPosList.reserve(1 + destWidth);
-        for (int col = -1; col < destWidth; ++col) {
-            destPosList.emplace_back(lsst::geom::Point2D(col, -1));
-        }
-        auto prevSrcPosList = localDestToParentSrc->applyForward(destPosList);
-
-        for (int row = 0; row < destHeight; ++row) {
-            destPosList.clear();
-            for (int col = -1; col < destWidth; ++col) {
-                destPosList.emplace_back(lsst::geom::Point2D(col, row));
-            }
-            auto srcPosList = localDestToParentSrc->applyForward(destPosList);
-
-            typename DestImageT::x_iterator destXIter = destImage.row_begin(row);
-            for (int col = 0; col < destWidth; ++col, ++destXIter) {
-                // column index = column + 1 because the first entry in srcPosList is for column -1
-                auto srcPos = srcPosList[col + 1];
-                double relativeArea =
-                        computeRelativeArea(srcPos, prevSrcPosList[col], prevSrcPosList[col + 1]);
-
-                if (warpAtOnePoint(destXIter, srcPos, relativeArea,
-                                   typename image::detail::image_traits<DestImageT>::image_category())) {
-                    ++numGoodPixels;
+        // Transform the destination positions in blocks of whole rows
+        int const rowsPerBlock = std::max(1, SrcPosGrid::BLOCK_SIZE / (destWidth + 1));
+        SrcPosGrid srcPosGrid(*localDestToParentSrc, destWidth);
+        for (int beginRow = 0; beginRow < destHeight; beginRow += rowsPerBlock) {
+            int const endRow = std::min(beginRow + rowsPerBlock, destHeight);
+            srcPosGrid.compute(beginRow, endRow);
+            for (int row = beginRow; row < endRow; ++row) {
+                for (int col = 0; col < destWidth; ++col) {
+                    batchWarper.add(srcPosGrid.getSrcPos(row - beginRow, col),
+                                    srcPosGrid.getRelativeArea(row - beginRow, col));
+                }  // for col
+                if (row == maxRow || batchWarper.isFull()) {
+                    numGoodPixels += batchWarper.warp();
                 }
-            }  // for col
-            // move points from srcPosList to prevSrcPosList (we don't care about what ends up in srcPosList
-            // because it will be reallocated anyway)
-            swap(srcPosList, prevSrcPosList);
-        }  // for row
-    }      // if interp
+            }  // for row
+        }      // for block of rows
+    }          // if interp
 
     return numGoodPixels;
 }
@@ -323,6 +323,7 @@ public:
                     "photoCalib", mapper);
         }
 
+        mapper.require(ExposureTable::makeMinimalSchema());
         auto schema = mapper.finalize();
         std::shared_ptr<ExposureTable> table = ExposureTable::make(schema);
         table->setMetadata(metadata);
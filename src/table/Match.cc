@@ -23,80 +23,122 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cmath>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "lsst/pex/exceptions.h"
 #include "lsst/log/Log.h"
 #include "lsst/geom/Angle.h"
 #include "lsst/afw/table/Match.h"
+#include "lsst/afw/math/detail/Parallel.h"
 
 namespace lsst {
 namespace afw {
 namespace table {
 namespace {
 
-template <typename RecordT>
-struct RecordPos {
-    double dec;
-    double x;
-    double y;
-    double z;
-    // JFB removed extra pointer here; this may have performance implications, but hopefully not
-    // significant ones.  BaseCatalog iterators yield temporary BaseRecord shared_ptrs, so storing
-    // their address was no longer an option.
-    std::shared_ptr<RecordT> src;
-};
-
-template <typename Record1, typename Record2>
-bool operator<(RecordPos<Record1> const &s1, RecordPos<Record2> const &s2) {
-    return (s1.dec < s2.dec);
-}
-
 struct CmpRecordPtr {
     bool operator()(std::shared_ptr<SourceRecord> const s1, std::shared_ptr<SourceRecord> const s2) {
         return s1->getY() < s2->getY();
     }
 };
 
+/// Maximum number of points in a leaf of a RaDecIndex's tree
+std::size_t const LEAF_SIZE = 8;
+
+/// Bound on the depth of a RaDecIndex's tree, which is balanced, so never more than log2 of its size
+int const MAX_DEPTH = 64;
+
 /**
- * @internal Extract source positions from `set`, convert them to cartesian coordinates
- * (for faster distance checks) and sort the resulting array of `RecordPos`
- * instances by declination. Records with positions containing a NaN are skipped.
+ * @internal Compute the unit vector of a position on the sky
  *
- * @param[in] set          set of sources to process
- * @param[out] positions   pointer to an array of at least `set.size()`
- *                         RecordPos instances
- * @returns                 The number of sources with positions not containing a NaN.
+ * @param[in] ra, dec  the position
+ * @param[out] v  the unit vector (x, y, z)
  */
-template <typename Cat>
-size_t makeRecordPositions(Cat const &cat, RecordPos<typename Cat::Record> *positions) {
-    size_t n = 0;
-    Key<lsst::geom::Angle> raKey = Cat::Table::getCoordKey().getRa();
-    Key<lsst::geom::Angle> decKey = Cat::Table::getCoordKey().getDec();
-    for (typename Cat::const_iterator i(cat.begin()), e(cat.end()); i != e; ++i) {
-        lsst::geom::Angle ra = i->get(raKey);
-        lsst::geom::Angle dec = i->get(decKey);
-        if (std::isnan(ra.asRadians()) || std::isnan(dec.asRadians())) {
-            continue;
-        }
-        double cosDec = std::cos(dec);
-        positions[n].dec = dec.asRadians();
-        positions[n].x = std::cos(ra) * cosDec;
-        positions[n].y = std::sin(ra) * cosDec;
-        positions[n].z = std::sin(dec);
-        positions[n].src = i;
-        ++n;
+inline void toUnitVector(lsst::geom::Angle ra, lsst::geom::Angle dec, double *v) {
+    double cosDec = std::cos(dec);
+    v[0] = std::cos(ra) * cosDec;
+    v[1] = std::sin(ra) * cosDec;
+    v[2] = std::sin(dec);
+}
+
+/**
+ * @internal Compute the unit vector of the coordinates of a record.
+ *
+ * @param[in] record  the record
+ * @param[out] v  the unit vector (x, y, z)
+ * @returns false, leaving `v` unset, if the record's coordinates contain a NaN
+ */
+template <typename Record>
+bool getUnitVector(Record const &record, double *v) {
+    lsst::geom::Angle ra = record.get(Record::Table::getCoordKey().getRa());
+    lsst::geom::Angle dec = record.get(Record::Table::getCoordKey().getDec());
+    if (std::isnan(ra.asRadians()) || std::isnan(dec.asRadians())) {
+        return false;
     }
-    std::sort(positions, positions + n);
-    if (n < cat.size()) {
-        LOGLS_WARN("lsst.afw.table.matchRaDec", "At least one source had ra or dec equal to NaN");
+    toUnitVector(ra, dec, v);
+    return true;
+}
+
+void checkMatchRadius(lsst::geom::Angle radius) {
+    if (radius < 0.0 || (radius > (45. * lsst::geom::degrees))) {
+        throw LSST_EXCEPT(pex::exceptions::RangeError, "match radius out of range (0 to 45 degrees)");
     }
-    return n;
 }
 
-template size_t makeRecordPositions(SimpleCatalog const &, RecordPos<SimpleRecord> *);
-template size_t makeRecordPositions(SourceCatalog const &, RecordPos<SourceRecord> *);
+void checkNumThreads(MatchControl const &mc) {
+    if (mc.numThreads < 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "numThreads may not be negative.");
+    }
+}
+
+/// Minimum number of records matched by each thread
+int const MATCH_GRAIN = 1024;
+
+/**
+ * @internal Match the records [0, n) of a catalog in bands, one band per thread.
+ *
+ * @param n  number of records to match
+ * @param numThreads  number of threads, as MatchControl::numThreads
+ * @param matchRange  callable with signature
+ *                    `void(std::size_t begin, std::size_t end, std::vector<MatchT> &matches)`
+ *                    that appends the matches of records [begin, end) to `matches`
+ * @returns the matches of all the bands, concatenated in order, so that they are the same as those
+ *          of `matchRange(0, n, matches)` whatever the number of threads.
+ */
+template <typename MatchT, typename Function>
+std::vector<MatchT> matchInBands(std::size_t n, int numThreads, Function const &matchRange) {
+    if (n > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        numThreads = 1;  // parallelForBands counts with an int
+    }
+    std::vector<std::vector<MatchT>> bandMatches(math::detail::resolveNumThreads(numThreads));
+    if (bandMatches.size() == 1) {
+        matchRange(0, n, bandMatches[0]);
+        return std::move(bandMatches[0]);
+    }
+    math::detail::parallelForBands(static_cast<int>(n), numThreads,
+                                   [&matchRange, &bandMatches](int begin, int end, int iBand) {
+                                       matchRange(begin, end, bandMatches[iBand]);
+                                   },
+                                   MATCH_GRAIN);
+    std::size_t nMatches = 0;
+    for (auto const &band : bandMatches) {
+        nMatches += band.size();
+    }
+    std::vector<MatchT> matches;
+    matches.reserve(nMatches);
+    for (auto &band : bandMatches) {
+        matches.insert(matches.end(), std::make_move_iterator(band.begin()),
+                       std::make_move_iterator(band.end()));
+    }
+    return matches;
+}
 
 template <typename Cat1, typename Cat2>
 bool doSelfMatchIfSame(std::vector<Match<typename Cat1::Record, typename Cat2::Record> > &result,
@@ -143,6 +185,128 @@ lsst::geom::Angle fromUnitSphereDistanceSquared(double d2) noexcept {
 
 }  // namespace
 
+template <typename Cat>
+RaDecIndex<Cat>::RaDecIndex(Cat const &cat) : _depth(0) {
+    _records.reserve(cat.size());
+    _points.reserve(cat.size());
+    for (typename Cat::const_iterator i(cat.begin()), e(cat.end()); i != e; ++i) {
+        Point point;
+        if (!getUnitVector(*i, point.v)) {
+            continue;
+        }
+        point.index = _records.size();
+        _points.push_back(point);
+        _records.push_back(i);
+    }
+    if (_records.size() < cat.size()) {
+        LOGLS_WARN("lsst.afw.table.matchRaDec", "At least one source had ra or dec equal to NaN");
+    }
+    if (!_points.empty()) {
+        _nodes.reserve(4 * (_points.size() / LEAF_SIZE + 1));
+        _build(0, _points.size(), 0);
+    }
+}
+
+template <typename Cat>
+int RaDecIndex<Cat>::_build(std::size_t begin, std::size_t end, int depth) {
+    int const index = _nodes.size();
+    _nodes.emplace_back();
+    _depth = std::max(_depth, depth);
+
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    node.left = -1;
+    node.right = -1;
+    for (int k = 0; k < 3; ++k) {
+        node.min[k] = std::numeric_limits<double>::infinity();
+        node.max[k] = -std::numeric_limits<double>::infinity();
+    }
+    for (std::size_t i = begin; i < end; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            node.min[k] = std::min(node.min[k], _points[i].v[k]);
+            node.max[k] = std::max(node.max[k], _points[i].v[k]);
+        }
+    }
+    if (end - begin > LEAF_SIZE) {
+        // split at the median along the axis of greatest extent
+        int axis = 0;
+        for (int k = 1; k < 3; ++k) {
+            if (node.max[k] - node.min[k] > node.max[axis] - node.min[axis]) {
+                axis = k;
+            }
+        }
+        std::size_t const mid = begin + (end - begin) / 2;
+        std::nth_element(_points.begin() + begin, _points.begin() + mid, _points.begin() + end,
+                         [axis](Point const &a, Point const &b) { return a.v[axis] < b.v[axis]; });
+        node.left = _build(begin, mid, depth + 1);
+        node.right = _build(mid, end, depth + 1);
+    }
+    // _nodes may have been reallocated by the recursion, so don't hold a reference across it
+    _nodes[index] = node;
+    return index;
+}
+
+template <typename Cat>
+void RaDecIndex<Cat>::findNear(double x, double y, double z, double d2Limit,
+                               std::vector<std::pair<std::size_t, double>> &found) const {
+    if (_nodes.empty()) {
+        return;
+    }
+    assert(_depth < MAX_DEPTH);
+    double const q[3] = {x, y, z};
+    // depth-first search; the stack holds at most one pending node per level of the tree
+    int stack[MAX_DEPTH + 1];
+    int nStack = 0;
+    stack[nStack++] = 0;
+    while (nStack > 0) {
+        Node const &node = _nodes[stack[--nStack]];
+        double d2Box = 0.0;  // squared distance from q to the node's bounding box
+        for (int k = 0; k < 3; ++k) {
+            double const d = std::max({node.min[k] - q[k], q[k] - node.max[k], 0.0});
+            d2Box += d * d;
+        }
+        if (d2Box >= d2Limit) {
+            continue;
+        }
+        if (node.left >= 0) {
+            stack[nStack++] = node.right;
+            stack[nStack++] = node.left;
+            continue;
+        }
+        for (std::size_t i = node.begin; i < node.end; ++i) {
+            Point const &point = _points[i];
+            double dx = x - point.v[0];
+            double dy = y - point.v[1];
+            double dz = z - point.v[2];
+            double d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 < d2Limit) {
+                found.emplace_back(point.index, d2);
+            }
+        }
+    }
+}
+
+template <typename Cat>
+std::vector<std::shared_ptr<typename Cat::Record>> RaDecIndex<Cat>::findWithin(
+        lsst::geom::SpherePoint const &coord, lsst::geom::Angle radius) const {
+    checkMatchRadius(radius);
+    double v[3];
+    toUnitVector(coord.getLongitude(), coord.getLatitude(), v);
+    std::vector<std::pair<std::size_t, double>> found;
+    findNear(v[0], v[1], v[2], toUnitSphereDistanceSquared(radius), found);
+    std::sort(found.begin(), found.end());
+    std::vector<std::shared_ptr<Record>> result;
+    result.reserve(found.size());
+    for (auto const &indexAndDistance : found) {
+        result.push_back(_records[indexAndDistance.first]);
+    }
+    return result;
+}
+
+template class RaDecIndex<SimpleCatalog>;
+template class RaDecIndex<SourceCatalog>;
+
 template <typename Cat1, typename Cat2>
 std::vector<Match<typename Cat1::Record, typename Cat2::Record> > matchRaDec(Cat1 const &cat1,
                                                                              Cat2 const &cat2,
@@ -159,75 +323,79 @@ std::vector<Match<typename Cat1::Record, typename Cat2::Record> > matchRaDec(Cat
                                                                              Cat2 const &cat2,
                                                                              lsst::geom::Angle radius,
                                                                              MatchControl const &mc) {
-    using MatchT = Match<typename Cat1::Record, typename Cat2::Record>;
-    std::vector<MatchT> matches;
+    std::vector<Match<typename Cat1::Record, typename Cat2::Record> > matches;
 
     if (doSelfMatchIfSame(matches, cat1, cat2, radius)) return matches;
 
-    if (radius < 0.0 || (radius > (45. * lsst::geom::degrees))) {
-        throw LSST_EXCEPT(pex::exceptions::RangeError, "match radius out of range (0 to 45 degrees)");
-    }
+    checkMatchRadius(radius);
+    checkNumThreads(mc);
     if (cat1.size() == 0 || cat2.size() == 0) {
         return matches;
     }
+    return matchRaDec(cat1, RaDecIndex<Cat2>(cat2), radius, mc);
+}
+
+template <typename Cat1, typename Cat2>
+std::vector<Match<typename Cat1::Record, typename Cat2::Record> > matchRaDec(Cat1 const &cat1,
+                                                                             RaDecIndex<Cat2> const &index2,
+                                                                             lsst::geom::Angle radius,
+                                                                             MatchControl const &mc) {
+    using MatchT = Match<typename Cat1::Record, typename Cat2::Record>;
+    std::vector<MatchT> matches;
+
+    checkMatchRadius(radius);
+    checkNumThreads(mc);
+    if (cat1.size() == 0 || index2.size() == 0) {
+        return matches;
+    }
     // setup match parameters
     double const d2Limit = toUnitSphereDistanceSquared(radius);
 
-    // Build position lists
-    size_t len1 = cat1.size();
-    size_t len2 = cat2.size();
-
-    using Pos1 = RecordPos<typename Cat1::Record>;
-    using Pos2 = RecordPos<typename Cat2::Record>;
-    std::unique_ptr<Pos1[]> pos1(new Pos1[len1]);
-    std::unique_ptr<Pos2[]> pos2(new Pos2[len2]);
-    len1 = makeRecordPositions(cat1, pos1.get());
-    len2 = makeRecordPositions(cat2, pos2.get());
     std::shared_ptr<typename Cat2::Record> nullRecord = std::shared_ptr<typename Cat2::Record>();
-
-    for (size_t i = 0, start = 0; i < len1; ++i) {
-        double minDec = pos1[i].dec - radius.asRadians();
-        while (start < len2 && pos2[start].dec < minDec) {
-            ++start;
-        }
-        if (start == len2) {
-            break;
-        }
-        double maxDec = pos1[i].dec + radius.asRadians();
-        size_t closestIndex = -1;    // Index of closest match (if any)
-        double d2Include = d2Limit;  // Squared distance for inclusion of match
-        bool found = false;          // Found anything?
-        size_t nMatches = 0;         // Number of matches
-        for (size_t j = start; j < len2 && pos2[j].dec <= maxDec; ++j) {
-            double dx = pos1[i].x - pos2[j].x;
-            double dy = pos1[i].y - pos2[j].y;
-            double dz = pos1[i].z - pos2[j].z;
-            double d2 = dx * dx + dy * dy + dz * dz;
-            if (d2 < d2Include) {
-                if (mc.findOnlyClosest) {
-                    d2Include = d2;
-                    closestIndex = j;
-                    found = true;
-                } else {
-                    matches.push_back(MatchT(pos1[i].src, pos2[j].src, fromUnitSphereDistanceSquared(d2)));
+    std::atomic<bool> foundNan(false);
+    auto matchRange = [&](std::size_t begin, std::size_t end, std::vector<MatchT> &bandMatches) {
+        std::vector<std::pair<std::size_t, double>> found;  // index in index2 and squared distance
+        for (std::size_t i = begin; i < end; ++i) {
+            std::shared_ptr<typename Cat1::Record> record1 = cat1.get(i);
+            double v[3];
+            if (!getUnitVector(*record1, v)) {
+                foundNan = true;
+                continue;
+            }
+            found.clear();
+            index2.findNear(v[0], v[1], v[2], d2Limit, found);
+            if (found.empty()) {
+                if (mc.includeMismatches) {
+                    bandMatches.push_back(MatchT(record1, nullRecord, NAN));
+                }
+            } else if (mc.findOnlyClosest) {
+                // ties go to the record that comes first in the second catalog
+                auto closest =
+                        std::min_element(found.begin(), found.end(), [](auto const &a, auto const &b) {
+                            return a.second < b.second || (a.second == b.second && a.first < b.first);
+                        });
+                bandMatches.push_back(MatchT(record1, index2.getRecord(closest->first),
+                                             fromUnitSphereDistanceSquared(closest->second)));
+            } else {
+                std::sort(found.begin(), found.end());
+                for (auto const &indexAndDistance : found) {
+                    bandMatches.push_back(MatchT(record1, index2.getRecord(indexAndDistance.first),
+                                                 fromUnitSphereDistanceSquared(indexAndDistance.second)));
                 }
-                ++nMatches;
             }
         }
-        if (mc.includeMismatches && nMatches == 0) {
-            matches.push_back(MatchT(pos1[i].src, nullRecord, NAN));
-        }
-        if (mc.findOnlyClosest && found) {
-            matches.push_back(
-                    MatchT(pos1[i].src, pos2[closestIndex].src, fromUnitSphereDistanceSquared(d2Include)));
-        }
+    };
+    matches = matchInBands<MatchT>(cat1.size(), mc.numThreads, matchRange);
+    if (foundNan) {
+        LOGLS_WARN("lsst.afw.table.matchRaDec", "At least one source had ra or dec equal to NaN");
     }
     return matches;
 }
 
-#define LSST_MATCH_RADEC(RTYPE, C1, C2)                                         \
-    template RTYPE matchRaDec(C1 const &, C2 const &, lsst::geom::Angle, bool); \
-    template RTYPE matchRaDec(C1 const &, C2 const &, lsst::geom::Angle, MatchControl const &)
+#define LSST_MATCH_RADEC(RTYPE, C1, C2)                                                        \
+    template RTYPE matchRaDec(C1 const &, C2 const &, lsst::geom::Angle, bool);                \
+    template RTYPE matchRaDec(C1 const &, C2 const &, lsst::geom::Angle, MatchControl const &); \
+    template RTYPE matchRaDec(C1 const &, RaDecIndex<C2> const &, lsst::geom::Angle, MatchControl const &)
 
 LSST_MATCH_RADEC(SimpleMatchVector, SimpleCatalog, SimpleCatalog);
 LSST_MATCH_RADEC(ReferenceMatchVector, SimpleCatalog, SourceCatalog);
@@ -252,38 +420,40 @@ std::vector<Match<typename Cat::Record, typename Cat::Record> > matchRaDec(Cat c
     using MatchT = Match<typename Cat::Record, typename Cat::Record>;
     std::vector<MatchT> matches;
 
-    if (radius < 0.0 || radius > (45.0 * lsst::geom::degrees)) {
-        throw LSST_EXCEPT(pex::exceptions::RangeError, "match radius out of range (0 to 45 degrees)");
-    }
+    checkMatchRadius(radius);
+    checkNumThreads(mc);
     if (cat.size() == 0) {
         return matches;
     }
     // setup match parameters
     double const d2Limit = toUnitSphereDistanceSquared(radius);
 
-    // Build position list
-    size_t len = cat.size();
-    using Pos = RecordPos<typename Cat::Record>;
-    std::unique_ptr<Pos[]> pos(new Pos[len]);
-    len = makeRecordPositions(cat, pos.get());
-
-    for (size_t i = 0; i < len; ++i) {
-        double maxDec = pos[i].dec + radius.asRadians();
-        for (size_t j = i + 1; j < len && pos[j].dec <= maxDec; ++j) {
-            double dx = pos[i].x - pos[j].x;
-            double dy = pos[i].y - pos[j].y;
-            double dz = pos[i].z - pos[j].z;
-            double d2 = dx * dx + dy * dy + dz * dz;
-            if (d2 < d2Limit) {
-                lsst::geom::Angle d = fromUnitSphereDistanceSquared(d2);
-                matches.push_back(MatchT(pos[i].src, pos[j].src, d));
+    RaDecIndex<Cat> index(cat);
+    auto matchRange = [&](std::size_t begin, std::size_t end, std::vector<MatchT> &bandMatches) {
+        std::vector<std::pair<std::size_t, double>> found;  // index and squared distance
+        for (std::size_t i = begin; i < end; ++i) {
+            std::shared_ptr<typename Cat::Record> const &record = index.getRecord(i);
+            double v[3];
+            getUnitVector(*record, v);
+            found.clear();
+            index.findNear(v[0], v[1], v[2], d2Limit, found);
+            std::sort(found.begin(), found.end());
+            for (auto const &indexAndDistance : found) {
+                // each pair is found twice; keep it once
+                if (indexAndDistance.first <= i) {
+                    continue;
+                }
+                std::shared_ptr<typename Cat::Record> const &record2 =
+                        index.getRecord(indexAndDistance.first);
+                lsst::geom::Angle d = fromUnitSphereDistanceSquared(indexAndDistance.second);
+                bandMatches.push_back(MatchT(record, record2, d));
                 if (mc.symmetricMatch) {
-                    matches.push_back(MatchT(pos[j].src, pos[i].src, d));
+                    bandMatches.push_back(MatchT(record2, record, d));
                 }
             }
         }
-    }
-    return matches;
+    };
+    return matchInBands<MatchT>(index.size(), mc.numThreads, matchRange);
 }
 
 #define LSST_MATCH_RADEC(RTYPE, C)                                 \
@@ -307,6 +477,7 @@ SourceMatchVector matchXy(SourceCatalog const &cat1, SourceCatalog const &cat2,
     if (&cat1 == &cat2) {
         return matchXy(cat1, radius);
     }
+    checkNumThreads(mc);
     // setup match parameters
     double const r2 = radius * radius;
 
@@ -338,46 +509,53 @@ SourceMatchVector matchXy(SourceCatalog const &cat1, SourceCatalog const &cat2,
     std::sort(pos1.get(), pos1.get() + len1, CmpRecordPtr());
     std::sort(pos2.get(), pos2.get() + len2, CmpRecordPtr());
 
-    SourceMatchVector matches;
-    for (size_t i = 0, start = 0; i < len1; ++i) {
-        double y = pos1[i]->getY();
-        double minY = y - radius;
-        while (start < len2 && pos2[start]->getY() < minY) {
-            ++start;
+    auto matchRange = [&](std::size_t begin, std::size_t end, SourceMatchVector &matches) {
+        if (begin == end) {
+            return;
         }
-        if (start == len2) {
-            break;
-        }
-        double x = pos1[i]->getX();
-        double maxY = y + radius;
-        double y2;
-        size_t closestIndex = -1;  // Index of closest match (if any)
-        double r2Include = r2;     // Squared radius for inclusion of match
-        bool found = false;        // Found anything?
-        size_t nMatches = 0;       // Number of matches
-        for (size_t j = start; j < len2 && (y2 = pos2[j]->getY()) <= maxY; ++j) {
-            double dx = x - pos2[j]->getX();
-            double dy = y - y2;
-            double d2 = dx * dx + dy * dy;
-            if (d2 < r2Include) {
-                if (mc.findOnlyClosest) {
-                    r2Include = d2;
-                    closestIndex = j;
-                    found = true;
-                } else {
-                    matches.push_back(SourceMatch(pos1[i], pos2[j], std::sqrt(d2)));
+        // first candidate for pos1[begin]; it only increases with i
+        size_t start = std::lower_bound(pos2.get(), pos2.get() + len2, pos1[begin]->getY() - radius,
+                                        [](std::shared_ptr<SourceRecord> const &s, double y) {
+                                            return s->getY() < y;
+                                        }) -
+                       pos2.get();
+        for (size_t i = begin; i < end; ++i) {
+            double y = pos1[i]->getY();
+            double minY = y - radius;
+            while (start < len2 && pos2[start]->getY() < minY) {
+                ++start;
+            }
+            double x = pos1[i]->getX();
+            double maxY = y + radius;
+            double y2;
+            size_t closestIndex = -1;  // Index of closest match (if any)
+            double r2Include = r2;     // Squared radius for inclusion of match
+            bool found = false;        // Found anything?
+            size_t nMatches = 0;       // Number of matches
+            for (size_t j = start; j < len2 && (y2 = pos2[j]->getY()) <= maxY; ++j) {
+                double dx = x - pos2[j]->getX();
+                double dy = y - y2;
+                double d2 = dx * dx + dy * dy;
+                if (d2 < r2Include) {
+                    if (mc.findOnlyClosest) {
+                        r2Include = d2;
+                        closestIndex = j;
+                        found = true;
+                    } else {
+                        matches.push_back(SourceMatch(pos1[i], pos2[j], std::sqrt(d2)));
+                    }
+                    ++nMatches;
                 }
-                ++nMatches;
+            }
+            if (mc.includeMismatches && nMatches == 0) {
+                matches.push_back(SourceMatch(pos1[i], nullRecord, NAN));
+            }
+            if (mc.findOnlyClosest && found) {
+                matches.push_back(SourceMatch(pos1[i], pos2[closestIndex], std::sqrt(r2Include)));
             }
         }
-        if (mc.includeMismatches && nMatches == 0) {
-            matches.push_back(SourceMatch(pos1[i], nullRecord, NAN));
-        }
-        if (mc.findOnlyClosest && found) {
-            matches.push_back(SourceMatch(pos1[i], pos2[closestIndex], std::sqrt(r2Include)));
-        }
-    }
-    return matches;
+    };
+    return matchInBands<SourceMatch>(len1, mc.numThreads, matchRange);
 }
 
 SourceMatchVector matchXy(SourceCatalog const &cat, double radius, bool symmetric) {
@@ -388,6 +566,7 @@ SourceMatchVector matchXy(SourceCatalog const &cat, double radius, bool symmetri
 }
 
 SourceMatchVector matchXy(SourceCatalog const &cat, double radius, MatchControl const &mc) {
+    checkNumThreads(mc);
     // setup match parameters
     double const r2 = radius * radius;
 
@@ -406,26 +585,27 @@ SourceMatchVector matchXy(SourceCatalog const &cat, double radius, MatchControl
 
     std::sort(pos.get(), pos.get() + len, CmpRecordPtr());
 
-    SourceMatchVector matches;
-    for (size_t i = 0; i < len; ++i) {
-        double x = pos[i]->getX();
-        double y = pos[i]->getY();
-        double maxY = y + radius;
-        double y2;
-        for (size_t j = i + 1; j < len && (y2 = pos[j]->getY()) <= maxY; ++j) {
-            double dx = x - pos[j]->getX();
-            double dy = y - y2;
-            double d2 = dx * dx + dy * dy;
-            if (d2 < r2) {
-                double d = std::sqrt(d2);
-                matches.push_back(SourceMatch(pos[i], pos[j], d));
-                if (mc.symmetricMatch) {
-                    matches.push_back(SourceMatch(pos[j], pos[i], d));
+    auto matchRange = [&](std::size_t begin, std::size_t end, SourceMatchVector &matches) {
+        for (size_t i = begin; i < end; ++i) {
+            double x = pos[i]->getX();
+            double y = pos[i]->getY();
+            double maxY = y + radius;
+            double y2;
+            for (size_t j = i + 1; j < len && (y2 = pos[j]->getY()) <= maxY; ++j) {
+                double dx = x - pos[j]->getX();
+                double dy = y - y2;
+                double d2 = dx * dx + dy * dy;
+                if (d2 < r2) {
+                    double d = std::sqrt(d2);
+                    matches.push_back(SourceMatch(pos[i], pos[j], d));
+                    if (mc.symmetricMatch) {
+                        matches.push_back(SourceMatch(pos[j], pos[i], d));
+                    }
                 }
             }
         }
-    }
-    return matches;
+    };
+    return matchInBands<SourceMatch>(len, mc.numThreads, matchRange);
 }
 
 template <typename Record1, typename Record2>
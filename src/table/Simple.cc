@@ -55,6 +55,7 @@ public:
     std::shared_ptr<BaseTable> makeTable(io::FitsSchemaInputMapper& mapper,
                                          std::shared_ptr<daf::base::PropertyList> metadata, int ioFlags,
                                          bool stripMetadata) const override {
+        mapper.require(SimpleTable::makeMinimalSchema());
         std::shared_ptr<SimpleTable> table = SimpleTable::make(mapper.finalize());
         table->setMetadata(metadata);
         return table;
@@ -346,6 +346,7 @@ public:
         // Look for new-style persistence of Footprints.  We'll only read them if we have an archive,
         // but we'll strip fields out regardless.
         SourceFootprintReader::setup(mapper, ioFlags);
+        mapper.require(SourceTable::makeMinimalSchema());
         std::shared_ptr<SourceTable> table = SourceTable::make(mapper.finalize());
         table->setMetadata(metadata);
         return table;
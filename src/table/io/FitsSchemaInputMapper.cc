@@ -4,9 +4,13 @@
 #include <cmath>
 #include <cstdint>
 #include <string>
+#include <vector>
 #include <algorithm>
 #include <cctype>
+#include <iterator>
+#include <numeric>
 #include <regex>
+#include <set>
 
 #include "boost/multi_index_container.hpp"
 #include "boost/multi_index/sequenced_index.hpp"
@@ -71,6 +75,23 @@ public:
 
     Impl()  {}
 
+    // Remove the items that are not selected, and the aliases that no longer point to any item.
+    void selectItems();
+
+    // Find the flag bits and columns of the row filter's fields.
+    void resolveRowFilter();
+
+    // A condition on a flag bit, or on the value of a scalar numeric column.
+    struct FlagCondition {
+        std::size_t bit;
+        bool value;
+    };
+    struct RangeCondition {
+        int column;
+        double min;
+        double max;
+    };
+
     int version{0};
     std::string type;
     int flagColumn{0};
@@ -79,6 +100,16 @@ public:
     std::vector<std::unique_ptr<FitsColumnReader>> readers;
     std::vector<Key<Flag>> flagKeys;
     std::unique_ptr<bool[]> flagWorkspace;
+    std::vector<std::uint8_t> flagBlock;
+    std::vector<std::string> selection;
+    std::vector<std::string> required;
+    FitsReadOptions rowFilter;
+    std::vector<FlagCondition> flagConditions;
+    std::vector<RangeCondition> rangeConditions;
+    std::size_t nFlags = 0;
+    std::vector<char> rowPasses;
+    std::vector<double> rangeBlock;
+    std::vector<std::size_t> rowWorkspace;
     std::shared_ptr<io::InputArchive> archive;
     InputContainer inputs;
     std::size_t nRowsToPrep = 1;
@@ -279,6 +310,7 @@ FitsSchemaInputMapper::FitsSchemaInputMapper(daf::base::PropertyList &metadata,
             nFlags = std::stoi(m[1].str());
         }
         _impl->flagKeys.resize(nFlags);
+        _impl->nFlags = nFlags;
         _impl->flagWorkspace.reset(new bool[nFlags]);
         // Delete the flag column from the input list so we don't interpret it as a
         // regular field.
@@ -356,6 +388,39 @@ void FitsSchemaInputMapper::customize(std::unique_ptr<FitsColumnReader> reader)
 
 namespace {
 
+// The values of a fixed-size column for a block of consecutive rows, read with a single CFITSIO
+// call.  Both FITS binary tables and CFITSIO are row-major, so the nElements values of each row
+// are contiguous in the block.
+template <typename T>
+class ColumnBlock {
+public:
+    explicit ColumnBlock(std::size_t nElements) : _nElements(nElements), _firstRow(0) {}
+
+    void read(fits::Fits &fits, int column, std::size_t firstRow, std::size_t nRows) {
+        _values.resize(nRows * _nElements);
+        _firstRow = firstRow;
+        fits.readTableArray(firstRow, column, _values.size(), _values.data());
+    }
+
+    // Return the values of a row: from the block if one has been read, or else by reading just
+    // that row into buffer (which must have room for nElements values).
+    T const *getRow(fits::Fits &fits, int column, std::size_t row, T *buffer) const {
+        if (_values.empty()) {
+            fits.readTableArray(row, column, _nElements, buffer);
+            return buffer;
+        }
+        assert(row >= _firstRow);
+        std::size_t offset = (row - _firstRow) * _nElements;
+        assert(offset < _values.size());
+        return _values.data() + offset;
+    }
+
+private:
+    std::size_t _nElements;
+    std::vector<T> _values;
+    std::size_t _firstRow;
+};
+
 template <typename T>
 class StandardReader : public FitsColumnReader {
 public:
@@ -366,39 +431,26 @@ public:
 
     StandardReader(Schema &schema, FitsSchemaItem const &item, FieldBase<T> const &base)
             : _column(item.column), _key(schema.addField<T>(item.ttype, item.doc, item.tunit, base)),
-              _cache(), _cacheFirstRow(0)
+              _block(_key.getElementCount())
     {}
 
     void prepRead(std::size_t firstRow, std::size_t nRows, fits::Fits & fits) override {
-        // We only prep and cache scalar-valued columns, not array-valued
-        // columns, as apparently the order CFITSIO reads array-valued columns
-        // is not the order we want.
-        if (_key.getElementCount() == 1u) {
-            std::size_t nElements = nRows*_key.getElementCount();
-            _cache.resize(nElements);
-            _cacheFirstRow = firstRow;
-            fits.readTableArray(firstRow, _column, nElements, &_cache.front());
-        }
+        _block.read(fits, _column, firstRow, nRows);
     }
 
     void readCell(BaseRecord &record, std::size_t row, afw::fits::Fits &fits,
                   std::shared_ptr<InputArchive> const &archive) const override {
-        if (_cache.empty()) {
-            fits.readTableArray(row, _column, _key.getElementCount(), record.getElement(_key));
-        } else {
-            assert(row >= _cacheFirstRow);
-            std::size_t offset = row - _cacheFirstRow;
-            assert(offset < _cache.size());
-            std::copy_n(_cache.begin() + offset, _key.getElementCount(), record.getElement(_key));
+        typename FieldBase<T>::Element *element = record.getElement(_key);
+        typename FieldBase<T>::Element const *values = _block.getRow(fits, _column, row, element);
+        if (values != element) {
+            std::copy_n(values, _key.getElementCount(), element);
         }
     }
 
 private:
     int _column;
     Key<T> _key;
-    std::vector<typename FieldBase<T>::Element> _cache;
-    std::size_t _cacheFirstRow;
-    std::size_t _nRowsToPrep;
+    ColumnBlock<typename FieldBase<T>::Element> _block;
 };
 
 class AngleReader : public FitsColumnReader {
@@ -410,7 +462,8 @@ public:
     }
 
     AngleReader(Schema &schema, FitsSchemaItem const &item, FieldBase<lsst::geom::Angle> const &base)
-            : _column(item.column), _key(schema.addField<lsst::geom::Angle>(item.ttype, item.doc, "", base)) {
+            : _column(item.column), _key(schema.addField<lsst::geom::Angle>(item.ttype, item.doc, "", base)),
+              _block(1) {
         // We require an LSST-specific key in the headers before parsing a column
         // as Angle at all, so we don't need to worry about other units or other
         // spellings of radians.  We do continue to support no units for backwards
@@ -423,30 +476,19 @@ public:
 
     void prepRead(std::size_t firstRow, std::size_t nRows, fits::Fits & fits) override {
         assert(_key.getElementCount() == 1u);
-        _cache.resize(nRows);
-        _cacheFirstRow = firstRow;
-        fits.readTableArray(firstRow, _column, nRows, &_cache.front());
+        _block.read(fits, _column, firstRow, nRows);
     }
 
     void readCell(BaseRecord &record, std::size_t row, afw::fits::Fits &fits,
                   std::shared_ptr<InputArchive> const &archive) const override {
-        if (_cache.empty()) {
-            double tmp = 0;
-            fits.readTableScalar(row, _column, tmp);
-            record.set(_key, tmp * lsst::geom::radians);
-        } else {
-            assert(row >= _cacheFirstRow);
-            std::size_t offset = row - _cacheFirstRow;
-            assert(offset < _cache.size());
-            record.set(_key, _cache[offset] * lsst::geom::radians);
-        }
+        double buffer = 0;
+        record.set(_key, *_block.getRow(fits, _column, row, &buffer) * lsst::geom::radians);
     }
 
 private:
     int _column;
     Key<lsst::geom::Angle> _key;
-    std::vector<double> _cache;
-    std::size_t _cacheFirstRow;
+    ColumnBlock<double> _block;
 };
 
 class StringReader : public FitsColumnReader {
@@ -506,18 +548,24 @@ public:
     }
 
     PointConversionReader(Schema &schema, FitsSchemaItem const &item)
-            : _column(item.column), _key(PointKey<T>::addFields(schema, item.ttype, item.doc, item.tunit)) {}
+            : _column(item.column), _key(PointKey<T>::addFields(schema, item.ttype, item.doc, item.tunit)),
+              _block(2) {}
+
+    void prepRead(std::size_t firstRow, std::size_t nRows, fits::Fits & fits) override {
+        _block.read(fits, _column, firstRow, nRows);
+    }
 
     void readCell(BaseRecord &record, std::size_t row, afw::fits::Fits &fits,
                   std::shared_ptr<InputArchive> const &archive) const override {
         std::array<T, 2> buffer;
-        fits.readTableArray(row, _column, 2, buffer.data());
-        record.set(_key, lsst::geom::Point<T, 2>(buffer[0], buffer[1]));
+        T const *values = _block.getRow(fits, _column, row, buffer.data());
+        record.set(_key, lsst::geom::Point<T, 2>(values[0], values[1]));
     }
 
 private:
     int _column;
     PointKey<T> _key;
+    ColumnBlock<T> _block;
 };
 
 // Read a 2-element FITS array column as separate ra and dec Schema fields (hence converting
@@ -529,18 +577,23 @@ public:
     }
 
     CoordConversionReader(Schema &schema, FitsSchemaItem const &item)
-            : _column(item.column), _key(CoordKey::addFields(schema, item.ttype, item.doc)) {}
+            : _column(item.column), _key(CoordKey::addFields(schema, item.ttype, item.doc)), _block(2) {}
+
+    void prepRead(std::size_t firstRow, std::size_t nRows, fits::Fits & fits) override {
+        _block.read(fits, _column, firstRow, nRows);
+    }
 
     void readCell(BaseRecord &record, std::size_t row, afw::fits::Fits &fits,
                   std::shared_ptr<InputArchive> const &archive) const override {
         std::array<lsst::geom::Angle, 2> buffer;
-        fits.readTableArray(row, _column, 2, buffer.data());
-        record.set(_key, lsst::geom::SpherePoint(buffer[0], buffer[1]));
+        lsst::geom::Angle const *values = _block.getRow(fits, _column, row, buffer.data());
+        record.set(_key, lsst::geom::SpherePoint(values[0], values[1]));
     }
 
 private:
     int _column;
     CoordKey _key;
+    ColumnBlock<lsst::geom::Angle> _block;
 };
 
 // Read a 3-element FITS array column as separate xx, yy, and xy Schema fields (hence converting
@@ -553,18 +606,24 @@ public:
 
     MomentsConversionReader(Schema &schema, FitsSchemaItem const &item)
             : _column(item.column),
-              _key(QuadrupoleKey::addFields(schema, item.ttype, item.doc, CoordinateType::PIXEL)) {}
+              _key(QuadrupoleKey::addFields(schema, item.ttype, item.doc, CoordinateType::PIXEL)),
+              _block(3) {}
+
+    void prepRead(std::size_t firstRow, std::size_t nRows, fits::Fits & fits) override {
+        _block.read(fits, _column, firstRow, nRows);
+    }
 
     void readCell(BaseRecord &record, std::size_t row, afw::fits::Fits &fits,
                   std::shared_ptr<InputArchive> const &archive) const override {
         std::array<double, 3> buffer;
-        fits.readTableArray(row, _column, 3, buffer.data());
-        record.set(_key, geom::ellipses::Quadrupole(buffer[0], buffer[1], buffer[2], false));
+        double const *values = _block.getRow(fits, _column, row, buffer.data());
+        record.set(_key, geom::ellipses::Quadrupole(values[0], values[1], values[2], false));
     }
 
 private:
     int _column;
     QuadrupoleKey _key;
+    ColumnBlock<double> _block;
 };
 
 // Read a FITS array column representing a packed symmetric matrix into
@@ -594,14 +653,19 @@ public:
             : _column(item.column),
               _size(names.size()),
               _key(CovarianceMatrixKey<T, N>::addFields(schema, item.ttype, names, guessUnits(item.tunit))),
-              _buffer(new T[detail::computeCovariancePackedSize(names.size())]) {}
+              _buffer(new T[detail::computeCovariancePackedSize(names.size())]),
+              _block(detail::computeCovariancePackedSize(names.size())) {}
+
+    void prepRead(std::size_t firstRow, std::size_t nRows, fits::Fits & fits) override {
+        _block.read(fits, _column, firstRow, nRows);
+    }
 
     void readCell(BaseRecord &record, std::size_t row, afw::fits::Fits &fits,
                   std::shared_ptr<InputArchive> const &archive) const override {
-        fits.readTableArray(row, _column, detail::computeCovariancePackedSize(_size), _buffer.get());
+        T const *values = _block.getRow(fits, _column, row, _buffer.get());
         for (int i = 0; i < _size; ++i) {
             for (int j = i; j < _size; ++j) {
-                _key.setElement(record, i, j, _buffer[detail::indexCovariance(i, j)]);
+                _key.setElement(record, i, j, values[detail::indexCovariance(i, j)]);
             }
         }
     }
@@ -611,6 +675,7 @@ private:
     int _size;
     CovarianceMatrixKey<T, N> _key;
     std::unique_ptr<T[]> _buffer;
+    ColumnBlock<T> _block;
 };
 
 std::unique_ptr<FitsColumnReader> makeColumnReader(Schema &schema, FitsSchemaItem const &item) {
@@ -766,8 +831,107 @@ std::string replace(std::string full, std::string const & from, std::string cons
     return full.replace(full.find(from), from.size(), to);
 }
 
+// Return true if 'name' is 'prefix', or starts with 'prefix' followed by an underscore.
+bool isFieldOrSubfield(std::string const &name, std::string const &prefix) {
+    return name.compare(0, prefix.size(), prefix) == 0 &&
+           (name.size() == prefix.size() || name[prefix.size()] == '_');
+}
+
 }  // namespace
 
+void FitsSchemaInputMapper::select(std::vector<std::string> const &names) { _impl->selection = names; }
+
+void FitsSchemaInputMapper::require(Schema const &schema) {
+    std::set<std::string> names = schema.getNames();
+    _impl->required.insert(_impl->required.end(), names.begin(), names.end());
+}
+
+void FitsSchemaInputMapper::Impl::selectItems() {
+    AliasMap &aliases = *schema.getAliasMap();
+    std::vector<std::string> prefixes;
+    prefixes.reserve(selection.size());
+    for (auto const &name : selection) {
+        prefixes.push_back(aliases.apply(name));
+    }
+    std::vector<bool> used(prefixes.size(), false);
+    for (auto iter = asList().begin(); iter != asList().end();) {
+        bool selected = std::find(required.begin(), required.end(), iter->ttype) != required.end();
+        for (std::size_t i = 0; i < prefixes.size(); ++i) {
+            if (isFieldOrSubfield(iter->ttype, prefixes[i])) {
+                selected = true;
+                used[i] = true;
+            }
+        }
+        iter = selected ? std::next(iter) : asList().erase(iter);
+    }
+    for (std::size_t i = 0; i < prefixes.size(); ++i) {
+        if (!used[i]) {
+            throw LSST_EXCEPT(pex::exceptions::NotFoundError,
+                              (boost::format("No column matches selected field '%s'") %
+                               selection[i]).str());
+        }
+    }
+    // Drop the aliases that no longer point to any field; aliases do partial matches, so an
+    // alias's target need only be the start of a field name.
+    std::vector<std::string> unused;
+    for (auto const &alias : aliases) {
+        std::string const target = aliases.apply(alias.first);
+        bool found = std::any_of(asList().begin(), asList().end(),
+                                 [&target](FitsSchemaItem const &item) {
+                                     return item.ttype.compare(0, target.size(), target) == 0;
+                                 });
+        if (!found) {
+            unused.push_back(alias.first);
+        }
+    }
+    for (auto const &alias : unused) {
+        aliases.erase(alias);
+    }
+}
+
+void FitsSchemaInputMapper::setRowFilter(FitsReadOptions const &options) {
+    _impl->rowFilter.unsetFlags = options.unsetFlags;
+    _impl->rowFilter.setFlags = options.setFlags;
+    _impl->rowFilter.valueRanges = options.valueRanges;
+}
+
+void FitsSchemaInputMapper::Impl::resolveRowFilter() {
+    AliasMap const &aliases = *schema.getAliasMap();
+    auto findItem = [this, &aliases](std::string const &name) -> FitsSchemaItem const & {
+        auto iter = byName().find(aliases.apply(name));
+        if (iter == byName().end()) {
+            throw LSST_EXCEPT(pex::exceptions::NotFoundError,
+                              (boost::format("No column for row filter field '%s'") % name).str());
+        }
+        return *iter;
+    };
+    auto addFlagCondition = [this, &findItem](std::string const &name, bool value) {
+        FitsSchemaItem const &item = findItem(name);
+        if (item.bit < 0) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Row filter field '%s' is not a Flag") % name).str());
+        }
+        flagConditions.push_back(FlagCondition{static_cast<std::size_t>(item.bit), value});
+    };
+    for (auto const &name : rowFilter.unsetFlags) {
+        addFlagCondition(name, false);
+    }
+    for (auto const &name : rowFilter.setFlags) {
+        addFlagCondition(name, true);
+    }
+    static std::regex const regex("(1)?[BIJKED]");
+    for (auto const &range : rowFilter.valueRanges) {
+        FitsSchemaItem const &item = findItem(range.first);
+        if (item.bit >= 0 || !std::regex_match(item.tform, regex)) {
+            throw LSST_EXCEPT(
+                    pex::exceptions::InvalidParameterError,
+                    (boost::format("Row filter field '%s' is not a scalar numeric field") % range.first)
+                            .str());
+        }
+        rangeConditions.push_back(RangeCondition{item.column, range.second.first, range.second.second});
+    }
+}
+
 Schema FitsSchemaInputMapper::finalize() {
     if (_impl->version == 0) {
         AliasMap &aliases = *_impl->schema.getAliasMap();
@@ -834,6 +998,13 @@ Schema FitsSchemaInputMapper::finalize() {
             }
         }
     }
+    if (_impl->rowFilter.hasRowFilter()) {
+        // The fields the filter uses need not be selected, so find them before selecting.
+        _impl->resolveRowFilter();
+    }
+    if (!_impl->selection.empty()) {
+        _impl->selectItems();
+    }
     for (auto iter = _impl->asList().begin(); iter != _impl->asList().end(); ++iter) {
         if (iter->bit < 0) {  // not a Flag column
             std::unique_ptr<FitsColumnReader> reader = makeColumnReader(_impl->schema, *iter);
@@ -855,6 +1026,11 @@ Schema FitsSchemaInputMapper::finalize() {
         }
     }
     _impl->asList().clear();
+    if (std::none_of(_impl->flagKeys.begin(), _impl->flagKeys.end(),
+                     [](Key<Flag> const &key) { return key.isValid(); })) {
+        // No flags were selected, so there is no need to read the flag column at all.
+        _impl->flagKeys.clear();
+    }
     if (_impl->schema.getRecordSize() <= 0) {
         throw LSST_EXCEPT(
             pex::exceptions::LengthError,
@@ -870,7 +1046,9 @@ void FitsSchemaInputMapper::readRecord(BaseRecord &record, afw::fits::Fits &fits
     if (!_impl->flagKeys.empty()) {
         fits.readTableArray<bool>(row, _impl->flagColumn, _impl->flagKeys.size(), _impl->flagWorkspace.get());
         for (std::size_t bit = 0; bit < _impl->flagKeys.size(); ++bit) {
-            record.set(_impl->flagKeys[bit], _impl->flagWorkspace[bit]);
+            if (_impl->flagKeys[bit].isValid()) {
+                record.set(_impl->flagKeys[bit], _impl->flagWorkspace[bit]);
+            }
         }
     }
     if (_impl->nRowsToPrep != 1 && row % _impl->nRowsToPrep == 0) {
@@ -885,6 +1063,96 @@ void FitsSchemaInputMapper::readRecord(BaseRecord &record, afw::fits::Fits &fits
         reader->readCell(record, row, fits, _impl->archive);
     }
 }
+
+std::size_t FitsSchemaInputMapper::getBlockSize() const { return _impl->nRowsToPrep; }
+
+void FitsSchemaInputMapper::readRecords(std::vector<BaseRecord *> const &records, afw::fits::Fits &fits,
+                                        std::size_t firstRow) {
+    _impl->rowWorkspace.resize(records.size());
+    std::iota(_impl->rowWorkspace.begin(), _impl->rowWorkspace.end(), firstRow);
+    readRecords(records, fits, _impl->rowWorkspace);
+}
+
+void FitsSchemaInputMapper::readRecords(std::vector<BaseRecord *> const &records, afw::fits::Fits &fits,
+                                        std::vector<std::size_t> const &rows) {
+    if (records.size() != rows.size()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Number of records (%d) does not match number of rows (%d)") %
+                           records.size() % rows.size()).str());
+    }
+    if (rows.empty()) {
+        return;
+    }
+    // Read every row from the first to the last, and keep the ones asked for.
+    std::size_t const firstRow = rows.front();
+    std::size_t const nRows = rows.back() - firstRow + 1;
+    if (!_impl->flagKeys.empty()) {
+        // Read the flags as packed bytes (most significant bit first), as they are written.
+        std::size_t const nFlags = _impl->flagKeys.size();
+        std::size_t const rowBytes = (nFlags + 7) / 8;
+        _impl->flagBlock.resize(nRows * rowBytes);
+        fits.readTableArray(firstRow, _impl->flagColumn, _impl->flagBlock.size(), _impl->flagBlock.data());
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            std::uint8_t const *bytes = _impl->flagBlock.data() + (rows[i] - firstRow) * rowBytes;
+            for (std::size_t bit = 0; bit < nFlags; ++bit) {
+                if (_impl->flagKeys[bit].isValid()) {
+                    records[i]->set(_impl->flagKeys[bit], (bytes[bit / 8] & (0x80 >> (bit % 8))) != 0);
+                }
+            }
+        }
+    }
+    // Fill the block one column at a time, so each reader's values are read with a single call
+    // and then copied into the records.
+    for (auto const &reader : _impl->readers) {
+        reader->prepRead(firstRow, nRows, fits);
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            reader->readCell(*records[i], rows[i], fits, _impl->archive);
+        }
+    }
+}
+
+bool FitsSchemaInputMapper::hasRowFilter() const {
+    return !_impl->flagConditions.empty() || !_impl->rangeConditions.empty();
+}
+
+void FitsSchemaInputMapper::filterRows(afw::fits::Fits &fits, std::size_t firstRow, std::size_t nRows,
+                                       std::vector<std::size_t> &rows) {
+    std::vector<char> &passes = _impl->rowPasses;
+    passes.assign(nRows, true);
+    if (nRows == 0) {
+        return;
+    }
+    if (!_impl->flagConditions.empty()) {
+        std::size_t const rowBytes = (_impl->nFlags + 7) / 8;
+        _impl->flagBlock.resize(nRows * rowBytes);
+        fits.readTableArray(firstRow, _impl->flagColumn, _impl->flagBlock.size(), _impl->flagBlock.data());
+        for (std::size_t i = 0; i < nRows; ++i) {
+            std::uint8_t const *bytes = _impl->flagBlock.data() + i * rowBytes;
+            for (auto const &condition : _impl->flagConditions) {
+                bool value = (bytes[condition.bit / 8] & (0x80 >> (condition.bit % 8))) != 0;
+                if (value != condition.value) {
+                    passes[i] = false;
+                }
+            }
+        }
+    }
+    for (auto const &condition : _impl->rangeConditions) {
+        // CFITSIO converts the column's values to double.
+        _impl->rangeBlock.resize(nRows);
+        fits.readTableArray(firstRow, condition.column, nRows, _impl->rangeBlock.data());
+        for (std::size_t i = 0; i < nRows; ++i) {
+            double value = _impl->rangeBlock[i];
+            if (!(value >= condition.min && value <= condition.max)) {
+                passes[i] = false;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < nRows; ++i) {
+        if (passes[i]) {
+            rows.push_back(firstRow + i);
+        }
+    }
+}
 }  // namespace io
 }  // namespace table
 }  // namespace afw
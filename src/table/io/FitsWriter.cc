@@ -1,6 +1,10 @@
 // -*- lsst-c++ -*-
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "lsst/afw/table/io/FitsWriter.h"
 #include "lsst/afw/table/BaseTable.h"
@@ -122,74 +126,222 @@ void FitsWriter::_writeTable(std::shared_ptr<BaseTable const> const& table, std:
     metadata->remove("AFW_TABLE_VERSION");
     _row = -1;
     _fits->addRows(nRows);
-    _processor = std::make_shared<ProcessRecords>(_fits, schema, nFlags, _row);
+    _processor = std::make_shared<ProcessRecords>(_fits, schema, nFlags, nRows);
 }
 
 //----- Code for writing FITS records -----------------------------------------------------------------------
 
-// The driver code is at the bottom of this section; it's easier to understand if you start there
-// and work your way up.
+// Values of fixed-length columns are copied into column-major blocks of rows, and each block is
+// written with a single cfitsio call per column, as cfitsio's per-call overhead dominates writing
+// tables with many columns one cell at a time.  The driver code is at the bottom of this section;
+// it's easier to understand if you start there and work your way up.
 
-// A Schema::forEach functor that writes table data for a single record when it is called.
-// We instantiate one of these, then reuse it on all the records after updating the data
-// members that tell it which record and row number it's on.
-struct FitsWriter::ProcessRecords {
+namespace {
+
+// Target size of a block of rows, in bytes
+std::size_t const BLOCK_BYTES = 1 << 22;
+
+// Writes one column of a table, buffering its values if possible.
+class ColumnWriter {
+public:
+    ColumnWriter() = default;
+    ColumnWriter(ColumnWriter const&) = delete;
+    ColumnWriter& operator=(ColumnWriter const&) = delete;
+    virtual ~ColumnWriter() = default;
+
+    // Bytes needed to buffer a row of this column
+    virtual std::size_t getRowBytes() const { return 0; }
+
+    // Allocate a buffer for a block of nRows rows
+    virtual void allocate(std::size_t nRows) {}
+
+    // Process the value of a record, which is row `row` of the table and row `i` of the block.
+    virtual void append(Fits& fits, BaseRecord const& record, std::size_t row, std::size_t i) = 0;
+
+    // Write the first nRows rows of the block, starting at row `row` of the table
+    virtual void flush(Fits& fits, std::size_t row, std::size_t nRows) const {}
+};
+
+// Writes a scalar or fixed-length array column in blocks.
+template <typename T>
+class FixedColumnWriter final : public ColumnWriter {
+public:
+    using Element = typename Field<T>::Element;
+
+    FixedColumnWriter(Key<T> const& key, int col) : _key(key), _col(col), _size(key.getElementCount()) {}
+
+    std::size_t getRowBytes() const override { return _size * sizeof(Element); }
+
+    void allocate(std::size_t nRows) override { _values.resize(nRows * _size); }
+
+    void append(Fits&, BaseRecord const& record, std::size_t, std::size_t i) override {
+        Element const* value = record.getElement(_key);
+        std::copy(value, value + _size, _values.begin() + i * _size);
+    }
+
+    void flush(Fits& fits, std::size_t row, std::size_t nRows) const override {
+        fits.writeTableArray(row, _col, nRows * _size, _values.data());
+    }
+
+private:
+    Key<T> _key;
+    int _col;
+    std::size_t _size;
+    std::vector<Element> _values;
+};
+
+// Writes a variable-length array column one cell at a time; cfitsio must lay out its heap row by row.
+template <typename T>
+class VariableLengthColumnWriter final : public ColumnWriter {
+public:
+    VariableLengthColumnWriter(Key<Array<T>> const& key, int col) : _key(key), _col(col) {}
+
+    void append(Fits& fits, BaseRecord const& record, std::size_t row, std::size_t) override {
+        ndarray::Array<T const, 1, 1> array = record.get(_key);
+        fits.writeTableArray(row, _col, array.template getSize<0>(), array.getData());
+    }
+
+private:
+    Key<Array<T>> _key;
+    int _col;
+};
+
+// Writes a string column one cell at a time.
+class StringColumnWriter final : public ColumnWriter {
+public:
+    StringColumnWriter(Key<std::string> const& key, int col) : _key(key), _col(col) {}
+
+    void append(Fits& fits, BaseRecord const& record, std::size_t row, std::size_t) override {
+        // Write fixed-length and variable-length strings the same way
+        fits.writeTableScalar(row, _col, record.get(_key));
+    }
+
+private:
+    Key<std::string> _key;
+    int _col;
+};
+
+// Writes all the Flag fields, which share the first column, packed into bytes in blocks.
+class FlagColumnWriter final : public ColumnWriter {
+public:
+    explicit FlagColumnWriter(std::vector<Key<Flag>> keys)
+            : _keys(std::move(keys)), _rowBytes((_keys.size() + 7) / 8) {}
+
+    std::size_t getRowBytes() const override { return _rowBytes; }
+
+    void allocate(std::size_t nRows) override { _bytes.resize(nRows * _rowBytes); }
+
+    void append(Fits&, BaseRecord const& record, std::size_t, std::size_t i) override {
+        // FITS bit columns put the first bit in the most significant bit of the first byte
+        std::uint8_t* bytes = _bytes.data() + i * _rowBytes;
+        std::fill(bytes, bytes + _rowBytes, 0);
+        for (std::size_t bit = 0; bit < _keys.size(); ++bit) {
+            if (record.get(_keys[bit])) {
+                bytes[bit / 8] |= 0x80 >> (bit % 8);
+            }
+        }
+    }
+
+    void flush(Fits& fits, std::size_t row, std::size_t nRows) const override {
+        fits.writeTableArray(row, 0, nRows * _rowBytes, _bytes.data());
+    }
+
+private:
+    std::vector<Key<Flag>> _keys;
+    std::size_t _rowBytes;
+    std::vector<std::uint8_t> _bytes;
+};
+
+// A Schema::forEach functor that makes the ColumnWriter for each field
+struct MakeColumnWriters {
     template <typename T>
     void operator()(SchemaItem<T> const& item) const {
-        fits->writeTableArray(row, col, item.key.getElementCount(), record->getElement(item.key));
-        ++col;
+        writers->push_back(std::make_unique<FixedColumnWriter<T>>(item.key, col++));
     }
 
     template <typename T>
-    void operator()(SchemaItem<Array<T> > const& item) const {
+    void operator()(SchemaItem<Array<T>> const& item) const {
         if (item.key.isVariableLength()) {
-            ndarray::Array<T const, 1, 1> array = record->get(item.key);
-            fits->writeTableArray(row, col, array.template getSize<0>(), array.getData());
+            writers->push_back(std::make_unique<VariableLengthColumnWriter<T>>(item.key, col++));
         } else {
-            fits->writeTableArray(row, col, item.key.getElementCount(), record->getElement(item.key));
+            writers->push_back(std::make_unique<FixedColumnWriter<Array<T>>>(item.key, col++));
         }
-        ++col;
     }
 
     void operator()(SchemaItem<std::string> const& item) const {
-        // Write fixed-length and variable-length strings the same way
-        fits->writeTableScalar(row, col, record->get(item.key));
-        ++col;
+        writers->push_back(std::make_unique<StringColumnWriter>(item.key, col++));
     }
 
-    void operator()(SchemaItem<Flag> const& item) const {
-        flags[bit] = record->get(item.key);
-        ++bit;
+    void operator()(SchemaItem<Flag> const& item) const { flagKeys->push_back(item.key); }
+
+    std::vector<std::unique_ptr<ColumnWriter>>* writers;
+    std::vector<Key<Flag>>* flagKeys;
+    mutable int col;
+};
+
+}  // namespace
+
+// Buffers the values of records in blocks of rows, and writes each block when it is full.
+struct FitsWriter::ProcessRecords {
+    ProcessRecords(Fits* fits_, Schema const& schema, int nFlags, std::size_t nRows)
+            : fits(fits_), blockRows(1), blockBegin(0), blockSize(0) {
+        std::vector<Key<Flag>> flagKeys;
+        MakeColumnWriters f = {&writers, &flagKeys, nFlags ? 1 : 0};
+        schema.forEach(f);
+        if (nFlags) {
+            writers.push_back(std::make_unique<FlagColumnWriter>(std::move(flagKeys)));
+        }
+        std::size_t rowBytes = 0;
+        for (auto const& writer : writers) {
+            rowBytes += writer->getRowBytes();
+        }
+        if (rowBytes > 0) {
+            blockRows = std::max<std::size_t>(1, std::min(nRows, BLOCK_BYTES / rowBytes));
+        }
+        for (auto const& writer : writers) {
+            writer->allocate(blockRows);
+        }
     }
 
-    ProcessRecords(Fits* fits_, Schema const& schema_, int nFlags_, std::size_t const& row_)
-            : row(row_), col(0), bit(0), nFlags(nFlags_), fits(fits_), schema(schema_) {
-        if (nFlags) flags.reset(new bool[nFlags]);
+    void apply(BaseRecord const& record, std::size_t row) {
+        if (blockSize == 0) {
+            blockBegin = row;
+        }
+        for (auto const& writer : writers) {
+            writer->append(*fits, record, row, blockSize);
+        }
+        if (++blockSize == blockRows) {
+            flush();
+        }
     }
 
-    void apply(BaseRecord const* r) {
-        record = r;
-        col = 0;
-        bit = 0;
-        if (nFlags) ++col;
-        schema.forEach(*this);
-        if (nFlags) fits->writeTableArray(row, 0, nFlags, flags.get());
+    void flush() {
+        if (blockSize > 0) {
+            for (auto const& writer : writers) {
+                writer->flush(*fits, blockBegin, blockSize);
+            }
+            blockSize = 0;
+        }
     }
 
-    std::size_t const& row;
-    mutable int col;
-    mutable int bit;
-    int nFlags;
     Fits* fits;
-    std::unique_ptr<bool[]> flags;
-    BaseRecord const* record;
-    Schema schema;
+    std::vector<std::unique_ptr<ColumnWriter>> writers;
+    std::size_t blockRows;   // number of rows in a full block
+    std::size_t blockBegin;  // table row of the first row of the current block
+    std::size_t blockSize;   // number of rows in the current block
 };
 
 void FitsWriter::_writeRecord(BaseRecord const& record) {
     ++_row;
-    _processor->apply(&record);
+    _processor->apply(record, _row);
 }
+
+void FitsWriter::_flushRecords() {
+    if (_processor) {
+        _processor->flush();
+    }
+}
+
 }  // namespace io
 }  // namespace table
 }  // namespace afw
@@ -809,6 +809,56 @@ class BackgroundTestCase(lsst.utils.tests.TestCase):
                 self.assertEqual(np.min(backImage.getArray()), 0.0)
                 self.assertEqual(np.max(backImage.getArray()), 0.0)
 
+    def testMultiThreaded(self):
+        """Test that computing the cells' statistics in parallel gives the same answer as in serial"""
+        rng = np.random.RandomState(101)
+        mi = afwImage.MaskedImageF(lsst.geom.Extent2I(257, 193))
+        mi.image.array[:] = rng.normal(100.0, 5.0, size=mi.image.array.shape)
+        mi.variance.array[:] = 25.0
+        mi.mask.array[50:60, :] = afwImage.Mask.getPlaneBitMask("BAD")
+
+        for prop in (afwMath.MEANCLIP, afwMath.MEDIAN):
+            sctrl = afwMath.StatisticsControl()
+            sctrl.setAndMask(afwImage.Mask.getPlaneBitMask("BAD"))
+            bgCtrl = afwMath.BackgroundControl(17, 13, sctrl, prop)
+            self.assertEqual(bgCtrl.getNumThreads(), 1)
+            serial = afwMath.makeBackground(mi, bgCtrl).getStatsImage()
+            for numThreads in (0, 3):
+                bgCtrl.setNumThreads(numThreads)
+                self.assertEqual(bgCtrl.getNumThreads(), numThreads)
+                parallel = afwMath.makeBackground(mi, bgCtrl).getStatsImage()
+                self.assertMaskedImagesEqual(parallel, serial)
+
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            afwMath.BackgroundControl(4, 4).setNumThreads(-1)
+
+    def testCachedInterpolation(self):
+        """Test that getImage's cached interpolants are reused and invalidated correctly"""
+        rng = np.random.RandomState(102)
+        mi = afwImage.MaskedImageF(lsst.geom.Extent2I(200, 150))
+        yy, xx = np.mgrid[0:150, 0:200]
+        mi.image.array[:] = 100.0 + 0.1*xx + 0.02*yy + rng.normal(0.0, 1.0, size=xx.shape)
+        bkgd = afwMath.makeBackground(mi, afwMath.BackgroundControl(8, 6))
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(30, 40), lsst.geom.Extent2I(70, 60))
+
+        first = bkgd.getImageF("AKIMA_SPLINE")
+        self.assertImagesEqual(bkgd.getImageF("AKIMA_SPLINE"), first)
+        self.assertImagesEqual(bkgd.getImageF(bbox, "AKIMA_SPLINE"), afwImage.ImageF(first, bbox))
+        # changing the style and changing it back gives the original image
+        self.assertFloatsNotEqual(bkgd.getImageF("LINEAR").array, first.array)
+        self.assertImagesEqual(bkgd.getImageF("AKIMA_SPLINE"), first)
+
+        # the background must follow changes to the statsImage, however they're made
+        bkgd += 5.0
+        self.assertFloatsAlmostEqual(bkgd.getImageF("AKIMA_SPLINE").array, first.array + 5.0, rtol=1e-6)
+        bkgd -= 5.0
+
+        statsImage = bkgd.getStatsImage()
+        statsImage.image.array[2, 3] += 10.0
+        expected = afwMath.BackgroundMI(bkgd.getImageBBox(), statsImage.clone()).getImageF("AKIMA_SPLINE")
+        self.assertImagesEqual(bkgd.getImageF("AKIMA_SPLINE"), expected)
+        self.assertFloatsNotEqual(expected.array, first.array)
+
 
 class MemoryTester(lsst.utils.tests.MemoryTestCase):
     pass
@@ -35,6 +35,7 @@ import numpy
 import lsst.utils
 import lsst.utils.tests
 import lsst.geom
+import lsst.pex.exceptions
 import lsst.afw.image as afwImage
 import lsst.afw.math as afwMath
 import lsst.afw.math.detail as mathDetail
@@ -693,6 +694,110 @@ class ConvolveTestCase(lsst.utils.tests.TestCase):
                 maxInterpDist=maxInterpDist,
                 rtol=rtol)
 
+    def testMultiThreaded(self):
+        """Test that convolving in parallel gives exactly the serial result
+        """
+        rng = numpy.random.RandomState(5)
+        inImage = afwImage.MaskedImageF(lsst.geom.Extent2I(97, 83))
+        inImage.image.array[:] = rng.normal(100.0, 10.0, size=inImage.image.array.shape)
+        inImage.variance.array[:] = rng.uniform(50.0, 150.0, size=inImage.image.array.shape)
+        inImage.mask.array[::7, ::5] = afwImage.Mask.getPlaneBitMask("BAD")
+
+        sFunc = afwMath.PolynomialFunction2D(1)
+        basisKernelList = makeGaussianKernelList(7, 6, ((1.5, 1.5, 0.0), (2.5, 1.5, 0.0), (2.5, 2.5, 0.0)))
+        lcKernel = afwMath.LinearCombinationKernel(basisKernelList, sFunc)
+        lcKernel.setSpatialParameters(((1.0, -0.001, -0.001), (0.0, 0.01, 0.0), (0.0, 0.0, 0.01)))
+        gaussFunc1 = afwMath.GaussianFunction1D(1.0)
+        separableKernel = afwMath.SeparableKernel(7, 6, gaussFunc1, gaussFunc1)
+        varyingSeparableKernel = afwMath.SeparableKernel(7, 6, gaussFunc1, gaussFunc1, sFunc)
+        varyingSeparableKernel.setSpatialParameters(((1.0, 0.02, 0.0), (1.0, 0.0, 0.02)))
+        analyticKernel = afwMath.AnalyticKernel(7, 6, afwMath.GaussianFunction2D(2.5, 1.5, 0.5))
+
+        for kernel, maxInterpDist in ((lcKernel, 10), (lcKernel, 0), (separableKernel, 10),
+                                      (varyingSeparableKernel, 10), (analyticKernel, 10)):
+            convControl = afwMath.ConvolutionControl()
+            convControl.setMaxInterpolationDistance(maxInterpDist)
+            self.assertEqual(convControl.getNumThreads(), 1)
+            serial = afwImage.MaskedImageF(inImage.getDimensions())
+            afwMath.convolve(serial, inImage, kernel, convControl)
+            for numThreads in (0, 2, 3, 8):
+                with self.subTest(kernel=type(kernel).__name__, maxInterpDist=maxInterpDist,
+                                  numThreads=numThreads):
+                    convControl.setNumThreads(numThreads)
+                    self.assertEqual(convControl.getNumThreads(), numThreads)
+                    parallel = afwImage.MaskedImageF(inImage.getDimensions())
+                    afwMath.convolve(parallel, inImage, kernel, convControl)
+                    self.assertMaskedImagesEqual(parallel, serial)
+
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            afwMath.ConvolutionControl().setNumThreads(-1)
+
+    def testFftConvolve(self):
+        """Test that convolving using FFTs matches direct convolution,
+        including the propagation of masks and non-finite pixels
+        """
+        rng = numpy.random.RandomState(7)
+        dims = lsst.geom.Extent2I(157, 131)
+        maskedImage = afwImage.MaskedImageF(dims)
+        maskedImage.image.array[:] = rng.normal(100.0, 10.0, size=maskedImage.image.array.shape)
+        maskedImage.variance.array[:] = rng.uniform(50.0, 150.0, size=maskedImage.image.array.shape)
+        maskedImage.mask.array[::17, ::13] = afwImage.Mask.getPlaneBitMask("BAD")
+        maskedImage.image.array[40, 60] = numpy.nan
+        maskedImage.image.array[100, 20] = numpy.inf
+        maskedImage.variance.array[70, 130] = numpy.nan
+        image = afwImage.ImageD(dims)
+        image.array[:] = rng.normal(100.0, 10.0, size=image.array.shape)
+        image.array[60, 90] = numpy.nan
+
+        kernelImage = afwImage.ImageD(lsst.geom.Extent2I(21, 19))
+        kernelImage.array[:] = rng.uniform(0.0, 1.0, size=kernelImage.array.shape)
+        kernelImage.array[3:7, 5:9] = 0.0
+        fixedKernel = afwMath.FixedKernel(kernelImage)
+        analyticKernel = afwMath.AnalyticKernel(17, 17, afwMath.GaussianFunction2D(3.0, 2.0, 0.3))
+
+        self.assertEqual(afwMath.ConvolutionControl().getAlgorithm(), afwMath.ConvolutionControl.AUTO)
+        for kernel in (fixedKernel, analyticKernel):
+            for inImage, rtol in ((maskedImage, 1e-5), (image, 1e-10)):
+                with self.subTest(kernel=type(kernel).__name__, image=type(inImage).__name__):
+                    convControl = afwMath.ConvolutionControl()
+                    convControl.setAlgorithm(afwMath.ConvolutionControl.DIRECT)
+                    direct = inImage.Factory(dims)
+                    afwMath.convolve(direct, inImage, kernel, convControl)
+
+                    convControl.setAlgorithm(afwMath.ConvolutionControl.FFT)
+                    fft = inImage.Factory(dims)
+                    afwMath.convolve(fft, inImage, kernel, convControl)
+                    if isinstance(inImage, afwImage.MaskedImageF):
+                        numpy.testing.assert_array_equal(fft.mask.array, direct.mask.array)
+                        planes = ((fft.image, direct.image), (fft.variance, direct.variance))
+                    else:
+                        planes = ((fft, direct),)
+                    for fftPlane, directPlane in planes:
+                        numpy.testing.assert_array_equal(numpy.isfinite(fftPlane.array),
+                                                         numpy.isfinite(directPlane.array))
+                        good = numpy.isfinite(directPlane.array)
+                        self.assertGreater(numpy.sum(~good), 0)
+                        self.assertFloatsAlmostEqual(fftPlane.array[good], directPlane.array[good],
+                                                     rtol=rtol)
+
+                    convControl.setNumThreads(3)
+                    parallel = inImage.Factory(dims)
+                    afwMath.convolve(parallel, inImage, kernel, convControl)
+                    if isinstance(inImage, afwImage.MaskedImageF):
+                        self.assertMaskedImagesEqual(parallel, fft)
+                    else:
+                        self.assertImagesEqual(parallel, fft)
+
+        # Round-off in the transforms mustn't make the variance negative where it should be (nearly) zero
+        sparse = afwImage.MaskedImageF(dims)
+        sparse.variance.array[::29, ::31] = 1e6
+        convControl = afwMath.ConvolutionControl()
+        convControl.setAlgorithm(afwMath.ConvolutionControl.FFT)
+        fft = afwImage.MaskedImageF(dims)
+        afwMath.convolve(fft, sparse, analyticKernel, convControl)
+        good = numpy.isfinite(fft.variance.array)
+        self.assertTrue(numpy.all(fft.variance.array[good] >= 0.0))
+
 
 class MemoryTester(lsst.utils.tests.MemoryTestCase):
     pass
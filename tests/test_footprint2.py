@@ -30,8 +30,11 @@ or
 
 import unittest
 
+import numpy as np
+
 import lsst.utils.tests
 import lsst.geom
+import lsst.pex.exceptions
 import lsst.afw.table as afwTable
 import lsst.afw.image as afwImage
 import lsst.afw.geom as afwGeom
@@ -375,6 +378,45 @@ class FootprintSetTestCase(unittest.TestCase):
 
         self.assertEqual(len(objects), 1)
 
+    def testNumThreads(self):
+        """Test that detecting in parallel finds the same Footprints, in the
+        same order and with the same peaks, as detecting serially"""
+        rng = np.random.RandomState(12345)
+        mi = afwImage.MaskedImageF(lsst.geom.Box2I(lsst.geom.Point2I(-20, 30), lsst.geom.Extent2I(150, 97)))
+        mi.image.array[:, :] = rng.normal(0.0, 1.0, mi.image.array.shape)
+        mi.image.array[rng.uniform(size=mi.image.array.shape) < 0.01] = np.nan
+        mi.variance.array[:, :] = rng.uniform(0.5, 2.0, mi.variance.array.shape)
+
+        def footprintsOf(fs):
+            # Peak IDs come from a PeakTable shared by all FootprintSets, so compare them relative to
+            # the smallest ID in each FootprintSet
+            ids = [p.getId() for fp in fs.getFootprints() for p in fp.getPeaks()]
+            firstId = min(ids) if ids else 0
+            return [(tuple((s.getY(), s.getMinX(), s.getMaxX()) for s in fp.getSpans()),
+                     tuple((p.getId() - firstId, p.getIx(), p.getIy(), p.getPeakValue())
+                           for p in fp.getPeaks()))
+                    for fp in fs.getFootprints()]
+
+        for threshold in (afwDetect.Threshold(0.5, includeMultiplier=1.5),
+                          afwDetect.Threshold(0.5, afwDetect.Threshold.VALUE, False, 1.5),
+                          afwDetect.Threshold(1.0, afwDetect.Threshold.PIXEL_STDEV, True, 1.5)):
+            serial = footprintsOf(afwDetect.FootprintSet(mi, threshold, "", 2, True, 1))
+            self.assertGreater(len(serial), 10)
+            for numThreads in (2, 7, 0):
+                self.assertEqual(footprintsOf(afwDetect.FootprintSet(mi, threshold, "", 2, True, numThreads)),
+                                 serial)
+            self.assertEqual(footprintsOf(afwDetect.FootprintSet(mi.image, threshold, numThreads=4)),
+                             footprintsOf(afwDetect.FootprintSet(mi.image, threshold)))
+
+        mask = afwImage.Mask(mi.getBBox())
+        mask.array[:, :] = rng.uniform(size=mask.array.shape) < 0.4
+        threshold = afwDetect.Threshold(0x1, afwDetect.Threshold.BITMASK)
+        self.assertEqual(footprintsOf(afwDetect.FootprintSet(mask, threshold, numThreads=3)),
+                         footprintsOf(afwDetect.FootprintSet(mask, threshold)))
+
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            afwDetect.FootprintSet(mi, afwDetect.Threshold(0.5), numThreads=-1)
+
 
 class PeaksInFootprintsTestCase(unittest.TestCase):
     """A test case for detecting Peaks within Footprints"""
@@ -27,6 +27,7 @@ import lsst.utils.tests
 import lsst.pex.exceptions
 import lsst.geom
 import lsst.afw.image as afwImage
+import lsst.afw.geom as afwGeom
 import lsst.afw.detection as afwDetect
 import lsst.afw.table as afwTable
 
@@ -350,6 +351,50 @@ class FootprintMergeCatalogTestCase(lsst.utils.tests.TestCase):
             for peak in record.getFootprint().getPeaks():
                 self.assertTrue(isPeakInCatalog(peak, merge))
 
+    def testManyFootprints(self):
+        """Test that footprints spread over a large area are merged in
+        priority order.
+
+        Each row of small, separated cat1 footprints is connected by a single
+        long cat2 footprint, so every row must be merged into the footprint of
+        its leftmost cat1 source, with the peaks of the others appended from
+        left to right.
+        """
+        schema = afwTable.SourceTable.makeMinimalSchema()
+        idFactory = afwTable.IdFactory.makeSimple()
+        table = afwTable.SourceTable.make(schema, idFactory)
+        cat1 = afwTable.SourceCatalog(table)
+        cat2 = afwTable.SourceCatalog(table)
+        size = 20
+        spacing = 40
+        nx, ny = 25, 10
+        for j in range(ny):
+            y0 = -300 + j*spacing
+            for i in range(nx):
+                x0 = -400 + i*spacing
+                box = lsst.geom.Box2I(lsst.geom.Point2I(x0, y0), lsst.geom.Extent2I(size, size))
+                footprint = afwDetect.Footprint(afwGeom.SpanSet(box))
+                footprint.addPeak(x0 + size//2, y0 + size//2, 1.0)
+                cat1.addNew().setFootprint(footprint)
+            bar = lsst.geom.Box2I(lsst.geom.Point2I(-400, y0 + size//2),
+                                  lsst.geom.Extent2I(nx*spacing, 1))
+            footprint = afwDetect.Footprint(afwGeom.SpanSet(bar))
+            footprint.addPeak(-400 + size//2, y0 + size//2, 1.0)
+            cat2.addNew().setFootprint(footprint)
+
+        merge, nob, npeak = mergeCatalogs([cat1, cat2], ["1", "2"], 10, idFactory, samePeakDist=3)
+        self.assertEqual(nob, ny)
+        self.assertEqual(npeak, nx*ny)
+        for j, record in enumerate(merge):
+            peaks = record.getFootprint().getPeaks()
+            self.assertEqual([peak.getIx() for peak in peaks],
+                             [-400 + i*spacing + size//2 for i in range(nx)])
+            self.assertEqual({peak.getIy() for peak in peaks}, {-300 + j*spacing + size//2})
+            self.assertTrue(peaks[0].get("merge_peak_2"))
+            self.assertFalse(any(peak.get("merge_peak_2") for peak in peaks[1:]))
+            self.assertTrue(record.get("merge_footprint_1"))
+            self.assertTrue(record.get("merge_footprint_2"))
+
 
 class MemoryTester(lsst.utils.tests.MemoryTestCase):
     pass
@@ -0,0 +1,128 @@
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SeparableConvolve
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "lsst/afw/math/detail/SeparableConvolve.h"
+
+namespace detail = lsst::afw::math::detail;
+using lsst::afw::image::MaskPixel;
+
+namespace {
+
+template <typename InPixelT, typename OutPixelT>
+void checkSumTaps() {
+    std::mt19937 rng(12345);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    for (int kWidth : {1, 3, 5, 6, 7, 8, 9, 10, 11, 17}) {
+        std::vector<double> kernelVec(kWidth);
+        for (auto &value : kernelVec) {
+            value = normal(rng);
+        }
+        if (kWidth > 3) {
+            kernelVec[0] = 0.0;
+        }
+        detail::KernelTaps const taps(kernelVec);
+
+        for (int n : {0, 1, 3, 4, 7, 8, 9, 31, 100}) {
+            std::vector<InPixelT> in(n + kWidth);
+            for (auto &value : in) {
+                value = normal(rng);
+            }
+            if (kWidth > 3) {
+                in[0] = std::numeric_limits<InPixelT>::quiet_NaN();  // only under the zero tap
+            }
+            std::vector<InPixelT const *> sources;
+            for (int offset : taps.offsets) {
+                sources.push_back(in.data() + offset);
+            }
+
+            std::vector<OutPixelT> expected(n);
+            detail::sumTaps(sources.data(), taps, expected.data(), n, detail::SimdLevel::SCALAR);
+            for (int i = 0; i < n; ++i) {
+                double sum = 0.0;
+                double scale = 0.0;
+                for (int j = 0; j < kWidth; ++j) {
+                    if (kernelVec[j] != 0.0) {
+                        sum += kernelVec[j] * in[i + j];
+                        scale += std::fabs(kernelVec[j] * in[i + j]);
+                    }
+                }
+                BOOST_CHECK_MESSAGE(
+                        std::fabs(expected[i] - sum) <= 4 * std::numeric_limits<OutPixelT>::epsilon() * scale,
+                        expected[i] << " != " << sum);
+            }
+
+            // All levels sum the taps in the same order, so only fused multiply-adds could make
+            // them differ
+            for (auto level : {detail::SimdLevel::SSE2, detail::SimdLevel::AVX2}) {
+                std::vector<OutPixelT> out(n);
+                detail::sumTaps(sources.data(), taps, out.data(), n, level);
+                for (int i = 0; i < n; ++i) {
+                    BOOST_CHECK_CLOSE_FRACTION(out[i], expected[i],
+                                               4 * std::numeric_limits<OutPixelT>::epsilon());
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(SumTapsFloat) { checkSumTaps<float, float>(); }
+
+BOOST_AUTO_TEST_CASE(SumTapsDouble) { checkSumTaps<double, double>(); }
+
+BOOST_AUTO_TEST_CASE(SumTapsMixed) {
+    checkSumTaps<float, double>();
+    checkSumTaps<double, float>();
+}
+
+BOOST_AUTO_TEST_CASE(SquaredTaps) {
+    detail::KernelTaps const taps({0.5, 0.0, -2.0}, true);
+    BOOST_CHECK_EQUAL(taps.size(), 2);
+    BOOST_CHECK_EQUAL(taps.offsets[0], 0);
+    BOOST_CHECK_EQUAL(taps.offsets[1], 2);
+    BOOST_CHECK_EQUAL(taps.values[0], 0.25);
+    BOOST_CHECK_EQUAL(taps.values[1], 4.0);
+}
+
+BOOST_AUTO_TEST_CASE(OrTaps) {
+    std::vector<MaskPixel> in = {0x1, 0x0, 0x2, 0x0, 0x4, 0x0, 0x0};
+    std::vector<MaskPixel const *> sources = {in.data(), in.data() + 2};
+    std::vector<MaskPixel> out(5);
+    detail::orTaps(sources.data(), sources.size(), out.data(), out.size());
+    std::vector<MaskPixel> const expected = {0x3, 0x0, 0x6, 0x0, 0x4};
+    BOOST_CHECK_EQUAL_COLLECTIONS(out.begin(), out.end(), expected.begin(), expected.end());
+}
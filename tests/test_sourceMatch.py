@@ -34,6 +34,7 @@ import unittest
 import numpy as np
 
 import lsst.geom
+import lsst.pex.exceptions
 import lsst.afw.table as afwTable
 import lsst.daf.base as dafBase
 import lsst.utils.tests
@@ -379,6 +380,93 @@ class SourceMatchTestCase(lsst.utils.tests.TestCase):
         self.assertLess(diff.std(), tol)  # I get 4e-12
         self.assertFloatsAlmostEqual(dist1, dist2, atol=tol)
 
+    def testRaDecIndex(self):
+        """Test matching against a reusable spatial index, including near a pole
+        """
+        num = 300
+        radius = 1.0*lsst.geom.degrees
+        rng = np.random.RandomState(12345)
+        coordKey = afwTable.SourceTable.getCoordKey()
+        for minDec in (-10.0, 85.0):
+            cat1 = afwTable.SourceCatalog(self.table)
+            cat2 = afwTable.SourceCatalog(self.table)
+            for ii, cat in enumerate((cat1, cat2)):
+                for jj in range(num):
+                    src = cat.addNew()
+                    src.setId(ii*num + jj)
+                    src.set(coordKey, lsst.geom.SpherePoint(rng.uniform(0, 360)*lsst.geom.degrees,
+                                                            rng.uniform(minDec, 90)*lsst.geom.degrees))
+            expected = {(s1.getId(), s2.getId()) for s1 in cat1 for s2 in cat2
+                        if s1.getCoord().separation(s2.getCoord()) < radius}
+            self.assertGreater(len(expected), 0)
+
+            mc = afwTable.MatchControl()
+            mc.findOnlyClosest = False
+            index = afwTable.SourceRaDecIndex(cat2)
+            self.assertEqual(len(index), len(cat2))
+            for matches in (afwTable.matchRaDec(cat1, cat2, radius, mc),
+                            afwTable.matchRaDec(cat1, index, radius, mc),
+                            afwTable.matchRaDec(cat1, index, radius, mc)):
+                self.assertEqual(len(matches), len(expected))
+                self.assertEqual({(m.first.getId(), m.second.getId()) for m in matches}, expected)
+                for m in matches:
+                    self.assertAlmostEqual((m.distance*lsst.geom.radians).asArcseconds(),
+                                           m.first.getCoord().separation(m.second.getCoord()).asArcseconds(),
+                                           places=6)
+
+            for src in cat1[:20]:
+                found = index.findWithin(src.getCoord(), radius)
+                self.assertEqual([s.getId() for s in found],
+                                 sorted(s2 for s1, s2 in expected if s1 == src.getId()))
+
+        with self.assertRaises(lsst.pex.exceptions.RangeError):
+            index.findWithin(cat1[0].getCoord(), 46.0*lsst.geom.degrees)
+
+    def testNumThreads(self):
+        """Test that matching in parallel gives the same matches, in the same order
+        """
+        num = 5000
+        rng = np.random.RandomState(54321)
+        schema = afwTable.SourceTable.makeMinimalSchema()
+        centroidKey = afwTable.Point2DKey.addFields(schema, "centroid", "centroid", "pixel")
+        table = afwTable.SourceTable.make(schema)
+        table.defineCentroid("centroid")
+        coordKey = afwTable.SourceTable.getCoordKey()
+        cat1 = afwTable.SourceCatalog(table)
+        cat2 = afwTable.SourceCatalog(table)
+        for ii, cat in enumerate((cat1, cat2)):
+            for jj in range(num):
+                src = cat.addNew()
+                src.setId(ii*num + jj)
+                src.set(coordKey, lsst.geom.SpherePoint(rng.uniform(10, 11)*lsst.geom.degrees,
+                                                        rng.uniform(10, 11)*lsst.geom.degrees))
+                src.set(centroidKey, lsst.geom.Point2D(rng.uniform(0, 1000), rng.uniform(0, 1000)))
+
+        def getIds(matches):
+            # mismatches have a NaN distance, which does not compare equal to itself
+            return [(m.first.getId(), m.second.getId(), m.distance) if m.second is not None
+                    else (m.first.getId(),) for m in matches]
+
+        for closest in (True, False):
+            mc = afwTable.MatchControl()
+            mc.findOnlyClosest = closest
+            mc.includeMismatches = True
+            radius = 20.0*lsst.geom.arcseconds
+            expected = [getIds(afwTable.matchRaDec(cat1, cat2, radius, mc)),
+                        getIds(afwTable.matchRaDec(cat1, radius, mc)),
+                        getIds(afwTable.matchXy(cat1, cat2, 5.0, mc)),
+                        getIds(afwTable.matchXy(cat1, 5.0, mc))]
+            for numThreads in (0, 3):
+                mc.numThreads = numThreads
+                self.assertEqual(getIds(afwTable.matchRaDec(cat1, cat2, radius, mc)), expected[0])
+                self.assertEqual(getIds(afwTable.matchRaDec(cat1, radius, mc)), expected[1])
+                self.assertEqual(getIds(afwTable.matchXy(cat1, cat2, 5.0, mc)), expected[2])
+                self.assertEqual(getIds(afwTable.matchXy(cat1, 5.0, mc)), expected[3])
+
+        mc.numThreads = -1
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            afwTable.matchXy(cat1, cat2, 5.0, mc)
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
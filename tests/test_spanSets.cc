@@ -20,7 +20,9 @@
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <cstdlib>
 #include <iostream>
+#include <vector>
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE SpanSet
 
@@ -30,6 +32,7 @@
 #pragma clang diagnostic pop
 #include "boost/test/tools/floating_point_comparison.hpp"
 
+#include "lsst/pex/exceptions.h"
 #include "lsst/geom.h"
 #include "lsst/afw/geom/SpanSet.h"
 #include "lsst/afw/image.h"
@@ -182,6 +185,52 @@ BOOST_AUTO_TEST_CASE(SpanSet_testShiftedBy) {
     BOOST_CHECK(shiftedNullSpanSet->size() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(SpanSet_testSharedShift) {
+    // Two disconnected regions, so that splitting a shifted SpanSet is tested too
+    std::vector<afwGeom::Span> spans = {afwGeom::Span(0, 0, 3), afwGeom::Span(1, 1, 2),
+                                        afwGeom::Span(1, 6, 8), afwGeom::Span(2, 6, 6)};
+    auto spanSet = std::make_shared<afwGeom::SpanSet>(spans);
+    auto shifted = spanSet->shiftedBy(-5, 3)->shiftedBy(1, 1);
+
+    // The shifted SpanSet should be the same as one made from shifted Spans
+    std::vector<afwGeom::Span> shiftedSpans;
+    for (auto const& spn : spans) {
+        shiftedSpans.emplace_back(spn.getY() + 4, spn.getX0() - 4, spn.getX1() - 4);
+    }
+    afwGeom::SpanSet expected(shiftedSpans);
+    BOOST_CHECK(*shifted == expected);
+    BOOST_CHECK(shifted->getBBox() == expected.getBBox());
+    BOOST_CHECK(shifted->getArea() == expected.getArea());
+    BOOST_CHECK(shifted->front() == shiftedSpans.front());
+    BOOST_CHECK(shifted->back() == shiftedSpans.back());
+    BOOST_CHECK(shifted->end() - shifted->begin() == 4);
+    BOOST_CHECK(shifted->begin()[2] == shiftedSpans[2]);
+    BOOST_CHECK(shifted->begin()->getY() == 4);
+    BOOST_CHECK(std::vector<afwGeom::Span>(shifted->begin(), shifted->end()) == shiftedSpans);
+
+    // Shifting back should give the original SpanSet, and operations on the shifted SpanSet should
+    // give the same results as on an unshared one
+    BOOST_CHECK(*(shifted->shiftedBy(4, -4)) == *spanSet);
+    BOOST_CHECK(*spanSet != *shifted);
+    BOOST_CHECK(shifted->contains(lsst::geom::Point2I(2, 5)));
+    BOOST_CHECK(!shifted->contains(lsst::geom::Point2I(6, 5)));
+    BOOST_CHECK(*(shifted->clippedTo(expected.getBBox())) == expected);
+    BOOST_CHECK(*(shifted->intersect(expected)) == expected);
+    BOOST_CHECK(*(shifted->union_(*spanSet)) == *(expected.union_(*spanSet)));
+    auto shiftedSplit = shifted->split();
+    auto expectedSplit = expected.split();
+    BOOST_CHECK(shiftedSplit.size() == 2u);
+    BOOST_CHECK(expectedSplit.size() == 2u);
+    for (std::size_t i = 0; i < shiftedSplit.size(); ++i) {
+        BOOST_CHECK(*(shiftedSplit[i]) == *(expectedSplit[i]));
+    }
+
+    // Assignment should leave an equal SpanSet
+    afwGeom::SpanSet assigned;
+    assigned = *shifted;
+    BOOST_CHECK(assigned == expected);
+}
+
 BOOST_AUTO_TEST_CASE(SpanSet_testClippedTo) {
     lsst::geom::Box2I clipBox(lsst::geom::Box2I(lsst::geom::Point2I(-2, -2), lsst::geom::Point2I(2, 2)));
     // BBox lower corner shouuld be at -4,-4
@@ -321,6 +370,40 @@ BOOST_AUTO_TEST_CASE(SpanSet_testeroded) {
     BOOST_CHECK(SpanSetNulleroded->getBBox().getMinY() == -2);
 }
 
+BOOST_AUTO_TEST_CASE(SpanSet_testStencilMorphology) {
+    // Dilating or eroding with a stencil should agree with doing so with the stencil's SpanSet
+    std::vector<afwGeom::Span> spans;
+    for (int y = -7; y <= 12; ++y) {
+        // Two blobs joined by a thin bridge, with a hole and some isolated pixels
+        spans.emplace_back(y, -10 + std::abs(y) / 2, 3 + (y % 3));
+        if (y > 0 && y < 9 && y != 4) {
+            spans.emplace_back(y, 7, 25 - y);
+        } else if (y == 4) {
+            spans.emplace_back(y, 5, 9);
+            spans.emplace_back(y, 12, 25 - y);
+        }
+        if (y % 4 == 0) {
+            spans.emplace_back(y, 30 + y, 30 + y);
+        }
+    }
+    afwGeom::SpanSet spanSet(std::move(spans));
+
+    for (auto stencil : {afwGeom::Stencil::CIRCLE, afwGeom::Stencil::BOX, afwGeom::Stencil::MANHATTAN}) {
+        for (int r = 0; r <= 6; ++r) {
+            auto stencilSpanSet = afwGeom::SpanSet::fromShape(r, stencil);
+            BOOST_CHECK(*spanSet.dilated(r, stencil) == *spanSet.dilated(*stencilSpanSet));
+            BOOST_CHECK(*spanSet.eroded(r, stencil) == *spanSet.eroded(*stencilSpanSet));
+        }
+        BOOST_CHECK_THROW(spanSet.dilated(-1, stencil), lsst::pex::exceptions::InvalidParameterError);
+        BOOST_CHECK_THROW(spanSet.eroded(-1, stencil), lsst::pex::exceptions::InvalidParameterError);
+    }
+
+    // Eroding away everything should give a null SpanSet
+    BOOST_CHECK(spanSet.eroded(20, afwGeom::Stencil::BOX)->size() == 0u);
+    afwGeom::SpanSet pixel(std::vector<afwGeom::Span>{afwGeom::Span(0, 0, 0)});
+    BOOST_CHECK(pixel.eroded(*afwGeom::SpanSet::fromShape(1, afwGeom::Stencil::BOX))->size() == 0u);
+}
+
 BOOST_AUTO_TEST_CASE(SpanSet_testFlatten) {
     // Test version without output array, as this simply delegates
     // Create an array and initialize it to 9
@@ -632,6 +715,65 @@ BOOST_AUTO_TEST_CASE(SpanSet_testUnion) {
     BOOST_CHECK(*spanSetAsOther == *firstSS);
 }
 
+BOOST_AUTO_TEST_CASE(SpanSet_testSetOperationsSeveralSpansPerRow) {
+    afwGeom::SpanSet first(std::vector<afwGeom::Span>{afwGeom::Span(0, 0, 2), afwGeom::Span(0, 5, 8),
+                                                      afwGeom::Span(1, 0, 8)});
+    afwGeom::SpanSet second(std::vector<afwGeom::Span>{afwGeom::Span(0, 1, 6), afwGeom::Span(1, 2, 3),
+                                                       afwGeom::Span(1, 5, 5), afwGeom::Span(2, 0, 1)});
+
+    std::vector<afwGeom::Span> expectedIntersect{afwGeom::Span(0, 1, 2), afwGeom::Span(0, 5, 6),
+                                                 afwGeom::Span(1, 2, 3), afwGeom::Span(1, 5, 5)};
+    BOOST_CHECK(*(first.intersect(second)) == afwGeom::SpanSet(expectedIntersect));
+
+    std::vector<afwGeom::Span> expectedIntersectNot{afwGeom::Span(0, 0, 0), afwGeom::Span(0, 7, 8),
+                                                    afwGeom::Span(1, 0, 1), afwGeom::Span(1, 4, 4),
+                                                    afwGeom::Span(1, 6, 8)};
+    BOOST_CHECK(*(first.intersectNot(second)) == afwGeom::SpanSet(expectedIntersectNot));
+
+    std::vector<afwGeom::Span> expectedUnion{afwGeom::Span(0, 0, 8), afwGeom::Span(1, 0, 8),
+                                             afwGeom::Span(2, 0, 1)};
+    BOOST_CHECK(*(first.union_(second)) == afwGeom::SpanSet(expectedUnion));
+}
+
+BOOST_AUTO_TEST_CASE(SpanSet_testUnionAll) {
+    auto box = std::make_shared<afwGeom::SpanSet>(
+            lsst::geom::Box2I(lsst::geom::Point2I(0, 0), lsst::geom::Point2I(3, 3)));
+    auto spans = std::make_shared<afwGeom::SpanSet>(
+            std::vector<afwGeom::Span>{afwGeom::Span(2, 5, 9), afwGeom::Span(4, 0, 1)});
+    auto shiftedBox = box->shiftedBy(4, 0);
+    auto nullSpanSet = std::make_shared<afwGeom::SpanSet>();
+
+    auto result = afwGeom::SpanSet::unionAll({box, nullSpanSet, spans, shiftedBox});
+    std::vector<afwGeom::Span> expected{afwGeom::Span(0, 0, 7), afwGeom::Span(1, 0, 7),
+                                        afwGeom::Span(2, 0, 9), afwGeom::Span(3, 0, 7),
+                                        afwGeom::Span(4, 0, 1)};
+    BOOST_CHECK(*result == afwGeom::SpanSet(expected));
+    BOOST_CHECK(*result == *(box->union_(*spans)->union_(*shiftedBox)));
+
+    // The union of no SpanSets, or of null SpanSets, is a null SpanSet
+    BOOST_CHECK(afwGeom::SpanSet::unionAll({})->empty());
+    BOOST_CHECK(afwGeom::SpanSet::unionAll({nullSpanSet, nullSpanSet})->empty());
+}
+
+BOOST_AUTO_TEST_CASE(SpanSet_testIntersectAll) {
+    auto box = std::make_shared<afwGeom::SpanSet>(
+            lsst::geom::Box2I(lsst::geom::Point2I(0, 0), lsst::geom::Point2I(3, 3)));
+    auto otherBox = std::make_shared<afwGeom::SpanSet>(
+            lsst::geom::Box2I(lsst::geom::Point2I(2, 1), lsst::geom::Point2I(6, 5)));
+    auto spans = std::make_shared<afwGeom::SpanSet>(std::vector<afwGeom::Span>{
+            afwGeom::Span(1, 0, 0), afwGeom::Span(1, 2, 9), afwGeom::Span(3, 3, 3)});
+
+    auto result = afwGeom::SpanSet::intersectAll({box, otherBox, spans});
+    std::vector<afwGeom::Span> expected{afwGeom::Span(1, 2, 3), afwGeom::Span(3, 3, 3)};
+    BOOST_CHECK(*result == afwGeom::SpanSet(expected));
+    BOOST_CHECK(*result == *(box->intersect(*otherBox)->intersect(*spans)));
+
+    // The intersection with a disjoint or null SpanSet, or of no SpanSets, is a null SpanSet
+    BOOST_CHECK(afwGeom::SpanSet::intersectAll({box, box->shiftedBy(10, 0)})->empty());
+    BOOST_CHECK(afwGeom::SpanSet::intersectAll({box, std::make_shared<afwGeom::SpanSet>()})->empty());
+    BOOST_CHECK(afwGeom::SpanSet::intersectAll({})->empty());
+}
+
 BOOST_AUTO_TEST_CASE(SpanSet_MaskToSpanSet) {
     // This is to test the free function that turns Masks to SpanSets
     auto maskAndSet = makeMaskAndSpanSetForOperationTests();
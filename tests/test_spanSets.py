@@ -339,6 +339,38 @@ class SpanSetTestCase(lsst.utils.tests.TestCase):
         for yVal, span in enumerate(spanSetUnion):
             self.assertEqual(span.getY(), yVal)
 
+    def testUnionAllIntersectAll(self):
+        firstSpanSet, secondSpanSet = self.makeOverlapSpanSets()
+        thirdSpanSet = afwGeom.SpanSet.fromShape(2, afwGeom.Stencil.BOX, offset=(2, 3))
+        spanSets = [firstSpanSet, secondSpanSet, thirdSpanSet]
+
+        self.assertEqual(afwGeom.SpanSet.unionAll(spanSets),
+                         firstSpanSet.union(secondSpanSet).union(thirdSpanSet))
+        self.assertEqual(afwGeom.SpanSet.intersectAll(spanSets),
+                         firstSpanSet.intersect(secondSpanSet).intersect(thirdSpanSet))
+        self.assertEqual(len(afwGeom.SpanSet.unionAll([])), 0)
+        self.assertEqual(len(afwGeom.SpanSet.intersectAll([])), 0)
+
+    def testSetOperationsNotNormalized(self):
+        # Spans out of order, overlapping and contiguous, which are not normalized when constructed
+        spans = [afwGeom.Span(2, 0, 4), afwGeom.Span(0, 3, 6), afwGeom.Span(0, 0, 3),
+                 afwGeom.Span(2, 5, 7), afwGeom.Span(1, 2, 2)]
+        notNormalized = afwGeom.SpanSet(spans, normalize=False)
+        normalized = afwGeom.SpanSet(spans)
+        self.assertEqual(normalized.getBBox(), notNormalized.getBBox())
+        other = afwGeom.SpanSet.fromShape(2, afwGeom.Stencil.BOX, offset=(3, 1))
+
+        self.assertEqual(notNormalized.union(other), normalized.union(other))
+        self.assertEqual(other.union(notNormalized), normalized.union(other))
+        self.assertEqual(notNormalized.intersect(other), normalized.intersect(other))
+        self.assertEqual(other.intersect(notNormalized), normalized.intersect(other))
+        self.assertEqual(notNormalized.intersectNot(other), normalized.intersectNot(other))
+        self.assertEqual(other.intersectNot(notNormalized), other.intersectNot(normalized))
+        self.assertEqual(afwGeom.SpanSet.unionAll([other, notNormalized]),
+                         afwGeom.SpanSet.unionAll([other, normalized]))
+        self.assertEqual(afwGeom.SpanSet.intersectAll([other, notNormalized]),
+                         afwGeom.SpanSet.intersectAll([other, normalized]))
+
     def testMaskToSpanSet(self):
         mask, _ = self.makeMaskAndSpanSetForOperationTest()
         spanSetFromMask = afwGeom.SpanSet.fromMask(mask)
@@ -27,6 +27,7 @@ Run with:
 or
    pytest test_stacker.py
 """
+import contextlib
 import unittest
 from functools import reduce
 
@@ -403,6 +404,143 @@ class StackTestCase(lsst.utils.tests.TestCase):
         self.assertEqual(stack.mask[1, 1, afwImage.LOCAL], clipped)
         self.assertEqual(stack.mask[1, 2, afwImage.LOCAL], rejected)
 
+    def testMultiThreaded(self):
+        """Test that stacking with several threads matches the serial stack exactly"""
+        rng = np.random.RandomState(12345)
+        badVal = afwImage.Mask.getPlaneBitMask("BAD")
+        images = []
+        for i in range(self.nImg):
+            mimg = afwImage.MaskedImageF(lsst.geom.Extent2I(self.nX, self.nY + 3))
+            mimg.image.array[:] = rng.normal(size=mimg.image.array.shape)
+            mimg.variance.array[:] = rng.uniform(0.5, 2.0, size=mimg.variance.array.shape)
+            mimg.mask.array[:] = np.where(rng.uniform(size=mimg.mask.array.shape) < 0.1, badVal, 0)
+            images.append(mimg)
+
+        for stat in (afwMath.MEAN, afwMath.MEDIAN, afwMath.MEANCLIP):
+            for weighted in (False, True):
+                sctrl = afwMath.StatisticsControl()
+                sctrl.setAndMask(badVal)
+                sctrl.setWeighted(weighted)
+                serial = afwMath.statisticsStack(images, stat, sctrl)
+                for numThreads in (0, 4):
+                    sctrl.setNumThreads(numThreads)
+                    parallel = afwMath.statisticsStack(images, stat, sctrl)
+                    self.assertMaskedImagesEqual(parallel, serial)
+
+        with self.assertRaises(pexEx.InvalidParameterError):
+            afwMath.StatisticsControl().setNumThreads(-1)
+
+    def testTransposedStackMatchesStatistics(self):
+        """Test that the MEAN, MEDIAN and MEANCLIP stacks match makeStatistics on each pixel's inputs"""
+        rng = np.random.RandomState(54321)
+        badVal = afwImage.Mask.getPlaneBitMask("BAD")
+        nX, nY = 7, 5
+        images = []
+        for i in range(self.nImg):
+            mimg = afwImage.MaskedImageF(lsst.geom.Extent2I(nX, nY))
+            mimg.image.array[:] = rng.standard_cauchy(size=mimg.image.array.shape)
+            mimg.variance.array[:] = rng.uniform(0.5, 2.0, size=mimg.variance.array.shape)
+            mimg.mask.array[:] = np.where(rng.uniform(size=mimg.mask.array.shape) < 0.2, badVal, 0)
+            images.append(mimg)
+
+        for stat in (afwMath.MEAN, afwMath.MEDIAN, afwMath.MEANCLIP):
+            for weighted in (False, True):
+                sctrl = afwMath.StatisticsControl()
+                sctrl.setAndMask(badVal)
+                sctrl.setWeighted(weighted)
+                stack = afwMath.statisticsStack(images, stat, sctrl)
+                for y in range(nY):
+                    for x in range(nX):
+                        pixels = afwImage.MaskedImageF(lsst.geom.Extent2I(self.nImg, 1))
+                        for i, mimg in enumerate(images):
+                            pixels[i, 0, afwImage.LOCAL] = mimg[x, y, afwImage.LOCAL]
+                        if weighted:
+                            weights = afwImage.ImageF(pixels.variance, True)
+                            weights.array[:] = 1.0/weights.array.astype(np.float64)
+                            expected = afwMath.makeStatistics(pixels, weights, stat | afwMath.ERRORS, sctrl)
+                        else:
+                            expected = afwMath.makeStatistics(pixels, stat | afwMath.ERRORS, sctrl)
+                        self.assertEqual(stack.image[x, y, afwImage.LOCAL],
+                                         np.float32(expected.getValue(stat)))
+                        self.assertEqual(stack.variance[x, y, afwImage.LOCAL],
+                                         np.float32(expected.getError(stat)**2))
+
+    def testStackAccumulator(self):
+        """Test that StackAccumulator matches an in-memory MEAN stack when fed in strips"""
+        rng = np.random.RandomState(2468)
+        badVal = afwImage.Mask.getPlaneBitMask("BAD")
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(10, 20), lsst.geom.Extent2I(self.nX, self.nY))
+        images = []
+        for i in range(self.nImg):
+            mimg = afwImage.MaskedImageF(bbox)
+            mimg.image.array[:] = rng.normal(size=mimg.image.array.shape)
+            mimg.variance.array[:] = rng.uniform(0.5, 2.0, size=mimg.variance.array.shape)
+            mimg.mask.array[:] = np.where(rng.uniform(size=mimg.mask.array.shape) < 0.1, badVal, 0)
+            images.append(mimg)
+
+        for weighted in (False, True):
+            sctrl = afwMath.StatisticsControl()
+            sctrl.setAndMask(badVal)
+            sctrl.setWeighted(weighted)
+            expected = afwMath.statisticsStack(images, afwMath.MEAN, sctrl)
+
+            accumulator = afwMath.StackAccumulatorF(bbox, afwMath.MEAN, sctrl)
+            self.assertEqual(accumulator.getBBox(), bbox)
+            stripHeight = 10
+            for y0 in range(bbox.getMinY(), bbox.getMaxY() + 1, stripHeight):
+                stripBBox = lsst.geom.Box2I(lsst.geom.Point2I(bbox.getMinX(), y0),
+                                            lsst.geom.Extent2I(bbox.getWidth(), stripHeight))
+                stripBBox.clip(bbox)
+                for mimg in images:
+                    accumulator.add(mimg.Factory(mimg, stripBBox, afwImage.PARENT))
+            result = accumulator.getResult()
+
+            self.assertEqual(result.getBBox(), bbox)
+            self.assertFloatsAlmostEqual(result.image.array, expected.image.array, rtol=1e-5, atol=1e-6)
+            self.assertFloatsAlmostEqual(result.variance.array, expected.variance.array, rtol=1e-5)
+            self.assertImagesEqual(result.mask, expected.mask)
+
+        accumulator = afwMath.StackAccumulatorF(bbox, afwMath.MEAN)
+        with self.assertRaises(pexEx.LengthError):
+            accumulator.add(afwImage.MaskedImageF(lsst.geom.Extent2I(self.nX, self.nY)))
+        with self.assertRaises(pexEx.InvalidParameterError):
+            afwMath.StackAccumulatorF(bbox, afwMath.MEDIAN)
+
+    def testStackFromReaders(self):
+        """Test that stacking from FITS files in strips matches the in-memory stack"""
+        rng = np.random.RandomState(1357)
+        badVal = afwImage.Mask.getPlaneBitMask("BAD")
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(5, -3), lsst.geom.Extent2I(self.nX, self.nY))
+        images = []
+        for i in range(5):
+            mimg = afwImage.MaskedImageF(bbox)
+            mimg.image.array[:] = rng.normal(size=mimg.image.array.shape)
+            mimg.variance.array[:] = rng.uniform(0.5, 2.0, size=mimg.variance.array.shape)
+            mimg.mask.array[:] = np.where(rng.uniform(size=mimg.mask.array.shape) < 0.1, badVal, 0)
+            images.append(mimg)
+
+        sctrl = afwMath.StatisticsControl()
+        sctrl.setAndMask(badVal)
+        with contextlib.ExitStack() as tempFiles:
+            readers = []
+            for i, mimg in enumerate(images):
+                filename = tempFiles.enter_context(lsst.utils.tests.getTempFilePath(f"_{i}.fits"))
+                mimg.writeFits(filename)
+                readers.append(afwImage.ExposureFitsReader(filename))
+
+            for stat in (afwMath.MEAN, afwMath.MEDIAN, afwMath.MEANCLIP):
+                expected = afwMath.statisticsStack(images, stat, sctrl)
+                out = afwImage.MaskedImageF(bbox)
+                afwMath.statisticsStack(out, readers, stat, sctrl, stripHeight=7)
+                self.assertMaskedImagesEqual(out, expected)
+
+            with self.assertRaises(pexEx.InvalidParameterError):
+                afwMath.statisticsStack(afwImage.MaskedImageF(bbox), readers, afwMath.MEAN, sctrl,
+                                        stripHeight=0)
+            with self.assertRaises(pexEx.LengthError):
+                afwMath.statisticsStack(afwImage.MaskedImageF(lsst.geom.Extent2I(self.nX + 10, self.nY)),
+                                        readers, afwMath.MEAN, sctrl)
+
 #################################################################
 # Test suite boiler plate
 #################################################################
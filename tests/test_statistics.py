@@ -576,6 +576,75 @@ class StatisticsTestCase(lsst.utils.tests.TestCase):
             mask[1, 1] = maskVal
             self.assertEqual(afwMath.makeStatistics(image, mask, afwMath.NMASKED, ctrl).getValue(), 1)
 
+    @staticmethod
+    def integerQuantile(values, fraction):
+        """Reference implementation of the quantile of integer data used by Statistics"""
+        values = np.sort(values.flatten())
+        n = len(values)
+        naive = values[int(fraction*(n - 1))]
+        left = np.sum(values < naive)
+        middle = np.sum(values == naive)
+        return naive - 0.5 + (fraction*n - left)/middle
+
+    def testIntegerQuantiles(self):
+        """Test the median and quartiles of integer images, with both narrow and wide ranges of values"""
+        rng = np.random.RandomState(42)
+        flagsMedian = afwMath.MEDIAN
+        flagsAll = afwMath.MEDIAN | afwMath.IQRANGE
+        for ImageClass, dtype in ((afwImage.ImageI, np.int32), (afwImage.ImageU, np.uint16)):
+            for scale in (1, 1000):  # the histogram is too sparse to use for the wider range
+                image = ImageClass(lsst.geom.ExtentI(31, 17))
+                image.array[:] = (scale*np.floor(rng.normal(30, 3, image.array.shape))).astype(dtype)
+                mask = afwImage.Mask(image.getBBox())
+                mask.array[3:5, :] = 0x1
+                ctrl = afwMath.StatisticsControl()
+                ctrl.setAndMask(0x1)
+                good = image.array[mask.array == 0].astype(np.int64)
+
+                median = afwMath.makeStatistics(image, mask, flagsMedian, ctrl).getValue(afwMath.MEDIAN)
+                stats = afwMath.makeStatistics(image, mask, flagsAll, ctrl)
+                self.assertEqual(median, self.integerQuantile(good, 0.5))
+                self.assertEqual(stats.getValue(afwMath.MEDIAN), median)
+                self.assertFloatsAlmostEqual(stats.getValue(afwMath.IQRANGE),
+                                             self.integerQuantile(good, 0.75) -
+                                             self.integerQuantile(good, 0.25), atol=1e-12, rtol=0)
+
+    def testFloatQuantiles(self):
+        """Test the median and quartiles of floating-point images, with odd and even numbers of pixels"""
+        rng = np.random.RandomState(43)
+        for width in (1, 2, 3, 10, 11):
+            image = afwImage.ImageD(lsst.geom.ExtentI(width, 1))
+            image.array[:] = rng.normal(size=image.array.shape)
+            stats = afwMath.makeStatistics(image, afwMath.MEDIAN | afwMath.IQRANGE)
+            q1, median, q3 = np.percentile(image.array, [25, 50, 75])
+            self.assertFloatsAlmostEqual(stats.getValue(afwMath.MEDIAN), median, rtol=1e-14, atol=1e-14)
+            self.assertFloatsAlmostEqual(stats.getValue(afwMath.IQRANGE), q3 - q1, rtol=1e-14, atol=1e-14)
+            self.assertEqual(afwMath.makeStatistics(image, afwMath.MEDIAN).getValue(),
+                             stats.getValue(afwMath.MEDIAN))
+
+    def testVectorize(self):
+        """Test that vectorised sums agree with the default ones to within rounding"""
+        rng = np.random.RandomState(44)
+        flags = afwMath.NPOINT | afwMath.MIN | afwMath.MAX | afwMath.MEAN | afwMath.VARIANCE | \
+            afwMath.MEANCLIP | afwMath.VARIANCECLIP
+        for width in (1, 3, 8, 101):
+            image = afwImage.MaskedImageF(lsst.geom.ExtentI(width, 7))
+            image.image.array[:] = rng.normal(loc=100.0, size=image.image.array.shape)
+            image.variance.array[:] = 1.0
+            image.mask.array[:] = rng.randint(0, 2, size=image.mask.array.shape)
+            ctrl = afwMath.StatisticsControl()
+            ctrl.setAndMask(0x1)
+            self.assertFalse(ctrl.getVectorize())
+            serial = afwMath.makeStatistics(image, flags, ctrl)
+            ctrl.setVectorize(True)
+            self.assertTrue(ctrl.getVectorize())
+            vector = afwMath.makeStatistics(image, flags, ctrl)
+            for flag in (afwMath.NPOINT, afwMath.MIN, afwMath.MAX):
+                self.assertEqual(vector.getValue(flag), serial.getValue(flag))
+            for flag in (afwMath.MEAN, afwMath.VARIANCE, afwMath.MEANCLIP, afwMath.VARIANCECLIP):
+                self.assertFloatsAlmostEqual(vector.getValue(flag), serial.getValue(flag),
+                                             rtol=1e-10, atol=1e-12)
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
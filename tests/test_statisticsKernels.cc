@@ -0,0 +1,116 @@
+/*
+ * This file is part of afw.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE StatisticsKernels
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-variable"
+#include "boost/test/unit_test.hpp"
+#pragma clang diagnostic pop
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "lsst/afw/math/detail/StatisticsKernels.h"
+
+namespace detail = lsst::afw::math::detail;
+using lsst::afw::image::MaskPixel;
+using lsst::afw::image::VariancePixel;
+
+namespace {
+
+// Sums of n terms may differ by O(n*epsilon) in relative terms when summed in a different order
+void checkSum(double a, double b, int n) {
+    double const tol = 4 * n * std::numeric_limits<double>::epsilon() * std::fabs(b);
+    BOOST_CHECK_MESSAGE(std::fabs(a - b) <= tol, a << " != " << b);
+}
+
+template <typename PixelT>
+void checkKernels() {
+    std::mt19937 rng(12345);
+    std::normal_distribution<double> normal(10.0, 3.0);
+    std::uniform_int_distribution<int> uniform(0, 99);
+
+    for (int n : {0, 1, 3, 4, 5, 17, 256, 1001}) {
+        std::vector<PixelT> img(n);
+        std::vector<MaskPixel> msk(n);
+        std::vector<VariancePixel> var(n);
+        for (int i = 0; i < n; ++i) {
+            img[i] = normal(rng);
+            msk[i] = uniform(rng) < 20 ? 0x1 << (uniform(rng) % 4) : 0x0;
+            var[i] = uniform(rng);
+            int const special = uniform(rng);
+            if (special == 0) {
+                img[i] = std::numeric_limits<PixelT>::quiet_NaN();
+            } else if (special == 1) {
+                img[i] = -std::numeric_limits<PixelT>::infinity();
+            }
+        }
+
+        for (bool checkFinite : {false, true}) {
+            for (bool doClip : {false, true}) {
+                detail::PixelSums expected;
+                detail::accumulatePixels(img.data(), msk.data(), var.data(), n, 10.0, 4.0, 0x2, checkFinite,
+                                         doClip, expected, detail::SimdLevel::SCALAR);
+                for (auto level : {detail::SimdLevel::SSE2, detail::SimdLevel::AVX2}) {
+                    detail::PixelSums sums;
+                    detail::accumulatePixels(img.data(), msk.data(), var.data(), n, 10.0, 4.0, 0x2,
+                                             checkFinite, doClip, sums, level);
+                    BOOST_CHECK_EQUAL(sums.n, expected.n);
+                    BOOST_CHECK_EQUAL(sums.orMask, expected.orMask);
+                    if (checkFinite) {
+                        BOOST_CHECK_EQUAL(sums.min, expected.min);
+                        BOOST_CHECK_EQUAL(sums.max, expected.max);
+                        checkSum(sums.sumx, expected.sumx, n);
+                        checkSum(sums.sumx2, expected.sumx2, n);
+                    }
+                    checkSum(sums.sumv, expected.sumv, n);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(KernelsFloat) { checkKernels<float>(); }
+
+BOOST_AUTO_TEST_CASE(KernelsDouble) { checkKernels<double>(); }
+
+BOOST_AUTO_TEST_CASE(MissingMaskAndVariance) {
+    std::vector<float> img = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0};
+    for (auto level : {detail::SimdLevel::SCALAR, detail::SimdLevel::SSE2, detail::SimdLevel::AVX2}) {
+        detail::PixelSums sums;
+        detail::accumulatePixels(img.data(), nullptr, nullptr, img.size(), 0.0, 0.0, 0x0, true, false, sums,
+                                 level);
+        BOOST_CHECK_EQUAL(sums.n, 7);
+        BOOST_CHECK_EQUAL(sums.sumx, 28.0);
+        BOOST_CHECK_EQUAL(sums.sumx2, 140.0);
+        BOOST_CHECK_EQUAL(sums.sumv, 0.0);
+        BOOST_CHECK_EQUAL(sums.min, 1.0);
+        BOOST_CHECK_EQUAL(sums.max, 7.0);
+        BOOST_CHECK_EQUAL(sums.orMask, 0x0);
+    }
+}
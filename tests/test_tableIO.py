@@ -26,6 +26,7 @@ import numpy as np
 import astropy.io.fits
 
 import lsst.utils.tests
+import lsst.pex.exceptions
 import lsst.geom
 import lsst.afw.table
 import lsst.afw.image
@@ -102,6 +103,222 @@ class TableIoTestCase(lsst.utils.tests.TestCase):
             self.assertFloatsEqual(larger[bb], larger2[bb])
             self.assertFloatsEqual(larger[cc], larger2[cc])
 
+    def testBlockWriting(self):
+        """Test writing a catalog whose rows are written in several blocks
+        """
+        schema = lsst.afw.table.Schema()
+        flagKeys = [schema.addField("f%d" % i, type="Flag", doc="flag %d" % i) for i in range(11)]
+        aa = schema.addField("a", type=np.int64, doc="a")
+        bb = schema.addField("b", type=np.float32, doc="b")
+        cc = schema.addField("c", type="ArrayD", doc="c", size=1000)
+        dd = schema.addField("d", type="Angle", doc="d")
+        ee = schema.addField("e", type="String", doc="e", size=8)
+        ff = schema.addField("f", type="ArrayI", doc="f", size=0)
+        # Each row takes about 8kB, so this needs about three blocks, the last one partial
+        nRows = 1300
+        rng = np.random.RandomState(5)
+        cat = lsst.afw.table.BaseCatalog(schema)
+        cat.resize(nRows)
+        cat[aa] = rng.randint(-2**40, 2**40, size=nRows)
+        cat[bb] = rng.randn(nRows)
+        cat[cc] = rng.randn(nRows, 1000)
+        flags = rng.randint(0, 2, size=(nRows, len(flagKeys))).astype(bool)
+        for i, record in enumerate(cat):
+            for j, key in enumerate(flagKeys):
+                record.set(key, flags[i, j])
+            record.set(dd, lsst.geom.Angle(rng.randn()))
+            record.set(ee, "r%d" % i)
+            record.set(ff, np.arange(i % 5, dtype=np.int32))
+        with lsst.utils.tests.getTempFilePath(".fits") as tmpFile:
+            cat.writeFits(tmpFile)
+            cat2 = lsst.afw.table.BaseCatalog.readFits(tmpFile)
+            self.assertEqual(len(cat2), nRows)
+            self.assertFloatsEqual(cat[aa], cat2[aa])
+            self.assertFloatsEqual(cat[bb], cat2[bb])
+            self.assertFloatsEqual(cat[cc], cat2[cc])
+            for j, key in enumerate(flagKeys):
+                np.testing.assert_array_equal(cat2[key], flags[:, j])
+            for record, record2 in zip(cat, cat2):
+                self.assertEqual(record.get(dd), record2.get(dd))
+                self.assertEqual(record.get(ee), record2.get(ee))
+                np.testing.assert_array_equal(record.get(ff), record2.get(ff))
+            # The flag bits are in the order of the TFLAGn keys
+            with astropy.io.fits.open(tmpFile) as inFits:
+                np.testing.assert_array_equal(inFits[1].data["flags"], flags)
+
+    def testBlockReading(self):
+        """Test reading a catalog in blocks of rows of several sizes, including blocks that
+        don't evenly divide the catalog and array columns that span several rows of a block.
+        """
+        schema = lsst.afw.table.Schema()
+        flagKeys = [schema.addField("f%d" % i, type="Flag", doc="flag %d" % i) for i in range(9)]
+        aa = schema.addField("a", type=np.int32, doc="a")
+        bb = schema.addField("b", type="ArrayF", doc="b", size=3)
+        cc = schema.addField("c", type="Angle", doc="c")
+        dd = schema.addField("d", type="ArrayD", doc="d", size=5)
+        ee = schema.addField("e", type="String", doc="e", size=4)
+        nRows = 23
+        rng = np.random.RandomState(7)
+        cat = lsst.afw.table.BaseCatalog(schema)
+        cat.resize(nRows)
+        cat[aa] = rng.randint(-1000, 1000, size=nRows)
+        cat[bb] = rng.randn(nRows, 3)
+        cat[dd] = rng.randn(nRows, 5)
+        flags = rng.randint(0, 2, size=(nRows, len(flagKeys))).astype(bool)
+        for i, record in enumerate(cat):
+            for j, key in enumerate(flagKeys):
+                record.set(key, flags[i, j])
+            record.set(cc, lsst.geom.Angle(rng.randn()))
+            record.set(ee, "r%d" % i)
+        oldFactor = lsst.afw.table.io.getPreppedRowsFactor()
+        try:
+            with lsst.utils.tests.getTempFilePath(".fits") as tmpFile:
+                cat.writeFits(tmpFile)
+                for blockSize in (1, 2, 5, nRows, 2*nRows):
+                    with self.subTest(blockSize=blockSize):
+                        lsst.afw.table.io.setPreppedRowsFactor(blockSize*schema.getRecordSize())
+                        cat2 = lsst.afw.table.BaseCatalog.readFits(tmpFile)
+                        self.assertEqual(len(cat2), nRows)
+                        self.assertFloatsEqual(cat[aa], cat2[aa])
+                        self.assertFloatsEqual(cat[bb], cat2[bb])
+                        self.assertFloatsEqual(cat[dd], cat2[dd])
+                        for j, key in enumerate(flagKeys):
+                            np.testing.assert_array_equal(cat2[key], flags[:, j])
+                        for record, record2 in zip(cat, cat2):
+                            self.assertEqual(record.get(cc), record2.get(cc))
+                            self.assertEqual(record.get(ee), record2.get(ee))
+        finally:
+            lsst.afw.table.io.setPreppedRowsFactor(oldFactor)
+
+    def testColumnSelection(self):
+        """Test reading only some of the columns of a catalog, selected by name, prefix or alias
+        """
+        schema = lsst.afw.table.SourceTable.makeMinimalSchema()
+        centroidKey = lsst.afw.table.Point2DKey.addFields(schema, "cen", "centroid", "pixel")
+        centroidFlagKey = schema.addField("cen_flag", type="Flag", doc="centroid failed")
+        fluxKey = schema.addField("flux_instFlux", type=np.float64, doc="flux", units="count")
+        fluxFlagKey = schema.addField("flux_flag", type="Flag", doc="flux failed")
+        arrayKey = schema.addField("arr", type="ArrayF", doc="array", size=3)
+        schema.getAliasMap().set("slot_Centroid", "cen")
+        schema.getAliasMap().set("slot_PsfFlux", "flux")
+        cat = lsst.afw.table.SourceCatalog(schema)
+        for i in range(10):
+            record = cat.addNew()
+            record.set(centroidKey, lsst.geom.Point2D(i, 2*i))
+            record.set(centroidFlagKey, i % 2 == 0)
+            record.set(fluxKey, 3.0*i)
+            record.set(fluxFlagKey, i % 3 == 0)
+            record.set(arrayKey, np.arange(i, i + 3, dtype=np.float32))
+        with lsst.utils.tests.getTempFilePath(".fits") as tmpFile:
+            cat.writeFits(tmpFile)
+            options = lsst.afw.table.io.FitsReadOptions()
+            options.columns = ["slot_Centroid", "arr"]
+            cat2 = lsst.afw.table.SourceCatalog.readFits(tmpFile, options)
+            schema2 = cat2.schema
+            # The minimal schema's fields are always read
+            self.assertEqual(schema2.getNames(),
+                             {"id", "coord_ra", "coord_dec", "parent", "cen_x", "cen_y", "cen_flag",
+                              "arr"})
+            self.assertLess(schema2.getRecordSize(), schema.getRecordSize())
+            self.assertEqual(dict(schema2.getAliasMap()), {"slot_Centroid": "cen"})
+            self.assertEqual(len(cat2), len(cat))
+            for record, record2 in zip(cat, cat2):
+                self.assertEqual(record.getId(), record2.getId())
+                self.assertEqual(record.getCentroid(), record2.getCentroid())
+                self.assertEqual(record.get(centroidFlagKey), record2.get("cen_flag"))
+                np.testing.assert_array_equal(record.get(arrayKey), record2.get("arr"))
+            # A selection with no flags doesn't read any
+            options.columns = ["flux_instFlux"]
+            cat3 = lsst.afw.table.SourceCatalog.readFits(tmpFile, options)
+            self.assertEqual(cat3.schema.getNames(),
+                             {"id", "coord_ra", "coord_dec", "parent", "flux_instFlux"})
+            self.assertEqual(dict(cat3.schema.getAliasMap()), {"slot_PsfFlux": "flux"})
+            self.assertFloatsEqual(cat3["flux_instFlux"], cat[fluxKey])
+            options.columns = ["flux_instFlux", "nonexistent"]
+            with self.assertRaises(lsst.pex.exceptions.NotFoundError):
+                lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+
+    def testRowSelection(self):
+        """Test reading a range of rows, and only the rows that pass a filter on their values
+        """
+        schema = lsst.afw.table.Schema()
+        f0 = schema.addField("f0", type="Flag", doc="flag 0")
+        f1 = schema.addField("f1", type="Flag", doc="flag 1")
+        aa = schema.addField("a", type=np.int32, doc="a")
+        bb = schema.addField("b", type=np.float64, doc="b")
+        cc = schema.addField("c", type="String", doc="c", size=6)
+        schema.getAliasMap().set("bAlias", "b")
+        nRows = 50
+        rng = np.random.RandomState(3)
+        cat = lsst.afw.table.BaseCatalog(schema)
+        cat.resize(nRows)
+        cat[aa] = np.arange(nRows, dtype=np.int32)
+        values = rng.randn(nRows)
+        values[::7] = np.nan
+        cat[bb] = values
+        flags = rng.randint(0, 2, size=(nRows, 2)).astype(bool)
+        for i, record in enumerate(cat):
+            record.set(f0, flags[i, 0])
+            record.set(f1, flags[i, 1])
+            record.set(cc, "r%d" % i)
+        oldFactor = lsst.afw.table.io.getPreppedRowsFactor()
+        try:
+            # Use blocks of a few rows, so the selected rows span several
+            lsst.afw.table.io.setPreppedRowsFactor(4*schema.getRecordSize())
+            with lsst.utils.tests.getTempFilePath(".fits") as tmpFile:
+                cat.writeFits(tmpFile)
+                options = lsst.afw.table.io.FitsReadOptions()
+                self.assertFalse(options.hasRowFilter())
+                options.firstRow = 5
+                options.nRows = 30
+                cat2 = lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+                self.assertEqual(list(cat2[aa]), list(range(5, 35)))
+                options.nRows = 1000
+                cat2 = lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+                self.assertEqual(list(cat2[aa]), list(range(5, nRows)))
+
+                options.unsetFlags = ["f0"]
+                options.setFlags = ["f1"]
+                options.valueRanges = {"bAlias": (-0.5, 1.0)}
+                self.assertTrue(options.hasRowFilter())
+                cat2 = lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+                self.assertTrue(cat2.isContiguous())
+                with np.errstate(invalid="ignore"):
+                    passes = np.logical_and.reduce([~flags[:, 0], flags[:, 1],
+                                                    values >= -0.5, values <= 1.0])
+                passes[:5] = False
+                self.assertGreater(passes.sum(), 0)
+                self.assertEqual(list(cat2[aa]), list(np.flatnonzero(passes)))
+                self.assertFloatsEqual(cat2[bb], values[passes])
+                for record in cat2:
+                    self.assertEqual(record.get(cc), "r%d" % record.get(aa))
+                    self.assertFalse(record.get(f0))
+                    self.assertTrue(record.get(f1))
+
+                # The filter's fields need not be read
+                options.columns = ["c"]
+                cat3 = lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+                self.assertEqual(cat3.schema.getNames(), {"c"})
+                self.assertEqual([record.get("c") for record in cat3], [record.get(cc) for record in cat2])
+
+                options = lsst.afw.table.io.FitsReadOptions()
+                options.unsetFlags = ["a"]
+                with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+                    lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+                options = lsst.afw.table.io.FitsReadOptions()
+                options.valueRanges = {"c": (0.0, 1.0)}
+                with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+                    lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+                options.valueRanges = {"d": (0.0, 1.0)}
+                with self.assertRaises(lsst.pex.exceptions.NotFoundError):
+                    lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+                options = lsst.afw.table.io.FitsReadOptions()
+                options.firstRow = nRows + 1
+                with self.assertRaises(lsst.pex.exceptions.OutOfRangeError):
+                    lsst.afw.table.BaseCatalog.readFits(tmpFile, options)
+        finally:
+            lsst.afw.table.io.setPreppedRowsFactor(oldFactor)
+
 
 class MemoryTester(lsst.utils.tests.MemoryTestCase):
     pass
@@ -29,6 +29,7 @@
 
 #include "boost/test/unit_test.hpp"
 
+#include "lsst/pex/exceptions.h"
 #include "lsst/afw/geom/Transform.h"
 
 /*
@@ -105,6 +106,45 @@ BOOST_AUTO_TEST_CASE(getJacobianDimensions) {
         }
     }
 }
+
+/*
+ * Tests that Transform::applyForwardData and applyInverseData match applyForward and applyInverse,
+ * and reject arrays of the wrong shape.
+ */
+BOOST_AUTO_TEST_CASE(applyData) {
+    using Point2Transform = Transform<Point2Endpoint, Point2Endpoint>;
+    Point2Transform transform(ast::ZoomMap(2, 1.5).then(ast::ShiftMap({3.0, -2.0})));
+
+    int const nPoints = 7;
+    std::vector<lsst::geom::Point2D> points;
+    ndarray::Array<double, 2, 2> data = ndarray::allocate(ndarray::makeVector(2, nPoints));
+    for (int i = 0; i < nPoints; ++i) {
+        points.emplace_back(0.5 * i, 4.0 - i);
+        data[0][i] = points.back().getX();
+        data[1][i] = points.back().getY();
+    }
+
+    ndarray::Array<double, 2, 2> forward = ndarray::allocate(ndarray::makeVector(2, nPoints));
+    transform.applyForwardData(data, forward);
+    auto const expectedForward = transform.applyForward(points);
+    for (int i = 0; i < nPoints; ++i) {
+        BOOST_TEST(forward[0][i] == expectedForward[i].getX());
+        BOOST_TEST(forward[1][i] == expectedForward[i].getY());
+    }
+
+    ndarray::Array<double, 2, 2> inverse = ndarray::allocate(ndarray::makeVector(2, nPoints));
+    transform.applyInverseData(forward, inverse);
+    for (int i = 0; i < nPoints; ++i) {
+        BOOST_TEST(inverse[0][i] == data[0][i], boost::test_tools::tolerance(1e-14));
+        BOOST_TEST(inverse[1][i] == data[1][i], boost::test_tools::tolerance(1e-14));
+    }
+
+    ndarray::Array<double, 2, 2> tooShort = ndarray::allocate(ndarray::makeVector(2, nPoints - 1));
+    BOOST_CHECK_THROW(transform.applyForwardData(data, tooShort), pex::exceptions::InvalidParameterError);
+    ndarray::Array<double, 2, 2> tooManyAxes = ndarray::allocate(ndarray::makeVector(3, nPoints));
+    BOOST_CHECK_THROW(transform.applyInverseData(tooManyAxes, forward),
+                      pex::exceptions::InvalidParameterError);
+}
 }  // namespace geom
 }  // namespace afw
 }  // namespace lsst
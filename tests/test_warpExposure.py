@@ -471,6 +471,145 @@ class WarpExposureTestCase(lsst.utils.tests.TestCase):
         noDataBitMask = afwImage.Mask.getPlaneBitMask("NO_DATA")
         self.assertTrue(np.all(maskArr == noDataBitMask))
 
+    def testMultiThreaded(self):
+        """Test that warping in parallel gives exactly the serial result
+        """
+        rng = np.random.RandomState(3)
+        srcImage = afwImage.MaskedImageF(lsst.geom.Box2I(lsst.geom.Point2I(5, -3),
+                                                         lsst.geom.Extent2I(190, 170)))
+        srcImage.image.array[:] = rng.normal(100.0, 10.0, size=srcImage.image.array.shape)
+        srcImage.variance.array[:] = rng.uniform(50.0, 150.0, size=srcImage.image.array.shape)
+        srcImage.mask.array[::11, ::7] = afwImage.Mask.getPlaneBitMask("BAD")
+        srcImage.image.array[50, 60] = np.nan
+
+        linearTransform = lsst.geom.LinearTransform(np.array([[1.03, -0.18], [0.17, 0.96]]))
+        srcToDest = afwGeom.makeTransform(lsst.geom.AffineTransform(linearTransform,
+                                                                    lsst.geom.Extent2D(-8.5, 12.25)))
+        destBBox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(210, 185))
+
+        for interpLength in (0, 7):
+            warpingControl = afwMath.WarpingControl("lanczos3", "bilinear", cacheSize=10000,
+                                                    interpLength=interpLength)
+            self.assertEqual(warpingControl.getNumThreads(), 1)
+            serial = afwImage.MaskedImageF(destBBox)
+            numGoodSerial = afwMath.warpImage(serial, srcImage, srcToDest, warpingControl)
+            self.assertGreater(numGoodSerial, 0)
+            self.assertLess(numGoodSerial, destBBox.getArea())
+            for numThreads in (0, 2, 3):
+                with self.subTest(interpLength=interpLength, numThreads=numThreads):
+                    warpingControl.setNumThreads(numThreads)
+                    self.assertEqual(warpingControl.getNumThreads(), numThreads)
+                    parallel = afwImage.MaskedImageF(destBBox)
+                    numGood = afwMath.warpImage(parallel, srcImage, srcToDest, warpingControl)
+                    self.assertEqual(numGood, numGoodSerial)
+                    self.assertMaskedImagesEqual(parallel, serial)
+
+        with self.assertRaises(pexExcept.InvalidParameterError):
+            afwMath.WarpingControl("lanczos3").setNumThreads(-1)
+
+    def testNoInterpolation(self):
+        """Test that warping without interpolation, which transforms the
+        destination positions in blocks of rows, matches interpolating
+        every pixel (interpLength=1)
+        """
+        rng = np.random.RandomState(7)
+        srcImage = afwImage.MaskedImageF(lsst.geom.Box2I(lsst.geom.Point2I(2, 3),
+                                                         lsst.geom.Extent2I(150, 420)))
+        srcImage.image.array[:] = rng.normal(100.0, 10.0, size=srcImage.image.array.shape)
+        srcImage.variance.array[:] = rng.uniform(50.0, 150.0, size=srcImage.image.array.shape)
+        srcImage.mask.array[::13, ::3] = afwImage.Mask.getPlaneBitMask("BAD")
+
+        linearTransform = lsst.geom.LinearTransform(np.array([[1.01, 0.07], [-0.05, 0.98]]))
+        srcToDest = afwGeom.makeTransform(lsst.geom.AffineTransform(linearTransform,
+                                                                    lsst.geom.Extent2D(-4.2, 6.9)))
+        # tall enough that the positions are transformed in several blocks
+        destBBox = lsst.geom.Box2I(lsst.geom.Point2I(-3, 1), lsst.geom.Extent2I(140, 400))
+
+        interpolated = afwImage.MaskedImageF(destBBox)
+        numGoodInterpolated = afwMath.warpImage(interpolated, srcImage, srcToDest,
+                                                afwMath.WarpingControl("lanczos3", interpLength=1))
+        exact = afwImage.MaskedImageF(destBBox)
+        numGood = afwMath.warpImage(exact, srcImage, srcToDest,
+                                    afwMath.WarpingControl("lanczos3", interpLength=0))
+        self.assertGreater(numGood, 0)
+        self.assertEqual(numGood, numGoodInterpolated)
+        self.assertMaskedImagesAlmostEqual(exact, interpolated, rtol=1e-6)
+
+    def testInterpTolerance(self):
+        """Test that warping with an interpolation tolerance matches an
+        exact warp, even with a long interpolation length
+        """
+        srcImage = afwImage.MaskedImageF(lsst.geom.Box2I(lsst.geom.Point2I(0, 0),
+                                                         lsst.geom.Extent2I(200, 200)))
+        yArr, xArr = np.mgrid[0:200, 0:200]
+        srcImage.image.array[:] = 100.0 + 0.2*xArr + 0.1*yArr + 10.0*np.sin(xArr/15.0)
+        srcImage.variance.array[:] = 100.0
+
+        # a strongly distorting transform
+        srcToDest = afwGeom.makeRadialTransform([0.0, 1.0, 0.0, 1.0e-6])
+        destBBox = lsst.geom.Box2I(lsst.geom.Point2I(20, 20), lsst.geom.Extent2I(150, 150))
+
+        exact = afwImage.MaskedImageF(destBBox)
+        numGoodExact = afwMath.warpImage(exact, srcImage, srcToDest, afwMath.WarpingControl("lanczos3"))
+        self.assertEqual(numGoodExact, destBBox.getArea())
+
+        for interpLength in (1, 7, 64):
+            with self.subTest(interpLength=interpLength):
+                warpingControl = afwMath.WarpingControl("lanczos3", interpLength=interpLength)
+                self.assertEqual(warpingControl.getInterpTolerance(), 0.0)
+                warpingControl.setInterpTolerance(0.001)
+                self.assertEqual(warpingControl.getInterpTolerance(), 0.001)
+                adaptive = afwImage.MaskedImageF(destBBox)
+                numGood = afwMath.warpImage(adaptive, srcImage, srcToDest, warpingControl)
+                self.assertEqual(numGood, numGoodExact)
+                self.assertImagesAlmostEqual(adaptive.image, exact.image, atol=0.01, rtol=0)
+                self.assertImagesAlmostEqual(adaptive.variance, exact.variance, rtol=1e-4)
+
+        with self.assertRaises(pexExcept.InvalidParameterError):
+            afwMath.WarpingControl("lanczos3").setInterpTolerance(-0.1)
+
+    def testLanczosCache(self):
+        """Test that warping with a cached Lanczos kernel (which looks up
+        the kernel in a table) matches warping with the exact kernel
+        """
+        rng = np.random.RandomState(5)
+        srcImage = afwImage.MaskedImageF(lsst.geom.Box2I(lsst.geom.Point2I(-4, 7),
+                                                         lsst.geom.Extent2I(120, 110)))
+        srcImage.image.array[:] = rng.normal(100.0, 10.0, size=srcImage.image.array.shape)
+        srcImage.variance.array[:] = rng.uniform(50.0, 150.0, size=srcImage.image.array.shape)
+        srcImage.mask.array[::9, ::5] = afwImage.Mask.getPlaneBitMask("BAD")
+        srcImage.mask.array[40:43, 30] = afwImage.Mask.getPlaneBitMask("EDGE")
+        srcImage.image.array[60, 25] = np.nan
+
+        linearTransform = lsst.geom.LinearTransform(np.array([[0.97, 0.21], [-0.19, 1.02]]))
+        srcToDest = afwGeom.makeTransform(lsst.geom.AffineTransform(linearTransform,
+                                                                    lsst.geom.Extent2D(3.3, -6.7)))
+        destBBox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(125, 115))
+
+        for kernelName in ("lanczos3", "lanczos4", "lanczos5"):
+            for maskKernelName in ("", "bilinear"):
+                with self.subTest(kernelName=kernelName, maskKernelName=maskKernelName):
+                    exact = afwImage.MaskedImageF(destBBox)
+                    numGoodExact = afwMath.warpImage(
+                        exact, srcImage, srcToDest,
+                        afwMath.WarpingControl(kernelName, maskKernelName, cacheSize=0))
+                    cached = afwImage.MaskedImageF(destBBox)
+                    numGood = afwMath.warpImage(
+                        cached, srcImage, srcToDest,
+                        afwMath.WarpingControl(kernelName, maskKernelName, cacheSize=20000))
+                    self.assertGreater(numGood, 0)
+                    self.assertEqual(numGood, numGoodExact)
+                    self.assertMaskedImagesAlmostEqual(cached, exact, rtol=1e-4)
+
+            with self.subTest(kernelName=kernelName, image=True):
+                exact = afwImage.ImageF(destBBox)
+                afwMath.warpImage(exact, srcImage.image, srcToDest,
+                                  afwMath.WarpingControl(kernelName, cacheSize=0))
+                cached = afwImage.ImageF(destBBox)
+                afwMath.warpImage(cached, srcImage.image, srcToDest,
+                                  afwMath.WarpingControl(kernelName, cacheSize=20000))
+                self.assertImagesAlmostEqual(cached, exact, rtol=1e-4)
+
     def verifyMaskWarp(self, kernelName, maskKernelName, growFullMask, interpLength=10, cacheSize=100000,
                        rtol=4e-05, atol=1e-2):
         """Verify that using a separate mask warping kernel produces the correct results